@@ -29,20 +29,37 @@ extern "C" {
 			strcpy_s(avcMSG, 512, "Opening dimensional portal between FAST and RLSimion\n");
 			tinyxml2::XMLDocument configFile;
 			const char* pipeName;
+			const char* sharedMemoryName;
 
 			printf("Loading Dimensional portal config file: %s\n", accINFILE);
 			if (configFile.LoadFile(accINFILE) == tinyxml2::XML_NO_ERROR)
 			{
 				tinyxml2::XMLElement *pNode;
 				pNode = configFile.FirstChildElement("FAST-DIMENSIONAL-PORTAL");
-				pipeName= pNode->FirstChildElement("PIPE-NAME")->GetText();
-				
-				if (g_FASTWorldPortal.connectToNamedPipeServer(pipeName))
-					printf("Connected to master process via pipe %s\n", pipeName);
+				//RLSimion uses shared memory if it could create the channel, and a named pipe otherwise
+				if (pNode->FirstChildElement("SHARED-MEMORY-NAME"))
+				{
+					sharedMemoryName = pNode->FirstChildElement("SHARED-MEMORY-NAME")->GetText();
+
+					if (g_FASTWorldPortal.connectToSharedMemoryServer(sharedMemoryName))
+						printf("Connected to master process via shared memory %s\n", sharedMemoryName);
+					else
+					{
+						printf("Failed to connect to master process via shared memory %s\n", sharedMemoryName);
+						*aviFAIL = -1;
+					}
+				}
 				else
 				{
-					printf("Failed to connect to master process via pipe %s\n", pipeName);
-					*aviFAIL = -1;
+					pipeName = pNode->FirstChildElement("PIPE-NAME")->GetText();
+
+					if (g_FASTWorldPortal.connectToNamedPipeServer(pipeName))
+						printf("Connected to master process via pipe %s\n", pipeName);
+					else
+					{
+						printf("Failed to connect to master process via pipe %s\n", pipeName);
+						*aviFAIL = -1;
+					}
 				}
 			}
 			else
@@ -64,7 +81,7 @@ extern "C" {
 		if (iStatus < 0)
 		{
 			//Last call
-			g_FASTWorldPortal.disconnectFromNamedPipeServer();
+			g_FASTWorldPortal.disconnectFromServer();
 		}
 	}
 }
\ No newline at end of file
@@ -162,22 +162,38 @@ void FASTWorldPortal::setActionVariables(float* FASTdata, bool bFirstTime)
 
 bool  FASTWorldPortal::connectToNamedPipeServer(const char* pipeName)
 {
+	m_bUsingSharedMemory = false;
 	return m_namedPipeClient.connectToServer(pipeName,false); //bAddPrefix= false because we are reading the full name from xml config file
 }
 
-void FASTWorldPortal::disconnectFromNamedPipeServer()
+bool  FASTWorldPortal::connectToSharedMemoryServer(const char* name)
 {
-	m_namedPipeClient.closeConnection();
+	m_bUsingSharedMemory = true;
+	return m_sharedMemoryClient.connectToServer(name, false); //bAddPrefix= false because we are reading the full name from xml config file
+}
+
+void FASTWorldPortal::disconnectFromServer()
+{
+	if (m_bUsingSharedMemory)
+		m_sharedMemoryClient.closeConnection();
+	else
+		m_namedPipeClient.closeConnection();
 }
 
 void FASTWorldPortal::sendState()
 {
 	double *pValues= s->getValueVector();
-	m_namedPipeClient.writeBuffer(pValues, (int) s->getNumVars()*sizeof(double));
+	if (m_bUsingSharedMemory)
+		m_sharedMemoryClient.writeBuffer(pValues, (int) s->getNumVars()*sizeof(double));
+	else
+		m_namedPipeClient.writeBuffer(pValues, (int) s->getNumVars()*sizeof(double));
 }
 
 void FASTWorldPortal::receiveAction()
 {
 	double *pValues = a->getValueVector();
-	m_namedPipeClient.readToBuffer(pValues, (int) a->getNumVars() * sizeof(double));
+	if (m_bUsingSharedMemory)
+		m_sharedMemoryClient.readToBuffer(pValues, (int) a->getNumVars() * sizeof(double));
+	else
+		m_namedPipeClient.readToBuffer(pValues, (int) a->getNumVars() * sizeof(double));
 }
\ No newline at end of file
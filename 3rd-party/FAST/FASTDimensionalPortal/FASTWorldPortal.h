@@ -2,6 +2,7 @@
 
 #include "../../../RLSimion/Common/named-var-set.h"
 #include "../../../tools/System/NamedPipe.h"
+#include "../../../tools/System/SharedMemoryChannel.h"
 
 #include <map>
 
@@ -19,6 +20,8 @@ class FASTActionDescriptor : public Descriptor
 class FASTWorldPortal
 {
 	NamedPipeClient m_namedPipeClient;
+	SharedMemoryChannelClient m_sharedMemoryClient;
+	bool m_bUsingSharedMemory = false;
 
 	double m_lastTime;
 	double m_elapsedTime;
@@ -45,5 +48,6 @@ public:
 	void receiveAction();
 
 	bool connectToNamedPipeServer(const char* name);
-	void disconnectFromNamedPipeServer();
+	bool connectToSharedMemoryServer(const char* name);
+	void disconnectFromServer();
 };
@@ -29,7 +29,10 @@
 #include "../Lib/app.h"
 #include "../Lib/logger.h"
 #include "../Lib/config.h"
+#include "../Lib/batch-runner.h"
+#include "../Lib/async-runner.h"
 #include "../../tools/System/FileUtils.h"
+#include <algorithm>
 
 int main(int argc, char* argv[])
 {
@@ -57,9 +60,66 @@ int main(int argc, char* argv[])
 				Logger::logMessage(MessageType::Info, "Failed to connect to output named pipe");
 		}
 
+		//allocation of the memory used by the VFAs: -huge-pages, -numa-node=<n> or -numa-interleave, and
+		//-mem-init-threads=<n>. By default, it is allocated in the heap and initialized by a single thread
+		bool bHugePages = SimionApp::flagPassed(argc, argv, "huge-pages");
+		NumaPolicy numaPolicy = NumaPolicy::Local;
+		int numaNode = 0;
+		const char* pNumaNode = SimionApp::getArgValue(argc, argv, "numa-node");
+		if (pNumaNode)
+		{
+			numaPolicy = NumaPolicy::Bind;
+			numaNode = std::max(0, atoi(pNumaNode));
+		}
+		else if (SimionApp::flagPassed(argc, argv, "numa-interleave"))
+			numaPolicy = NumaPolicy::Interleave;
+		bool bPageAllocator = bHugePages || numaPolicy != NumaPolicy::Local;
+		const char* pNumInitThreads = SimionApp::getArgValue(argc, argv, "mem-init-threads");
+		unsigned int numMemInitThreads = pNumInitThreads ? (unsigned int)std::max(0, atoi(pNumInitThreads)) : 1;
+
+		//batch mode: -batch=<list|dir> runs all the experiments in parallel in this process
+		const char* pBatch = SimionApp::getArgValue(argc, argv, "batch");
+		if (pBatch)
+		{
+			BatchRunner batchRunner(pBatch);
+			if (bPageAllocator)
+				batchRunner.usePageAllocator(bHugePages, numaPolicy, numaNode);
+			batchRunner.setNumMemInitThreads(numMemInitThreads);
+
+			const char* pNumThreads = SimionApp::getArgValue(argc, argv, "batch-threads");
+			if (pNumThreads)
+				batchRunner.setNumThreads((unsigned int)std::max(0, atoi(pNumThreads)));
+
+			if (SimionApp::flagPassed(argc, argv, "gpu"))
+				batchRunner.setPreferredDevice(Device::GPU);
+			else batchRunner.setPreferredDevice(Device::CPU);
+
+			size_t numFailedExperiments = batchRunner.run();
+			Logger::closeOutputPipe();
+			return numFailedExperiments == 0 ? 0 : 1;
+		}
+
 		if (argc <= 1)
 			Logger::logMessage(MessageType::Error, "Too few parameters: no config file provided");
 
+		//asynchronous mode: -async-workers=<n> runs the experiment with n workers that share the weights of the VFAs
+		const char* pNumAsyncWorkers = SimionApp::getArgValue(argc, argv, "async-workers");
+		if (pNumAsyncWorkers && !SimionApp::flagPassed(argc, argv, "requirements"))
+		{
+			AsyncRunner asyncRunner(argv[1], (unsigned int)std::max(0, atoi(pNumAsyncWorkers)));
+			if (bPageAllocator)
+				asyncRunner.getSharedMemManager()->usePageAllocator(bHugePages, numaPolicy, numaNode);
+			asyncRunner.getSharedMemManager()->setNumInitThreads(numMemInitThreads);
+
+			if (SimionApp::flagPassed(argc, argv, "gpu"))
+				asyncRunner.setPreferredDevice(Device::GPU);
+			else asyncRunner.setPreferredDevice(Device::CPU);
+
+			bool bSuccess = asyncRunner.run();
+			Logger::closeOutputPipe();
+			return bSuccess ? 0 : 1;
+		}
+
 		ConfigNode* pParameters= configXMLFile.loadFile(argv[1]);
 		if (!pParameters) throw std::runtime_error("Wrong experiment configuration file");
 
@@ -78,12 +138,21 @@ int main(int argc, char* argv[])
 				pApp->setExecutedRemotely(false);
 			else pApp->setExecutedRemotely(true);
 
+			//the window is drawn by another thread at -render-fps=<n> frames per second (60 by default)
+			const char* pRenderFPS = SimionApp::getArgValue(argc, argv, "render-fps");
+			if (pRenderFPS)
+				pApp->setRenderFPS(atof(pRenderFPS));
+
 			//CPU is used by default.
 			//tests so far seem to run faster on multi-core cpus than using gpus O_o
 			if (SimionApp::flagPassed(argc, argv, "gpu"))
 				pApp->setPreferredDevice(Device::GPU);
 			else pApp->setPreferredDevice(Device::CPU);
 
+			if (bPageAllocator)
+				pApp->pMemManager->usePageAllocator(bHugePages, numaPolicy, numaNode);
+			pApp->pMemManager->setNumInitThreads(numMemInitThreads);
+
 			if (SimionApp::flagPassed(argc, argv, "requirements"))
 				pApp->printRequirements();
 			else pApp->run();
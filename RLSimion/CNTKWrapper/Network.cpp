@@ -274,6 +274,56 @@ vector<double>& Network::evaluate(const State* s, const Action* a)
 	return m_output;
 }
 
+void Network::evaluateBatch(const State* const* pStates, const Action* const* pActions, size_t numSamples
+	, size_t outputIndex, double* pOutValues)
+{
+	//the whole batch is evaluated with a single call
+	ValuePtr outputValue;
+	unordered_map<CNTK::Variable, CNTK::ValuePtr> outputs =
+		{ { m_FunctionPtr->Output(), outputValue } };
+
+	unordered_map<CNTK::Variable, CNTK::ValuePtr> inputs = {};
+
+	vector<double> sampleInput;
+	vector<double> inputStates;
+	if (m_bInputStateUsed)
+	{
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			stateToVector(pStates[i], sampleInput);
+			inputStates.insert(inputStates.end(), sampleInput.begin(), sampleInput.end());
+		}
+		inputs[m_inputState] = CNTK::Value::CreateBatch(m_inputState.Shape()
+			, inputStates, CNTK::DeviceDescriptor::UseDefaultDevice());
+	}
+	vector<double> inputActions;
+	if (m_bInputActionUsed)
+	{
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			actionToVector(pActions[i], sampleInput);
+			inputActions.insert(inputActions.end(), sampleInput.begin(), sampleInput.end());
+		}
+		inputs[m_inputAction] = CNTK::Value::CreateBatch(m_inputAction.Shape()
+			, inputActions, CNTK::DeviceDescriptor::UseDefaultDevice());
+	}
+
+	m_FunctionPtr->Evaluate(inputs, outputs, CNTK::DeviceDescriptor::UseDefaultDevice());
+
+	outputValue = outputs[m_FunctionPtr];
+
+	size_t numOutputs = m_FunctionPtr->Output().Shape().TotalSize();
+	vector<double> batchOutput(numOutputs * numSamples);
+	CNTK::NDShape outputShape = m_FunctionPtr->Output().Shape().AppendShape({ 1, numSamples });
+
+	CNTK::NDArrayViewPtr cpuArrayOutput = CNTK::MakeSharedObject<CNTK::NDArrayView>(outputShape
+		, batchOutput, false);
+	cpuArrayOutput->CopyFrom(*outputValue->Data());
+
+	for (size_t i = 0; i < numSamples; ++i)
+		pOutValues[i] = batchOutput[i * numOutputs + outputIndex];
+}
+
 void Network::gradientWrtAction(const State* s, const Action* a, vector<double>& outputGradient)
 {
 	unordered_map<Variable, ValuePtr> arguments = {};
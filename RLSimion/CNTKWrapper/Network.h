@@ -61,6 +61,8 @@ public:
 	//StateActionFunction interface
 	unsigned int getNumOutputs();
 	vector<double>& evaluate(const State* s, const Action* a);
+	void evaluateBatch(const State* const* pStates, const Action* const* pActions, size_t numSamples, size_t outputIndex
+		, double* pOutValues);
 	const vector<string>& getInputStateVariables();
 	const vector<string>& getInputActionVariables();
 };
\ No newline at end of file
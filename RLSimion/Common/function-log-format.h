@@ -0,0 +1,54 @@
+#pragma once
+
+//Binary format of the function log files, shared by the writer (RLSimion/Lib) and the readers (tools/SimionLogViewer)
+
+#define FUNCTION_SAMPLE_HEADER 6543
+#define FUNCTION_DECLARATION_HEADER 5432
+#define FUNCTION_LOG_FILE_HEADER 4321
+#define FUNCTION_LOG_FILE_VERSION 1
+#define FUNCTION_LOG_FILE_VERSION_ENCODED 2
+
+#define MAX_FUNCTION_ID_LENGTH 128
+
+//using long long int to assure C# data-type compatibility
+
+struct FunctionLogHeader
+{
+	long long int magicNumber = FUNCTION_LOG_FILE_HEADER;
+	long long int fileVersion = FUNCTION_LOG_FILE_VERSION;
+	long long int numFunctions = 0;
+};
+
+struct FunctionDeclarationHeader
+{
+	long long int magicNumber = FUNCTION_DECLARATION_HEADER;
+	long long int id;
+	char name[MAX_FUNCTION_ID_LENGTH];
+	long long int numSamplesX;
+	long long int numSamplesY;
+	long long int numSamplesZ;
+};
+
+struct FunctionSampleHeader
+{
+	long long int magicNumber = FUNCTION_SAMPLE_HEADER;
+	long long int episode;
+	long long int step;
+	long long int experimentStep;
+	long long int id;
+};
+
+//Version 2 files: every FunctionSampleHeader is followed by a FunctionSampleEncodingHeader and the values are stored
+//as given by its encoding. Delta-encoded values are the change from the previous sample of the same function divided by
+//the quantum, so value[i]= previousValue[i] + delta[i] * quantum. The size of the values is padded to a multiple of 8 bytes
+#define FUNCTION_SAMPLE_FULL_DOUBLE 0
+#define FUNCTION_SAMPLE_FULL_FLOAT 1
+#define FUNCTION_SAMPLE_DELTA_INT8 2
+#define FUNCTION_SAMPLE_DELTA_INT16 3
+#define FUNCTION_SAMPLE_UNCHANGED 4
+
+struct FunctionSampleEncodingHeader
+{
+	long long int encoding;
+	double quantum;
+};
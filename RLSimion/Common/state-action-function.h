@@ -19,6 +19,18 @@ public:
 	virtual vector<double>& evaluate(const State* s, const Action* a) = 0;
 	virtual const vector<string>& getInputStateVariables() = 0;
 	virtual const vector<string>& getInputActionVariables() = 0;
+
+	//Evaluates the output outputIndex of the function for a batch of state-action pairs:
+	//pOutValues[i]= evaluate(pStates[i], pActions[i])[outputIndex]. Used to sample functions (see FunctionSampler).
+	//Implementations can override it to evaluate the whole batch at once
+	virtual void evaluateBatch(const State* const* pStates, const Action* const* pActions, size_t numSamples
+		, size_t outputIndex, double* pOutValues)
+	{
+		for (size_t i = 0; i < numSamples; ++i)
+			pOutValues[i] = evaluate(pStates[i], pActions[i])[outputIndex];
+	}
+	//Whether evaluateBatch() can be called from several threads at the same time
+	virtual bool isBatchEvaluationThreadSafe() { return false; }
 };
 
 #endif //__STATE_ACTION_FUNCTION
\ No newline at end of file
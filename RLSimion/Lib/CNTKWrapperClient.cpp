@@ -51,6 +51,7 @@
 
 #include "app.h"
 #include "logger.h"
+#include <mutex>
 
 
 namespace CNTK
@@ -60,6 +61,9 @@ namespace CNTK
 #endif
 
 	int NumNetworkInstances = 0;
+	bool bKeepLoaded = false;
+	//experiments run in parallel in batch mode may load/unload the library at the same time
+	std::mutex LoadMutex;
 	WrapperClient::getNetworkDefinitionDLL WrapperClient::getNetworkDefinition = 0;
 	WrapperClient::setDeviceDLL WrapperClient::setDevice = 0;
 
@@ -69,6 +73,7 @@ namespace CNTK
 	void WrapperClient::Load()
 	{
 #if defined(__linux__) || defined(_WIN64)
+		std::lock_guard<std::mutex> lock(LoadMutex);
 		NumNetworkInstances++;
 
 		if (!DynamicLibCNTK.IsLoaded())
@@ -137,11 +142,17 @@ namespace CNTK
 	void WrapperClient::UnLoad()
 	{
 #if defined(__linux__) || defined(_WIN64)
+		std::lock_guard<std::mutex> lock(LoadMutex);
 		NumNetworkInstances--;
-		if (NumNetworkInstances==0 && DynamicLibCNTK.IsLoaded())
+		if (NumNetworkInstances==0 && !bKeepLoaded && DynamicLibCNTK.IsLoaded())
 		{
 			DynamicLibCNTK.Unload();
 		}
 #endif
 	}
+
+	void WrapperClient::SetKeepLoaded(bool keepLoaded)
+	{
+		bKeepLoaded = keepLoaded;
+	}
 }
\ No newline at end of file
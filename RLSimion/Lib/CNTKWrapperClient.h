@@ -24,5 +24,8 @@ namespace CNTK
 
 		static void Load();
 		static void UnLoad();
+		//if set, the library is not unloaded when the last network is destroyed, so that the next experiment run by the
+		//same process (batch mode) can reuse it
+		static void SetKeepLoaded(bool keepLoaded);
 	};
 }
\ No newline at end of file
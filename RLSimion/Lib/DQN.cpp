@@ -127,6 +127,7 @@ double DQN::update(const State * s, const Action * a, const State * s_p, double
 			m_Q_s_p= m_pTargetQNetwork->evaluate(s_p, a);
 
 		//calculate targetvalue= r + gamma*Q(s_p,a)
+		//(replayed tuples may be n-step tuples: r is then the n-step return and gamma is gamma^n)
 		double targetValue = r + gamma * m_Q_s_p[argmaxQ];
 
 		//get the current value of Q(s)
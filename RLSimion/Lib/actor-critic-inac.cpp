@@ -66,6 +66,12 @@ IncrementalNaturalActorCritic::IncrementalNaturalActorCritic(ConfigNode* pConfig
 	//actor's stuff
 	m_policies = MULTI_VALUE_FACTORY<Policy>(pConfigNode, "Policy", "The policy");
 
+	//the policies of the different action dimensions are stored as a single multi-output function
+	vector<LinearStateVFA*> policyVFAs;
+	for (unsigned int i = 0; i < m_policies.size(); i++)
+		policyVFAs.push_back(m_policies[i]->getDetPolicyStateVFA());
+	LinearStateMultiVFA::shareWeights(policyVFAs);
+
 	m_w = new FeatureList*[m_policies.size()];
 	for (unsigned int i = 0; i < m_policies.size(); i++)
 	{
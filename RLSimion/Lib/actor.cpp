@@ -43,6 +43,12 @@ Actor::Actor(ConfigNode* pConfigNode): DeferredLoad(10)
 {
 	m_policyLearners= MULTI_VALUE_FACTORY<PolicyLearner>(pConfigNode, "Output", "The outputs of the actor. One for each output dimension");
 	m_pInitController= CHILD_OBJECT_FACTORY<Controller>(pConfigNode, "Base-Controller", "The base controller used to initialize the weights of the actor", true);
+
+	//the policies of the different action dimensions are stored as a single multi-output function
+	vector<LinearStateVFA*> policyVFAs;
+	for (size_t i = 0; i < m_policyLearners.size(); i++)
+		policyVFAs.push_back(m_policyLearners[i]->getPolicy()->getDetPolicyStateVFA());
+	LinearStateMultiVFA::shareWeights(policyVFAs);
 }
 
 Actor::~Actor() {}
@@ -72,7 +78,7 @@ void Actor::deferredLoadStep()
 					{
 						m_policyLearners[actorActionIndex]->getPolicy()->getDetPolicyStateVFA()->getStateFeatureMap()->getFeatureStateAction(i, s, a);
 						m_pInitController->selectAction(s, a);
-						(*pWeights)[i] = a->get(m_pInitController->getOutputAction(actionIndex));
+						pWeights->set(i, a->get(m_pInitController->getOutputAction(actionIndex)));
 					}
 				}
 			}
@@ -31,14 +31,13 @@
 #include "config.h"
 #include "utils.h"
 #include "function-sampler.h"
+#include "work-stealing-pool.h"
+#include "profiler.h"
+#include "parallel-evaluator.h"
+#include "render-thread.h"
+#include "episode-recorder.h"
 #include "../Common/state-action-function.h"
 #include "../Common/wire.h"
-#include "../../tools/OpenGLRenderer/basic-shapes-2d.h"
-#include "../../tools/OpenGLRenderer/renderer.h"
-#include "../../tools/OpenGLRenderer/text.h"
-#include "../../tools/OpenGLRenderer/input-handler.h"
-#include "../../tools/OpenGLRenderer/material.h"
-#include "../../tools/OpenGLRenderer/arranger.h"
 #include "../../tools/System/FileUtils.h"
 #include "../../tools/System/CrossPlatform.h"
 
@@ -52,11 +51,12 @@
 #define OUTPUT_FILE_XML_TAG "Output-File"
 #define RENAME_XML_ATTR "Rename"
 
-SimionApp* SimionApp::m_pAppInstance = 0;
+thread_local SimionApp* SimionApp::m_pAppInstance = 0;
 
 SimionApp::SimionApp(ConfigNode* pConfigNode)
 {
 	m_pAppInstance = this;
+	m_pConfigRoot = pConfigNode;
 
 	pConfigNode = pConfigNode->getChild("RLSimion");
 	if (!pConfigNode) throw std::runtime_error("Wrong experiment configuration file");
@@ -81,7 +81,8 @@ SimionApp::SimionApp(ConfigNode* pConfigNode)
 SimionApp::~SimionApp()
 {
 	if (pMemManager != nullptr) delete pMemManager;
-	if (m_pRenderer != nullptr) delete m_pRenderer;
+	m_pRenderThread.reset();
+	m_pEpisodeRecorder.reset();
 
 	for (FunctionSampler* sampler : m_pFunctionSamplers) delete sampler;
 	for (pair<string, Wire*> p : m_wires) delete p.second;
@@ -162,6 +163,11 @@ SimionApp* SimionApp::get()
 	return m_pAppInstance;
 }
 
+void SimionApp::setThreadInstance(SimionApp* pApp)
+{
+	m_pAppInstance = pApp;
+}
+
 void SimionApp::setExecutedRemotely(bool remote)
 {
 	m_bRemoteExecution = remote;
@@ -286,184 +292,183 @@ void SimionApp::registerOutputFile(const char* filepath)
 
 
 
-void SimionApp::run()
+void SimionApp::beginSimulation()
 {
-	Logger::logMessage(MessageType::Info, "Simulation starting");
-
 	//create state and action vectors
-	State *s = pWorld->getDynamicModel()->getStateDescriptor().getInstance();
-	State *s_p = pWorld->getDynamicModel()->getStateDescriptor().getInstance();
-	Action *a = pWorld->getDynamicModel()->getActionDescriptor().getInstance();
+	m_s = pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+	m_s_p = pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+	m_a = pWorld->getDynamicModel()->getActionDescriptor().getInstance();
 
-	double r;
-	double probability;
-	pLogger->addVarToStats<double>("reward", "r", r);
+	pLogger->addVarToStats<double>("reward", "r", m_r);
+
+	//phases of the step profiled (if Profile-Steps is set). The times of the whole step and of timestep() are logged
+	//in the next step, because stats are sampled within timestep()
+	m_pStepTime = pLogger->addProfiledSection("step");
+	m_pSelectActionTime = pLogger->addProfiledSection("selectAction");
+	m_pExecuteActionTime = pLogger->addProfiledSection("executeAction");
+	m_pUpdateTime = pLogger->addProfiledSection("update");
+	m_pTimestepTime = pLogger->addProfiledSection("timestep");
+	m_pPostUpdateTime = pLogger->addProfiledSection("postUpdate");
 
 	//load stuff we don't want to be loaded in the constructors for faster construction
 	pSimGod->deferredLoad();
 	Logger::logMessage(MessageType::Info, "Deferred load step finished");
+	if (m_deferredLoadCallback)
+		m_deferredLoadCallback();
+}
 
-	//load the scene and initialize visual objects
-	if (!m_bRemoteExecution)
-	{
-		//load the scene
-		string sceneFile = pWorld->getDynamicModel()->getWorldSceneFile();
-		//scene file names are in lower case
-		std::transform(sceneFile.begin(), sceneFile.end(), sceneFile.begin(), ::tolower);
-		initRenderer(sceneFile, s, a);
-	}
-	else
-		if (pLogger->areFunctionsLogged())
-			initFunctionSamplers(s, a);
+void SimionApp::endSimulation()
+{
+	delete m_s;
+	delete m_s_p;
+	delete m_a;
+	m_s = m_s_p = m_a = nullptr;
+}
 
-	Logger::logMessage(MessageType::Info, "Simulation begins");
+void SimionApp::runEpisode()
+{
+	double probability;
 
-	//episodes
-	for (pExperiment->nextEpisode(); pExperiment->isValidEpisode(); pExperiment->nextEpisode())
+	pWorld->reset(m_s);
+
+	//steps per episode
+	for (pExperiment->nextStep(); pExperiment->isValidStep(); pExperiment->nextStep())
 	{
-		pWorld->reset(s);
+		PROFILE_SCOPE(m_pStepTime);
 
-		//steps per episode
-		for (pExperiment->nextStep(); pExperiment->isValidStep(); pExperiment->nextStep())
+		//a= pi(s)
 		{
-			//a= pi(s)
-			probability = pSimGod->selectAction(s, a);
+			PROFILE_SCOPE(m_pSelectActionTime);
+			probability = pSimGod->selectAction(m_s, m_a);
+		}
 
-			//s_p= f(s,a); r= R(s');
-			r = pWorld->executeAction(s, a, s_p);
+		//s_p= f(s,a); r= R(s');
+		{
+			PROFILE_SCOPE(m_pExecuteActionTime);
+			m_r = pWorld->executeAction(m_s, m_a, m_s_p);
+		}
 
-			//update god's policy and value estimation
-			pSimGod->update(s, a, s_p, r, probability);
+		//update god's policy and value estimation
+		{
+			PROFILE_SCOPE(m_pUpdateTime);
+			pSimGod->update(m_s, m_a, m_s_p, m_r, probability);
+		}
 
-			//log tuple <s,a,s',r> and stats
-			pExperiment->timestep(s, a, s_p, pWorld->getRewardVector());
+		//log tuple <s,a,s',r> and stats
+		{
+			PROFILE_SCOPE(m_pTimestepTime);
+			pExperiment->timestep(m_s, m_a, m_s_p, pWorld->getRewardVector());
 			//we need the complete reward vector for logging
+		}
 
-			//do experience replay if enabled
+		//do experience replay if enabled
+		{
+			PROFILE_SCOPE(m_pPostUpdateTime);
 			pSimGod->postUpdate();
+		}
 
-			if (!m_bRemoteExecution)
-				updateScene(s, a);
+		if (m_pRenderThread)
+			m_pRenderThread->update(m_s, m_a);
+		if (m_pEpisodeRecorder)
+			m_pEpisodeRecorder->update(m_s);
 
-			//s= s'
-			s->copy(s_p);
-		}
+		//s= s'
+		m_s->copy(m_s_p);
 	}
-	Logger::logMessage(MessageType::Info, "Simulation finished");
-
-	delete s;
-	delete s_p;
-	delete a;
 }
 
-void SimionApp::initRenderer(string sceneFile, State* s, Action* a)
+void SimionApp::runEvaluation(unsigned int evaluationIndex)
 {
-	char arguments[] = "RLSimion";
-	char* argv = arguments;
-
-	//initialize the render if a scene file can be found
-	string sceneDir = "../config/scenes/";
-	if (!bFileExists(sceneDir + sceneFile))
-		return;
-
-	m_pRenderer = new Renderer();
-	m_pRenderer->init(1, &argv, 800, 600);
-
-	//resize the main viewport
-	double mainViewPortMinX = 0.0, mainViewPortMinY = 0.3, mainViewPortMaxX = 0.7, mainViewPortMaxY = 1.0;
-	ViewPort* pMainViewPort = m_pRenderer->getDefaultViewPort();
-	pMainViewPort->resize(mainViewPortMinX, mainViewPortMinY, mainViewPortMaxX, mainViewPortMaxY);
-	m_pRenderer->setDataFolder(sceneDir);
-	m_pRenderer->loadScene(sceneFile.c_str());
-
-	//text
-	m_pProgressText = new Text2D(string("Progress"), Vector2D(0.05, 0.95), 0.25);
-	m_pRenderer->add2DGraphicObject(m_pProgressText);
-
-	//create a second viewport for stats, state variables and action variables
-	double metersViewPortMinX = mainViewPortMaxX, metersViewPortMinY = mainViewPortMinY, metersViewPortMaxX = 1.0, metersViewPortMaxY = 1.0;
-	ViewPort* pMetersViewPort = m_pRenderer->addViewPort(metersViewPortMinX, metersViewPortMinY, metersViewPortMaxX, metersViewPortMaxY);
-
-	//stats
-	Meter2D* pMeter2D;
-	IStats* pStat;
-	Vector2D origin = Vector2D(0.025, 0.9);
-	Vector2D size = Vector2D(0.95, 0.04);
-	Vector2D offset = Vector2D(0.0, 0.05);
-	double depth = 0.25;
-	for (unsigned int i = 0; i < pLogger->getNumStats(); ++i)
+	pExperiment->setEvaluation(evaluationIndex);
+	//the same evaluation draws the same random numbers whichever evaluator runs it
+	pExperiment->seedRandomEngine(evaluationIndex + 1);
+	for (unsigned int episode = 0; episode < pExperiment->getNumEpisodesPerEvaluation(); ++episode)
 	{
-		pStat = pLogger->getStats(i);
-		pMeter2D = new Meter2D(string(pStat->getSubkey()), origin, size, depth);
-		m_pStatsUIMeters.push_back(pMeter2D);
-		m_pRenderer->add2DGraphicObject(pMeter2D, pMetersViewPort);
-		origin -= offset;
+		pExperiment->nextEpisode();
+		runEpisode();
 	}
+}
+
+void SimionApp::run()
+{
+	Logger::logMessage(MessageType::Info, "Simulation starting");
 
-	//state variables
-	Descriptor& stateDescriptor = pWorld->getDynamicModel()->getStateDescriptor();
-	for (unsigned int i = 0; i < stateDescriptor.size(); i++)
+	beginSimulation();
+
+	//load the scene and initialize visual objects
+	if (!m_bRemoteExecution)
 	{
-		pMeter2D = new Meter2D(stateDescriptor[i].getName(), origin, size, depth);
-		pMeter2D->setValueRange(Range(stateDescriptor[i].getMin(), stateDescriptor[i].getMax()));
-		m_pStateUIMeters.push_back(pMeter2D);
-		m_pRenderer->add2DGraphicObject(pMeter2D, pMetersViewPort);
-		origin -= offset;
+		//load the scene
+		string sceneFile = pWorld->getDynamicModel()->getWorldSceneFile();
+		//scene file names are in lower case
+		std::transform(sceneFile.begin(), sceneFile.end(), sceneFile.begin(), ::tolower);
+		if (m_pStateActionFunctions.size())
+			initFunctionSamplers(m_s, m_a);
+		m_pRenderThread.reset(new RenderThread(this, sceneFile, m_pFunctionSamplers, m_numSamplesPerDim, m_renderFPS));
+		if (!m_pRenderThread->isRunning())
+			m_pRenderThread.reset();
 	}
-	//action variables
-	Descriptor& actionDescriptor = pWorld->getDynamicModel()->getActionDescriptor();
-	for (unsigned int i = 0; i < actionDescriptor.size(); i++)
+	else
+		if (pLogger->areFunctionsLogged())
+			initFunctionSamplers(m_s, m_a);
+
+	//evaluations can be run by other threads while training goes on
+	unique_ptr<ParallelEvaluator> pParallelEvaluator;
+	if (pExperiment->getNumEvaluationThreads() > 0 && pExperiment->getEvaluationFreq() > 0)
+		pParallelEvaluator.reset(new ParallelEvaluator(this, m_pConfigRoot, pExperiment->getNumEvaluationThreads()));
+
+	//evaluation episodes are recorded offscreen. The scene can't be drawn by two renderers at once, and the episodes of
+	//parallel evaluations are run by other apps
+	if (pLogger->areEvaluationEpisodesRecorded())
 	{
-		pMeter2D = new Meter2D(actionDescriptor[i].getName(), origin, size, depth);
-		pMeter2D->setValueRange(Range(actionDescriptor[i].getMin(), actionDescriptor[i].getMax()));
-		m_pActionUIMeters.push_back(pMeter2D);
-		m_pRenderer->add2DGraphicObject(pMeter2D, pMetersViewPort);
-		origin -= offset;
+		if (m_pRenderThread)
+			Logger::logMessage(MessageType::Warning, "Evaluation episodes are not recorded in local mode");
+		else if (pParallelEvaluator)
+			Logger::logMessage(MessageType::Warning, "Evaluation episodes are not recorded if evaluations are run in parallel");
+		else
+		{
+			string sceneFile = pWorld->getDynamicModel()->getWorldSceneFile();
+			std::transform(sceneFile.begin(), sceneFile.end(), sceneFile.begin(), ::tolower);
+			m_pEpisodeRecorder.reset(new EpisodeRecorder(this, sceneFile));
+			if (!m_pEpisodeRecorder->isRunning())
+				m_pEpisodeRecorder.reset();
+		}
 	}
 
-	//create function samplers
-	if (m_pStateActionFunctions.size())
-	{
-		initFunctionSamplers(s, a);
+	Logger::logMessage(MessageType::Info, "Simulation begins");
 
-		ViewPort* functionViewPort = new ViewPort(0.0, 0.0, 1.0, mainViewPortMinY);
-		m_pRenderer->addViewPort(functionViewPort);
-		vector<GraphicObject2D*> objects;
-		for (FunctionSampler* pSampler : m_pFunctionSamplers)
+	//episodes
+	for (pExperiment->nextEpisode(); pExperiment->isValidEpisode(); pExperiment->nextEpisode())
+	{
+		if (pParallelEvaluator)
 		{
-			//create the function viewer
-			FunctionViewer* pFunctionViewer = nullptr;
-			//depending on the dimensions, we create a 3d viewer or a 2d viewer
-			if (pSampler->getNumSamplesY() > 1)
-				pFunctionViewer= new FunctionViewer3D(pSampler->getFunctionId(), Vector2D(0.0, 0.0), Vector2D(0.0, 0.0), m_numSamplesPerDim, 0.25);
-			else if (pSampler->getNumSamplesY() == 1)
-				pFunctionViewer = new FunctionViewer2D(pSampler->getFunctionId(), Vector2D(0.0, 0.0), Vector2D(0.0, 0.0), m_numSamplesPerDim, 0.25);
-
-			if (pFunctionViewer)
+			if (pExperiment->isEvaluationEpisode())
 			{
-				m_pFunctionViews[pFunctionViewer] = pSampler;
-
-				m_pRenderer->add2DGraphicObject(pFunctionViewer, functionViewPort);
-				objects.push_back(pFunctionViewer);
+				//all the episodes of the evaluation are run at once by an evaluator on a snapshot of the weights
+				if (pExperiment->getEpisodeInEvaluationIndex() == 1)
+					pParallelEvaluator->evaluate(pExperiment->getEvaluationIndex());
+				continue;
 			}
+			pParallelEvaluator->mergeResults();
 		}
-
-		Arranger objectArranger;
-		objectArranger.arrange2DObjects(objects, Vector2D(0.0,0.0), Vector2D(1.0,1.0), Vector2D(0.15,0.25)
-			, Vector2D(0.20, 1.0), Vector2D(0.0075, 0.06));
-
-		objectArranger.tag2DObjects(objects, functionViewPort);
+		runEpisode();
 	}
+	if (pParallelEvaluator)
+		pParallelEvaluator->finish();
+	//waits until the last frames recorded are written
+	m_pEpisodeRecorder.reset();
+	Logger::logMessage(MessageType::Info, "Simulation finished");
 
-	m_pInputHandler = new FreeCameraInputHandler();
-
-	m_timer.start();
+	endSimulation();
 }
 
 void SimionApp::initFunctionSamplers(State* s, Action* a)
 {
 	vector<pair<VariableSource, string>> m_sampledVariables;
 	size_t numInputs;
+	unsigned int numThreads = pLogger->getNumFunctionSamplingThreads();
+	if (numThreads != 1)
+		m_pFunctionSamplingPool.reset(new WorkStealingPool(numThreads));
 	for (auto functionIt : m_pStateActionFunctions)
 	{
 		numInputs = functionIt.second->getInputActionVariables().size() + functionIt.second->getInputStateVariables().size();
@@ -484,7 +489,7 @@ void SimionApp::initFunctionSamplers(State* s, Action* a)
 					//create the 3D sampler: only the two first inputs will be used
 					FunctionSampler* pSampler = new FunctionSampler3D(functionIt.first, functionIt.second, outputIndex, m_numSamplesPerDim
 						, s->getDescriptor(), a->getDescriptor(), m_sampledVariables[0].first, m_sampledVariables[0].second
-						, m_sampledVariables[1].first, m_sampledVariables[1].second);
+						, m_sampledVariables[1].first, m_sampledVariables[1].second, m_pFunctionSamplingPool.get());
 					m_pFunctionSamplers.push_back(pSampler);
 				}
 				//2d sampler
@@ -492,7 +497,8 @@ void SimionApp::initFunctionSamplers(State* s, Action* a)
 				{
 					//create the 2D sampler: only one input
 					FunctionSampler* pSampler = new FunctionSampler2D(functionIt.first, functionIt.second, outputIndex, m_numSamplesPerDim
-						, s->getDescriptor(), a->getDescriptor(), m_sampledVariables[0].first, m_sampledVariables[0].second);
+						, s->getDescriptor(), a->getDescriptor(), m_sampledVariables[0].first, m_sampledVariables[0].second
+						, m_pFunctionSamplingPool.get());
 					m_pFunctionSamplers.push_back(pSampler);
 				}
 			}
@@ -500,62 +506,6 @@ void SimionApp::initFunctionSamplers(State* s, Action* a)
 	}
 }
 
-void SimionApp::updateScene(State* s, Action* a)
-{
-	//check the renderer has been initialized
-	if (!m_pRenderer) return;
-
-	//update progress text
-	m_pProgressText->set(string("Episode: ") + std::to_string(pExperiment->getEpisodeIndex())
-		+ string(" Step: ") + std::to_string(pExperiment->getStep()));
-
-	update2DMeters(s, a);
-
-	//2D/3D BOUND PROPERTIES: translation, rotation, ...
-	//update bindings
-	double value;
-	string varName;
-	for (unsigned int b = 0; b < m_pRenderer->getNumBindings(); ++b)
-	{
-		varName = m_pRenderer->getBindingExternalName(b);
-		value = s->get(varName.c_str());
-		m_pRenderer->updateBinding(varName, value);
-	}
-
-	//Update the function views each m_functionViewUpdateStepFreq steps
-	if ((pExperiment->getExperimentStep()-1) % m_functionViewUpdateStepFreq == 0)
-	{
-		for (auto functionIt : m_pFunctionViews)
-		{
-			const vector<double>& sampledValues = functionIt.second->sample();
-			functionIt.first->update(sampledValues);
-		}
-	}
-	//render the image
-	m_pInputHandler->handleInput();
-	m_pRenderer->draw();
-}
-
-void SimionApp::update2DMeters(State* s, Action* a)
-{
-	//2D METERS
-	//update stats
-	unsigned int statIndex = 0;
-	for (Meter2D* pMeter2D : m_pStatsUIMeters)
-	{
-		IStats* pStat = pLogger->getStats(statIndex);
-		pMeter2D->setValue(pStat->get());
-		pMeter2D->setValueRange(Range(pStat->getStatsInfo()->getMin(), pStat->getStatsInfo()->getMax()));
-		++statIndex;
-	}
-	//update state
-	for (int i = 0; i < (int) s->getNumVars(); i++)
-		m_pStateUIMeters[i]->setValue(s->get(i));
-
-	//update action
-	for (int i = 0; i < (int) a->getNumVars(); i++)
-		m_pActionUIMeters[i]->setValue(a->get(i));
-}
 
 #include "CNTKWrapperClient.h"
 void SimionApp::setPreferredDevice(Device device)
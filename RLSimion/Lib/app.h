@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <unordered_map>
+#include <functional>
+#include <memory>
+#include <random>
 using namespace std;
 
 #include "parameters.h"
@@ -12,12 +15,10 @@ using namespace std;
 #include "../../tools/System/Timer.h"
 #define MAX_PATH_SIZE 1024
 
-class Renderer;
-class IInputHandler;
-class Text2D;
-class Meter2D;
 class FunctionSampler;
-class FunctionViewer;
+class WorkStealingPool;
+class RenderThread;
+class EpisodeRecorder;
 class ConfigNode;
 class ConfigFile;
 class Logger;
@@ -34,9 +35,11 @@ class SimionApp: public WireHandler
 {
 
 private:
-	static SimionApp* m_pAppInstance;
+	//thread_local so that several experiments can be run in parallel in batch mode (see BatchRunner)
+	static thread_local SimionApp* m_pAppInstance;
 
 	ConfigFile* m_pConfigDoc;
+	ConfigNode* m_pConfigRoot;
 	string m_directory;
 	string m_configFile;
 
@@ -57,6 +60,10 @@ private:
 	bool m_bRemoteExecution = true;
 #endif
 
+	//every app draws its random numbers from its own engine, so that experiments run in parallel (batch/asynchronous
+	//mode, parallel evaluations) can still be reproduced from their Random-Seed (see Experiment::seedRandomEngine)
+	std::mt19937 m_randomEngine;
+
 	//requirements/support
 	unsigned int m_numCPUCores = 1;
 	string m_architecture = ""; //required architecture. None if not set
@@ -67,8 +74,16 @@ public:
 	virtual ~SimionApp();
 
 	void run();
+	//Runs the episodes of an evaluation instead of the whole experiment. Used by the apps that run the evaluations in
+	//parallel with training (see ParallelEvaluator), after beginSimulation()
+	void runEvaluation(unsigned int evaluationIndex);
 
 	static SimionApp* get();
+	//Makes the calling thread use pApp as its app. Used by worker threads that run tasks on behalf of another thread
+	//(see WorkStealingPool)
+	static void setThreadInstance(SimionApp* pApp);
+
+	std::mt19937& getRandomEngine() { return m_randomEngine; }
 
 	MemManager<SimionMemPool>* pMemManager;
 	CHILD_OBJECT<Logger> pLogger;
@@ -114,29 +129,46 @@ public:
 	
 	void setPreferredDevice(Device device);
 
-private:
-	//Rendering
-	Timer m_timer;
-	Renderer *m_pRenderer = 0;
-	IInputHandler *m_pInputHandler = 0;
+	//Frames per second drawn in local mode. The simulation doesn't wait for the window
+	void setRenderFPS(double fps) { m_renderFPS = fps; }
+
+	//Called by run() once the deferred load is finished, right before the first episode begins. The workers of an
+	//asynchronous experiment wait there for each other (see AsyncRunner)
+	void setDeferredLoadCallback(function<void()> callback) { m_deferredLoadCallback = callback; }
 
-	Text2D* m_pProgressText = 0;
-	vector<Meter2D*> m_pStatsUIMeters;
-	vector<Meter2D*> m_pStateUIMeters;
-	vector<Meter2D*> m_pActionUIMeters;
+private:
+	function<void()> m_deferredLoadCallback;
+
+	//Simulation loop
+	friend class ParallelEvaluator;
+	State* m_s = nullptr;
+	State* m_s_p = nullptr;
+	Action* m_a = nullptr;
+	double m_r = 0.0;
+	//profiled phases of the step (nullptr if Profile-Steps isn't set)
+	double* m_pStepTime = nullptr;
+	double* m_pSelectActionTime = nullptr;
+	double* m_pExecuteActionTime = nullptr;
+	double* m_pUpdateTime = nullptr;
+	double* m_pTimestepTime = nullptr;
+	double* m_pPostUpdateTime = nullptr;
+	//creates the state/action vectors and does the deferred load
+	void beginSimulation();
+	void endSimulation();
+	void runEpisode();
+
+	//Rendering (local mode only): the scene is drawn by another thread
+	unique_ptr<RenderThread> m_pRenderThread;
+	double m_renderFPS = 60.0;
+	//Recording of evaluation episodes (Record-Eval-Episodes): rendered offscreen by another thread
+	unique_ptr<EpisodeRecorder> m_pEpisodeRecorder;
 
 	const int m_numSamplesPerDim = 16;
-	const unsigned int m_functionViewUpdateStepFreq = 100;
-	unordered_map<FunctionViewer*, FunctionSampler*> m_pFunctionViews;
 	vector<FunctionSampler*> m_pFunctionSamplers;
+	//threads used by all the function samplers (Function-Sampling-Threads)
+	unique_ptr<WorkStealingPool> m_pFunctionSamplingPool;
 	void initFunctionSamplers(State* s, Action* a);
 
-	void update2DMeters(State* s, Action* a);
-
-	void initRenderer(string sceneFile, State* s, Action* a);
-
-	void updateScene(State* s, Action* a);
-
 public:
 	vector<FunctionSampler*> getFunctionSamplers() { return m_pFunctionSamplers; }
 };
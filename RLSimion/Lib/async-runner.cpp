@@ -0,0 +1,131 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "async-runner.h"
+#include "app.h"
+#include "config.h"
+#include "logger.h"
+#include "experiment.h"
+#include "simgod.h"
+#include "CNTKWrapperClient.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+AsyncRunner::AsyncRunner(const string& configFile, unsigned int numWorkers)
+{
+	m_configFile = configFile;
+	m_numWorkers = numWorkers > 0 ? numWorkers : std::max(1u, std::thread::hardware_concurrency());
+
+	m_pSharedMemManager = new MemManager<SimionMemPool>();
+	//the shared manager is initialized by the workers: it must not be loaded with the app of the calling thread
+	SimGod::unregisterDeferredLoadStep(m_pSharedMemManager);
+}
+
+AsyncRunner::~AsyncRunner()
+{
+	delete m_pSharedMemManager;
+}
+
+void AsyncRunner::workerLoaded(bool bWait)
+{
+	unique_lock<mutex> lock(m_loadMutex);
+	++m_numLoadedWorkers;
+	m_loadCondition.notify_all();
+	if (bWait)
+		m_loadCondition.wait(lock, [this]() { return m_numLoadedWorkers == m_numWorkers; });
+}
+
+bool AsyncRunner::runWorker(unsigned int worker)
+{
+	bool bLoaded = false;
+	Logger::setOnlyErrorMessages(worker > 0);
+	try
+	{
+		//every worker has its own copy of the configuration, because parameters are read from it as they are used
+		ConfigFile configFile;
+		ConfigNode* pParameters = configFile.loadFile(m_configFile.c_str());
+		if (!pParameters || (strcmp("RLSimion", pParameters->getName()) && strcmp("RLSimion-x64", pParameters->getName())))
+			throw std::runtime_error("Wrong experiment configuration file");
+
+		SimionApp app(pParameters);
+		app.pMemManager->shareMemBuffers(m_pSharedMemManager);
+		app.setExecutedRemotely(true);
+		app.setPreferredDevice(m_device);
+		if (worker == 0)
+			app.setConfigFile(m_configFile);
+		else
+			app.pLogger->disableFileLogging();
+
+		//the training episodes are split among the workers
+		Experiment* pExperiment = app.pExperiment.ptr();
+		pExperiment->seedRandomEngine(worker);
+		int numTrainingEpisodes = (int)pExperiment->getNumTrainingEpisodes();
+		if (numTrainingEpisodes > 1)
+		{
+			int evalFreq = pExperiment->getEvaluationFreq();
+			pExperiment->setNumTrainingEpisodes(std::max(2, (numTrainingEpisodes + (int)m_numWorkers - 1) / (int)m_numWorkers));
+			if (worker == 0 && evalFreq > 0)
+				pExperiment->setEvaluationFreq(std::max(1, evalFreq / (int)m_numWorkers));
+		}
+		if (worker > 0)
+			pExperiment->setEvaluationFreq(0);
+
+		app.setDeferredLoadCallback([this, &bLoaded]() { bLoaded = true; workerLoaded(true); });
+		app.run();
+		return true;
+	}
+	catch (std::exception& e)
+	{
+		//don't let the rest of the workers wait for this one
+		if (!bLoaded)
+			workerLoaded(false);
+		//errors are reported with logMessage(), which throws them again
+		try { Logger::logMessage(MessageType::Error, ("Worker " + to_string(worker) + ": " + e.what()).c_str()); }
+		catch (std::exception&) {}
+	}
+	return false;
+}
+
+bool AsyncRunner::run()
+{
+	Logger::logMessage(MessageType::Info, ("Running the experiment asynchronously with " + to_string(m_numWorkers)
+		+ " workers").c_str());
+
+	//the first worker that loads the CNTK library leaves it loaded for the rest
+	CNTK::WrapperClient::SetKeepLoaded(true);
+
+	vector<char> results(m_numWorkers, 0);
+	vector<thread> threads;
+	for (unsigned int worker = 1; worker < m_numWorkers; ++worker)
+		threads.push_back(thread([this, worker, &results]() { results[worker] = runWorker(worker); }));
+	//the calling thread runs the first worker, so that its messages are those of a regular experiment
+	results[0] = runWorker(0);
+
+	for (thread& workerThread : threads)
+		workerThread.join();
+
+	return std::find(results.begin(), results.end(), 0) == results.end();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+#include "app.h"
+
+//Asynchronous mode (-async-workers=<n>): a single experiment is run by several workers in parallel. Each worker has its
+//own SimionApp (world, simions, eligibility traces, experience replay...) run by its own thread, but the memory
+//buffers of all of them (the weights of the linear VFAs) are shared and updated without any synchronization, Hogwild!
+//style: updates of linear VFAs with sparse features rarely collide, and a lost update is just noise in the SGD.
+//Every worker runs 1/n of the training episodes. Only the first one evaluates the policy (as often as a single worker
+//would, in terms of the total number of training episodes) and writes the log files.
+//Not supported: memory limits (all the shared memory is allocated up front) and deep VFAs (each worker learns its own)
+class AsyncRunner
+{
+	string m_configFile;
+	unsigned int m_numWorkers;
+	Device m_device = Device::CPU;
+
+	MemManager<SimionMemPool>* m_pSharedMemManager = nullptr;
+
+	//workers don't begin their first episode until every worker has finished its deferred load, because some
+	//deferred load steps initialize the shared weights
+	mutex m_loadMutex;
+	condition_variable m_loadCondition;
+	unsigned int m_numLoadedWorkers = 0;
+	void workerLoaded(bool bWait);
+
+	bool runWorker(unsigned int worker);
+public:
+	//0 workers: as many as hardware threads are available
+	AsyncRunner(const string& configFile, unsigned int numWorkers);
+	virtual ~AsyncRunner();
+
+	unsigned int getNumWorkers() const { return m_numWorkers; }
+	void setPreferredDevice(Device device) { m_device = device; }
+	//memory allocation options of the shared buffers (see MemManager)
+	MemManager<SimionMemPool>* getSharedMemManager() { return m_pSharedMemManager; }
+
+	//Returns whether all the workers finished successfully
+	bool run();
+};
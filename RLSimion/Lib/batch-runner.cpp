@@ -0,0 +1,139 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "batch-runner.h"
+#include "work-stealing-pool.h"
+#include "app.h"
+#include "config.h"
+#include "logger.h"
+#include "CNTKWrapperClient.h"
+#include "../../tools/System/FileUtils.h"
+#include <fstream>
+#include <algorithm>
+
+BatchRunner::BatchRunner(const string& batch)
+{
+	vector<string> configFiles;
+	if (bIsDirectory(batch))
+		findFiles(batch, EXPERIMENT_FILE_EXTENSION, configFiles);
+	else
+	{
+		ifstream batchFile(batch);
+		if (!batchFile.is_open())
+			throw std::runtime_error(("Couldn't open the batch file: " + batch).c_str());
+
+		string line;
+		while (getline(batchFile, line))
+		{
+			line.erase(line.find_last_not_of(" \t\r\n") + 1);
+			line.erase(0, line.find_first_not_of(" \t"));
+			if (!line.empty() && line[0] != '#')
+				configFiles.push_back(line);
+		}
+	}
+	if (configFiles.empty())
+		throw std::runtime_error(("No experiment found in the batch: " + batch).c_str());
+
+	for (const string& configFile : configFiles)
+		addExperiment(configFile);
+}
+
+BatchRunner::~BatchRunner()
+{
+	for (BatchExperiment& experiment : m_experiments)
+		delete experiment.pConfigFile;
+}
+
+void BatchRunner::addExperiment(const string& configFile)
+{
+	BatchExperiment experiment;
+	experiment.configFile = configFile;
+	size_t lastBar = configFile.find_last_of("/\\");
+	experiment.id = removeExtension(lastBar == string::npos ? configFile : configFile.substr(lastBar + 1), 2);
+
+	//configuration files are parsed before any experiment is run, so that wrong files are reported right away.
+	//Experiments that can't be parsed are reported as failed when their turn comes
+	experiment.pConfigFile = new ConfigFile();
+	try
+	{
+		ConfigNode* pParameters = experiment.pConfigFile->loadFile(configFile.c_str());
+		if (pParameters && (!strcmp("RLSimion", pParameters->getName()) || !strcmp("RLSimion-x64", pParameters->getName())))
+			experiment.pParameters = pParameters;
+	}
+	catch (std::exception&) {}
+
+	if (!experiment.pParameters)
+		Logger::logMessage(MessageType::Warning, ("Wrong experiment configuration file: " + configFile).c_str());
+	m_experiments.push_back(experiment);
+}
+
+void BatchRunner::runExperiment(BatchExperiment& experiment)
+{
+	Logger::setExperimentId(experiment.id);
+	try
+	{
+		if (!experiment.pParameters)
+			throw std::runtime_error("Wrong experiment configuration file");
+
+		SimionApp app(experiment.pParameters);
+		app.setConfigFile(experiment.configFile);
+		app.setExecutedRemotely(true);
+		app.setPreferredDevice(m_device);
+		if (m_bPageAllocator)
+			app.pMemManager->usePageAllocator(m_bHugePages, m_numaPolicy, m_numaNode);
+		app.pMemManager->setNumInitThreads(m_numMemInitThreads);
+		app.run();
+		experiment.bSuccess = true;
+	}
+	catch (std::exception& e)
+	{
+		//errors are reported with logMessage(), which throws them again: don't let it stop the rest of the batch
+		try { Logger::logMessage(MessageType::Error, e.what()); }
+		catch (std::exception&) {}
+	}
+	Logger::logExperimentEnd(experiment.bSuccess);
+	Logger::setExperimentId("");
+}
+
+size_t BatchRunner::run()
+{
+	WorkStealingPool pool(m_numThreads, m_experiments.size());
+	Logger::logMessage(MessageType::Info, ("Running a batch of " + to_string(m_experiments.size()) + " experiments with "
+		+ to_string(pool.getNumThreads()) + " threads").c_str());
+
+	//the first experiment that loads the CNTK library leaves it loaded for the rest
+	CNTK::WrapperClient::SetKeepLoaded(true);
+	pool.run(m_experiments.size(), [this](size_t i) { runExperiment(m_experiments[i]); });
+
+	size_t numFailedExperiments = 0;
+	for (const BatchExperiment& experiment : m_experiments)
+	{
+		if (!experiment.bSuccess)
+			++numFailedExperiments;
+	}
+	Logger::logMessage(MessageType::Info, ("Batch finished: " + to_string(m_experiments.size() - numFailedExperiments)
+		+ " experiments succeeded, " + to_string(numFailedExperiments) + " failed").c_str());
+	return numFailedExperiments;
+}
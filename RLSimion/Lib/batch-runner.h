@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <string>
+using namespace std;
+
+#include "app.h"
+
+class ConfigFile;
+class ConfigNode;
+
+//Batch mode (-batch=<list|dir>): runs several experiments in parallel within the same process. Every experiment is
+//run by a single thread with its own SimionApp and its messages are tagged with the experiment's id (the name of its
+//configuration file), so a single pipe can be used to monitor all of them. Loaded libraries (CNTK) are kept loaded
+//until the batch is finished
+class BatchRunner
+{
+	struct BatchExperiment
+	{
+		string configFile;
+		string id;
+		ConfigFile* pConfigFile = nullptr;
+		ConfigNode* pParameters = nullptr;
+		bool bSuccess = false;
+	};
+	vector<BatchExperiment> m_experiments;
+
+	unsigned int m_numThreads = 0;
+	Device m_device = Device::CPU;
+
+	bool m_bPageAllocator = false;
+	bool m_bHugePages = false;
+	NumaPolicy m_numaPolicy = NumaPolicy::Local;
+	int m_numaNode = 0;
+	unsigned int m_numMemInitThreads = 1;
+
+	void addExperiment(const string& configFile);
+	void runExperiment(BatchExperiment& experiment);
+public:
+	static constexpr const char* EXPERIMENT_FILE_EXTENSION = ".simion.exp";
+
+	//batch is either a directory (searched recursively for experiment files) or a text file with the path of an
+	//experiment file in each line. Empty lines and lines beginning with '#' are ignored
+	BatchRunner(const string& batch);
+	virtual ~BatchRunner();
+
+	//0 uses as many threads as hardware threads are available (and no more than experiments in the batch)
+	void setNumThreads(unsigned int numThreads) { m_numThreads = numThreads; }
+	void setPreferredDevice(Device device) { m_device = device; }
+	//memory allocation options of every experiment (see MemManager::usePageAllocator())
+	void usePageAllocator(bool bHugePages, NumaPolicy numaPolicy, int numaNode)
+	{
+		m_bPageAllocator = true;
+		m_bHugePages = bHugePages;
+		m_numaPolicy = numaPolicy;
+		m_numaNode = numaNode;
+	}
+	void setNumMemInitThreads(unsigned int numThreads) { m_numMemInitThreads = numThreads; }
+
+	size_t getNumExperiments() const { return m_experiments.size(); }
+
+	//Returns the number of experiments that failed
+	size_t run();
+};
@@ -70,7 +70,7 @@ int DiscreteEpsilonGreedyDeepPolicy::selectAction(const std::vector<double>& val
 
 	if (randomValue < eps)
 	{
-		resultingActionIndex = std::rand() % static_cast<int>(values.size() + 1);
+		resultingActionIndex = getRandomIndex(values.size() + 1);
 	}
 	else
 	{
@@ -33,4 +33,6 @@ DeferredLoad::DeferredLoad(unsigned int loadOrder)
 }
 
 DeferredLoad::~DeferredLoad()
-{}
\ No newline at end of file
+{
+	SimGod::unregisterDeferredLoadStep(this);
+}
\ No newline at end of file
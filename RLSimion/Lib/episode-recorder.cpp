@@ -0,0 +1,312 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "episode-recorder.h"
+#include "app.h"
+#include "logger.h"
+#include "experiment.h"
+#include "worlds/world.h"
+#include "../Common/named-var-set.h"
+#include "../Common/wire.h"
+#include "../../tools/OpenGLRenderer/renderer.h"
+#include "../../tools/System/FileUtils.h"
+#include <algorithm>
+#include <cmath>
+
+EpisodeRecorder::EpisodeRecorder(SimionApp* pApp, string sceneFile)
+{
+	m_pApp = pApp;
+	m_sceneFile = sceneFile;
+	m_width = pApp->pLogger->getRecordWidth();
+	m_height = pApp->pLogger->getRecordHeight();
+	m_format = pApp->pLogger->getRecordFormat();
+
+	//frames are taken at fixed time-steps of the simulation
+	double dt = pApp->pWorld->getDT();
+	double recordFPS = pApp->pLogger->getRecordFPS();
+	if (dt > 0.0)
+	{
+		m_stepsPerFrame = (unsigned int)std::max(1.0, std::round(1.0 / (recordFPS * dt)));
+		m_videoFPS = 1.0 / (m_stepsPerFrame * dt);
+	}
+	else m_videoFPS = recordFPS;
+
+	m_renderThread = thread([this]() { render(); });
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_bLoaded; });
+	}
+	if (!m_bSceneLoaded)
+	{
+		m_renderThread.join();
+		if (!m_loadError.empty())
+			Logger::logMessage(MessageType::Warning, (string("Evaluation episodes can't be recorded: ") + m_loadError).c_str());
+		else
+			Logger::logMessage(MessageType::Warning, (string("Evaluation episodes can't be recorded: scene file not found: ") + m_sceneFile).c_str());
+		return;
+	}
+
+	//bindings are resolved once instead of looking up their names every step
+	Descriptor& stateDescriptor = World::getDynamicModel()->getStateDescriptor();
+	for (const string& name : m_bindingNames)
+	{
+		BoundVariable variable = { 0, nullptr };
+		size_t i = 0;
+		while (i < stateDescriptor.size() && name != stateDescriptor[i].getName())
+			++i;
+		if (i < stateDescriptor.size())
+			variable.stateIndex = i;
+		else
+		{
+			variable.pWire = pApp->wireGet(name);
+			if (!variable.pWire)
+			{
+				{
+					lock_guard<mutex> lock(m_mutex);
+					m_bExit = true;
+				}
+				m_condition.notify_all();
+				m_renderThread.join();
+				throw std::runtime_error(("The scene is bound to an unknown variable: " + name).c_str());
+			}
+		}
+		m_boundVariables.push_back(variable);
+	}
+}
+
+EpisodeRecorder::~EpisodeRecorder()
+{
+	if (m_renderThread.joinable())
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_bExit = true;
+		}
+		m_condition.notify_all();
+		m_renderThread.join();
+	}
+	//reported from the simulation thread, where messages are tagged with the experiment
+	if (!m_writeError.empty())
+		Logger::logMessage(MessageType::Warning, m_writeError.c_str());
+	if (m_numDroppedFrames > 0)
+		Logger::logMessage(MessageType::Warning, (to_string(m_numDroppedFrames)
+			+ string(" frames of the recorded evaluation episodes were dropped because the recorder couldn't keep up")).c_str());
+}
+
+bool EpisodeRecorder::loadScene()
+{
+	string sceneDir = "../config/scenes/";
+	if (!bFileExists(sceneDir + m_sceneFile))
+		return false;
+
+	//the scene fills the whole frame: no meters or function viewers
+	m_pRenderer = new Renderer();
+	m_pRenderer->initOffscreen(m_width, m_height);
+	m_pRenderer->setDataFolder(sceneDir);
+	m_pRenderer->loadScene(m_sceneFile.c_str());
+
+	for (unsigned int b = 0; b < m_pRenderer->getNumBindings(); ++b)
+		m_bindingNames.push_back(m_pRenderer->getBindingExternalName(b));
+	return true;
+}
+
+void EpisodeRecorder::render()
+{
+	bool bSceneLoaded = false;
+	string error;
+	try
+	{
+		bSceneLoaded = loadScene();
+	}
+	catch (std::exception& e)
+	{
+		error = e.what();
+	}
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_bLoaded = true;
+		m_bSceneLoaded = bSceneLoaded;
+		m_loadError = error;
+	}
+	m_condition.notify_all();
+
+	if (bSceneLoaded)
+	{
+		m_pixels.resize(3 * m_width * m_height);
+		Frame frame;
+		while (true)
+		{
+			{
+				//the frames queued before the exit was requested are still written
+				unique_lock<mutex> lock(m_mutex);
+				m_condition.wait(lock, [this]() { return m_bExit || !m_frames.empty(); });
+				if (m_frames.empty())
+					break;
+				if (!frame.bindingValues.empty())
+					m_freeBindingValues.push_back(std::move(frame.bindingValues));
+				frame = std::move(m_frames.front());
+				m_frames.pop_front();
+			}
+			recordFrame(frame);
+		}
+		closeRecording();
+	}
+
+	//the OpenGL context belongs to this thread
+	delete m_pRenderer;
+	m_pRenderer = nullptr;
+}
+
+void EpisodeRecorder::recordFrame(const Frame& frame)
+{
+	if (frame.evaluation != m_recordedEvaluation)
+	{
+		closeRecording();
+		openRecording(frame.evaluation);
+	}
+
+	for (unsigned int b = 0; b < frame.bindingValues.size(); ++b)
+		m_pRenderer->updateBinding(b, frame.bindingValues[b]);
+	m_pRenderer->draw();
+	m_pRenderer->readFrame(m_pixels.data());
+
+	if (m_format == VideoFormat::y4m)
+		writeVideoFrame();
+	else writeImage();
+	++m_numWrittenFrames;
+}
+
+void EpisodeRecorder::openRecording(unsigned int evaluation)
+{
+	m_recordedEvaluation = evaluation;
+	m_numWrittenFrames = 0;
+	if (m_format != VideoFormat::y4m)
+		return;
+
+	string filename = m_pApp->pLogger->getRecordingFilename(evaluation);
+	m_pVideoFile = fopen(filename.c_str(), "wb");
+	if (!m_pVideoFile)
+	{
+		m_writeError = "Couldn't create the video file " + filename;
+		return;
+	}
+	//frame rate as a fraction with millisecond precision. 4:4:4 chroma, so that frames are converted pixel by pixel
+	fprintf(m_pVideoFile, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C444\n", m_width, m_height
+		, (int)std::round(m_videoFPS * 1000.0));
+}
+
+void EpisodeRecorder::closeRecording()
+{
+	if (m_pVideoFile)
+		fclose(m_pVideoFile);
+	m_pVideoFile = nullptr;
+}
+
+void EpisodeRecorder::writeVideoFrame()
+{
+	if (!m_pVideoFile)
+		return;
+
+	//RGB to Y'CbCr (BT.601, studio range). Rows are read bottom-up
+	size_t planeSize = (size_t)m_width * m_height;
+	m_videoFrame.resize(3 * planeSize);
+	unsigned char* pY = m_videoFrame.data();
+	unsigned char* pCb = pY + planeSize;
+	unsigned char* pCr = pCb + planeSize;
+	for (int row = 0; row < m_height; ++row)
+	{
+		const unsigned char* pRGB = m_pixels.data() + 3 * (size_t)(m_height - 1 - row) * m_width;
+		for (int x = 0; x < m_width; ++x, pRGB += 3)
+		{
+			int r = pRGB[0], g = pRGB[1], b = pRGB[2];
+			*pY++ = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+			*pCb++ = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			*pCr++ = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+	fputs("FRAME\n", m_pVideoFile);
+	if (fwrite(m_videoFrame.data(), 1, m_videoFrame.size(), m_pVideoFile) != m_videoFrame.size())
+	{
+		m_writeError = "Couldn't write the video file " + m_pApp->pLogger->getRecordingFilename(m_recordedEvaluation);
+		closeRecording();
+	}
+}
+
+void EpisodeRecorder::writeImage()
+{
+	char frameSuffix[32];
+	snprintf(frameSuffix, sizeof(frameSuffix), ".%05u.ppm", m_numWrittenFrames);
+	string filename = m_pApp->pLogger->getRecordingFilename(m_recordedEvaluation) + frameSuffix;
+	FILE* pFile = fopen(filename.c_str(), "wb");
+	if (!pFile)
+	{
+		m_writeError = "Couldn't create the image file " + filename;
+		return;
+	}
+	fprintf(pFile, "P6\n%d %d\n255\n", m_width, m_height);
+	//rows are read bottom-up
+	for (int row = m_height - 1; row >= 0; --row)
+		fwrite(m_pixels.data() + 3 * (size_t)row * m_width, 1, 3 * (size_t)m_width, pFile);
+	fclose(pFile);
+}
+
+void EpisodeRecorder::update(const State* s)
+{
+	if (!m_bSceneLoaded)
+		return;
+
+	//only the first episode of the recorded evaluations, one frame every m_stepsPerFrame steps
+	Experiment* pExperiment = m_pApp->pExperiment.ptr();
+	if (!pExperiment->isEvaluationEpisode() || pExperiment->getEpisodeInEvaluationIndex() != 1
+		|| (pExperiment->getStep() - 1) % m_stepsPerFrame != 0)
+		return;
+	unsigned int evaluation = pExperiment->getEvaluationIndex();
+	if (!m_pApp->pLogger->isEvaluationRecorded(evaluation))
+		return;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_frames.size() >= MAX_QUEUED_FRAMES)
+		{
+			++m_numDroppedFrames;
+			return;
+		}
+		Frame frame;
+		frame.evaluation = evaluation;
+		if (!m_freeBindingValues.empty())
+		{
+			frame.bindingValues = std::move(m_freeBindingValues.back());
+			m_freeBindingValues.pop_back();
+		}
+		frame.bindingValues.resize(m_boundVariables.size());
+		for (size_t b = 0; b < m_boundVariables.size(); ++b)
+		{
+			const BoundVariable& variable = m_boundVariables[b];
+			frame.bindingValues[b] = variable.pWire ? variable.pWire->getValue() : s->get(variable.stateIndex);
+		}
+		m_frames.push_back(std::move(frame));
+	}
+	m_condition.notify_one();
+}
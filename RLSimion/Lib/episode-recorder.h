@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "parameters.h"
+using namespace std;
+
+class SimionApp;
+class NamedVarSet;
+typedef NamedVarSet State;
+class Wire;
+class Renderer;
+
+//Recording of evaluation episodes (Record-Eval-Episodes): the scene of the selected evaluation episodes is rendered
+//offscreen (no window or display is needed) and saved as a raw YUV4MPEG2 video or a sequence of PPM images, one per
+//evaluation. The simulation thread only copies the values bound to the scene every few steps (one frame every
+//1/Record-FPS seconds of simulation time) to a queue. A background thread owns the offscreen renderer: it draws the
+//queued frames, reads them back and writes them. If the queue is full, frames are dropped instead of slowing down the
+//simulation
+class EpisodeRecorder
+{
+	//what the simulation thread queues
+	struct Frame
+	{
+		unsigned int evaluation;
+		vector<double> bindingValues;
+	};
+	static const size_t MAX_QUEUED_FRAMES = 256;
+	deque<Frame> m_frames;
+	vector<vector<double>> m_freeBindingValues; //recycled to avoid allocating every frame
+	size_t m_numDroppedFrames = 0;
+
+	//simulation thread: the source of the bindings of the scene, resolved once (a state variable or a wire)
+	struct BoundVariable
+	{
+		size_t stateIndex;
+		Wire* pWire;
+	};
+	SimionApp* m_pApp;
+	vector<BoundVariable> m_boundVariables;
+	unsigned int m_stepsPerFrame = 1;
+
+	//what the render thread needs, copied before it starts
+	string m_sceneFile;
+	int m_width;
+	int m_height;
+	double m_videoFPS = 0.0; //the frame rate of the video: 1/(m_stepsPerFrame*dt)
+	VideoFormat m_format;
+
+	//render thread
+	thread m_renderThread;
+	Renderer* m_pRenderer = nullptr;
+	unsigned int m_recordedEvaluation = 0;
+	FILE* m_pVideoFile = nullptr;
+	unsigned int m_numWrittenFrames = 0;
+	vector<unsigned char> m_pixels;
+	vector<unsigned char> m_videoFrame;
+	string m_writeError;
+
+	//the frames are queued and taken under the mutex. The scene is loaded by the render thread before the simulation
+	//begins, because the bindings come from the scene
+	mutex m_mutex;
+	condition_variable m_condition;
+	bool m_bExit = false;
+	bool m_bLoaded = false;
+	bool m_bSceneLoaded = false;
+	string m_loadError;
+	vector<string> m_bindingNames;
+
+	void render();
+	bool loadScene();
+	void recordFrame(const Frame& frame);
+	void openRecording(unsigned int evaluation);
+	void closeRecording();
+	void writeVideoFrame();
+	void writeImage();
+public:
+	//Loads the scene (sceneFile is relative to the scenes folder) with an offscreen renderer. If it can't be loaded,
+	//a warning is logged and nothing will be recorded
+	EpisodeRecorder(SimionApp* pApp, string sceneFile);
+	//waits until all the queued frames are written
+	virtual ~EpisodeRecorder();
+
+	bool isRunning() const { return m_bSceneLoaded; }
+
+	//Called by the simulation thread after every step
+	void update(const State* s);
+};
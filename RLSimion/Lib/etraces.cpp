@@ -27,6 +27,8 @@
 #include "experiment.h"
 #include "config.h"
 #include "app.h"
+#include <algorithm>
+#include <math.h>
 
 ETraces::ETraces(ConfigNode* pConfigNode): FeatureList("ETraces")
 {
@@ -39,12 +41,26 @@ ETraces::ETraces(ConfigNode* pConfigNode): FeatureList("ETraces")
 		//CONST_DOUBLE_VALUE(m_lambda,"Lambda",0.9,"Lambda parameter");
 		m_bReplace= BOOL_PARAM(pConfigNode,"Replace", "Replace existing traces? Or add?",true);
 		//ENUM_VALUE(replace, Boolean, "Replace", "True","Replace existing traces? Or add?");
+		m_maxNumTraces = INT_PARAM(pConfigNode, "Max-Num-Traces", "Maximum number of active traces. The smallest are removed (0: no limit)", 0);
 		if (m_bReplace.get()) m_overwriteMode = OverwriteMode::Replace;
 		else m_overwriteMode = OverwriteMode::Add;
+		resetPositionTable(0);
 	}
 
 }
 
+ETraces::ETraces(double threshold, double lambda, bool bReplace, int maxNumTraces) : FeatureList("ETraces")
+{
+	m_bUse = true;
+	m_threshold.set(threshold);
+	m_lambda.set(lambda);
+	m_bReplace.set(bReplace);
+	m_maxNumTraces.set(maxNumTraces);
+	if (bReplace) m_overwriteMode = OverwriteMode::Replace;
+	else m_overwriteMode = OverwriteMode::Add;
+	resetPositionTable(0);
+}
+
 ETraces::ETraces():FeatureList("ETraces")
 {
 	m_bUse = false;
@@ -58,23 +74,128 @@ ETraces::~ETraces()
 void ETraces::update(double factor)
 {
 	if (!SimionApp::get()->pExperiment->isFirstStep() && m_bUse)
-	{
-		mult(factor* m_lambda.get());
-		applyThreshold(m_threshold.get());
-	}
+		decay(factor);
 	else
 		clear();
 }
 
+void ETraces::decay(double factor)
+{
+	//decay the traces and remove those under the threshold in a single pass, indexing the remaining ones
+	double decayFactor = factor * m_lambda.get();
+	double threshold = fabs(m_threshold.get());
+	size_t numTraces = 0;
+
+	resetPositionTable(m_numFeatures);
+	for (size_t i = 0; i < m_numFeatures; i++)
+	{
+		double trace = m_pFeatures[i].m_factor * decayFactor;
+		if (fabs(trace) >= threshold)
+		{
+			m_pFeatures[numTraces].m_index = m_pFeatures[i].m_index;
+			m_pFeatures[numTraces].m_factor = trace;
+			indexFeature(numTraces);
+			numTraces++;
+		}
+	}
+	m_numFeatures = numTraces;
+}
+
 void ETraces::addFeatureList(FeatureList* inList, double factor)
 {
 	if (m_bUse)
 	{
-		FeatureList::addFeatureList(inList, factor);
+		//the list may have been changed using the FeatureList interface
+		if (m_numIndexedFeatures != m_numFeatures)
+			rebuildPositionTable();
+
+		for (size_t i = 0; i < inList->m_numFeatures; i++)
+			addTrace(inList->m_pFeatures[i].m_index, inList->m_pFeatures[i].m_factor * factor);
+
+		if (m_maxNumTraces.get() > 0 && m_numFeatures > (size_t) m_maxNumTraces.get())
+			evictSmallestTraces();
 	}
 	else
 	{
 		clear();
 		copyMult(factor,inList);
 	}
-}
\ No newline at end of file
+}
+
+void ETraces::clear()
+{
+	FeatureList::clear();
+	resetPositionTable(0);
+}
+
+void ETraces::applyThreshold(double threshold)
+{
+	FeatureList::applyThreshold(threshold);
+	rebuildPositionTable();
+}
+
+size_t ETraces::findSlot(size_t featureIndex) const
+{
+	//Fibonacci hashing: consecutive feature indices are spread over the table
+	size_t mask = m_positionTable.size() - 1;
+	size_t slot = (size_t)((featureIndex * 11400714819323198485ull) >> 20) & mask;
+	while (m_positionTable[slot] >= 0 && m_pFeatures[m_positionTable[slot]].m_index != featureIndex)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+void ETraces::resetPositionTable(size_t numFeatures)
+{
+	//keep the load factor under 1/2
+	size_t tableSize = 64;
+	while (tableSize < 2 * numFeatures)
+		tableSize *= 2;
+	if (m_positionTable.size() < tableSize)
+		m_positionTable.resize(tableSize);
+	std::fill(m_positionTable.begin(), m_positionTable.end(), -1);
+	m_numIndexedFeatures = 0;
+}
+
+void ETraces::indexFeature(size_t pos)
+{
+	m_positionTable[findSlot(m_pFeatures[pos].m_index)] = (long long)pos;
+	m_numIndexedFeatures++;
+}
+
+void ETraces::rebuildPositionTable()
+{
+	resetPositionTable(m_numFeatures);
+	for (size_t i = 0; i < m_numFeatures; i++)
+		indexFeature(i);
+}
+
+void ETraces::addTrace(size_t index, double value)
+{
+	size_t slot = findSlot(index);
+	long long pos = m_positionTable[slot];
+	if (pos >= 0)
+	{
+		if (m_overwriteMode == OverwriteMode::Add) m_pFeatures[pos].m_factor += value;
+		else m_pFeatures[pos].m_factor = value;
+		return;
+	}
+	if (m_numFeatures >= getNumAllocFeatures())
+		resize(m_numFeatures + 1);
+	m_pFeatures[m_numFeatures].m_index = index;
+	m_pFeatures[m_numFeatures].m_factor = value;
+	m_positionTable[slot] = (long long)m_numFeatures;
+	m_numFeatures++;
+	m_numIndexedFeatures++;
+	if (2 * m_numIndexedFeatures > m_positionTable.size())
+		rebuildPositionTable();
+}
+
+void ETraces::evictSmallestTraces()
+{
+	//move the largest traces to the beginning of the list and drop the rest
+	size_t maxNumTraces = (size_t) m_maxNumTraces.get();
+	std::nth_element(m_pFeatures, m_pFeatures + maxNumTraces, m_pFeatures + m_numFeatures
+		, [](const Feature& a, const Feature& b) { return fabs(a.m_factor) > fabs(b.m_factor); });
+	m_numFeatures = maxNumTraces;
+	rebuildPositionTable();
+}
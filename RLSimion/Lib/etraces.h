@@ -1,6 +1,7 @@
 #pragma once
 #include "parameters.h"
 #include "features.h"
+#include <vector>
 
 class ConfigNode;
 
@@ -10,17 +11,36 @@ class ETraces : public FeatureList
 	DOUBLE_PARAM m_threshold;
 	DOUBLE_PARAM m_lambda;
 	BOOL_PARAM m_bReplace;
+	INT_PARAM m_maxNumTraces;
+
+	//Open-addressing hash table with the position in the list of each feature index, so that adding a feature doesn't
+	//have to search the whole list. Empty slots are -1. It is rebuilt while the traces are decayed
+	vector<long long> m_positionTable;
+	size_t m_numIndexedFeatures = 0;
+
+	size_t findSlot(size_t featureIndex) const;
+	void resetPositionTable(size_t numFeatures);
+	void indexFeature(size_t pos);
+	void rebuildPositionTable();
+	void addTrace(size_t index, double value);
+	void evictSmallestTraces();
 public:
 	ETraces(ConfigNode* pConfigNode);
+	ETraces(double threshold, double lambda, bool bReplace, int maxNumTraces = 0);
 	ETraces();
 	virtual ~ETraces();
 
 	//traces will be multiplied by factor*lambda
 	//traces are automatically cleared if it's the first step of an episode
 	void update(double factor = 1.0);
+	//traces are multiplied by factor*lambda and those under the threshold are removed
+	void decay(double factor);
 
 	void addFeatureList(FeatureList *inList, double factor = 1.0);
 
+	void clear();
+	void applyThreshold(double threshold);
+
 	double getLambda() { return m_lambda.get(); };
 	void setLambda(double value) { m_lambda.set(value); }
 
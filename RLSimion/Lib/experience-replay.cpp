@@ -29,23 +29,33 @@
 #include "logger.h"
 #include "../Common/named-var-set.h"
 #include "simgod.h"
+#include "noise.h"
 #include "worlds/world.h"
 #include <algorithm>
 
 ExperienceTuple::ExperienceTuple()
 {
-	s = SimionApp::get()->pWorld->getDynamicModel()->getStateInstance();
-	a = SimionApp::get()->pWorld->getDynamicModel()->getActionInstance();
-	s_p = SimionApp::get()->pWorld->getDynamicModel()->getStateInstance();
+	s = nullptr;
+	a = nullptr;
+	s_p = nullptr;
 }
 
-void ExperienceTuple::copy(const State* s, const Action* a, const State* s_p, double r, double probability)
+void ExperienceTuple::init(Descriptor& stateDescriptor, Descriptor& actionDescriptor)
+{
+	s = stateDescriptor.getInstance();
+	a = actionDescriptor.getInstance();
+	s_p = stateDescriptor.getInstance();
+}
+
+void ExperienceTuple::copy(const State* s, const Action* a, const State* s_p, double r, double probability
+	, bool bEpisodeEnd)
 {
 	this->s->copy(s);
 	this->a->copy(a);
 	this->s_p->copy(s_p);
 	this->r = r;
 	this->probability = probability;
+	this->bEpisodeEnd = bEpisodeEnd;
 }
 
 
@@ -53,6 +63,8 @@ ExperienceReplay::ExperienceReplay(ConfigNode* pConfigNode)
 {
 	m_bufferSize = INT_PARAM(pConfigNode, "Buffer-Size", "Size of the buffer used to store experience tuples", 1000);
 	m_updateBatchSize = INT_PARAM(pConfigNode, "Update-Batch-Size", "Number of tuples used each time-step in the update", 10);
+	m_returnSteps = INT_PARAM(pConfigNode, "Return-Steps", "Maximum number of steps n of the returns used as targets of the replayed tuples (1: one-step targets)", 1);
+	m_returnLambda = DOUBLE_PARAM(pConfigNode, "Return-Lambda", "Lambda of the truncated lambda-returns of the replayed tuples (0: n-step returns)", 0.0);
 
 	Logger::logMessage(MessageType::Info, "Experience replay buffer initialized");
 
@@ -66,6 +78,8 @@ ExperienceReplay::ExperienceReplay() : DeferredLoad()
 	//default behaviour when experience replay is not used
 	m_bufferSize.set(0);
 	m_updateBatchSize.set(0);
+	m_returnSteps.set(1);
+	m_returnLambda.set(0.0);
 
 	m_pTupleBuffer = 0;
 	m_currentPosition = 0;
@@ -77,9 +91,17 @@ bool ExperienceReplay::bUsing()
 	return m_bufferSize.get() != 0;
 }
 
-void ExperienceReplay::deferredLoadStep()
+void ExperienceReplay::init(Descriptor& stateDescriptor, Descriptor& actionDescriptor)
 {
 	m_pTupleBuffer = new ExperienceTuple[m_bufferSize.get()];
+	for (int i = 0; i < m_bufferSize.get(); ++i)
+		m_pTupleBuffer[i].init(stateDescriptor, actionDescriptor);
+}
+
+void ExperienceReplay::deferredLoadStep()
+{
+	init(SimionApp::get()->pWorld->getDynamicModel()->getStateDescriptor()
+		, SimionApp::get()->pWorld->getDynamicModel()->getActionDescriptor());
 }
 
 ExperienceReplay::~ExperienceReplay()
@@ -101,7 +123,8 @@ bool ExperienceReplay::bHaveEnoughTuples() const
 	return m_numTuples >= minNumTuplesForUpdate;
 }
 
-void ExperienceReplay::addTuple(const State* s, const  Action* a, const State* s_p, double r, double probability)
+void ExperienceReplay::addTuple(const State* s, const  Action* a, const State* s_p, double r, double probability
+	, bool bEpisodeEnd)
 {
 	//add the experience tuple to the buffer
 	if (!bUsing()) return;
@@ -109,20 +132,92 @@ void ExperienceReplay::addTuple(const State* s, const  Action* a, const State* s
 	if (m_numTuples < (size_t)m_bufferSize.get())
 	{
 		//the buffer is not yet full
-		m_pTupleBuffer[m_currentPosition].copy(s, a, s_p, r, probability);
+		m_pTupleBuffer[m_currentPosition].copy(s, a, s_p, r, probability, bEpisodeEnd);
 		++m_numTuples;
 	}
 	else
 	{
 		//the buffer is full
-		m_pTupleBuffer[m_currentPosition].copy(s, a, s_p, r, probability);
+		m_pTupleBuffer[m_currentPosition].copy(s, a, s_p, r, probability, bEpisodeEnd);
 	}
 	m_currentPosition = ++m_currentPosition % (size_t) m_bufferSize.get();
 }
 
 ExperienceTuple* ExperienceReplay::getRandomTupleFromBuffer()
 {
-	int randomIndex = rand() % (size_t) m_numTuples;
+	int randomIndex = (int) getRandomIndex(m_numTuples);
 
 	return &m_pTupleBuffer[randomIndex];
-}
\ No newline at end of file
+}
+
+//Number of steps of the trajectory that begins with the tuple in position start (at most Return-Steps)
+size_t ExperienceReplay::getNumSteps(size_t start) const
+{
+	size_t maxNumSteps = (size_t)std::max(1, m_returnSteps.get());
+	size_t numSteps = 1;
+	size_t position = start;
+	while (numSteps < maxNumSteps && !m_pTupleBuffer[position].bEpisodeEnd)
+	{
+		position = (position + 1) % (size_t)m_bufferSize.get();
+		//the tuple that follows the most recent one is the oldest one
+		if (position == m_currentPosition)
+			break;
+		++numSteps;
+	}
+	return numSteps;
+}
+
+//The n-step return G(n) has weight (1-lambda)*lambda^(n-1) in the lambda-return truncated after N steps, and G(N)
+//takes the remaining weight lambda^(N-1)
+size_t ExperienceReplay::sampleNumSteps() const
+{
+	size_t maxNumSteps = (size_t)std::max(1, m_returnSteps.get());
+	if (maxNumSteps == 1 || m_returnLambda.get() <= 0.0)
+		return maxNumSteps;
+
+	size_t numSteps = 1;
+	while (numSteps < maxNumSteps && getRandomValue() <= m_returnLambda.get())
+		++numSteps;
+	return numSteps;
+}
+
+const std::vector<ReplayedTuple>& ExperienceReplay::sampleBatch(double gamma)
+{
+	size_t batchSize = getUpdateBatchSize();
+	m_batchStart.resize(batchSize);
+	m_batchNumSteps.resize(batchSize);
+	m_batchReturns.assign(batchSize, 0.0);
+	m_batch.resize(batchSize);
+
+	size_t maxNumSteps = 0;
+	for (size_t i = 0; i < batchSize; ++i)
+	{
+		m_batchStart[i] = getRandomIndex(m_numTuples);
+		size_t numSteps = sampleNumSteps();
+		m_batchNumSteps[i] = std::min(numSteps, getNumSteps(m_batchStart[i]));
+		maxNumSteps = std::max(maxNumSteps, m_batchNumSteps[i]);
+	}
+
+	//backward pass: G= r_{t+k} + gamma*G, from the last step of the longest trajectory to the first one
+	size_t bufferSize = (size_t)m_bufferSize.get();
+	for (size_t step = maxNumSteps; step-- > 0;)
+	{
+		for (size_t i = 0; i < batchSize; ++i)
+		{
+			if (step < m_batchNumSteps[i])
+				m_batchReturns[i] = m_pTupleBuffer[(m_batchStart[i] + step) % bufferSize].r + gamma * m_batchReturns[i];
+		}
+	}
+
+	for (size_t i = 0; i < batchSize; ++i)
+	{
+		ReplayedTuple& replayedTuple = m_batch[i];
+		replayedTuple.pTuple = &m_pTupleBuffer[m_batchStart[i]];
+		replayedTuple.s_n = m_pTupleBuffer[(m_batchStart[i] + m_batchNumSteps[i] - 1) % bufferSize].s_p;
+		replayedTuple.nStepReturn = m_batchReturns[i];
+		replayedTuple.discount = gamma;
+		for (size_t step = 1; step < m_batchNumSteps[i]; ++step)
+			replayedTuple.discount *= gamma;
+	}
+	return m_batch;
+}
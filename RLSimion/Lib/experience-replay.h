@@ -2,9 +2,11 @@
 
 #include "deferred-load.h"
 #include "parameters.h"
+#include <vector>
 class NamedVarSet;
 typedef NamedVarSet State;
 typedef NamedVarSet Action;
+class Descriptor;
 class ConfigNode;
 
 class ExperienceTuple
@@ -15,9 +17,22 @@ public:
 	State* s_p;
 	double r;
 	double probability; //probability under which the actor took action a in state s
+	bool bEpisodeEnd; //s_p is the last state of the episode: the next tuple in the buffer begins a new one
 
 	ExperienceTuple();
-	void copy(const State* s, const Action* a, const  State* s_p, double r,double probability);
+	void init(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
+	void copy(const State* s, const Action* a, const  State* s_p, double r,double probability, bool bEpisodeEnd);
+};
+
+//A replayed tuple: the experience tuple of time t, the last state s_{t+n} reached by the trajectory that begins with
+//it, the discounted sum of the n rewards received r_t + gamma*r_{t+1} + ... + gamma^(n-1)*r_{t+n-1}, and gamma^n,
+//the discount that must be applied to the value of s_{t+n}. With n=1, these are the tuple's own s_p, r and gamma
+struct ReplayedTuple
+{
+	const ExperienceTuple* pTuple;
+	const State* s_n;
+	double nStepReturn;
+	double discount;
 };
 
 class ExperienceReplay: public DeferredLoad
@@ -26,9 +41,21 @@ class ExperienceReplay: public DeferredLoad
 	INT_PARAM m_bufferSize;
 	INT_PARAM m_updateBatchSize;
 
+	INT_PARAM m_returnSteps;
+	DOUBLE_PARAM m_returnLambda;
+
 	size_t m_currentPosition= 0;
 	size_t m_numTuples= 0;
 	const unsigned int m_minUpdateSizeTimes = 4; //how many update-size times tuples we need to start updating
+
+	//the batch sampled last, stored by columns so that returns can be computed with a backward pass over all of them
+	std::vector<size_t> m_batchStart;
+	std::vector<size_t> m_batchNumSteps;
+	std::vector<double> m_batchReturns;
+	std::vector<ReplayedTuple> m_batch;
+
+	size_t getNumSteps(size_t start) const;
+	size_t sampleNumSteps() const;
 public:
 	ExperienceReplay(ConfigNode* pParameters);
 	ExperienceReplay();
@@ -37,9 +64,19 @@ public:
 	bool bUsing();
 	bool bHaveEnoughTuples() const;
 
-	void addTuple(const State* s, const Action* a, const State* s_p, double r, double probability);
+	void addTuple(const State* s, const Action* a, const State* s_p, double r, double probability
+		, bool bEpisodeEnd = false);
 	size_t getUpdateBatchSize() const;
 	ExperienceTuple* getRandomTupleFromBuffer();
 
+	//Samples getUpdateBatchSize() tuples and calculates their returns. Trajectories are cut at the end of episodes
+	//and at the most recent tuple. With Return-Lambda=0, the n-step return is used (n=Return-Steps). Otherwise, the
+	//number of steps of each tuple is sampled from the weights of the n-step returns in the lambda-return, so that
+	//the expected target is the lambda-return truncated after Return-Steps steps
+	const std::vector<ReplayedTuple>& sampleBatch(double gamma);
+
+	//Allocates the buffer with tuples of the given state and action variables. deferredLoadStep() calls it with
+	//those of the world
+	void init(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	void deferredLoadStep();
 };
\ No newline at end of file
@@ -110,7 +110,8 @@ bool Experiment::isEvaluationEpisode()
 			% (m_numEpisodesPerEvaluation + m_evalFreq.get());
 		return episodeInEvalTrainingCycle < m_numEpisodesPerEvaluation;
 	}
-	return true;
+	//only training episodes
+	return false;
 }
 
 unsigned int Experiment::getEpisodeInEvaluationIndex()
@@ -206,6 +207,17 @@ void Experiment::nextEpisode()
 	}
 }
 
+void Experiment::setEvaluation(unsigned int evaluationIndex)
+{
+	//evaluations are followed by m_evalFreq training episodes, except the last one
+	unsigned int numPreviousEvaluations = evaluationIndex - 1;
+	m_episodeIndex = numPreviousEvaluations * (m_numEpisodesPerEvaluation + m_evalFreq.get());
+	m_evalEpisodeIndex = numPreviousEvaluations * m_numEpisodesPerEvaluation;
+	m_trainingEpisodeIndex = std::min(numPreviousEvaluations * m_evalFreq.get(), (unsigned int)m_numTrainingEpisodes.get());
+	m_step = 0;
+	m_bTerminalState = false;
+}
+
 bool Experiment::isFirstEpisode()
 {
 	return m_episodeIndex == 1;
@@ -233,6 +245,7 @@ Experiment::Experiment(ConfigNode* pConfigNode)
 
 	m_numTrainingEpisodes = INT_PARAM(pConfigNode, "Num-Episodes", "Number of episodes. Zero if we only want to run one evaluation episode", 1000);
 	m_evalFreq = INT_PARAM(pConfigNode, "Eval-Freq", "Evaluation frequency (in episodes). If zero then only training episodes will be run", 10);
+	m_numEvaluationThreads = INT_PARAM(pConfigNode, "Evaluation-Threads", "Threads that run the evaluations in parallel with the training episodes, on a snapshot of the weights. If zero, training stops while evaluations are run", 0);
 
 	m_episodeLength = DOUBLE_PARAM(pConfigNode, "Episode-Length", "Length of an episode(seconds)", 10.0);
 
@@ -241,7 +254,16 @@ Experiment::Experiment(ConfigNode* pConfigNode)
 
 	m_pProgressTimer = new Timer();
 
-	srand((unsigned int)m_randomSeed.get());
+	seedRandomEngine();
+}
+
+void Experiment::seedRandomEngine(unsigned int stream)
+{
+	SimionApp* pApp = SimionApp::get();
+	if (!pApp) return;
+
+	std::seed_seq seed = { (unsigned int)m_randomSeed.get(), stream };
+	pApp->getRandomEngine().seed(seed);
 }
 
 
@@ -41,6 +41,7 @@ class Experiment
 	unsigned int m_numEvaluations= 0;	//total number of evaluation episodes
 	unsigned int m_numEpisodesPerEvaluation= 1;//number of episodes in each evaluation
 	INT_PARAM m_evalFreq;					//frequeny (in episodes) at which an evaluation episode will be done
+	INT_PARAM m_numEvaluationThreads;		//threads that run the evaluations in parallel with training (0: none)
 	//steps
 	unsigned int m_numSteps= 0;
 	unsigned int m_experimentStep= 0;
@@ -58,6 +59,9 @@ public:
 
 	void getExperimentTime(ExperimentTime& ref) { ref.m_episodeIndex = m_episodeIndex; ref.m_step = m_step; }
 	void reset();
+	//Seeds the random engine of the app with Random-Seed. Apps that run part of the same experiment (asynchronous
+	//workers, parallel evaluators) pass a different stream each, so that they don't draw the same numbers
+	void seedRandomEngine(unsigned int stream = 0);
 
 	//STEP
 	bool isValidStep();
@@ -86,6 +90,11 @@ public:
 	bool isEvaluationEpisode();
 
 	unsigned int getNumEvaluations(){ return m_numEvaluations; }
+	int getEvaluationFreq() { return m_evalFreq.get(); }
+	unsigned int getNumEvaluationThreads() { return m_numEvaluationThreads.get() > 0 ? (unsigned int) m_numEvaluationThreads.get() : 0; }
+	//Sets the counters so that the next episode is the first one of the given evaluation (1-based index). Used by the
+	//apps that run the evaluations in parallel with training (see ParallelEvaluator)
+	void setEvaluation(unsigned int evaluationIndex);
 	void setEvaluationFreq(int evalFreq);
 	void setNumEpisodesPerEvaluation(int numEpisodes);
 	unsigned int getNumEpisodesPerEvaluation() { return m_numEpisodesPerEvaluation; }
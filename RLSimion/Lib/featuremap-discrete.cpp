@@ -54,7 +54,7 @@ DiscreteFeatureMap::~DiscreteFeatureMap()
 
 }
 
-void DiscreteFeatureMap::map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures)
+void DiscreteFeatureMap::map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList*)
 {
 	size_t offset = 1, featureIndex = 0;
 
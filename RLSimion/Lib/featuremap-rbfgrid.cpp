@@ -33,18 +33,14 @@
 
 GaussianRBFGridFeatureMap::GaussianRBFGridFeatureMap()
 {
-	m_pVarFeatures = new FeatureList("RBFGrid/var");
 }
 
 GaussianRBFGridFeatureMap::GaussianRBFGridFeatureMap(ConfigNode* pConfigNode)
 {
-	m_pVarFeatures = new FeatureList("RBFGrid/var");
 }
 
 GaussianRBFGridFeatureMap::~GaussianRBFGridFeatureMap()
 {
-	if (m_pVarFeatures)
-		delete m_pVarFeatures;
 }
 
 void GaussianRBFGridFeatureMap::init(vector<SingleDimensionGrid*>& grids)
@@ -61,7 +57,7 @@ void GaussianRBFGridFeatureMap::init(vector<SingleDimensionGrid*>& grids)
 }
 
 
-void GaussianRBFGridFeatureMap::map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures)
+void GaussianRBFGridFeatureMap::map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList* pAuxFeatures)
 {
 	size_t offset = 1;
 
@@ -74,10 +70,10 @@ void GaussianRBFGridFeatureMap::map(vector<SingleDimensionGrid*>& grids, const v
 	{
 		offset *= grids[i-1]->getValues().size();
 
-		//we calculate the features of i-th variable in m_pVarFeatures
-		getDimensionFeatures(grids[i], values[i], m_pVarFeatures);
+		//we calculate the features of i-th variable in pAuxFeatures
+		getDimensionFeatures(grids[i], values[i], pAuxFeatures);
 		//spawn features in buffer with the i-th variable's features
-		outFeatures->spawn(m_pVarFeatures, offset);
+		outFeatures->spawn(pAuxFeatures, offset);
 	}
 	//unnecessary (it will be done by each grid) if there is only one variable
 	if (grids.size() > 1)
@@ -62,7 +62,7 @@ TileCodingFeatureMap::~TileCodingFeatureMap()
 
 
 //https://www.cs.utexas.edu/~pstone/Papers/bib2html-links/SARA05.slides.pdf
-void TileCodingFeatureMap::map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures)
+void TileCodingFeatureMap::map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList*)
 {
 	//initialize outFeatures with the right size
 	outFeatures->clear();
@@ -27,6 +27,7 @@
 #include "config.h"
 #include "../Common/named-var-set.h"
 #include "single-dimension-grid.h"
+#include "features.h"
 #include "app.h"
 #include "worlds/world.h"
 
@@ -36,11 +37,18 @@
 FeatureMap::FeatureMap(ConfigNode* pConfigNode)
 {
 	m_numFeaturesPerVariable = INT_PARAM(pConfigNode, "Num-Features-Per-Dimension", "Number of features per input variable", 20);
+	m_pAuxFeatures = new FeatureList("FeatureMap/aux");
 }
 
 FeatureMap::FeatureMap(size_t numFeaturesPerVariable)
 {
 	m_numFeaturesPerVariable.set((int) numFeaturesPerVariable);
+	m_pAuxFeatures = new FeatureList("FeatureMap/aux");
+}
+
+FeatureMap::~FeatureMap()
+{
+	delete m_pAuxFeatures;
 }
 
 size_t FeatureMap::getNumFeaturesPerVariable()
@@ -60,12 +68,20 @@ size_t FeatureMap::getMaxNumActiveFeatures() const
 
 void FeatureMap::getFeatures(const State* s, const Action* a, FeatureList* outFeatures)
 {
-	//copy input variable values to the internal buffer
+	//use the internal buffers
+	getFeatures(s, a, outFeatures, m_variableValues, m_pAuxFeatures);
+}
+
+void FeatureMap::getFeatures(const State* s, const Action* a, FeatureList* outFeatures, vector<double>& variableValues
+	, FeatureList* pAuxFeatures)
+{
+	//copy input variable values to the buffer
+	variableValues.resize(m_grids.size());
 	for (size_t grid = 0; grid < m_grids.size(); grid++)
-		m_variableValues[grid] = getInputVariableValue(grid, s, a);
+		variableValues[grid] = getInputVariableValue(grid, s, a);
 
 	//pass the buffer to the feature mapper
-	m_featureMapper->map(m_grids, m_variableValues, outFeatures);
+	m_featureMapper->map(m_grids, variableValues, outFeatures, pAuxFeatures);
 }
 
 void FeatureMap::getFeatureStateAction(size_t feature, State* s, Action* a)
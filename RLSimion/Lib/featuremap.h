@@ -21,7 +21,9 @@ class FeatureMapper
 {
 public:
 	virtual void init(vector<SingleDimensionGrid*>& outGrids) = 0;
-	virtual void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures) = 0;
+	//pAuxFeatures is a buffer the mapper can use to calculate intermediate features. It is given by the caller so that
+	//the same mapper can be used from several threads at the same time
+	virtual void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList* pAuxFeatures) = 0;
 	virtual void unmap(size_t feature, vector<SingleDimensionGrid*>& grids, vector<double>& outValues) = 0;
 
 	virtual size_t getTotalNumFeatures() const = 0;
@@ -37,7 +39,6 @@ class GaussianRBFGridFeatureMap : public FeatureMapper
 	size_t m_totalNumFeatures;
 	size_t m_maxNumActiveFeatures;
 	const size_t m_maxNumActiveFeaturesPerDimension = 3;
-	FeatureList* m_pVarFeatures;
 
 	double getFeatureFactor(SingleDimensionGrid* pGrid, size_t feature, double value) const;
 	void getDimensionFeatures(SingleDimensionGrid* pGrid, double value, FeatureList* outFeatures);
@@ -47,7 +48,7 @@ public:
 	virtual ~GaussianRBFGridFeatureMap();
 
 	void init(vector<SingleDimensionGrid*>& grids);
-	void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures);
+	void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList* pAuxFeatures);
 	void unmap(size_t feature, vector<SingleDimensionGrid*>& grids, vector<double>& outValues);
 
 	size_t getTotalNumFeatures() const { return m_totalNumFeatures; };
@@ -71,7 +72,7 @@ public:
 	virtual ~TileCodingFeatureMap();
 
 	void init(vector<SingleDimensionGrid*>& grids);
-	void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures);
+	void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList* pAuxFeatures);
 	void unmap(size_t feature, vector<SingleDimensionGrid*>& grids, vector<double>& outValues);
 
 	size_t getTotalNumFeatures() const { return m_totalNumFeatures; };
@@ -93,7 +94,7 @@ public:
 	virtual ~DiscreteFeatureMap();
 
 	void init(vector<SingleDimensionGrid*>& grids);
-	void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures);
+	void map(vector<SingleDimensionGrid*>& grids, const vector<double>& values, FeatureList* outFeatures, FeatureList* pAuxFeatures);
 	void unmap(size_t feature, vector<SingleDimensionGrid*>& grids, vector<double>& outValues);
 
 	size_t getTotalNumFeatures() const { return m_totalNumFeatures; };
@@ -112,6 +113,7 @@ class FeatureMap
 protected:
 	vector<SingleDimensionGrid*> m_grids;
 	vector<double> m_variableValues;
+	FeatureList* m_pAuxFeatures;
 
 	CHILD_OBJECT_FACTORY<FeatureMapper> m_featureMapper;
 
@@ -126,12 +128,16 @@ protected:
 
 	size_t getNumFeaturesPerVariable();
 public:
-	virtual ~FeatureMap() {};
+	virtual ~FeatureMap();
 
 	size_t getTotalNumFeatures() const;
 	size_t getMaxNumActiveFeatures() const;
 
 	void getFeatures(const State* s, const Action* a, FeatureList* outFeatures);
+	//Same as above, but the intermediate results are kept in the buffers given instead of the object's, so that it
+	//can be called from several threads at the same time
+	void getFeatures(const State* s, const Action* a, FeatureList* outFeatures, vector<double>& variableValues
+		, FeatureList* pAuxFeatures);
 	void getFeatureStateAction(size_t feature, State* s, Action* a);
 
 	virtual double getInputVariableValue(size_t inputIndex, const State* s, const Action* a) = 0;
@@ -23,9 +23,10 @@ class FeatureList
 	const char *m_name;
 	size_t m_numAllocFeatures;
 
+protected:
 	void resize(size_t newSize, bool bKeepFeatures= true);
+	size_t getNumAllocFeatures() const { return m_numAllocFeatures; }
 
-protected:
 	OverwriteMode m_overwriteMode;
 public:
 	Feature* m_pFeatures;
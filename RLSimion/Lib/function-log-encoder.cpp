@@ -0,0 +1,109 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "function-log-encoder.h"
+#include "../Common/function-log-format.h"
+#include <algorithm>
+#include <math.h>
+
+FunctionLogEncoder::FunctionLogEncoder(size_t numFunctions, bool bDelta, bool bFloat32, double precision)
+	: m_bDelta(bDelta), m_bFloat32(bFloat32), m_precision(precision)
+{
+	m_lastValues = vector<vector<double>>(numFunctions);
+	m_numDeltaSamples = vector<size_t>(numFunctions, 0);
+}
+
+void FunctionLogEncoder::encodeFull(size_t functionId, const vector<double>& values, FunctionSampleEncodingHeader& outHeader)
+{
+	vector<double>& lastValues = m_lastValues[functionId];
+	outHeader.quantum = 0.0;
+	if (m_bFloat32)
+	{
+		outHeader.encoding = FUNCTION_SAMPLE_FULL_FLOAT;
+		vector<float> floatValues(values.begin(), values.end());
+		copyValues(floatValues);
+		lastValues.assign(floatValues.begin(), floatValues.end());
+	}
+	else
+	{
+		outHeader.encoding = FUNCTION_SAMPLE_FULL_DOUBLE;
+		copyValues(values);
+		lastValues = values;
+	}
+	m_numDeltaSamples[functionId] = 0;
+}
+
+const vector<char>& FunctionLogEncoder::encode(size_t functionId, const vector<double>& values, FunctionSampleEncodingHeader& outHeader)
+{
+	vector<double>& lastValues = m_lastValues[functionId];
+	//a function without samples is saved as a full sample with no values
+	if (!m_bDelta || values.empty() || lastValues.size() != values.size() || m_numDeltaSamples[functionId] >= MAX_DELTA_SAMPLES)
+	{
+		encodeFull(functionId, values, outHeader);
+		return m_buffer;
+	}
+
+	double minValue = *std::min_element(values.begin(), values.end());
+	double maxValue = *std::max_element(values.begin(), values.end());
+	double quantum = m_precision * (maxValue > minValue ? maxValue - minValue : 1.0);
+
+	//quantize the changes
+	vector<long long int> deltas(values.size());
+	long long int maxAbsDelta = 0;
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		double delta = (values[i] - lastValues[i]) / quantum;
+		//values that don't fit in 16 bits (or aren't finite) are saved in full
+		if (!(fabs(delta) < 32767.0))
+		{
+			encodeFull(functionId, values, outHeader);
+			return m_buffer;
+		}
+		deltas[i] = (long long int) round(delta);
+		maxAbsDelta = std::max(maxAbsDelta, deltas[i] < 0 ? -deltas[i] : deltas[i]);
+	}
+
+	outHeader.quantum = quantum;
+	if (maxAbsDelta == 0)
+	{
+		outHeader.encoding = FUNCTION_SAMPLE_UNCHANGED;
+		m_buffer.clear();
+	}
+	else if (maxAbsDelta <= 127)
+	{
+		outHeader.encoding = FUNCTION_SAMPLE_DELTA_INT8;
+		copyValues(vector<signed char>(deltas.begin(), deltas.end()));
+	}
+	else
+	{
+		outHeader.encoding = FUNCTION_SAMPLE_DELTA_INT16;
+		copyValues(vector<short>(deltas.begin(), deltas.end()));
+	}
+	//update the values the same way readers will
+	for (size_t i = 0; i < values.size(); ++i)
+		lastValues[i] += (double)deltas[i] * quantum;
+	++m_numDeltaSamples[functionId];
+	return m_buffer;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+using namespace std;
+
+struct FunctionSampleEncodingHeader;
+
+//Encodes the samples of the logged functions for version 2 files. The first sample of each function, and every
+//MAX_DELTA_SAMPLES-th sample after it, is saved in full so that readers don't have to decode long chains of deltas and
+//the errors don't accumulate
+class FunctionLogEncoder
+{
+public:
+	static const size_t MAX_DELTA_SAMPLES = 32;
+private:
+	bool m_bDelta;
+	bool m_bFloat32;
+	double m_precision;
+
+	//the values of the last sample of each function, as readers decode them. Deltas are calculated from these
+	vector<vector<double>> m_lastValues;
+	vector<size_t> m_numDeltaSamples;
+	vector<char> m_buffer;
+
+	template<typename T>
+	void copyValues(const vector<T>& values)
+	{
+		size_t numBytes = values.size() * sizeof(T);
+		m_buffer.assign((const char*)values.data(), (const char*)values.data() + numBytes);
+		m_buffer.resize(numBytes + (8 - numBytes % 8) % 8, 0);
+	}
+	void encodeFull(size_t functionId, const vector<double>& values, FunctionSampleEncodingHeader& outHeader);
+public:
+	FunctionLogEncoder(size_t numFunctions, bool bDelta, bool bFloat32, double precision);
+
+	//Encodes the sample and returns the encoded values, ready to be written after the headers
+	const vector<char>& encode(size_t functionId, const vector<double>& values, FunctionSampleEncodingHeader& outHeader);
+};
@@ -25,15 +25,22 @@
 
 #include "../Common/state-action-function.h"
 #include "function-sampler.h"
+#include "work-stealing-pool.h"
 #include "../Common/named-var-set.h"
 
 #include <math.h>
+#include <string.h>
+#include <algorithm>
 #include <stdexcept>
 
 FunctionSampler::~FunctionSampler()
 {
 	delete m_pState;
 	delete m_pAction;
+	for (State* pState : m_sampleStates)
+		delete pState;
+	for (Action* pAction : m_sampleActions)
+		delete pAction;
 }
 
 NamedVarSet* FunctionSampler::Source(VariableSource source)
@@ -44,7 +51,7 @@ NamedVarSet* FunctionSampler::Source(VariableSource source)
 }
 
 FunctionSampler::FunctionSampler(string functionId, StateActionFunction* pFunction, size_t outputIndex, size_t samplesPerDimension
-	, size_t numDimensions, Descriptor& stateDescriptor, Descriptor& actionDescriptor)
+	, size_t numDimensions, Descriptor& stateDescriptor, Descriptor& actionDescriptor, WorkStealingPool* pThreadPool)
 	: m_pFunction(pFunction), m_samplesPerDimension(samplesPerDimension)
 
 {
@@ -65,6 +72,110 @@ FunctionSampler::FunctionSampler(string functionId, StateActionFunction* pFuncti
 
 	for (int i = 0; i < (int) m_pAction->getNumVars(); ++i)
 		m_pAction->set(i, m_pAction->getDescriptor()[i].getMin() + m_pAction->getDescriptor()[i].getRangeWidth()*0.5);
+
+	//only worth it if the function can be evaluated from several threads and there are enough samples for more than one
+	if (pThreadPool && pThreadPool->getNumThreads() > 1 && pFunction->isBatchEvaluationThreadSafe()
+		&& m_numSamples >= 2 * MIN_SAMPLES_PER_BATCH)
+		m_pThreadPool = pThreadPool;
+}
+
+void FunctionSampler::addSampledVariable(VariableSource source, string name)
+{
+	SampledVariable variable;
+	variable.pSource = Source(source);
+	variable.name = name;
+	variable.index = 0;
+	variable.bResolved = false;
+	for (size_t i = 0; i < variable.pSource->getNumVars(); ++i)
+	{
+		if (!strcmp(variable.pSource->getProperties(i)->getName(), name.c_str()))
+		{
+			variable.index = i;
+			variable.bResolved = true;
+			break;
+		}
+	}
+	m_sampledVariables.push_back(variable);
+}
+
+void FunctionSampler::setSampledValues(size_t sample, NamedVarSet* pState, NamedVarSet* pAction)
+{
+	//the first sampled variable changes fastest
+	size_t coordinate = sample;
+	for (const SampledVariable& variable : m_sampledVariables)
+	{
+		NamedVarProperties* pProperties = variable.bResolved ? variable.pSource->getProperties(variable.index)
+			: variable.pSource->getProperties(variable.name.c_str());
+		double rangeStep = pProperties->getRangeWidth() / (double)(m_samplesPerDimension - 1);
+		double value = pProperties->getMin() + rangeStep * (double)(coordinate % m_samplesPerDimension);
+		coordinate /= m_samplesPerDimension;
+
+		NamedVarSet* pTarget = (variable.pSource == m_pState) ? pState : pAction;
+		if (variable.bResolved)
+			pTarget->set(variable.index, value);
+		else
+			pTarget->set(variable.name.c_str(), value);
+	}
+}
+
+void FunctionSampler::precomputeInputs()
+{
+	m_sampleStates.resize(m_numSamples);
+	m_sampleActions.resize(m_numSamples);
+	for (size_t i = 0; i < m_numSamples; ++i)
+	{
+		m_sampleStates[i] = m_pState->getDescriptor().getInstance();
+		m_sampleStates[i]->copy(m_pState);
+		m_sampleActions[i] = m_pAction->getDescriptor().getInstance();
+		m_sampleActions[i]->copy(m_pAction);
+		setSampledValues(i, m_sampleStates[i], m_sampleActions[i]);
+	}
+	m_bPrecomputedInputs = true;
+}
+
+void FunctionSampler::sampleSerially(unsigned int outputIndex)
+{
+	//wires are shared by all the samples, so their values have to be set right before each evaluation
+	for (size_t i = 0; i < m_numSamples; ++i)
+	{
+		setSampledValues(i, m_pState, m_pAction);
+		m_sampledValues[i] = m_pFunction->evaluate(m_pState, m_pAction)[outputIndex];
+	}
+}
+
+void FunctionSampler::sampleInBatches(unsigned int outputIndex)
+{
+	if (!m_bPrecomputedInputs)
+		precomputeInputs();
+
+	if (!m_pThreadPool)
+	{
+		m_pFunction->evaluateBatch(m_sampleStates.data(), m_sampleActions.data(), m_numSamples, outputIndex, m_sampledValues.data());
+		return;
+	}
+
+	size_t numBatches = std::min((size_t)m_pThreadPool->getNumThreads(), m_numSamples / MIN_SAMPLES_PER_BATCH);
+	size_t batchSize = (m_numSamples + numBatches - 1) / numBatches;
+	m_pThreadPool->run(numBatches, [this, outputIndex, batchSize](size_t batch)
+	{
+		size_t firstSample = batch * batchSize;
+		size_t numSamples = std::min(batchSize, m_numSamples - firstSample);
+		m_pFunction->evaluateBatch(m_sampleStates.data() + firstSample, m_sampleActions.data() + firstSample, numSamples
+			, outputIndex, m_sampledValues.data() + firstSample);
+	});
+}
+
+const vector<double>& FunctionSampler::sampleFunction(unsigned int outputIndex)
+{
+	bool bAllVariablesResolved = true;
+	for (const SampledVariable& variable : m_sampledVariables)
+		bAllVariablesResolved = bAllVariablesResolved && variable.bResolved;
+
+	if (bAllVariablesResolved)
+		sampleInBatches(outputIndex);
+	else
+		sampleSerially(outputIndex);
+	return m_sampledValues;
 }
 
 string FunctionSampler3D::getFunctionId() const
@@ -88,12 +199,12 @@ size_t FunctionSampler::getNumOutputs() const
 
 FunctionSampler3D::FunctionSampler3D(string functionId, StateActionFunction* pFunction, size_t outputIndex, size_t samplesPerDimension
 	, Descriptor& stateDescriptor, Descriptor& actionDescriptor
-	, VariableSource xVarSource, string xVarName, VariableSource yVarSource, string yVarName)
-	:FunctionSampler(functionId, pFunction, outputIndex, samplesPerDimension, 2, stateDescriptor, actionDescriptor)
+	, VariableSource xVarSource, string xVarName, VariableSource yVarSource, string yVarName, WorkStealingPool* pThreadPool)
+	:FunctionSampler(functionId, pFunction, outputIndex, samplesPerDimension, 2, stateDescriptor, actionDescriptor, pThreadPool)
 	, m_xVarName(xVarName), m_yVarName(yVarName)
 {
-	m_xVarSource = Source(xVarSource);
-	m_yVarSource = Source(yVarSource);
+	addSampledVariable(xVarSource, xVarName);
+	addSampledVariable(yVarSource, yVarName);
 }
 
 const vector<double>& FunctionSampler3D::sample(unsigned int outputIndex)
@@ -101,43 +212,16 @@ const vector<double>& FunctionSampler3D::sample(unsigned int outputIndex)
 	if (outputIndex >= m_numOutputs)
 		throw runtime_error("FunctionSampler3D::sample() was given an incorrect output index");
 
-	double xValue, yValue;
-	double xMinValue, xRangeStep, xRange;
-	NamedVarProperties* pXProperties = m_xVarSource->getProperties(m_xVarName.c_str());// m_sampledVariableSources[0]->getProperties(m_sampledVariableNames[0].c_str());
-	xMinValue = pXProperties->getMin();
-	xRange = pXProperties->getRangeWidth();
-	xRangeStep = xRange / (double)(m_samplesPerDimension - 1);
-	double yMinValue, yRangeStep, yRange;
-	NamedVarProperties* pYProperties = m_yVarSource->getProperties(m_yVarName.c_str());// m_sampledVariableSources[1]->getProperties(m_sampledVariableNames[1].c_str());
-	yMinValue = pYProperties->getMin();
-	yRange = pYProperties->getRangeWidth();
-	yRangeStep = yRange / (double)(m_samplesPerDimension - 1);
-	
-	unsigned int i = 0;
-	for (unsigned int y = 0; y < m_samplesPerDimension; ++y)
-	{
-		yValue = yMinValue + yRangeStep * (double)y;
-		m_yVarSource->set(m_yVarName.c_str(), yValue);// m_sampledVariableSources[1]->set(m_sampledVariableNames[1].c_str(), yValue);
-		for (unsigned int x = 0; x < m_samplesPerDimension; ++x)
-		{
-			xValue = xMinValue + xRangeStep * (double)x;
-			m_xVarSource->set(m_xVarName.c_str(), xValue);// m_sampledVariableSources[0]->set(m_sampledVariableNames[0].c_str(), xValue);
-			vector<double>& output= m_pFunction->evaluate(m_pState, m_pAction);
-
-			m_sampledValues[i] = output[outputIndex];
-			++i;
-		}
-	}
-	return m_sampledValues;
+	return sampleFunction(outputIndex);
 }
 
 FunctionSampler2D::FunctionSampler2D(string functionId, StateActionFunction* pFunction, size_t outputIndex, size_t samplesPerDimension
 	, Descriptor& stateDescriptor, Descriptor& actionDescriptor
-	, VariableSource xVarSource, string xVarName)
-	:FunctionSampler(functionId, pFunction, outputIndex, samplesPerDimension, 1, stateDescriptor, actionDescriptor)
+	, VariableSource xVarSource, string xVarName, WorkStealingPool* pThreadPool)
+	:FunctionSampler(functionId, pFunction, outputIndex, samplesPerDimension, 1, stateDescriptor, actionDescriptor, pThreadPool)
 	, m_xVarName(xVarName)
 {
-	m_xVarSource = Source(xVarSource);
+	addSampledVariable(xVarSource, xVarName);
 }
 
 const vector<double>& FunctionSampler2D::sample(unsigned int outputIndex)
@@ -145,25 +229,7 @@ const vector<double>& FunctionSampler2D::sample(unsigned int outputIndex)
 	if (outputIndex >= m_numOutputs)
 		throw runtime_error("FunctionSampler2D::sample() was given an incorrect output index");
 
-	double xValue, xMinValue, xRangeStep, xRange;
-	NamedVarProperties* pXProperties = m_xVarSource->getProperties(m_xVarName.c_str());
-	xMinValue = pXProperties->getMin();
-	xRange = pXProperties->getRangeWidth();
-	xRangeStep = xRange / (double)(m_samplesPerDimension - 1);
-
-
-	unsigned int i = 0;
-	for (unsigned int x = 0; x < m_samplesPerDimension; ++x)
-	{
-		xValue = xMinValue + xRangeStep * (double)x;
-		m_xVarSource->set(m_xVarName.c_str(), xValue);
-
-		vector<double>& output = m_pFunction->evaluate(m_pState, m_pAction);
-
-		m_sampledValues[i] = output[outputIndex];
-		++i;
-	}
-	return m_sampledValues;
+	return sampleFunction(outputIndex);
 }
 
 string FunctionSampler2D::getFunctionId() const
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 using namespace std;
 
 class StateActionFunction;
@@ -8,11 +9,34 @@ class NamedVarSet;
 using State = NamedVarSet;
 using Action = NamedVarSet;
 class Descriptor;
+class WorkStealingPool;
 
 enum VariableSource {StateSource, ActionSource};
 
 class FunctionSampler
 {
+	//A variable whose value is set in each sample
+	struct SampledVariable
+	{
+		NamedVarSet* pSource;
+		string name;
+		//index of the variable in its descriptor. Wires aren't in the descriptor and are set by name
+		size_t index;
+		bool bResolved;
+	};
+
+	//Inputs of every sample (x is the fastest changing variable). They are precomputed so that the samples can be
+	//evaluated in batches from several threads
+	vector<State*> m_sampleStates;
+	vector<Action*> m_sampleActions;
+	bool m_bPrecomputedInputs = false;
+	//shared by all the samplers of an app (not owned)
+	WorkStealingPool* m_pThreadPool = nullptr;
+
+	void precomputeInputs();
+	void setSampledValues(size_t sample, NamedVarSet* pState, NamedVarSet* pAction);
+	void sampleSerially(unsigned int outputIndex);
+	void sampleInBatches(unsigned int outputIndex);
 protected:
 	size_t m_outputIndex = 0;
 	size_t m_numInputs = 2;
@@ -25,11 +49,19 @@ protected:
 	size_t m_numSamples;
 	size_t m_numOutputs;
 	string m_functionId;
+	vector<SampledVariable> m_sampledVariables;
 
 	NamedVarSet* Source(VariableSource source);
+	void addSampledVariable(VariableSource source, string name);
+	//Evaluates the function in all the samples, using several threads if the function allows it
+	const vector<double>& sampleFunction(unsigned int outputIndex);
 public:
+	//Samples are evaluated in batches of at least this size by each thread
+	static const size_t MIN_SAMPLES_PER_BATCH = 64;
+
+	//pThreadPool: threads used to sample the function. If null, the function is sampled by the calling thread
 	FunctionSampler(string functionId, StateActionFunction* pFunction, size_t outputIndex, size_t samplesPerDimension, size_t numDimensions
-		, Descriptor& stateDescriptor, Descriptor& actionDescriptor);
+		, Descriptor& stateDescriptor, Descriptor& actionDescriptor, WorkStealingPool* pThreadPool= nullptr);
 	virtual ~FunctionSampler();
 
 	size_t getNumOutputs() const;
@@ -42,14 +74,12 @@ public:
 
 class FunctionSampler3D : public FunctionSampler
 {
-	NamedVarSet* m_xVarSource;
 	string m_xVarName;
-	NamedVarSet* m_yVarSource;
 	string m_yVarName;
 public:
 	FunctionSampler3D(string functionId, StateActionFunction* pFunction, size_t outputIndex, size_t samplesPerDimension
 		, Descriptor& stateDescriptor, Descriptor& actionDescriptor
-		, VariableSource xVarSource, string xVarName, VariableSource yVarSource, string yVarName);
+		, VariableSource xVarSource, string xVarName, VariableSource yVarSource, string yVarName, WorkStealingPool* pThreadPool= nullptr);
 	
 	const vector<double>& sample(unsigned int outputIndex = 0);
 
@@ -60,11 +90,11 @@ public:
 
 class FunctionSampler2D : public FunctionSampler
 {
-	NamedVarSet* m_xVarSource;
 	string m_xVarName;
 public:
 	FunctionSampler2D(string functionId, StateActionFunction* pFunction, size_t outputIndex, size_t samplesPerDimension
-		, Descriptor& stateDescriptor, Descriptor& actionDescriptor, VariableSource xVarSource, string xVarName);
+		, Descriptor& stateDescriptor, Descriptor& actionDescriptor, VariableSource xVarSource, string xVarName
+		, WorkStealingPool* pThreadPool= nullptr);
 
 	const vector<double>& sample(unsigned int outputIndex = 0);
 
@@ -0,0 +1,171 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "log-writer.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+//time the writer thread sleeps when there is nothing to write
+#define WRITER_IDLE_SLEEP_MS 1
+
+AsyncLogWriter::AsyncLogWriter(FILE* pFile, size_t bufferSize, LogBufferFullPolicy fullPolicy)
+{
+	m_pFile = pFile;
+	m_fullPolicy = fullPolicy;
+
+	//round the size of the buffer up to a power of 2 so that we can wrap positions with a mask
+	m_bufferSize = 1024;
+	while (m_bufferSize < bufferSize)
+		m_bufferSize <<= 1;
+	m_bufferMask = m_bufferSize - 1;
+	m_pBuffer = new char[m_bufferSize];
+
+	m_writePos = 0;
+	m_readPos = 0;
+	m_numFlushRequests = 0;
+	m_numFlushesDone = 0;
+	m_bStop = false;
+
+	m_writerThread = std::thread(&AsyncLogWriter::writerThreadLoop, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	//the writer thread writes everything left in the buffer before exiting
+	m_bStop.store(true, std::memory_order_release);
+	if (m_writerThread.joinable())
+		m_writerThread.join();
+
+	if (m_pFile)
+		fflush(m_pFile);
+
+	delete[] m_pBuffer;
+}
+
+void AsyncLogWriter::waitForFreeSpace(size_t numBytes)
+{
+	++m_numWaits;
+	while (m_bufferSize - (m_writePos.load(std::memory_order_relaxed) - m_readPos.load(std::memory_order_acquire)) < numBytes)
+		std::this_thread::yield();
+}
+
+bool AsyncLogWriter::write(const void* pData, size_t numBytes, bool bCanBeDropped)
+{
+	if (!m_pFile || numBytes == 0)
+		return true;
+
+	size_t writePos = m_writePos.load(std::memory_order_relaxed);
+	size_t freeSpace = m_bufferSize - (writePos - m_readPos.load(std::memory_order_acquire));
+
+	if (freeSpace < numBytes)
+	{
+		//records are dropped as a whole so that the file can still be parsed
+		if (bCanBeDropped && m_fullPolicy == LogBufferFullPolicy::drop)
+		{
+			++m_numDroppedRecords;
+			return false;
+		}
+		//records bigger than the whole buffer are copied in chunks as the writer thread frees space
+		if (numBytes > m_bufferSize)
+		{
+			const char* pChunk = (const char*)pData;
+			while (numBytes > 0)
+			{
+				size_t chunkSize = std::min(numBytes, m_bufferSize / 2);
+				write(pChunk, chunkSize, false);
+				pChunk += chunkSize;
+				numBytes -= chunkSize;
+			}
+			return true;
+		}
+		waitForFreeSpace(numBytes);
+	}
+
+	//copy the record in (at most) two pieces if it wraps around the end of the buffer
+	size_t offset = writePos & m_bufferMask;
+	size_t firstPieceSize = std::min(numBytes, m_bufferSize - offset);
+	memcpy(m_pBuffer + offset, pData, firstPieceSize);
+	if (firstPieceSize < numBytes)
+		memcpy(m_pBuffer, (const char*)pData + firstPieceSize, numBytes - firstPieceSize);
+
+	//publish the record
+	m_writePos.store(writePos + numBytes, std::memory_order_release);
+	return true;
+}
+
+void AsyncLogWriter::flush(bool bWait)
+{
+	unsigned int flushRequest = m_numFlushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+	if (!bWait) return;
+
+	while (m_numFlushesDone.load(std::memory_order_acquire) < flushRequest)
+		std::this_thread::yield();
+}
+
+size_t AsyncLogWriter::writePendingData()
+{
+	size_t readPos = m_readPos.load(std::memory_order_relaxed);
+	size_t numBytes = m_writePos.load(std::memory_order_acquire) - readPos;
+	if (numBytes == 0)
+		return 0;
+
+	size_t offset = readPos & m_bufferMask;
+	size_t firstPieceSize = std::min(numBytes, m_bufferSize - offset);
+	fwrite(m_pBuffer + offset, 1, firstPieceSize, m_pFile);
+	if (firstPieceSize < numBytes)
+		fwrite(m_pBuffer, 1, numBytes - firstPieceSize, m_pFile);
+
+	//free the space once the data has been written
+	m_readPos.store(readPos + numBytes, std::memory_order_release);
+	return numBytes;
+}
+
+void AsyncLogWriter::writerThreadLoop()
+{
+	while (true)
+	{
+		//read the flags before draining the buffer so that everything requested before is written
+		bool bStop = m_bStop.load(std::memory_order_acquire);
+		unsigned int numFlushRequests = m_numFlushRequests.load(std::memory_order_acquire);
+
+		size_t numBytesWritten = writePendingData();
+
+		if (numFlushRequests != m_numFlushesDone.load(std::memory_order_relaxed))
+		{
+			fflush(m_pFile);
+			m_numFlushesDone.store(numFlushRequests, std::memory_order_release);
+		}
+
+		if (bStop)
+		{
+			//write whatever might have been added after reading the flag
+			writePendingData();
+			return;
+		}
+		if (numBytesWritten == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_IDLE_SLEEP_MS));
+	}
+}
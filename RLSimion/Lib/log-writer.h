@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <stdio.h>
+#include "parameters.h"
+
+//Asynchronous binary file writer used by the Logger
+//The learning thread (the only producer) copies each record into a lock-free ring buffer and a background thread
+//(the only consumer) writes the buffered bytes to the file, so that no file I/O is done inside the step loop.
+//Memory is bounded by the size of the ring buffer. When the buffer is full, records are either dropped or the
+//producer waits for the writer thread, depending on the policy (records that can't be dropped always wait)
+class AsyncLogWriter
+{
+	FILE* m_pFile;
+	LogBufferFullPolicy m_fullPolicy;
+
+	char* m_pBuffer = nullptr;
+	size_t m_bufferSize; //always a power of 2
+	size_t m_bufferMask;
+
+	//m_writePos is only modified by the producer and m_readPos only by the writer thread. Both increase
+	//monotonically (the position in the buffer is pos & m_bufferMask). They are kept in different cache lines by
+	//padding them with a whole cache line: alignas would not be honored by new, because the writer is allocated in
+	//the heap
+	static const size_t CACHE_LINE_SIZE = 64;
+	char m_padding0[CACHE_LINE_SIZE];
+	std::atomic<size_t> m_writePos;
+	char m_padding1[CACHE_LINE_SIZE];
+	std::atomic<size_t> m_readPos;
+	char m_padding2[CACHE_LINE_SIZE];
+
+	std::atomic<unsigned int> m_numFlushRequests;
+	std::atomic<unsigned int> m_numFlushesDone;
+	std::atomic<bool> m_bStop;
+
+	size_t m_numDroppedRecords = 0;
+	size_t m_numWaits = 0;
+
+	std::thread m_writerThread;
+
+	void writerThreadLoop();
+	size_t writePendingData();
+	void waitForFreeSpace(size_t numBytes);
+public:
+	static const size_t DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+	//The writer doesn't take ownership of the file: it has to be closed by the owner after the writer is destroyed
+	AsyncLogWriter(FILE* pFile, size_t bufferSize = DEFAULT_BUFFER_SIZE
+		, LogBufferFullPolicy fullPolicy = LogBufferFullPolicy::block);
+	//Writes all the pending data and stops the writer thread
+	virtual ~AsyncLogWriter();
+
+	//Copies the record to the ring buffer. Returns false if the record was dropped because the buffer was full
+	bool write(const void* pData, size_t numBytes, bool bCanBeDropped = false);
+
+	//Asks the writer thread to write all the data buffered so far and flush the file. If bWait is true, the call
+	//returns once the data has been written
+	void flush(bool bWait = false);
+
+	size_t getNumDroppedRecords() const { return m_numDroppedRecords; }
+	size_t getNumWaits() const { return m_numWaits; }
+	size_t getBufferSize() const { return m_bufferSize; }
+};
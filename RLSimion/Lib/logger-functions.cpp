@@ -27,45 +27,15 @@
 #include "app.h"
 #include "experiment.h"
 #include "function-sampler.h"
+#include "log-writer.h"
+#include "function-log-encoder.h"
+#include "../Common/function-log-format.h"
 #include "../../tools/System/CrossPlatform.h"
 #include <unordered_map>
+#include <algorithm>
+#include <math.h>
 using namespace std;
 
-#define FUNCTION_SAMPLE_HEADER 6543
-#define FUNCTION_DECLARATION_HEADER 5432
-#define FUNCTION_LOG_FILE_HEADER 4321
-#define FUNCTION_LOG_FILE_VERSION 1
-
-#define MAX_FUNCTION_ID_LENGTH 128
-
-//using long long int to assure C# data-type compatibility
-
-struct FunctionLogHeader
-{
-	long long int magicNumber = FUNCTION_LOG_FILE_HEADER;
-	long long int fileVersion = FUNCTION_LOG_FILE_VERSION;
-	long long int numFunctions = 0;
-};
-
-struct FunctionDeclarationHeader
-{
-	long long int magicNumber = FUNCTION_DECLARATION_HEADER;
-	long long int id;
-	char name[MAX_FUNCTION_ID_LENGTH];
-	long long int numSamplesX;
-	long long int numSamplesY;
-	long long int numSamplesZ;
-};
-
-struct FunctionSampleHeader
-{
-	long long int magicNumber = FUNCTION_SAMPLE_HEADER;
-	long long int episode;
-	long long int step;
-	long long int experimentStep;
-	long long int id;
-};
-
 void Logger::openFunctionLogFile(const char* filename)
 {
 	CrossPlatform::Fopen_s(&m_functionLogFile, m_outputFunctionLogBinary.c_str(), "wb");
@@ -73,8 +43,16 @@ void Logger::openFunctionLogFile(const char* filename)
 	{
 		//write function log header
 		FunctionLogHeader functionLogHeader;
+		m_pFunctionLogWriter = createLogWriter(m_functionLogFile);
+
 		functionLogHeader.numFunctions = SimionApp::get()->getFunctionSamplers().size();
-		fwrite(&functionLogHeader, sizeof(FunctionLogHeader), 1, m_functionLogFile);
+		if (m_functionLogEncoding.get() == FunctionLogEncoding::delta || m_bFunctionLogFloat32.get())
+		{
+			functionLogHeader.fileVersion = FUNCTION_LOG_FILE_VERSION_ENCODED;
+			m_pFunctionLogEncoder = new FunctionLogEncoder((size_t)functionLogHeader.numFunctions
+				, m_functionLogEncoding.get() == FunctionLogEncoding::delta, m_bFunctionLogFloat32.get(), m_functionLogDeltaPrecision.get());
+		}
+		writeFunctionLogBuffer(&functionLogHeader, sizeof(FunctionLogHeader));
 
 		//write function declarations
 		unsigned int functionId = 0;
@@ -87,7 +65,7 @@ void Logger::openFunctionLogFile(const char* filename)
 			functionDeclarationHeader.numSamplesY = (unsigned int)sampler->getNumSamplesY();
 			functionDeclarationHeader.numSamplesZ = 1; //for now, not using it
 
-			fwrite(&functionDeclarationHeader, sizeof(FunctionDeclarationHeader), 1, m_functionLogFile);
+			writeFunctionLogBuffer(&functionDeclarationHeader, sizeof(FunctionDeclarationHeader));
 			functionId++;
 		}
 	}
@@ -96,8 +74,21 @@ void Logger::openFunctionLogFile(const char* filename)
 
 void Logger::closeFunctionLogFile()
 {
+	destroyLogWriter(m_pFunctionLogWriter, "function log file");
 	if (m_functionLogFile)
 		fclose(m_functionLogFile);
+	m_functionLogFile = nullptr;
+	delete m_pFunctionLogEncoder;
+	m_pFunctionLogEncoder = nullptr;
+}
+
+void Logger::writeFunctionLogBuffer(const void* pBuffer, size_t numBytes)
+{
+	//function samples are never dropped
+	if (m_pFunctionLogWriter)
+		m_pFunctionLogWriter->write(pBuffer, numBytes);
+	else if (m_functionLogFile)
+		fwrite(pBuffer, 1, numBytes, m_functionLogFile);
 }
 
 
@@ -117,12 +108,21 @@ void Logger::writeFunctionLogSample()
 		header.experimentStep = pExperiment->getExperimentStep();
 		header.id = functionId;
 
-		fwrite(&header, sizeof(FunctionSampleHeader), 1, m_functionLogFile);
+		writeFunctionLogBuffer(&header, sizeof(FunctionSampleHeader));
 
-		//Write the values sampled
+		//Sample the function (this has to be done in the learning thread) and copy the values to the log buffer
 		const vector<double>& valuesSampled = sampler->sample();
 
-		fwrite(&valuesSampled[0], sizeof(double), valuesSampled.size(), m_functionLogFile);
+		if (m_pFunctionLogEncoder)
+		{
+			FunctionSampleEncodingHeader encodingHeader;
+			const vector<char>& encodedValues = m_pFunctionLogEncoder->encode(functionId, valuesSampled, encodingHeader);
+			writeFunctionLogBuffer(&encodingHeader, sizeof(FunctionSampleEncodingHeader));
+			if (!encodedValues.empty())
+				writeFunctionLogBuffer(encodedValues.data(), encodedValues.size());
+		}
+		else
+			writeFunctionLogBuffer(&valuesSampled[0], sizeof(double) * valuesSampled.size());
 
 		functionId++;
 	}
@@ -34,12 +34,15 @@
 #include "app.h"
 #include "utils.h"
 #include "experiment.h"
+#include "log-writer.h"
 #include <algorithm>
 
-FILE *Logger::m_logFile = 0;
 MessageOutputMode Logger::m_messageOutputMode = MessageOutputMode::Console;
 NamedPipeClient Logger::m_outputPipe;
 bool Logger::m_bLogMessagesEnabled = true;
+thread_local string Logger::m_experimentId;
+thread_local bool Logger::m_bOnlyErrorMessages = false;
+mutex Logger::m_outputMutex;
 
 #define HEADER_MAX_SIZE 16
 #define EXPERIMENT_HEADER 1
@@ -108,6 +111,27 @@ Logger::Logger(ConfigNode* pConfigNode)
 
 	m_bLogFunctions = BOOL_PARAM(pConfigNode, "Log-Functions", "Log functions learned?", true);
 	m_numFunctionLogPoints = INT_PARAM(pConfigNode, "Num-Functions-Logged", "How many times per experiment save logged functions", 10);
+	m_functionLogEncoding = ENUM_PARAM<FunctionLogEncoding>(pConfigNode, "Function-Log-Encoding"
+		, "How logged functions are saved: every sample in full or the changes from the previous sample (delta)", FunctionLogEncoding::full);
+	m_bFunctionLogFloat32 = BOOL_PARAM(pConfigNode, "Function-Log-Float32", "Save the logged functions' values as 32-bit floats?", false);
+	m_functionLogDeltaPrecision = DOUBLE_PARAM(pConfigNode, "Function-Log-Delta-Precision"
+		, "Precision of the changes saved with delta encoding, relative to the function's value range", 0.0001);
+	m_numFunctionSamplingThreads = INT_PARAM(pConfigNode, "Function-Sampling-Threads", "Threads used to sample the logged functions (0: all the hardware threads)", 1);
+
+	m_bAsyncLogWriter = BOOL_PARAM(pConfigNode, "Async-Log-Writer", "Write the log files from a background thread?", true);
+	m_logBufferSize = INT_PARAM(pConfigNode, "Log-Buffer-Size", "Size (in MB) of the buffer used to write each log file asynchronously", 4);
+	m_logBufferFullPolicy = ENUM_PARAM<LogBufferFullPolicy>(pConfigNode, "Log-Buffer-Full-Policy"
+		, "What to do with new steps if the log buffer is full: wait until there is space (block) or not log them (drop)", LogBufferFullPolicy::block);
+
+	m_bRecordEvaluationEpisodes = BOOL_PARAM(pConfigNode, "Record-Eval-Episodes", "Render evaluation episodes offscreen and save them as videos?", false);
+	m_recordFreq = INT_PARAM(pConfigNode, "Record-Freq", "The first episode of every n-th evaluation is recorded", 1);
+	m_recordFPS = DOUBLE_PARAM(pConfigNode, "Record-FPS", "Frames per second of simulation time recorded", 25.0);
+	m_recordFormat = ENUM_PARAM<VideoFormat>(pConfigNode, "Record-Format"
+		, "How recorded episodes are saved: a raw YUV4MPEG2 video (y4m) or a sequence of images (ppm)", VideoFormat::y4m);
+	m_recordWidth = INT_PARAM(pConfigNode, "Record-Width", "Width (in pixels) of the recorded videos", 640);
+	m_recordHeight = INT_PARAM(pConfigNode, "Record-Height", "Height (in pixels) of the recorded videos", 480);
+
+	m_bProfileSteps = BOOL_PARAM(pConfigNode, "Profile-Steps", "Log the time (in microseconds) spent in each phase of the time-steps?", false);
 
 	m_pEpisodeTimer = new Timer();
 	m_pExperimentTimer = new Timer();
@@ -117,6 +141,8 @@ Logger::Logger(ConfigNode* pConfigNode)
 #define LOG_DESCRIPTOR_EXTENSION ".log"
 #define LOG_BINARY_EXTENSION ".log.bin"
 #define FUNCTION_LOG_BINARY_EXTENSION ".log.functions"
+#define RECORDING_INFIX ".eval-"
+#define RECORDING_VIDEO_EXTENSION ".y4m"
 
 void Logger::setOutputFilenames()
 {
@@ -136,6 +162,36 @@ void Logger::setOutputFilenames()
 		m_outputFunctionLogBinary = inputConfigFile + FUNCTION_LOG_BINARY_EXTENSION;
 		SimionApp::get()->registerOutputFile(m_outputFunctionLogBinary.c_str());
 	}
+
+	if (m_bRecordEvaluationEpisodes.get())
+	{
+		m_outputRecordingPrefix = inputConfigFile + RECORDING_INFIX;
+		//the number of frames of an image sequence isn't known in advance, so only videos can be registered
+		if (m_recordFormat.get() == VideoFormat::y4m)
+		{
+			for (unsigned int evaluation = 1; evaluation <= SimionApp::get()->pExperiment->getNumEvaluations(); ++evaluation)
+			{
+				if (isEvaluationRecorded(evaluation))
+					SimionApp::get()->registerOutputFile(getRecordingFilename(evaluation).c_str());
+			}
+		}
+	}
+}
+
+bool Logger::isEvaluationRecorded(unsigned int evaluationIndex) const
+{
+	if (!m_bRecordEvaluationEpisodes.get() || evaluationIndex == 0)
+		return false;
+	unsigned int recordFreq = (unsigned int)std::max(1, m_recordFreq.get());
+	return (evaluationIndex - 1) % recordFreq == 0;
+}
+
+string Logger::getRecordingFilename(unsigned int evaluationIndex) const
+{
+	string filename = m_outputRecordingPrefix + to_string(evaluationIndex);
+	if (m_recordFormat.get() == VideoFormat::y4m)
+		filename += RECORDING_VIDEO_EXTENSION;
+	return filename;
 }
 
 
@@ -144,19 +200,83 @@ Logger::~Logger()
 	if (m_pExperimentTimer) delete m_pExperimentTimer;
 	if (m_pEpisodeTimer) delete m_pEpisodeTimer;
 
-	//Send message to let the server know we have finished
-	//Not really needed under Windows, but it seems to be needed in Linux
-	const char closingMessage [] = "<End></End>";
-	m_outputPipe.writeBuffer(closingMessage, (int)strlen(closingMessage) + 1);
-	m_outputPipe.closeConnection();
+	//close the log files before closing the pipe: pending data is written and any warning can still be sent
+	closeLogFile();
+	closeFunctionLogFile();
+
+	//In batch mode, the pipe is shared by all the experiments and the batch runner reports the end of each of them.
+	//Threads that only report errors (asynchronous workers, parallel evaluators) don't own it either
+	if (m_experimentId.empty() && !m_bOnlyErrorMessages)
+		closeOutputPipe();
 
 	for (auto it = m_stats.begin(); it != m_stats.end(); it++)
 		delete *it;
+}
 
-	closeLogFile();
-	closeFunctionLogFile();
+
+void Logger::disableFileLogging()
+{
+	m_bLogEvaluationEpisodes.set(false);
+	m_bLogTrainingEpisodes.set(false);
+	m_bLogFunctions.set(false);
+	m_bRecordEvaluationEpisodes.set(false);
 }
 
+void Logger::captureEvaluationEpisodes(vector<char>* pRecords)
+{
+	m_pCapturedRecords = pRecords;
+	m_bLogTrainingEpisodes.set(false);
+	m_bLogFunctions.set(false);
+	//the header is written by the app that runs the training episodes
+	m_bExperimentHeaderWritten = true;
+}
+
+void Logger::reserveEvaluation(unsigned int evaluationIndex)
+{
+	//the evaluation may begin before the first training episode
+	firstEpisode();
+
+	PendingRecords evaluationRecords;
+	evaluationRecords.evaluationIndex = evaluationIndex;
+	evaluationRecords.bComplete = false;
+	evaluationRecords.evaluationAvgReward = 0.0;
+	m_pendingRecords.push_back(evaluationRecords);
+}
+
+void Logger::mergeEvaluation(unsigned int evaluationIndex, vector<char>& records, const string& evaluationMessage
+	, double evaluationAvgReward)
+{
+	for (PendingRecords& pendingRecords : m_pendingRecords)
+	{
+		if (pendingRecords.evaluationIndex == evaluationIndex)
+		{
+			pendingRecords.records.swap(records);
+			pendingRecords.evaluationMessage = evaluationMessage;
+			pendingRecords.evaluationAvgReward = evaluationAvgReward;
+			pendingRecords.bComplete = true;
+		}
+	}
+	writePendingRecords();
+}
+
+void Logger::writePendingRecords()
+{
+	//records are written up to the first evaluation that hasn't been merged yet
+	while (!m_pendingRecords.empty() && m_pendingRecords.front().bComplete)
+	{
+		PendingRecords& pendingRecords = m_pendingRecords.front();
+		if (!pendingRecords.records.empty())
+			writeToLogFile(pendingRecords.records.data(), (int)pendingRecords.records.size());
+		if (!pendingRecords.evaluationMessage.empty())
+		{
+			m_lastEvaluationAvgReward = pendingRecords.evaluationAvgReward;
+			logMessage(MessageType::Evaluation, pendingRecords.evaluationMessage.c_str());
+		}
+		m_pendingRecords.pop_front();
+	}
+	if (m_pLogWriter)
+		m_pLogWriter->flush();
+}
 
 bool Logger::isEpisodeTypeLogged(bool evalEpisode)
 {
@@ -236,6 +356,10 @@ void Logger::firstEpisode()
 	//set episode start time
 	m_pEpisodeTimer->start();
 
+	if (m_bExperimentHeaderWritten)
+		return;
+	m_bExperimentHeaderWritten = true;
+
 	//generate the xml descriptor of the log file
 	writeLogFileXMLDescriptor(m_outputLogDescriptor.c_str());
 	//write the log file header
@@ -248,6 +372,11 @@ void Logger::firstEpisode()
 
 void Logger::lastEpisode()
 {
+	//make sure everything has been written to disk before the experiment ends
+	if (m_pLogWriter)
+		m_pLogWriter->flush(true);
+	if (m_pFunctionLogWriter)
+		m_pFunctionLogWriter->flush(true);
 }
 
 void Logger::firstStep()
@@ -290,11 +419,19 @@ void Logger::lastStep()
 {
 	Experiment* pExperiment = SimionApp::get()->pExperiment.ptr();
 	bool bEvalEpisode = pExperiment->isEvaluationEpisode();
+
+	if (m_pFunctionLogWriter)
+		m_pFunctionLogWriter->flush();
+
 	if (!isEpisodeTypeLogged(bEvalEpisode)) return;
 
 	//log the end of the episode: this way we don't have to precalculate the number of steps logged per episode
 	writeEpisodeEndHeader();
 
+	//the log file is flushed at the end of every episode without waiting for the writer thread
+	if (m_pLogWriter)
+		m_pLogWriter->flush();
+
 	//in case this is the last step of an evaluation episode, we log it and send the info to the host if there is one
 	char buffer[BUFFER_SIZE];
 	int numEvaluations = pExperiment->getNumEvaluations();
@@ -305,10 +442,14 @@ void Logger::lastStep()
 	if (pExperiment->isEvaluationEpisode()
 		&& pExperiment->getEpisodeInEvaluationIndex() == pExperiment->getNumEpisodesPerEvaluation())
 	{
+		m_lastEvaluationAvgReward = m_episodeRewardSum / (double)pExperiment->getStep();
 		CrossPlatform::Sprintf_s(buffer, BUFFER_SIZE, "%f,%f"
 			, (double)(numRelativeEpisodeIndex - 1)	/ (std::max(1.0, (double)numEvaluations*numEpisodesPerEvaluation - 1))
-			, m_episodeRewardSum / (double)pExperiment->getStep());
-		logMessage(MessageType::Evaluation, buffer);
+			, m_lastEvaluationAvgReward);
+		if (m_pCapturedRecords)
+			m_capturedEvaluationMessage = buffer;
+		else
+			logMessage(MessageType::Evaluation, buffer);
 	}
 }
 
@@ -351,7 +492,8 @@ void Logger::writeStepData(State* s, Action* a, State* s_p, Reward* r)
 	offset += writeNamedVarSetToBuffer(buffer, offset, r);
 	offset += writeStatsToBuffer(buffer, offset);
 
-	writeLogBuffer(buffer, offset);
+	//steps are the only records that can be dropped if the log buffer is full
+	writeLogBuffer(buffer, offset, true);
 }
 
 void Logger::writeExperimentHeader()
@@ -443,6 +585,17 @@ void Logger::addVarSetToStats(const char* key, NamedVarSet* varset)
 	}
 }
 
+double* Logger::addProfiledSection(const string& name)
+{
+	if (!m_bProfileSteps.get())
+		return nullptr;
+
+	//a deque doesn't move its elements when new ones are added
+	m_profiledSectionTimes.push_back(0.0);
+	addVarToStats<double>("Profiler", name, m_profiledSectionTimes.back());
+	return &m_profiledSectionTimes.back();
+}
+
 size_t Logger::getNumStats()
 {
 	return m_stats.size();
@@ -456,21 +609,75 @@ IStats* Logger::getStats(unsigned int i)
 }
 
 
+AsyncLogWriter* Logger::createLogWriter(FILE* pFile)
+{
+	if (!pFile || !m_bAsyncLogWriter.get())
+		return nullptr;
+	size_t bufferSize = (size_t) std::max(1, m_logBufferSize.get()) * 1024 * 1024;
+	return new AsyncLogWriter(pFile, bufferSize, m_logBufferFullPolicy.get());
+}
+
+void Logger::destroyLogWriter(AsyncLogWriter*& pLogWriter, const char* logName)
+{
+	if (!pLogWriter) return;
+
+	size_t numDroppedRecords = pLogWriter->getNumDroppedRecords();
+
+	//the destructor waits until all the buffered data has been written
+	delete pLogWriter;
+	pLogWriter = nullptr;
+
+	if (numDroppedRecords > 0)
+	{
+		char msg[BUFFER_SIZE];
+		CrossPlatform::Sprintf_s(msg, BUFFER_SIZE, "%zu records were not saved in the %s because the log buffer was full"
+			, numDroppedRecords, logName);
+		logMessage(MessageType::Warning, msg);
+	}
+}
+
 void Logger::openLogFile(const char* logFilename)
 {
 	CrossPlatform::Fopen_s(&m_logFile, logFilename, "wb");
 	if (!m_logFile)
 		logMessage(MessageType::Warning, "Log file couldn't be opened, so no log info will be saved.");
+	else
+		m_pLogWriter = createLogWriter(m_logFile);
 }
 void Logger::closeLogFile()
 {
+	destroyLogWriter(m_pLogWriter, "log file");
 	if (m_logFile)
 		fclose(m_logFile);
+	m_logFile = nullptr;
 }
 
-void Logger::writeLogBuffer(const char* pBuffer, int numBytes)
+void Logger::writeLogBuffer(const char* pBuffer, int numBytes, bool bCanBeDropped)
 {
-	if (m_logFile)
+	if (m_pCapturedRecords)
+		m_pCapturedRecords->insert(m_pCapturedRecords->end(), pBuffer, pBuffer + numBytes);
+	else if (!m_pendingRecords.empty())
+	{
+		//held until the evaluations that precede these records are merged
+		if (m_pendingRecords.back().evaluationIndex != 0)
+		{
+			PendingRecords trainingRecords;
+			trainingRecords.evaluationIndex = 0;
+			trainingRecords.bComplete = true;
+			trainingRecords.evaluationAvgReward = 0.0;
+			m_pendingRecords.push_back(trainingRecords);
+		}
+		m_pendingRecords.back().records.insert(m_pendingRecords.back().records.end(), pBuffer, pBuffer + numBytes);
+	}
+	else
+		writeToLogFile(pBuffer, numBytes, bCanBeDropped);
+}
+
+void Logger::writeToLogFile(const char* pBuffer, int numBytes, bool bCanBeDropped)
+{
+	if (m_pLogWriter)
+		m_pLogWriter->write(pBuffer, numBytes, bCanBeDropped);
+	else if (m_logFile)
 		fwrite(pBuffer, 1, numBytes, m_logFile);
 }
 
@@ -479,10 +686,54 @@ void Logger::enableLogMessages(bool enable)
 	m_bLogMessagesEnabled = enable;
 }
 
+void Logger::closeOutputPipe()
+{
+	//Send message to let the server know we have finished
+	//Not really needed under Windows, but it seems to be needed in Linux
+	const char closingMessage [] = "<End></End>";
+	m_outputPipe.writeBuffer(closingMessage, (int)strlen(closingMessage) + 1);
+	m_outputPipe.closeConnection();
+}
+
+void Logger::setExperimentId(const string& experimentId)
+{
+	m_experimentId = experimentId.substr(0, MAX_EXPERIMENT_ID_LENGTH);
+}
+
+//Sends a message through the pipe. Messages of an experiment run in batch mode are wrapped in an element named after
+//the experiment, the same way Herd agents wrap the messages of each of the experimental units they run
+void Logger::writeToPipe(const char* message)
+{
+	char wrappedMessage[1024 + 2 * MAX_EXPERIMENT_ID_LENGTH];
+
+	if (!m_experimentId.empty())
+	{
+		CrossPlatform::Sprintf_s(wrappedMessage, sizeof(wrappedMessage), "<%s>%s</%s>", m_experimentId.c_str(), message
+			, m_experimentId.c_str());
+		message = wrappedMessage;
+	}
+	lock_guard<mutex> lock(m_outputMutex);
+	m_outputPipe.writeBuffer(message, (int)strlen(message) + 1);
+}
+
+void Logger::logExperimentEnd(bool bSuccess)
+{
+	if (m_messageOutputMode == MessageOutputMode::NamedPipe && m_outputPipe.isConnected())
+		writeToPipe(bSuccess ? "<End>Ok</End>" : "<End>Error</End>");
+	else if (m_bLogMessagesEnabled)
+	{
+		lock_guard<mutex> lock(m_outputMutex);
+		printf("[%s] %s\n", m_experimentId.c_str(), bSuccess ? "Finished" : "FAILED");
+	}
+}
+
 void Logger::logMessage(MessageType type, const char* message)
 {
 	char messageLine[1024];
 
+	if (m_bOnlyErrorMessages && type != MessageType::Error)
+		return;
+
 	if (m_messageOutputMode == MessageOutputMode::NamedPipe && m_outputPipe.isConnected())
 	{
 		switch (type)
@@ -498,10 +749,13 @@ void Logger::logMessage(MessageType type, const char* message)
 		case Error:
 			CrossPlatform::Sprintf_s(messageLine, 1024, "<Error>ERROR: %s</Error>", message); break;
 		}
-		m_outputPipe.writeBuffer(messageLine, (int)strlen(messageLine) + 1);
+		writeToPipe(messageLine);
 	}
 	else if (m_bLogMessagesEnabled)
 	{
+		lock_guard<mutex> lock(m_outputMutex);
+		if (!m_experimentId.empty())
+			printf("[%s] ", m_experimentId.c_str());
 		switch (type)
 		{
 		case Warning:
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <algorithm>
 #include "parameters.h"
 #include "../../tools/System/NamedPipe.h"
 #include "stats.h"
@@ -13,6 +16,8 @@ class ConfigNode;
 class Descriptor;
 class Timer;
 class FunctionSampler;
+class AsyncLogWriter;
+class FunctionLogEncoder;
 
 enum MessageType {Progress,Evaluation,Info,Warning, Error};
 enum MessageOutputMode {Console,NamedPipe};
@@ -25,35 +30,71 @@ class Logger
 	//Functions log file: drawable downsampled 2d or 1d versions of the functions learned by the agents
 	string m_outputFunctionLogBinary;
 	FILE *m_functionLogFile = nullptr;
+	AsyncLogWriter* m_pFunctionLogWriter = nullptr;
 
 	BOOL_PARAM m_bLogFunctions;
 	INT_PARAM m_numFunctionLogPoints;
+	INT_PARAM m_numFunctionSamplingThreads;
+	//Function log format: with delta encoding or float32 values, the file version is 2 (see logger-functions.cpp)
+	ENUM_PARAM<FunctionLogEncoding> m_functionLogEncoding;
+	BOOL_PARAM m_bFunctionLogFloat32;
+	DOUBLE_PARAM m_functionLogDeltaPrecision;
+	FunctionLogEncoder* m_pFunctionLogEncoder = nullptr;
 
 	void openFunctionLogFile(const char* filename);
 	void closeFunctionLogFile();
 
 	void writeFunctionLogSample();
+	void writeFunctionLogBuffer(const void* pBuffer, size_t numBytes);
 
 	//Log file
 	string m_outputLogDescriptor;
 	string m_outputLogBinary;
-	static FILE *m_logFile;
+	FILE *m_logFile = nullptr;
+	AsyncLogWriter* m_pLogWriter = nullptr;
 
 	BOOL_PARAM m_bLogEvaluationEpisodes;
 	BOOL_PARAM m_bLogTrainingEpisodes;
 	DOUBLE_PARAM m_logFreq; //in seconds: time between file logs
 
+	//Asynchronous writing: log records are buffered and written to disk by a background thread
+	BOOL_PARAM m_bAsyncLogWriter;
+	INT_PARAM m_logBufferSize; //in MB
+	ENUM_PARAM<LogBufferFullPolicy> m_logBufferFullPolicy;
+	AsyncLogWriter* createLogWriter(FILE* pFile);
+	void destroyLogWriter(AsyncLogWriter*& pLogWriter, const char* logName);
+
 	Timer *m_pEpisodeTimer = nullptr;
 	Timer *m_pExperimentTimer = nullptr;
 
 	double m_episodeRewardSum;
+	double m_lastEvaluationAvgReward = 0.0;
 	double m_lastLogSimulationT;
+	bool m_bExperimentHeaderWritten = false;
+
+	//Parallel evaluations (see ParallelEvaluator). The apps that run them capture the records of the evaluation
+	//episodes and the evaluation message in memory instead of writing them. The app that runs the training episodes
+	//reserves the place of each evaluation in its log when the evaluation begins, and holds the records that follow it
+	//until the captured ones are merged
+	vector<char>* m_pCapturedRecords = nullptr;
+	string m_capturedEvaluationMessage;
+	struct PendingRecords
+	{
+		unsigned int evaluationIndex; //0 if these are the records of training episodes
+		bool bComplete;
+		vector<char> records;
+		string evaluationMessage;
+		double evaluationAvgReward;
+	};
+	std::deque<PendingRecords> m_pendingRecords;
+	void writePendingRecords();
 
 	void openLogFile(const char* fullLogFilename);
 	void closeLogFile();
 
 private:
-	static void writeLogBuffer(const char* pBuffer, int numBytes);
+	void writeLogBuffer(const char* pBuffer, int numBytes, bool bCanBeDropped = false);
+	void writeToLogFile(const char* pBuffer, int numBytes, bool bCanBeDropped = false);
 	void writeLogFileXMLDescriptor(const char* filename);
 
 	void writeNamedVarSetDescriptorToBuffer(char* buffer, const char* id, const Descriptor* pNamedVarSet);
@@ -68,8 +109,22 @@ private:
 	int writeNamedVarSetToBuffer(char* buffer, int offset, const NamedVarSet* pNamedVarSet);
 	int writeStatsToBuffer(char* buffer, int offset);
 
+	//Recording of evaluation episodes (see EpisodeRecorder): the first episode of every Record-Freq-th evaluation is
+	//rendered offscreen and saved as a video
+	BOOL_PARAM m_bRecordEvaluationEpisodes;
+	INT_PARAM m_recordFreq;
+	DOUBLE_PARAM m_recordFPS;
+	ENUM_PARAM<VideoFormat> m_recordFormat;
+	INT_PARAM m_recordWidth;
+	INT_PARAM m_recordHeight;
+	string m_outputRecordingPrefix;
+
 	//stats
 	std::vector<IStats *> m_stats;
+
+	//step-loop profiler: the variables set by the profiled sections' timers (see profiler.h)
+	BOOL_PARAM m_bProfileSteps;
+	std::deque<double> m_profiledSectionTimes;
 public:
 	static const unsigned int BIN_FILE_VERSION = 2;
 
@@ -82,6 +137,35 @@ public:
 
 	//returns whether we are logging functions
 	bool areFunctionsLogged() { return m_bLogFunctions.get(); }
+	//Nothing will be logged to files, regardless of the parameters. Used by the workers of an asynchronous experiment
+	//other than the first one
+	void disableFileLogging();
+	//average reward of the last evaluation reported (only if evaluation episodes are logged)
+	double getLastEvaluationAvgReward() const { return m_lastEvaluationAvgReward; }
+
+	//Parallel evaluations (see ParallelEvaluator)
+	//Only evaluation episodes will be logged, and their records will be appended to pRecords. The evaluation message
+	//is kept instead of being reported
+	void captureEvaluationEpisodes(vector<char>* pRecords);
+	const string& getCapturedEvaluationMessage() const { return m_capturedEvaluationMessage; }
+	//Called when an evaluation begins to run in parallel. Records written afterwards are held until it is merged
+	void reserveEvaluation(unsigned int evaluationIndex);
+	//Merges the captured records of an evaluation and reports its message, right after the records of the episodes
+	//that precede it
+	void mergeEvaluation(unsigned int evaluationIndex, vector<char>& records, const string& evaluationMessage
+		, double evaluationAvgReward);
+	//Recording of evaluation episodes
+	bool areEvaluationEpisodesRecorded() const { return m_bRecordEvaluationEpisodes.get(); }
+	//evaluationIndex is 1-based, as returned by Experiment::getEvaluationIndex()
+	bool isEvaluationRecorded(unsigned int evaluationIndex) const;
+	//y4m: the video file. ppm: the prefix of the frame files (<prefix>.<frame>.ppm)
+	string getRecordingFilename(unsigned int evaluationIndex) const;
+	double getRecordFPS() const { return m_recordFPS.get() > 0.0 ? m_recordFPS.get() : 25.0; }
+	VideoFormat getRecordFormat() const { return m_recordFormat.get(); }
+	int getRecordWidth() const { return std::max(16, m_recordWidth.get()); }
+	int getRecordHeight() const { return std::max(16, m_recordHeight.get()); }
+	//number of threads used to sample the functions (0: all the hardware threads)
+	unsigned int getNumFunctionSamplingThreads() { return m_numFunctionSamplingThreads.get() > 0 ? (unsigned int) m_numFunctionSamplingThreads.get() : 0; }
 
 	//METHODS CALLED FROM ANY CLASS
 	template <typename T>
@@ -90,6 +174,9 @@ public:
 		m_stats.push_back(new Stats<T>(key, subkey, variable));
 	}
 	void addVarSetToStats(const char* key, NamedVarSet* varset);
+	//Adds the time of a section of the step loop to the stats (key "Profiler"). Returns the variable that must be given
+	//to the section's PROFILE_SCOPE, or nullptr if steps are not profiled
+	double* addProfiledSection(const string& name);
 
 	size_t getNumStats();
 	IStats* getStats(unsigned int i);
@@ -100,12 +187,29 @@ public:
 	static NamedPipeClient m_outputPipe;
 	static bool m_bLogMessagesEnabled;
 
+	//Batch mode (see BatchRunner): id of the experiment run by the calling thread. Messages are tagged with it
+	static thread_local string m_experimentId;
+	static const size_t MAX_EXPERIMENT_ID_LENGTH = 256;
+	static void setExperimentId(const string& experimentId);
+	//Reports the end of the experiment run by the calling thread (only in batch mode)
+	static void logExperimentEnd(bool bSuccess);
+	//Asynchronous mode (see AsyncRunner): only errors are reported from the threads of the workers other than the first
+	static thread_local bool m_bOnlyErrorMessages;
+	static void setOnlyErrorMessages(bool bOnlyErrors) { m_bOnlyErrorMessages = bOnlyErrors; }
+	//Lets the server know we have finished and closes the pipe
+	static void closeOutputPipe();
+
 	//Function called to report progress and error messages
 	//static so that it can be called right from the beginning
 	static void logMessage(MessageType type, const char* message);
 	//Function called to enable/disable output messages. Used when RLSimion outputs its requirements
 	static void enableLogMessages(bool enable);
 
+private:
+	//messages can be logged from several threads in batch mode
+	static mutex m_outputMutex;
+	static void writeToPipe(const char* message);
+
 protected:
 	friend class Experiment;
 	//METHODS CALLED FROM Experiment
@@ -7,8 +7,9 @@ class SimionMemPool;
 class MemBlock
 {
 	SimionMemPool* m_pPool;
-	double* m_pBuffer = nullptr;
+	char* m_pBuffer = nullptr;
 	size_t m_blockSize = 0;
+	size_t m_valueSize = sizeof(double);
 	bool m_bInitialized = false;
 	BUFFER_SIZE m_lastAccess = 0;
 	int m_id;
@@ -16,16 +17,16 @@ class MemBlock
 
 	string getDumpFileName();
 public:
-	MemBlock(SimionMemPool* pPool,int id, size_t elementCount);
+	MemBlock(SimionMemPool* pPool,int id, size_t elementCount, size_t valueSize);
 	virtual ~MemBlock();
 
 	bool bAllocated() const { return m_pBuffer != nullptr; }
-	double* deallocate();
+	char* deallocate();
 
 	void restoreFromFile();
 	void dumpToFile();
 
-	void setBuffer(double* pBuffer);
+	void setBuffer(char* pBuffer);
 	size_t size() const { return m_blockSize; }
 	bool bInitialized() const { return m_bInitialized; }
 	void setInitialized() { m_bInitialized= true; }
@@ -33,6 +34,8 @@ public:
 	void setLastAccess(BUFFER_SIZE newValue) { m_lastAccess = newValue; }
 	int getId() const { return m_id; }
 
-	double& operator[](size_t index);
+	//address of the index-th value of the block, which is stored with the precision of the pool. Accesses are
+	//tracked by the pool (see SimionMemPool::getAddress())
+	void* getAddress(size_t index) { return m_pBuffer + index * m_valueSize; }
 };
 
@@ -44,6 +44,16 @@ double& SimpleMemBuffer::operator[](BUFFER_SIZE index)
 	return m_pBuffer[index];
 }
 
+double SimpleMemBuffer::get(BUFFER_SIZE index)
+{
+	return m_pBuffer[index];
+}
+
+void SimpleMemBuffer::set(BUFFER_SIZE index, double value)
+{
+	m_pBuffer[index] = value;
+}
+
 
 
 
@@ -63,7 +73,43 @@ double& SimionMemBuffer::operator[](BUFFER_SIZE index)
 	return m_pPool->get((int)index,m_offset);
 }
 
+double SimionMemBuffer::get(BUFFER_SIZE index)
+{
+	return m_pPool->getValue(index, m_offset);
+}
+
+void SimionMemBuffer::set(BUFFER_SIZE index, double value)
+{
+	m_pPool->setValue(index, m_offset, value);
+}
+
 BUFFER_SIZE SimionMemBuffer::getBlockSizeInBytes()
 {
-	return m_pPool->getBlockSize()*sizeof(double);
-}
\ No newline at end of file
+	return m_pPool->getBlockSize()*m_pPool->getValueSize();
+}
+
+StridedMemBuffer::StridedMemBuffer(IMemBuffer* pSource, BUFFER_SIZE stride, BUFFER_SIZE offset)
+	:IMemBuffer(pSource->getMemPool(), pSource->getNumElements() / stride), m_pSource(pSource), m_stride(stride), m_offset(offset)
+{
+	if (pSource->bInitValueSet())
+		setInitValue(pSource->getInitValue());
+}
+
+StridedMemBuffer::~StridedMemBuffer()
+{
+}
+
+double& StridedMemBuffer::operator[](BUFFER_SIZE index)
+{
+	return (*m_pSource)[index*m_stride + m_offset];
+}
+
+double StridedMemBuffer::get(BUFFER_SIZE index)
+{
+	return m_pSource->get(index*m_stride + m_offset);
+}
+
+void StridedMemBuffer::set(BUFFER_SIZE index, double value)
+{
+	m_pSource->set(index*m_stride + m_offset, value);
+}
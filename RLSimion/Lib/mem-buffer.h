@@ -13,6 +13,8 @@ public:
 	~SimpleMemBuffer();
 
 	double& operator[](BUFFER_SIZE index);
+	double get(BUFFER_SIZE index);
+	void set(BUFFER_SIZE index, double value);
 };
 
 class SimionMemBuffer: public IMemBuffer
@@ -28,12 +30,29 @@ public:
 	virtual ~SimionMemBuffer();
 
 	//this is meant to be used in case types with different sizes are to be interleaved
-	//as all the big buffers are, so far, double*, we skip this assume m_elementSize= 1
+	//all the buffers of a pool store their values with the same precision, so we skip this assume m_elementSize= 1
 	BUFFER_SIZE getElementSize() { return m_elementSize; }
 	BUFFER_SIZE getOffset() { return m_offset; }
 	BUFFER_SIZE getBlockSizeInBytes();
 	SimionMemPool* getPool() { return m_pPool; }
 
 	double& operator[](BUFFER_SIZE index);
+	double get(BUFFER_SIZE index);
+	void set(BUFFER_SIZE index, double value);
 };
 
+
+//A view of one of the outputs of a multi-output function whose weights are stored in a single buffer, the outputs of
+//each element next to each other: the i-th element of the view is the element i*stride+offset of the source buffer
+class StridedMemBuffer : public IMemBuffer
+{
+	IMemBuffer* m_pSource;
+	BUFFER_SIZE m_stride, m_offset;
+public:
+	StridedMemBuffer(IMemBuffer* pSource, BUFFER_SIZE stride, BUFFER_SIZE offset);
+	virtual ~StridedMemBuffer();
+
+	double& operator[](BUFFER_SIZE index);
+	double get(BUFFER_SIZE index);
+	void set(BUFFER_SIZE index, double value);
+};
@@ -1,24 +1,50 @@
 #pragma once
 #include "mem-manager.h"
+#include <mutex>
 class IMemBuffer;
+class PageAllocator;
 
 class IMemPool
 {
 protected:
 	BUFFER_SIZE m_totalAllocatedMem = 0;
 	BUFFER_SIZE m_memLimit = 0;
+	WeightPrecision m_precision = WeightPrecision::float64;
+	PageAllocator* m_pPageAllocator = nullptr;
+	unsigned int m_numInitThreads = 1;
+	mutex m_allocationMutex;
 public:
 	virtual ~IMemPool() {};
 
 	virtual IMemBuffer* getHandler(BUFFER_SIZE elementCount)= 0;
 	virtual void init(BUFFER_SIZE blockSize= 524288) = 0;
-	virtual bool bCanAllocate(BUFFER_SIZE elementCount) const = 0;
+	virtual bool bCanAllocate(BUFFER_SIZE elementCount, WeightPrecision precision) const = 0;
 	virtual void copy(IMemBuffer* pSrc, IMemBuffer* pDst) = 0;
+	//Allocates and initializes all the memory up front instead of when it is first accessed
+	virtual void allocateAll() {}
+	//Whether all the memory is allocated and none of it can be swapped out. Only then can the values be accessed from
+	//several threads at the same time
+	virtual bool bPreallocated() const { return false; }
+	//Must be held by threads that read the values concurrently while the pool isn't preallocated
+	mutex& getAllocationMutex() { return m_allocationMutex; }
+	//Copies all the values of pSrc, a pool with the same buffers and block size (i.e., the pool of another app built from
+	//the same configuration)
+	virtual void copyValues(IMemPool* pSrc) = 0;
 
 	virtual void setMemLimit(BUFFER_SIZE memLimit) { m_memLimit = memLimit; }
+	//Memory blocks are allocated in the heap unless a page allocator is given. Blocks can be initialized in parallel
+	//by more than one thread
+	void setAllocationOptions(PageAllocator* pPageAllocator, unsigned int numInitThreads)
+	{
+		m_pPageAllocator = pPageAllocator;
+		m_numInitThreads = numInitThreads;
+	}
 
 	BUFFER_SIZE getTotalAllocatedMem() const { return m_totalAllocatedMem; }
 	void updateTotalMemAllocated(BUFFER_SIZE inc) { m_totalAllocatedMem += inc; }
+
+	//the precision with which the values are stored. Values are always read and written as double
+	WeightPrecision getPrecision() const { return m_precision; }
 };
 
 class IMemBuffer
@@ -32,7 +58,11 @@ public:
 	IMemBuffer(IMemPool* pPool, BUFFER_SIZE numElements) { m_pPool = pPool; m_numElements = numElements; }
 	virtual ~IMemBuffer() {};
 
+	//Direct access to the stored values: only available if they are stored with double precision
 	virtual double& operator[](BUFFER_SIZE index)= 0;
+	//Access that converts from/to the precision with which the values are stored
+	virtual double get(BUFFER_SIZE index) = 0;
+	virtual void set(BUFFER_SIZE index, double value) = 0;
 	void setInitValue(double value) { m_initValue = value; m_bInitValueSet = true; }
 	bool bInitValueSet() const { return m_bInitValueSet; }
 	double getInitValue() const { return m_initValue; }
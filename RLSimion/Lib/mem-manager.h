@@ -5,13 +5,17 @@
 typedef size_t BUFFER_SIZE;
 
 #include <vector>
+#include <mutex>
+#include <stdexcept>
 using namespace std;
 
+#include "parameters.h"
 #include "mem-interfaces.h"
 #include "mem-block.h"
 #include "mem-buffer.h"
 #include "mem-pool.h"
 #include "deferred-load.h"
+#include "../../tools/System/PageAllocator.h"
 
 template <typename MemPoolType>
 class MemManager: public DeferredLoad
@@ -21,18 +25,60 @@ class MemManager: public DeferredLoad
 	//amount of elements. The goal is to interleave data and thus, reduce the number of cache errors
 	//This should be a short list. Not likely worth using a map instead of a vector
 	vector<IMemPool*>m_memPools;
+
+	PageAllocator* m_pPageAllocator = nullptr;
+	unsigned int m_numInitThreads = 1;
+
+	//Asynchronous learning (see AsyncRunner): the buffers are requested from a manager shared by all the workers. The
+	//n-th buffer requested by every worker is the same, because all of them request their buffers in the same order
+	MemManager* m_pSharedManager = nullptr;
+	size_t m_numSharedBuffersRequested = 0;
+	//members of the shared manager
+	mutex m_sharedBuffersMutex;
+	vector<IMemBuffer*> m_sharedBuffers;
+	bool m_bSharedBuffersInitialized = false;
+
+	//incremented every time all the values are overwritten by copyValues()
+	unsigned int m_valuesVersion = 0;
+
+	IMemBuffer* getSharedMemBuffer(size_t index, BUFFER_SIZE elementCount, WeightPrecision precision)
+	{
+		lock_guard<mutex> lock(m_sharedBuffersMutex);
+		if (index == m_sharedBuffers.size())
+		{
+			if (m_bSharedBuffersInitialized)
+				throw std::runtime_error("A memory buffer was requested by a worker after the shared buffers were initialized");
+			m_sharedBuffers.push_back(getMemBuffer(elementCount, precision));
+		}
+		IMemBuffer* pBuffer = m_sharedBuffers[index];
+		if (pBuffer->getNumElements() != elementCount || pBuffer->getMemPool()->getPrecision() != precision)
+			throw std::runtime_error("The workers requested different memory buffers");
+		return pBuffer;
+	}
+
+	void initSharedMemBuffers(BUFFER_SIZE blockSize)
+	{
+		lock_guard<mutex> lock(m_sharedBuffersMutex);
+		if (m_bSharedBuffersInitialized)
+			return;
+		init(blockSize);
+		//blocks are allocated lazily when they are first accessed, which can't be done concurrently
+		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
+			(*it)->allocateAll();
+		m_bSharedBuffersInitialized = true;
+	}
 	
-	IMemPool* getMemPool(BUFFER_SIZE elementCount)
+	IMemPool* getMemPool(BUFFER_SIZE elementCount, WeightPrecision precision)
 	{
 		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
 		{
-			if ((*it)->bCanAllocate(elementCount))
+			if ((*it)->bCanAllocate(elementCount, precision))
 			{
 				return (*it);
 			}
 		}
 
-		m_memPools.push_back(new MemPoolType(elementCount));
+		m_memPools.push_back(new MemPoolType(elementCount, precision));
 		return m_memPools.back();
 	}
 public:
@@ -44,7 +90,24 @@ public:
 		{
 			delete *it;
 		}
+		if (m_pPageAllocator != nullptr)
+			delete m_pPageAllocator;
+	}
+
+	//Allocates the memory blocks directly from the OS instead of the heap, optionally with huge pages (which reduce TLB
+	//misses on the random accesses of big VFAs) and a NUMA placement policy. Must be called before init()
+	void usePageAllocator(bool bHugePages, NumaPolicy numaPolicy = NumaPolicy::Local, int numaNode = 0)
+	{
+		if (m_pPageAllocator == nullptr)
+			m_pPageAllocator = new PageAllocator();
+		m_pPageAllocator->setHugePages(bHugePages);
+		m_pPageAllocator->setNumaPolicy(numaPolicy, numaNode);
 	}
+	const PageAllocator* getPageAllocator() const { return m_pPageAllocator; }
+
+	//Number of threads used to write the initial values of big memory blocks. With the Local NUMA policy, pages land on
+	//the nodes of the threads that write them first. 0 uses all the hardware threads
+	void setNumInitThreads(unsigned int numThreads) { m_numInitThreads = numThreads; }
 
 	//maxAllocatedMemory: maximum number of bytes allowed to have in memory concurrently
 	void setMaxAllocatedMem(BUFFER_SIZE maxAllocatedMem)
@@ -65,20 +128,40 @@ public:
 		return true;
 	}
 
-	IMemBuffer* getMemBuffer(BUFFER_SIZE elementCount)
+	//Makes this manager return the buffers of pSharedManager, which are shared with other managers (the workers of an
+	//asynchronous experiment). Its buffers are all allocated when first initialized and can be accessed concurrently
+	//(without a memory limit). Must be called before any buffer is requested
+	void shareMemBuffers(MemManager* pSharedManager) { m_pSharedManager = pSharedManager; }
+
+	//Buffers stored with reduced precision (float32/float16/bfloat16) take less memory and bandwidth, but can only be
+	//accessed through IMemBuffer::get() and IMemBuffer::set()
+	IMemBuffer* getMemBuffer(BUFFER_SIZE elementCount, WeightPrecision precision = WeightPrecision::float64)
 	{
-		IMemPool* pMemPool = getMemPool(elementCount);
+		if (m_pSharedManager)
+			return m_pSharedManager->getSharedMemBuffer(m_numSharedBuffersRequested++, elementCount, precision);
+
+		IMemPool* pMemPool = getMemPool(elementCount, precision);
 		return pMemPool->getHandler(elementCount);
 	}
 
 	void init(BUFFER_SIZE blockSize = 64 * 1024)
 	{
+		if (m_pSharedManager)
+		{
+			m_pSharedManager->initSharedMemBuffers(blockSize);
+			return;
+		}
 		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
+		{
+			(*it)->setAllocationOptions(m_pPageAllocator, m_numInitThreads);
 			(*it)->init(blockSize);
+		}
 	}
 
 	BUFFER_SIZE getTotalAllocatedMem() const
 	{
+		if (m_pSharedManager)
+			return m_pSharedManager->getTotalAllocatedMem();
 		BUFFER_SIZE total = 0;
 		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
 		{
@@ -89,8 +172,8 @@ public:
 
 	//This method copies initialized memory blocks from buffer to buffer
 	//Don't use in performance-critical operations done frequently such as copying weights
-	//from a function to the frozen copy. Rather, store in a separate feature list
-	//weight updates and then apply those updates to the frozen copy.
+	//from a function to the frozen copy. Rather, keep track of the updated weights and copy
+	//only those (see LinearVFA::syncFrozenWeights()).
 	virtual void copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 	{
 		IMemPool* pSrcPool= pSrc->getMemPool();
@@ -101,6 +184,22 @@ public:
 		}
 	}
 
+	//Copies the values of all the buffers of pSrc, which must have requested the same buffers in the same order (i.e.,
+	//the manager of another app built from the same configuration). Both must have been initialized
+	void copyValues(MemManager* pSrc)
+	{
+		if (m_pSharedManager || pSrc->m_pSharedManager)
+			throw std::runtime_error("The values of shared memory buffers can't be copied");
+		if (pSrc->m_memPools.size() != m_memPools.size())
+			throw std::runtime_error("Values can only be copied between memory managers with the same buffers");
+		for (size_t i = 0; i < m_memPools.size(); ++i)
+			m_memPools[i]->copyValues(pSrc->m_memPools[i]);
+		++m_valuesVersion;
+	}
+
+	//Any value calculated from the buffers and cached (see LinearStateMultiVFA) must be discarded if this changes
+	unsigned int getValuesVersion() const { return m_valuesVersion; }
+
 	void deferredLoadStep()
 	{
 		init();
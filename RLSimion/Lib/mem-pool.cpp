@@ -27,10 +27,20 @@
 #include "mem-buffer.h"
 #include "mem-block.h"
 #include "mem-manager.h"
+#include "work-stealing-pool.h"
+#include "../CNTKWrapper/HalfConverter.hpp"
+#include "../../tools/System/PageAllocator.h"
 #include <string>
 #include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <limits>
 
-SimpleMemPool::SimpleMemPool(BUFFER_SIZE elementCount) {}
+SimpleMemPool::SimpleMemPool(BUFFER_SIZE, WeightPrecision precision)
+{
+	if (precision != WeightPrecision::float64)
+		throw std::runtime_error("Simple memory pools can only store values with double precision");
+}
 SimpleMemPool::~SimpleMemPool()
 {
 	for (auto it = m_buffers.begin(); it != m_buffers.end(); ++it)
@@ -54,19 +64,36 @@ void SimpleMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 	{
 		for (BUFFER_SIZE i= 0; i<numElements; ++i)
 		{
-			(*pDst)[i] = (*pSrc)[i];
+			pDst->set(i, pSrc->get(i));
 		}
 	}
 }
 
 
+void SimpleMemPool::copyValues(IMemPool* pSrc)
+{
+	SimpleMemPool* pSrcPool = dynamic_cast<SimpleMemPool*>(pSrc);
+	if (!pSrcPool || pSrcPool->m_buffers.size() != m_buffers.size())
+		throw std::runtime_error("Values can only be copied between memory pools with the same buffers");
+	for (size_t i = 0; i < m_buffers.size(); ++i)
+		copy(pSrcPool->m_buffers[i], m_buffers[i]);
+}
+
 
 //Interleaved Memory Pool
 //a set arrays with the same size are interleaved to improve cache hits
 
-SimionMemPool::SimionMemPool(BUFFER_SIZE numElements)
+SimionMemPool::SimionMemPool(BUFFER_SIZE numElements, WeightPrecision precision)
 {
 	m_numElements = numElements;
+	m_precision = precision;
+	switch (precision)
+	{
+	case WeightPrecision::float32: m_valueSize = sizeof(float); break;
+	case WeightPrecision::float16:
+	case WeightPrecision::bfloat16: m_valueSize = sizeof(unsigned short); break;
+	default: m_valueSize = sizeof(double);
+	}
 }
 
 
@@ -98,21 +125,22 @@ IMemBuffer* SimionMemPool::getHandler(BUFFER_SIZE elementCount)
 }
 
 
-double& SimionMemPool::get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
+void* SimionMemPool::getAddress(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
 {
-	++m_accessCounter;
-
 	BUFFER_SIZE elementStartByte = elementIndex*m_elementSize + bufferOffset;
 	BUFFER_SIZE blockId = elementStartByte / m_memBlockSize;
 	BUFFER_SIZE relBlockAddr = elementStartByte % m_memBlockSize;
-	double* pMemBuffer= 0;
+	char* pMemBuffer= 0;
 	MemBlock* pBlock = m_memBlocks[(size_t)blockId];
 
+	if (m_bPreallocated)
+		return pBlock->getAddress((size_t)relBlockAddr);
+
 	if (!pBlock->bAllocated())
 	{
 		//can we allocate more memory?
 		BUFFER_SIZE allocatedMem = getTotalAllocatedMem();
-		BUFFER_SIZE requestedMem = m_memBlockSize * sizeof(double);
+		BUFFER_SIZE requestedMem = m_memBlockSize * m_valueSize;
 
 		if (m_memLimit == 0 || allocatedMem + requestedMem <= m_memLimit)
 		{
@@ -124,7 +152,7 @@ double& SimionMemPool::get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
 				//memory block successfully allocated
 				m_allocatedMemBlocks.push_back(pBlock);
 				pBlock->setBuffer(pMemBuffer);
-				m_totalAllocatedMem += m_memBlockSize * sizeof(double);
+				m_totalAllocatedMem += m_memBlockSize * m_valueSize;
 			}
 		}
 		if (!pMemBuffer)
@@ -140,8 +168,74 @@ double& SimionMemPool::get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
 		else pBlock->restoreFromFile();
 	}
 
+	//the least recently accessed blocks are the first ones swapped out
+	pBlock->setLastAccess(getAccessCounter());
+	if (pBlock->getLastAccess() == std::numeric_limits<BUFFER_SIZE>::max())
+		resetAccessCounter();
 
-	return (*pBlock)[relBlockAddr];
+	return pBlock->getAddress((size_t)relBlockAddr);
+}
+
+double& SimionMemPool::get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
+{
+	if (m_precision != WeightPrecision::float64)
+		throw std::runtime_error("Values stored with reduced precision can only be accessed with get() and set()");
+	return *(double*)getAddress(elementIndex, bufferOffset);
+}
+
+double SimionMemPool::getValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
+{
+	return load(getAddress(elementIndex, bufferOffset));
+}
+
+void SimionMemPool::setValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset, double value)
+{
+	store(getAddress(elementIndex, bufferOffset), value);
+}
+
+double SimionMemPool::load(const void* pValue) const
+{
+	float value;
+	unsigned int bits;
+	switch (m_precision)
+	{
+	case WeightPrecision::float32:
+		return *(const float*)pValue;
+	case WeightPrecision::float16:
+		CNTK::float16ToFloat((const unsigned short*)pValue, &value);
+		return value;
+	case WeightPrecision::bfloat16:
+		//bfloat16 values are the 16 most significant bits of a float
+		bits = ((unsigned int) *(const unsigned short*)pValue) << 16;
+		memcpy(&value, &bits, sizeof(float));
+		return value;
+	default:
+		return *(const double*)pValue;
+	}
+}
+
+void SimionMemPool::store(void* pValue, double value) const
+{
+	float floatValue = (float)value;
+	unsigned int bits;
+	switch (m_precision)
+	{
+	case WeightPrecision::float32:
+		*(float*)pValue = floatValue;
+		return;
+	case WeightPrecision::float16:
+		CNTK::floatToFloat16(&floatValue, (unsigned short*)pValue);
+		return;
+	case WeightPrecision::bfloat16:
+		memcpy(&bits, &floatValue, sizeof(float));
+		//round to nearest even, except NaNs, which would become infinities
+		if ((bits & 0x7fffffff) <= 0x7f800000)
+			bits += 0x7fff + ((bits >> 16) & 1);
+		*(unsigned short*)pValue = (unsigned short)(bits >> 16);
+		return;
+	default:
+		*(double*)pValue = value;
+	}
 }
 
 bool compare_lastAccess(MemBlock* pFirst, MemBlock* pSecond)
@@ -149,14 +243,14 @@ bool compare_lastAccess(MemBlock* pFirst, MemBlock* pSecond)
 	return (pFirst->getLastAccess() > pSecond->getLastAccess());
 }
 
-double* SimionMemPool::recycleMem()
+char* SimionMemPool::recycleMem()
 {
 	std::sort(m_allocatedMemBlocks.begin(),m_allocatedMemBlocks.end(),compare_lastAccess);
 
 	//blocks are sorted from last accest to oldest accest
 	MemBlock* pRecycledMemBlock = m_allocatedMemBlocks.back();
 	pRecycledMemBlock->dumpToFile();
-	double* pBuffer= pRecycledMemBlock->deallocate();
+	char* pBuffer= pRecycledMemBlock->deallocate();
 	m_allocatedMemBlocks.pop_back();
 	
 	return pBuffer;
@@ -178,26 +272,45 @@ void SimionMemPool::initialize(MemBlock* pBlock)
 	BUFFER_SIZE blockId = pBlock->getId();
 	size_t firstElement = blockId*pBlock->size();
 	size_t numHandlers = (int)m_memBufferHandlers.size();
-	size_t handler;
-	double initValue;
-	for (int i = 0; i < (int) pBlock->size(); ++i)
+	char* pBuffer = (char*)pBlock->getAddress(0);
+
+	auto initializeRange = [&](size_t start, size_t end)
 	{
-		handler = (firstElement+i) % numHandlers;
-		if (m_memBufferHandlers[handler]->bInitValueSet())
+		size_t handler;
+		for (size_t i = start; i < end; ++i)
 		{
-			initValue = m_memBufferHandlers[handler]->getInitValue();
-			(*pBlock)[i] = initValue;
+			handler = (firstElement + i) % numHandlers;
+			if (m_memBufferHandlers[handler]->bInitValueSet())
+				store(pBuffer + i * m_valueSize, m_memBufferHandlers[handler]->getInitValue());
 		}
+	};
+
+	//big blocks are initialized in parallel in chunks of the size of a huge page, so that every page is first touched by
+	//a single thread (with the Local NUMA policy, that thread's node is where the page is placed)
+	size_t chunkSize = PageAllocator::HUGE_PAGE_SIZE / m_valueSize;
+	size_t numChunks = (pBlock->size() + chunkSize - 1) / chunkSize;
+	if (m_numInitThreads != 1 && numChunks > 1)
+	{
+		WorkStealingPool threadPool(m_numInitThreads, numChunks);
+		threadPool.run(numChunks, [&](size_t chunk)
+		{
+			initializeRange(chunk * chunkSize, std::min((chunk + 1) * chunkSize, pBlock->size()));
+		});
 	}
+	else
+		initializeRange(0, pBlock->size());
 	pBlock->setInitialized();
 }
 
-double* SimionMemPool::tryToAllocateMem(BUFFER_SIZE blockSize)
+char* SimionMemPool::tryToAllocateMem(BUFFER_SIZE blockSize)
 {
-	double* pNewMemBlock;
+	if (m_pPageAllocator)
+		return (char*)m_pPageAllocator->allocate(blockSize * m_valueSize);
+
+	char* pNewMemBlock;
 	try
 	{
-		pNewMemBlock= new double[blockSize];
+		pNewMemBlock= new char[blockSize * m_valueSize];
 		return pNewMemBlock;
 	}
 	catch(std::exception ex)
@@ -206,10 +319,24 @@ double* SimionMemPool::tryToAllocateMem(BUFFER_SIZE blockSize)
 	}
 }
 
+void SimionMemPool::freeMem(char* pBuffer)
+{
+	if (m_pPageAllocator)
+		m_pPageAllocator->free(pBuffer);
+	else
+		delete[] pBuffer;
+}
+
 void SimionMemPool::init(BUFFER_SIZE blockSize)
 {
 	MemBlock* pNewMemBlock;
 	size_t totalNumElements= m_numElements * (int)m_memBufferHandlers.size();
+	//with huge pages, blocks span a whole number of them: as many as arrays are interleaved
+	if (m_pPageAllocator && m_pPageAllocator->bHugePages())
+	{
+		size_t hugePageBlockSize = m_elementSize * (PageAllocator::HUGE_PAGE_SIZE / m_valueSize);
+		blockSize = std::max((size_t)1, (blockSize + hugePageBlockSize - 1) / hugePageBlockSize) * hugePageBlockSize;
+	}
 	m_memBlockSize = std::min(blockSize,totalNumElements);
 
 	//make the block size a multiple of the number of interleaved arrays
@@ -225,13 +352,13 @@ void SimionMemPool::init(BUFFER_SIZE blockSize)
 
 	for (size_t i = 0; i < numBlocks; ++i)
 	{
-		pNewMemBlock = new MemBlock(this,i, m_memBlockSize);
+		pNewMemBlock = new MemBlock(this,i, m_memBlockSize, m_valueSize);
 		m_memBlocks.push_back(pNewMemBlock);
 	}
 
 	//we may have to correct the maximum amount of memory allowed to accomodate at least one block
 	if (m_memLimit>0)
-		m_memLimit = std::max(m_memLimit, (BUFFER_SIZE)(m_memBlockSize * sizeof(double)));
+		m_memLimit = std::max(m_memLimit, (BUFFER_SIZE)(m_memBlockSize * m_valueSize));
 }
 
 void SimionMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
@@ -256,7 +383,7 @@ void SimionMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 						++maxRelIndexInBlock;
 
 				for (size_t i= minRelIndexInBlock; i<maxRelIndexInBlock; ++i)
-					(*pDstBuffer)[i] = (*pSrcBuffer)[i];
+					pDstBuffer->set(i, pSrcBuffer->get(i));
 				++numBlocksCopied;
 			}
 			blockAbsOffset += m_memBlockSize;
@@ -265,6 +392,36 @@ void SimionMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 	}
 }
 
+void SimionMemPool::allocateAll()
+{
+	if (m_bPreallocated)
+		return;
+	for (size_t block = 0; block < m_memBlocks.size(); ++block)
+		getAddress(block * m_memBlockSize / m_elementSize, 0);
+
+	//with a memory limit, allocating the last blocks may have swapped out the first ones
+	m_bPreallocated = std::all_of(m_memBlocks.begin(), m_memBlocks.end(), [](MemBlock* pBlock) { return pBlock->bAllocated(); });
+}
+
+void SimionMemPool::copyValues(IMemPool* pSrc)
+{
+	SimionMemPool* pSrcPool = dynamic_cast<SimionMemPool*>(pSrc);
+	if (!pSrcPool || pSrcPool->m_precision != m_precision || pSrcPool->m_numElements != m_numElements
+		|| pSrcPool->m_elementSize != m_elementSize || pSrcPool->m_memBlockSize != m_memBlockSize)
+		throw std::runtime_error("Values can only be copied between memory pools with the same buffers");
+
+	//blocks never accessed in the source still hold their initial values: if they haven't been accessed here either,
+	//there's nothing to copy
+	for (size_t block = 0; block < m_memBlocks.size(); ++block)
+	{
+		if (!pSrcPool->m_memBlocks[block]->bInitialized())
+			continue;
+		BUFFER_SIZE firstElement = block * m_memBlockSize / m_elementSize;
+		void* pSrcValues = pSrcPool->getAddress(firstElement, 0);
+		memcpy(getAddress(firstElement, 0), pSrcValues, m_memBlocks[block]->size() * m_valueSize);
+	}
+}
+
 BUFFER_SIZE SimionMemPool::getAccessCounter()
 {
 	return ++m_accessCounter;
@@ -13,12 +13,16 @@ class SimpleMemPool : public IMemPool
 	vector<IMemBuffer*> m_buffers;
 
 public:
-	SimpleMemPool(BUFFER_SIZE elementCount);
+	//values are always stored with double precision. Any other precision throws an exception
+	SimpleMemPool(BUFFER_SIZE elementCount, WeightPrecision precision = WeightPrecision::float64);
 	virtual ~SimpleMemPool();
 	virtual IMemBuffer* getHandler(BUFFER_SIZE elementCount);
-	virtual bool bCanAllocate(BUFFER_SIZE elementCount) const { return true; }
+	virtual bool bCanAllocate(BUFFER_SIZE, WeightPrecision precision) const { return precision == WeightPrecision::float64; }
+	//buffers are allocated when they are requested
+	virtual bool bPreallocated() const { return true; }
 
 	void copy(IMemBuffer* pSrc, IMemBuffer* pDst);
+	virtual void copyValues(IMemPool* pSrc);
 
 	virtual void init(BUFFER_SIZE blockSize);
 };
@@ -34,35 +38,57 @@ class SimionMemPool: public IMemPool
 	vector<MemBlock*> m_allocatedMemBlocks;
 
 	void addMemBufferHandler(SimionMemBuffer* pMemBufferHandler);
-	//This function returns a buffer of size elementCount*sizeof(double)
+	//This function returns a buffer of size elementCount*getValueSize()
 	//or nullptr if "bad_allocation" exception was raised
-	double* tryToAllocateMem(BUFFER_SIZE elementCount);
+	char* tryToAllocateMem(BUFFER_SIZE elementCount);
+	void freeMem(char* pBuffer);
 	//This function dumpls to a file the memory allocated to some other memory block
 	//marks it as "not allocated" and returns the buffer for recycling
-	double* recycleMem();
+	char* recycleMem();
 	void initialize(MemBlock* pBlock);
 
+	void* getAddress(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset);
 	double& get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset);
+	double getValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset);
+	void setValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset, double value);
 
+	//conversion from/to the precision of the pool
+	double load(const void* pValue) const;
+	void store(void* pValue, double value) const;
+
+	BUFFER_SIZE m_valueSize = sizeof(double);
 	BUFFER_SIZE m_elementSize = 0;
 	BUFFER_SIZE m_numElements = 0;
 	BUFFER_SIZE m_memBlockSize = 0;
 	BUFFER_SIZE m_accessCounter = 0;
+
+	//Set by allocateAll() once every block is allocated. No block can be swapped out after that, so accesses are no
+	//longer tracked and the values can be read and written from several threads (i.e., the buffers shared by the
+	//workers of an asynchronous experiment): an access only computes the address
+	bool m_bPreallocated = false;
 public:
-	SimionMemPool(BUFFER_SIZE elementCount);
+	SimionMemPool(BUFFER_SIZE elementCount, WeightPrecision precision = WeightPrecision::float64);
 	virtual ~SimionMemPool();
 
 	virtual BUFFER_SIZE getNumElements() const { return m_numElements; }
 	BUFFER_SIZE getElementSize() const { return m_elementSize; }
 	BUFFER_SIZE getBlockSize() const { return m_memBlockSize; }
-	virtual bool bCanAllocate(BUFFER_SIZE elementCount) const { return elementCount == m_numElements; }
+	//number of bytes used to store each value
+	BUFFER_SIZE getValueSize() const { return m_valueSize; }
+	virtual bool bCanAllocate(BUFFER_SIZE elementCount, WeightPrecision precision) const
+	{
+		return elementCount == m_numElements && precision == m_precision;
+	}
 	BUFFER_SIZE getAccessCounter();
 	void resetAccessCounter();
+	virtual bool bPreallocated() const { return m_bPreallocated; }
 
 	virtual IMemBuffer* getHandler(BUFFER_SIZE elementCount);
 	void copy(IMemBuffer* pSrc, IMemBuffer* pDst);
 
 	//This method must be called after all the SimionMemBuffer's are requested
 	void init(BUFFER_SIZE blockSize);
+	virtual void allocateAll();
+	virtual void copyValues(IMemPool* pSrc);
 };
 
@@ -36,9 +36,25 @@
 #define MINIMAL_PROBABILITY 0.000001
 #define PROBABILITY_INTEGRATION_WIDTH 0.05
 
+std::mt19937& getRandomEngine()
+{
+	SimionApp* pApp = SimionApp::get();
+	if (pApp) return pApp->getRandomEngine();
+
+	static thread_local std::mt19937 engine;
+	return engine;
+}
+
+size_t getRandomIndex(size_t numIndices)
+{
+	//std::uniform_int_distribution isn't used because its output isn't the same with every standard library
+	return (size_t)(getRandomEngine()() % numIndices);
+}
+
 double getRandomValue()
 {
-	return (double)(rand() + 1) / ((double)RAND_MAX + 1);
+	std::mt19937& engine = getRandomEngine();
+	return ((double)engine() + 1.0) / ((double)engine.max() + 1.0);
 }
 
 int chooseRandomInteger(vector<double>& probability)
@@ -56,8 +72,9 @@ int chooseRandomInteger(vector<double>& probability)
 double GaussianNoise::getNormalDistributionSample(double mean, double sigma)
 {
 	if (sigma == 0.0) return mean;
-	double x1 = (double) (rand() + 1) / ((double) RAND_MAX + 1);
-	double x2 = (double) rand() / (double) RAND_MAX;
+	std::mt19937& engine = getRandomEngine();
+	double x1 = ((double)engine() + 1.0) / ((double)engine.max() + 1.0);
+	double x2 = (double)engine() / (double)engine.max();
 	double z = sqrt(- 2 * log(x1)) * cos(2 * M_PI * x2);
 	return z * sigma + mean;
 }
@@ -1,9 +1,12 @@
 #pragma once
 #include "parameters.h"
+#include <random>
 
 class ConfigNode;
 class NumericValue;
 
+std::mt19937& getRandomEngine(); //the engine of the app (see SimionApp::getRandomEngine), or one per thread if there is no app
+size_t getRandomIndex(size_t numIndices); //returns a random integer in range [0, numIndices)
 double getRandomValue();// returns a random value in range [0,1]
 int chooseRandomInteger(vector<double>& probability); //returns an integer in range [0, probability.size] according to the given probability
 
@@ -0,0 +1,197 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "parallel-evaluator.h"
+#include "app.h"
+#include "config.h"
+#include "logger.h"
+#include "experiment.h"
+#include "vfa.h"
+
+ParallelEvaluator::ParallelEvaluator(SimionApp* pApp, ConfigNode* pConfigRoot, unsigned int numThreads)
+{
+	m_pApp = pApp;
+
+	//every evaluator parses its own copy of the configuration, because parameters are read from it as they are used
+	tinyxml2::XMLPrinter printer;
+	pConfigRoot->GetDocument()->Print(&printer);
+	m_configuration = printer.CStr();
+
+	Logger::logMessage(MessageType::Info, ("Evaluations will be run in parallel by " + to_string(numThreads)
+		+ " threads").c_str());
+
+	//evaluators are loaded one at a time before training begins. Errors are reported right away
+	for (unsigned int i = 0; i < numThreads; ++i)
+	{
+		Evaluator* pEvaluator = new Evaluator();
+		m_evaluators.push_back(pEvaluator);
+		pEvaluator->evaluatorThread = thread([this, pEvaluator]() { runEvaluator(pEvaluator); });
+
+		unique_lock<mutex> lock(m_mutex);
+		m_condition.wait(lock, [pEvaluator]() { return pEvaluator->state != EvaluatorState::Loading; });
+		if (pEvaluator->state == EvaluatorState::Failed)
+		{
+			string error = pEvaluator->error;
+			lock.unlock();
+			//the destructor won't be called
+			stopEvaluators();
+			Logger::logMessage(MessageType::Error, ("Evaluator: " + error).c_str());
+		}
+	}
+}
+
+ParallelEvaluator::~ParallelEvaluator()
+{
+	stopEvaluators();
+}
+
+void ParallelEvaluator::stopEvaluators()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_bExit = true;
+	}
+	m_condition.notify_all();
+
+	for (Evaluator* pEvaluator : m_evaluators)
+	{
+		if (pEvaluator->evaluatorThread.joinable())
+			pEvaluator->evaluatorThread.join();
+		delete pEvaluator;
+	}
+	m_evaluators.clear();
+}
+
+void ParallelEvaluator::runEvaluator(Evaluator* pEvaluator)
+{
+	Logger::setOnlyErrorMessages(true);
+	try
+	{
+		ConfigFile configFile;
+		configFile.Parse(m_configuration.c_str());
+		ConfigNode* pConfigRoot = (ConfigNode*)configFile.FirstChildElement();
+		if (!pConfigRoot)
+			throw std::runtime_error("Couldn't parse the experiment configuration");
+
+		SimionApp app(pConfigRoot);
+		app.setExecutedRemotely(true);
+		app.pLogger->captureEvaluationEpisodes(&pEvaluator->records);
+		app.beginSimulation();
+
+		unique_lock<mutex> lock(m_mutex);
+		pEvaluator->pApp = &app;
+		pEvaluator->state = EvaluatorState::Idle;
+		m_condition.notify_all();
+		while (true)
+		{
+			m_condition.wait(lock, [this, pEvaluator]() { return m_bExit || pEvaluator->state == EvaluatorState::Evaluating; });
+			if (pEvaluator->state != EvaluatorState::Evaluating)
+				break;
+
+			lock.unlock();
+			app.runEvaluation(pEvaluator->evaluationIndex);
+			lock.lock();
+
+			pEvaluator->evaluationMessage = app.pLogger->getCapturedEvaluationMessage();
+			pEvaluator->evaluationAvgReward = app.pLogger->getLastEvaluationAvgReward();
+			pEvaluator->state = EvaluatorState::Finished;
+			m_condition.notify_all();
+		}
+		pEvaluator->pApp = nullptr;
+		lock.unlock();
+		app.endSimulation();
+	}
+	catch (std::exception& e)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		pEvaluator->pApp = nullptr;
+		pEvaluator->error = e.what();
+		pEvaluator->state = EvaluatorState::Failed;
+		m_condition.notify_all();
+	}
+}
+
+bool ParallelEvaluator::mergeFinishedEvaluations()
+{
+	bool bEvaluating = false;
+	for (Evaluator* pEvaluator : m_evaluators)
+	{
+		if (pEvaluator->state == EvaluatorState::Finished)
+		{
+			m_pApp->pLogger->mergeEvaluation(pEvaluator->evaluationIndex, pEvaluator->records
+				, pEvaluator->evaluationMessage, pEvaluator->evaluationAvgReward);
+			pEvaluator->state = EvaluatorState::Idle;
+		}
+		else if (pEvaluator->state == EvaluatorState::Failed)
+			Logger::logMessage(MessageType::Error, ("Evaluator: " + pEvaluator->error).c_str());
+		else if (pEvaluator->state == EvaluatorState::Evaluating)
+			bEvaluating = true;
+	}
+	return bEvaluating;
+}
+
+void ParallelEvaluator::evaluate(unsigned int evaluationIndex)
+{
+	unique_lock<mutex> lock(m_mutex);
+	Evaluator* pIdleEvaluator = nullptr;
+	while (!pIdleEvaluator)
+	{
+		mergeFinishedEvaluations();
+		for (Evaluator* pEvaluator : m_evaluators)
+		{
+			if (pEvaluator->state == EvaluatorState::Idle)
+			{
+				pIdleEvaluator = pEvaluator;
+				break;
+			}
+		}
+		if (!pIdleEvaluator)
+			m_condition.wait(lock);
+	}
+
+	//snapshot of the weights learned so far, including the updates of multi-output functions not yet applied. The
+	//evaluator doesn't access them while it's idle
+	LinearStateMultiVFA::applyPendingUpdates(m_pApp->pMemManager);
+	pIdleEvaluator->pApp->pMemManager->copyValues(m_pApp->pMemManager);
+	pIdleEvaluator->evaluationIndex = evaluationIndex;
+	pIdleEvaluator->records.clear();
+	pIdleEvaluator->evaluationMessage.clear();
+	pIdleEvaluator->state = EvaluatorState::Evaluating;
+	m_pApp->pLogger->reserveEvaluation(evaluationIndex);
+	m_condition.notify_all();
+}
+
+void ParallelEvaluator::mergeResults()
+{
+	lock_guard<mutex> lock(m_mutex);
+	mergeFinishedEvaluations();
+}
+
+void ParallelEvaluator::finish()
+{
+	unique_lock<mutex> lock(m_mutex);
+	while (mergeFinishedEvaluations())
+		m_condition.wait(lock);
+}
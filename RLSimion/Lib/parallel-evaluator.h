@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+class SimionApp;
+class ConfigNode;
+
+//Parallel evaluations (Evaluation-Threads > 0): instead of stopping training while the episodes of an evaluation are
+//run, the evaluation is handed to an evaluator thread and training goes on. Each evaluator runs its own app built from
+//the same configuration (with its own world, simions...), and the weights of the training app are copied to it when
+//an evaluation begins, so that it evaluates the policy learned up to that point. The records of the evaluation episodes
+//are merged into the log of the training app in episode order, and evaluations are reported in order too.
+//Only the weights held in memory buffers (linear VFAs) are copied: deep VFAs are not supported
+class ParallelEvaluator
+{
+	enum class EvaluatorState { Loading, Idle, Evaluating, Finished, Failed };
+	struct Evaluator
+	{
+		EvaluatorState state = EvaluatorState::Loading;
+		thread evaluatorThread;
+		SimionApp* pApp = nullptr;
+		unsigned int evaluationIndex = 0;
+		vector<char> records;
+		string evaluationMessage;
+		double evaluationAvgReward = 0.0;
+		string error;
+	};
+
+	SimionApp* m_pApp;
+	string m_configuration;
+	vector<Evaluator*> m_evaluators;
+
+	mutex m_mutex;
+	condition_variable m_condition;
+	bool m_bExit = false;
+
+	void runEvaluator(Evaluator* pEvaluator);
+	//Waits until the evaluators finish the evaluation they are running and destroys them
+	void stopEvaluators();
+	//Must be called with the mutex locked. Returns whether any evaluation is still being run
+	bool mergeFinishedEvaluations();
+public:
+	//pConfigRoot: the configuration of the training app
+	ParallelEvaluator(SimionApp* pApp, ConfigNode* pConfigRoot, unsigned int numThreads);
+	virtual ~ParallelEvaluator();
+
+	//Begins an evaluation with the current weights. If all the evaluators are busy, it waits until one is free
+	void evaluate(unsigned int evaluationIndex);
+	//Merges the results of the evaluations finished so far into the training app's log
+	void mergeResults();
+	//Waits until all the evaluations have finished and merges their results
+	void finish();
+};
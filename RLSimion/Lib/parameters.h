@@ -13,6 +13,10 @@ using namespace std;
 enum class Distribution { linear, quadratic, cubic };
 enum class Interpolation { linear, quadratic, cubic };
 enum class TimeReference { episode, experiment };
+enum class LogBufferFullPolicy { block, drop };
+enum class FunctionLogEncoding { full, delta };
+enum class WeightPrecision { float64, float32, float16, bfloat16 };
+enum class VideoFormat { y4m, ppm };
 
 template<typename DataType>
 class SimpleParam
@@ -89,6 +93,66 @@ protected:
 		}
 		value = m_default;
 	}
+	void initValue(ConfigNode* pConfigNode, LogBufferFullPolicy& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name);
+		if (strValue && !strcmp(strValue, "block"))
+		{
+			value = LogBufferFullPolicy::block; return;
+		}
+		else if (strValue && !strcmp(strValue, "drop"))
+		{
+			value = LogBufferFullPolicy::drop; return;
+		}
+		value = m_default;
+	}
+	void initValue(ConfigNode* pConfigNode, FunctionLogEncoding& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name);
+		if (strValue && !strcmp(strValue, "full"))
+		{
+			value = FunctionLogEncoding::full; return;
+		}
+		else if (strValue && !strcmp(strValue, "delta"))
+		{
+			value = FunctionLogEncoding::delta; return;
+		}
+		value = m_default;
+	}
+	void initValue(ConfigNode* pConfigNode, WeightPrecision& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name);
+		if (strValue && !strcmp(strValue, "float64"))
+		{
+			value = WeightPrecision::float64; return;
+		}
+		else if (strValue && !strcmp(strValue, "float32"))
+		{
+			value = WeightPrecision::float32; return;
+		}
+		else if (strValue && !strcmp(strValue, "float16"))
+		{
+			value = WeightPrecision::float16; return;
+		}
+		else if (strValue && !strcmp(strValue, "bfloat16"))
+		{
+			value = WeightPrecision::bfloat16; return;
+		}
+		value = m_default;
+	}
+	void initValue(ConfigNode* pConfigNode, VideoFormat& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name);
+		if (strValue && !strcmp(strValue, "y4m"))
+		{
+			value = VideoFormat::y4m; return;
+		}
+		else if (strValue && !strcmp(strValue, "ppm"))
+		{
+			value = VideoFormat::ppm; return;
+		}
+		value = m_default;
+	}
 public:
 	SimpleParam() = default;
 	SimpleParam(ConfigNode* pConfigNode
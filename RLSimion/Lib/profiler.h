@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+//Scoped timer used to profile the phases of the step loop: on destruction, it sets the variable given with the time
+//(in microseconds) elapsed since its construction. The variables are added to the logger's stats (see
+//Logger::addProfiledSection()), so the avg/min/max/std.dev. of each phase are logged with the rest of the stats.
+//A null variable (profiling disabled) makes the timer do nothing. Defining RLSIMION_NO_PROFILER removes the timers
+class ProfilerTimer
+{
+	double* m_pElapsedTime;
+	std::chrono::steady_clock::time_point m_start;
+public:
+	ProfilerTimer(double* pElapsedTime) : m_pElapsedTime(pElapsedTime)
+	{
+		if (m_pElapsedTime)
+			m_start = std::chrono::steady_clock::now();
+	}
+	~ProfilerTimer()
+	{
+		if (m_pElapsedTime)
+			*m_pElapsedTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_start).count();
+	}
+};
+
+#ifdef RLSIMION_NO_PROFILER
+#define PROFILE_SCOPE(pElapsedTime)
+#else
+#define PROFILE_SCOPE_NAME(line) profilerTimer##line
+#define PROFILE_SCOPE_TIMER(pElapsedTime, line) ProfilerTimer PROFILE_SCOPE_NAME(line)(pElapsedTime)
+#define PROFILE_SCOPE(pElapsedTime) PROFILE_SCOPE_TIMER(pElapsedTime, __LINE__)
+#endif
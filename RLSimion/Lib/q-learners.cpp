@@ -75,7 +75,7 @@ double QEGreedyPolicy::selectAction(LinearStateActionVFA* pQFunction, const Stat
 	else
 	{
 		size_t numActionWeights= pQFunction->getNumActionWeights();
-		size_t randomActionWeight = rand() % numActionWeights;
+		size_t randomActionWeight = getRandomIndex(numActionWeights);
 		pQFunction->getActionFeatureMap()->getFeatureStateAction(randomActionWeight, (State*) s, a);
 		return 1.0 / (double) numActionWeights;
 	}
@@ -0,0 +1,311 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "render-thread.h"
+#include "app.h"
+#include "logger.h"
+#include "stats.h"
+#include "experiment.h"
+#include "worlds/world.h"
+#include "function-sampler.h"
+#include "../Common/named-var-set.h"
+#include "../Common/wire.h"
+#include "../../tools/OpenGLRenderer/basic-shapes-2d.h"
+#include "../../tools/OpenGLRenderer/renderer.h"
+#include "../../tools/OpenGLRenderer/text.h"
+#include "../../tools/OpenGLRenderer/input-handler.h"
+#include "../../tools/OpenGLRenderer/arranger.h"
+#include "../../tools/System/FileUtils.h"
+#include "../../tools/System/Timer.h"
+#include <chrono>
+
+RenderThread::RenderThread(SimionApp* pApp, string sceneFile, const vector<FunctionSampler*>& functionSamplers
+	, size_t numSamplesPerDim, double targetFPS)
+{
+	m_pApp = pApp;
+	m_sceneFile = sceneFile;
+	m_pFunctionSamplers = functionSamplers;
+	m_numSamplesPerDim = numSamplesPerDim;
+	m_targetFPS = targetFPS > 0.0 ? targetFPS : 60.0;
+
+	//the descriptors, the stats and the samplers are only accessed from the simulation thread
+	for (unsigned int i = 0; i < pApp->pLogger->getNumStats(); ++i)
+		m_statMeters.push_back({ pApp->pLogger->getStats(i)->getSubkey(), 0.0, 1.0 });
+	Descriptor& stateDescriptor = World::getDynamicModel()->getStateDescriptor();
+	for (size_t i = 0; i < stateDescriptor.size(); ++i)
+		m_stateMeters.push_back({ stateDescriptor[i].getName(), stateDescriptor[i].getMin(), stateDescriptor[i].getMax() });
+	Descriptor& actionDescriptor = World::getDynamicModel()->getActionDescriptor();
+	for (size_t i = 0; i < actionDescriptor.size(); ++i)
+		m_actionMeters.push_back({ actionDescriptor[i].getName(), actionDescriptor[i].getMin(), actionDescriptor[i].getMax() });
+	for (FunctionSampler* pSampler : m_pFunctionSamplers)
+		m_functionViews.push_back(make_pair(pSampler->getFunctionId(), pSampler->getNumSamplesY() > 1));
+
+	m_renderThread = thread([this]() { render(); });
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_bLoaded; });
+	}
+	if (!m_loadError.empty())
+		stop(m_loadError);
+	if (!m_bSceneLoaded)
+		return;
+
+	//bindings are resolved once instead of looking up their names every step
+	for (const string& name : m_bindingNames)
+	{
+		BoundVariable variable = { 0, nullptr };
+		size_t i = 0;
+		while (i < stateDescriptor.size() && name != stateDescriptor[i].getName())
+			++i;
+		if (i < stateDescriptor.size())
+			variable.stateIndex = i;
+		else
+		{
+			variable.pWire = pApp->wireGet(name);
+			if (!variable.pWire)
+				stop("The scene is bound to an unknown variable: " + name);
+		}
+		m_boundVariables.push_back(variable);
+	}
+}
+
+void RenderThread::stop(const string& error)
+{
+	//the destructor won't be called
+	m_bExit = true;
+	m_renderThread.join();
+	throw std::runtime_error(error.c_str());
+}
+
+RenderThread::~RenderThread()
+{
+	m_bExit = true;
+	if (m_renderThread.joinable())
+		m_renderThread.join();
+}
+
+bool RenderThread::loadScene()
+{
+	char arguments[] = "RLSimion";
+	char* argv = arguments;
+
+	//initialize the render if a scene file can be found
+	string sceneDir = "../config/scenes/";
+	if (!bFileExists(sceneDir + m_sceneFile))
+		return false;
+
+	m_pRenderer = new Renderer();
+	m_pRenderer->init(1, &argv, 800, 600);
+
+	//resize the main viewport
+	double mainViewPortMinX = 0.0, mainViewPortMinY = 0.3, mainViewPortMaxX = 0.7, mainViewPortMaxY = 1.0;
+	ViewPort* pMainViewPort = m_pRenderer->getDefaultViewPort();
+	pMainViewPort->resize(mainViewPortMinX, mainViewPortMinY, mainViewPortMaxX, mainViewPortMaxY);
+	m_pRenderer->setDataFolder(sceneDir);
+	m_pRenderer->loadScene(m_sceneFile.c_str());
+
+	//text
+	m_pProgressText = new Text2D(string("Progress"), Vector2D(0.05, 0.95), 0.25);
+	m_pRenderer->add2DGraphicObject(m_pProgressText);
+
+	//create a second viewport for stats, state variables and action variables
+	double metersViewPortMinX = mainViewPortMaxX, metersViewPortMinY = mainViewPortMinY, metersViewPortMaxX = 1.0, metersViewPortMaxY = 1.0;
+	ViewPort* pMetersViewPort = m_pRenderer->addViewPort(metersViewPortMinX, metersViewPortMinY, metersViewPortMaxX, metersViewPortMaxY);
+
+	Vector2D origin = Vector2D(0.025, 0.9);
+	Vector2D size = Vector2D(0.95, 0.04);
+	Vector2D offset = Vector2D(0.0, 0.05);
+	double depth = 0.25;
+	auto addMeters = [&](const vector<MeterInfo>& meters, vector<Meter2D*>& uiMeters, bool bSetRange)
+	{
+		for (const MeterInfo& meter : meters)
+		{
+			Meter2D* pMeter2D = new Meter2D(meter.name, origin, size, depth);
+			if (bSetRange)
+				pMeter2D->setValueRange(Range(meter.min, meter.max));
+			uiMeters.push_back(pMeter2D);
+			m_pRenderer->add2DGraphicObject(pMeter2D, pMetersViewPort);
+			origin -= offset;
+		}
+	};
+	//the range of the stats is updated with every snapshot
+	addMeters(m_statMeters, m_pStatsUIMeters, false);
+	addMeters(m_stateMeters, m_pStateUIMeters, true);
+	addMeters(m_actionMeters, m_pActionUIMeters, true);
+
+	//function viewers
+	if (m_functionViews.size())
+	{
+		ViewPort* functionViewPort = new ViewPort(0.0, 0.0, 1.0, mainViewPortMinY);
+		m_pRenderer->addViewPort(functionViewPort);
+		vector<GraphicObject2D*> objects;
+		for (const pair<string, bool>& functionView : m_functionViews)
+		{
+			//depending on the dimensions, we create a 3d viewer or a 2d viewer
+			FunctionViewer* pFunctionViewer;
+			if (functionView.second)
+				pFunctionViewer = new FunctionViewer3D(functionView.first, Vector2D(0.0, 0.0), Vector2D(0.0, 0.0), m_numSamplesPerDim, 0.25);
+			else
+				pFunctionViewer = new FunctionViewer2D(functionView.first, Vector2D(0.0, 0.0), Vector2D(0.0, 0.0), m_numSamplesPerDim, 0.25);
+
+			m_pFunctionViewers.push_back(pFunctionViewer);
+			m_pRenderer->add2DGraphicObject(pFunctionViewer, functionViewPort);
+			objects.push_back(pFunctionViewer);
+		}
+
+		Arranger objectArranger;
+		objectArranger.arrange2DObjects(objects, Vector2D(0.0, 0.0), Vector2D(1.0, 1.0), Vector2D(0.15, 0.25)
+			, Vector2D(0.20, 1.0), Vector2D(0.0075, 0.06));
+
+		objectArranger.tag2DObjects(objects, functionViewPort);
+	}
+
+	m_pInputHandler = new FreeCameraInputHandler();
+
+	for (unsigned int b = 0; b < m_pRenderer->getNumBindings(); ++b)
+		m_bindingNames.push_back(m_pRenderer->getBindingExternalName(b));
+	return true;
+}
+
+void RenderThread::render()
+{
+	bool bSceneLoaded = false;
+	string error;
+	try
+	{
+		bSceneLoaded = loadScene();
+	}
+	catch (std::exception& e)
+	{
+		error = e.what();
+	}
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_bLoaded = true;
+		m_bSceneLoaded = bSceneLoaded;
+		m_loadError = error;
+	}
+	m_condition.notify_all();
+
+	if (bSceneLoaded)
+	{
+		Timer frameTimer;
+		double framePeriod = 1.0 / m_targetFPS;
+		while (!m_bExit)
+		{
+			frameTimer.start();
+
+			m_pInputHandler->handleInput();
+			if (m_snapshots.update())
+				drawSnapshot(m_snapshots.getFront());
+			if (m_functionSamples.update())
+			{
+				const vector<vector<double>>& samples = m_functionSamples.getFront();
+				for (size_t i = 0; i < samples.size() && i < m_pFunctionViewers.size(); ++i)
+					m_pFunctionViewers[i]->update(samples[i]);
+			}
+			m_pRenderer->draw();
+
+			//wait until the next frame is due
+			double remainingTime = framePeriod - frameTimer.getElapsedTime();
+			if (remainingTime > 0.0)
+				this_thread::sleep_for(chrono::duration<double>(remainingTime));
+		}
+	}
+
+	//the OpenGL context belongs to this thread
+	delete m_pInputHandler;
+	delete m_pRenderer;
+	m_pInputHandler = nullptr;
+	m_pRenderer = nullptr;
+}
+
+void RenderThread::drawSnapshot(const Snapshot& snapshot)
+{
+	m_pProgressText->set(string("Episode: ") + std::to_string(snapshot.episode)
+		+ string(" Step: ") + std::to_string(snapshot.step));
+
+	//2D meters
+	for (size_t i = 0; i < m_pStatsUIMeters.size(); ++i)
+	{
+		m_pStatsUIMeters[i]->setValue(snapshot.statValues[i]);
+		m_pStatsUIMeters[i]->setValueRange(Range(snapshot.statMins[i], snapshot.statMaxs[i]));
+	}
+	for (size_t i = 0; i < m_pStateUIMeters.size(); ++i)
+		m_pStateUIMeters[i]->setValue(snapshot.stateValues[i]);
+	for (size_t i = 0; i < m_pActionUIMeters.size(); ++i)
+		m_pActionUIMeters[i]->setValue(snapshot.actionValues[i]);
+
+	//2D/3D bound properties: translation, rotation, ...
+	for (unsigned int b = 0; b < snapshot.bindingValues.size(); ++b)
+		m_pRenderer->updateBinding(b, snapshot.bindingValues[b]);
+}
+
+void RenderThread::update(const State* s, const Action* a)
+{
+	if (!m_bSceneLoaded)
+		return;
+
+	Snapshot& snapshot = m_snapshots.getBack();
+	snapshot.episode = m_pApp->pExperiment->getEpisodeIndex();
+	snapshot.step = m_pApp->pExperiment->getStep();
+
+	snapshot.stateValues.resize(s->getNumVars());
+	for (size_t i = 0; i < s->getNumVars(); ++i)
+		snapshot.stateValues[i] = s->get(i);
+	snapshot.actionValues.resize(a->getNumVars());
+	for (size_t i = 0; i < a->getNumVars(); ++i)
+		snapshot.actionValues[i] = a->get(i);
+
+	size_t numStats = m_statMeters.size();
+	snapshot.statValues.resize(numStats);
+	snapshot.statMins.resize(numStats);
+	snapshot.statMaxs.resize(numStats);
+	for (unsigned int i = 0; i < numStats; ++i)
+	{
+		IStats* pStat = m_pApp->pLogger->getStats(i);
+		snapshot.statValues[i] = pStat->get();
+		snapshot.statMins[i] = pStat->getStatsInfo()->getMin();
+		snapshot.statMaxs[i] = pStat->getStatsInfo()->getMax();
+	}
+
+	snapshot.bindingValues.resize(m_boundVariables.size());
+	for (size_t b = 0; b < m_boundVariables.size(); ++b)
+	{
+		const BoundVariable& variable = m_boundVariables[b];
+		snapshot.bindingValues[b] = variable.pWire ? variable.pWire->getValue() : s->get(variable.stateIndex);
+	}
+	m_snapshots.publish();
+
+	//the functions are sampled by the simulation thread, which owns them, every m_functionSampleStepFreq steps
+	if (m_pFunctionSamplers.size() && (m_pApp->pExperiment->getExperimentStep() - 1) % m_functionSampleStepFreq == 0)
+	{
+		vector<vector<double>>& samples = m_functionSamples.getBack();
+		samples.resize(m_pFunctionSamplers.size());
+		for (size_t i = 0; i < m_pFunctionSamplers.size(); ++i)
+			samples[i] = m_pFunctionSamplers[i]->sample();
+		m_functionSamples.publish();
+	}
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+using namespace std;
+
+class SimionApp;
+class NamedVarSet;
+typedef NamedVarSet State;
+typedef NamedVarSet Action;
+class Wire;
+class FunctionSampler;
+class Renderer;
+class IInputHandler;
+class Text2D;
+class Meter2D;
+class FunctionViewer;
+
+//Lock-free triple buffer with a single writer and a single reader. The writer fills the back buffer and publishes it,
+//the reader takes the last buffer published. Neither ever waits for the other: buffers published before the reader
+//takes them are simply dropped
+template <typename T>
+class TripleBuffer
+{
+	static const unsigned int FRESH = 4; //set in m_ready if it holds a buffer the reader hasn't taken yet
+
+	T m_buffers[3];
+	unsigned int m_back = 0;
+	unsigned int m_front = 1;
+	atomic<unsigned int> m_ready{ 2 };
+public:
+	//writer
+	T& getBack() { return m_buffers[m_back]; }
+	void publish() { m_back = m_ready.exchange(m_back | FRESH) & ~FRESH; }
+
+	//reader. Returns whether a new buffer was taken
+	bool update()
+	{
+		if (!(m_ready.load() & FRESH))
+			return false;
+		m_front = m_ready.exchange(m_front) & ~FRESH;
+		return true;
+	}
+	const T& getFront() const { return m_buffers[m_front]; }
+};
+
+//Local mode (-local): the scene is drawn by its own thread at a fixed frame rate, so that the simulation runs at full
+//speed instead of waiting for the window every step. After every step, the simulation thread publishes a snapshot of the
+//state, action and stats, and every few steps a new sample of the functions drawn. The render thread owns the renderer
+//and the OpenGL context: it draws the last snapshot published and handles the input
+class RenderThread
+{
+	//what the simulation thread publishes
+	struct Snapshot
+	{
+		unsigned int episode = 0;
+		unsigned int step = 0;
+		vector<double> stateValues;
+		vector<double> actionValues;
+		vector<double> statValues;
+		vector<double> statMins;
+		vector<double> statMaxs;
+		vector<double> bindingValues;
+	};
+	TripleBuffer<Snapshot> m_snapshots;
+	TripleBuffer<vector<vector<double>>> m_functionSamples;
+
+	//simulation thread: the source of the bindings of the scene, resolved once (a state variable or a wire)
+	struct BoundVariable
+	{
+		size_t stateIndex;
+		Wire* pWire;
+	};
+	SimionApp* m_pApp;
+	vector<BoundVariable> m_boundVariables;
+	vector<FunctionSampler*> m_pFunctionSamplers;
+	const unsigned int m_functionSampleStepFreq = 100;
+
+	//what the render thread needs to build the scene, copied before it starts
+	struct MeterInfo
+	{
+		string name;
+		double min;
+		double max;
+	};
+	string m_sceneFile;
+	vector<MeterInfo> m_statMeters;
+	vector<MeterInfo> m_stateMeters;
+	vector<MeterInfo> m_actionMeters;
+	vector<pair<string, bool>> m_functionViews; //function id and whether it has two inputs (3D view)
+	size_t m_numSamplesPerDim;
+	double m_targetFPS;
+
+	//render thread
+	thread m_renderThread;
+	atomic<bool> m_bExit{ false };
+	Renderer* m_pRenderer = nullptr;
+	IInputHandler* m_pInputHandler = nullptr;
+	Text2D* m_pProgressText = nullptr;
+	vector<Meter2D*> m_pStatsUIMeters;
+	vector<Meter2D*> m_pStateUIMeters;
+	vector<Meter2D*> m_pActionUIMeters;
+	vector<FunctionViewer*> m_pFunctionViewers; //in the same order as the samplers
+
+	//the scene is loaded by the render thread before the simulation begins, because the bindings come from the scene
+	mutex m_mutex;
+	condition_variable m_condition;
+	bool m_bLoaded = false;
+	bool m_bSceneLoaded = false;
+	string m_loadError;
+	vector<string> m_bindingNames;
+	//stops the render thread and throws an exception. Only used by the constructor
+	void stop(const string& error);
+
+	void render();
+	bool loadScene();
+	void drawSnapshot(const Snapshot& snapshot);
+public:
+	//Loads the scene (sceneFile is relative to the scenes folder) and begins drawing it. The function samplers are
+	//owned by the app and only used by the simulation thread
+	RenderThread(SimionApp* pApp, string sceneFile, const vector<FunctionSampler*>& functionSamplers
+		, size_t numSamplesPerDim, double targetFPS);
+	virtual ~RenderThread();
+
+	//false if the scene file couldn't be found. Nothing will be drawn then
+	bool isRunning() const { return m_bSceneLoaded; }
+
+	//Called by the simulation thread after every step
+	void update(const State* s, const Action* a);
+};
@@ -33,19 +33,40 @@
 
 #include <math.h>
 #include <algorithm>
+#include <string.h>
+
+void RewardVariable::resolve(Descriptor& descriptor)
+{
+	for (size_t i = 0; i < descriptor.size(); ++i)
+	{
+		if (!strcmp(descriptor[i].getName(), m_name.c_str()))
+		{
+			m_index = i;
+			m_bResolved = true;
+			return;
+		}
+	}
+	m_bResolved = false;
+}
 
 ToleranceRegionReward::ToleranceRegionReward(string variable, double tolerance, double scale)
+	: m_variable(variable.c_str())
 {
 	m_name= "r/(" + variable + ")";
-	m_pVariableName = variable.c_str();
 	m_tolerance = tolerance;
 	m_scale = scale;
 }
+
+void ToleranceRegionReward::initialize(Descriptor& stateDescriptor, Descriptor&)
+{
+	m_variable.resolve(stateDescriptor);
+}
+
 double ToleranceRegionReward::getReward(const State *s, const Action* a, const State *s_p)
 {
 	double rew, error;
 
-	error = s_p->get(m_pVariableName.c_str());
+	error = m_variable.get(s_p);
 
 	error = (error) / m_tolerance;
 
@@ -59,7 +80,8 @@ double ToleranceRegionReward::getReward(const State *s, const Action* a, const S
 const char* ToleranceRegionReward::getName(){ return m_name.c_str(); }
 
 
-RewardFunction::RewardFunction()
+RewardFunction::RewardFunction(Descriptor& stateDescriptor, Descriptor& actionDescriptor)
+	: m_stateDescriptor(stateDescriptor), m_actionDescriptor(actionDescriptor)
 {
 	m_bInitialized = false;
 }
@@ -86,14 +108,15 @@ double RewardFunction::getReward(const State* s, const Action* a, const State* s
 		return m_overrideValue;
 	}
 
+	//the vector holds each component clamped to its range (as NamedVarSet::set() would), the scalar reward is the sum of the
+	//unclamped values
 	double reward = 0.0, r_i;
-	int i = 0;
-	for (auto it = m_rewardComponents.begin(); it != m_rewardComponents.end(); ++it)
+	double* pRewardValues = m_pRewardVector->getValueVector();
+	for (size_t i = 0; i < m_rewardComponents.size(); ++i)
 	{
-		r_i = (*it)->getReward(s, a, s_p);
-		m_pRewardVector->set(i, r_i);
+		r_i = m_rewardComponents[i]->getReward(s, a, s_p);
+		pRewardValues[i] = std::min(m_componentMax[i], std::max(m_componentMin[i], r_i));
 		reward += r_i;
-		++i;
 	}
 	return reward;
 }
@@ -115,6 +138,9 @@ void RewardFunction::initialize()
 		for (unsigned int i= 0; i<numComponents; ++i)
 		{
 			m_pRewardVector->getProperties(i)->setName(m_rewardComponents[i]->getName());
+			m_componentMin.push_back(m_rewardComponents[i]->getMin());
+			m_componentMax.push_back(m_rewardComponents[i]->getMax());
+			m_rewardComponents[i]->initialize(m_stateDescriptor, m_actionDescriptor);
 		}
 		
 		m_bInitialized = true;
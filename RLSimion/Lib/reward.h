@@ -8,11 +8,31 @@
 using namespace std;
 class ConfigNode;
 
+//A variable read by a reward component. It is resolved to its index in the descriptor by RewardFunction::initialize(),
+//so that the value is read by index in each step. Variables not found in the descriptor (i.e., wires) are read by name
+class RewardVariable
+{
+	string m_name;
+	size_t m_index = 0;
+	bool m_bResolved = false;
+public:
+	RewardVariable(const char* name) : m_name(name) {}
+
+	void resolve(Descriptor& descriptor);
+	const char* getName() const { return m_name.c_str(); }
+	double get(const NamedVarSet* pValues) const
+	{
+		return m_bResolved ? pValues->get(m_index) : pValues->get(m_name.c_str());
+	}
+};
+
 class IRewardComponent
 {
 public:
 	IRewardComponent() = default;
 	virtual ~IRewardComponent()= default;
+	//Called once by RewardFunction::initialize(): components should resolve here the variables they use
+	virtual void initialize(Descriptor&, Descriptor&) {}
 	virtual double getReward(const State *s, const Action* a, const State *s_p) = 0;
 	virtual const char* getName()= 0;
 	virtual double getMin() = 0;
@@ -23,7 +43,7 @@ public:
 class ToleranceRegionReward: public IRewardComponent
 {
 	string m_name;
-	string m_pVariableName;
+	RewardVariable m_variable;
 	double m_tolerance;
 	double m_scale;
 	double m_lastReward;
@@ -33,6 +53,7 @@ public:
 	double m_maxReward = 1.0;
 
 	ToleranceRegionReward(string variable, double tolerance, double scale);
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action* a, const State *s_p);
 	const char* getName();
 	double getMin() { return m_minReward; }
@@ -45,8 +66,14 @@ class RewardFunction
 {
 	std::vector<IRewardComponent*> m_rewardComponents;
 
+	Descriptor& m_stateDescriptor;
+	Descriptor& m_actionDescriptor;
+
 	Descriptor rewardDescriptor;
 	Reward* m_pRewardVector;
+	//value range of each component, cached to clamp the values written in the reward vector
+	std::vector<double> m_componentMin;
+	std::vector<double> m_componentMax;
 	bool m_bInitialized;
 
 	bool m_bOverride = false;
@@ -54,12 +81,16 @@ class RewardFunction
 public:
 
 	void addRewardComponent(IRewardComponent *rewardComponent);
+	//Creates the reward vector and resolves the variables used by the components. Must be called after all the
+	//state and action variables have been added to the descriptors
 	void initialize();
 
-	RewardFunction();
+	RewardFunction(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	virtual ~RewardFunction();
 
 	Reward* getRewardVector();
+	//Evaluates all the components in a single pass: each one is written in the reward vector and the scalar reward
+	//(their sum) is returned
 	double getReward(const State *s, const Action *a, const State *s_p);
 	
 	//This method can be used to, instead of calculating the next reward, return the given value
@@ -35,11 +35,13 @@
 #include "experience-replay.h"
 #include "parameters.h"
 #include "features.h"
+#include "logger.h"
+#include "profiler.h"
 #include <algorithm>
 
-std::vector<std::pair<DeferredLoad*, unsigned int>> SimGod::m_deferredLoadSteps;
-CHILD_OBJECT<StateFeatureMap> SimGod::m_pGlobalStateFeatureMap;
-CHILD_OBJECT<ActionFeatureMap> SimGod::m_pGlobalActionFeatureMap;
+thread_local std::vector<std::pair<DeferredLoad*, unsigned int>> SimGod::m_deferredLoadSteps;
+thread_local CHILD_OBJECT<StateFeatureMap> SimGod::m_pGlobalStateFeatureMap;
+thread_local CHILD_OBJECT<ActionFeatureMap> SimGod::m_pGlobalActionFeatureMap;
 
 SimGod::SimGod(ConfigNode* pConfigNode)
 {
@@ -50,6 +52,8 @@ SimGod::SimGod(ConfigNode* pConfigNode)
 	m_pGlobalActionFeatureMap = CHILD_OBJECT<ActionFeatureMap>(pConfigNode, "Action-Feature-Map", "The state feature map", true);
 	m_pExperienceReplay = CHILD_OBJECT<ExperienceReplay>(pConfigNode, "Experience-Replay", "The experience replay parameters", true);
 	m_simions = MULTI_VALUE_FACTORY<Simion>(pConfigNode, "Simion", "Simions: learning agents and controllers");
+	for (size_t i = 0; i < m_simions.size(); i++)
+		m_simionUpdateTimes.push_back(SimionApp::get()->pLogger->addProfiledSection("Simion-" + to_string(i) + "/update"));
 
 	//Gamma is global: it is considered a parameter of the problem, not the learning algorithm
 	m_gamma = DOUBLE_PARAM(pConfigNode, "Gamma", "Gamma parameter", 0.9);
@@ -62,6 +66,8 @@ SimGod::SimGod(ConfigNode* pConfigNode)
 
 SimGod::~SimGod()
 {
+	//the objects registered belong to this instance: don't let them be loaded again by another SimionApp
+	m_deferredLoadSteps.clear();
 }
 
 
@@ -83,30 +89,32 @@ void SimGod::update(State* s, Action* a, State* s_p, double r, double probabilit
 
 	//update step
 	for (unsigned int i = 0; i < m_simions.size(); i++)
+	{
+		PROFILE_SCOPE(m_simionUpdateTimes[i]);
 		m_simions[i]->update(s, a, s_p, r, probability);
+	}
 
 	if (m_pExperienceReplay->bUsing())
-		m_pExperienceReplay->addTuple(s, a, s_p, r, probability);
+		m_pExperienceReplay->addTuple(s, a, s_p, r, probability, SimionApp::get()->pExperiment->isLastStep());
 }
 
 void SimGod::postUpdate()
 {
-	ExperienceTuple* pExperienceTuple;
-
 	//Experience Replay
 	if (m_pExperienceReplay->bUsing() && m_pExperienceReplay->bHaveEnoughTuples())
 	{
 		m_bReplayingExperience = true;
 
-		size_t updateBatchSize = m_pExperienceReplay->getUpdateBatchSize();
-		for (size_t tuple = 0; tuple < updateBatchSize; ++tuple)
+		//each replayed tuple <s_t,a_t,s_{t+n},G> is learned as a one-step tuple discounted by gamma^n (see getGamma())
+		const std::vector<ReplayedTuple>& batch = m_pExperienceReplay->sampleBatch(m_gamma.get());
+		for (const ReplayedTuple& replayedTuple : batch)
 		{
-			pExperienceTuple = m_pExperienceReplay->getRandomTupleFromBuffer();
+			m_replayedTupleDiscount = replayedTuple.discount;
 
 			//update step
 			for (size_t i = 0; i < m_simions.size(); i++)
-				m_simions[i]->update(pExperienceTuple->s, pExperienceTuple->a, pExperienceTuple->s_p
-					, pExperienceTuple->r, pExperienceTuple->probability);
+				m_simions[i]->update(replayedTuple.pTuple->s, replayedTuple.pTuple->a, replayedTuple.s_n
+					, replayedTuple.nStepReturn, replayedTuple.pTuple->probability);
 		}
 	}
 }
@@ -116,6 +124,13 @@ void SimGod::registerDeferredLoadStep(DeferredLoad* deferredLoadObject, unsigned
 	m_deferredLoadSteps.push_back(std::pair<DeferredLoad*, unsigned int>(deferredLoadObject, orderLoad));
 }
 
+void SimGod::unregisterDeferredLoadStep(DeferredLoad* deferredLoadObject)
+{
+	m_deferredLoadSteps.erase(std::remove_if(m_deferredLoadSteps.begin(), m_deferredLoadSteps.end()
+		, [deferredLoadObject](const std::pair<DeferredLoad*, unsigned int>& step) { return step.first == deferredLoadObject; })
+		, m_deferredLoadSteps.end());
+}
+
 bool myComparison(const std::pair<DeferredLoad*, unsigned int> &a, const std::pair<DeferredLoad*, unsigned int> &b)
 {
 	return a.second < b.second;
@@ -144,6 +159,8 @@ std::shared_ptr<ActionFeatureMap> SimGod::getGlobalActionFeatureMap()
 
 double SimGod::getGamma()
 {
+	if (m_bReplayingExperience)
+		return m_replayedTupleDiscount;
 	return m_gamma.get();
 }
 
@@ -20,10 +20,11 @@ class FeatureList;
 //Some members are declared static because they are requested by children before the SimGod object is actually constructed
 class SimGod
 {
-	static CHILD_OBJECT<StateFeatureMap> m_pGlobalStateFeatureMap;
-	static CHILD_OBJECT<ActionFeatureMap> m_pGlobalActionFeatureMap;
+	static thread_local CHILD_OBJECT<StateFeatureMap> m_pGlobalStateFeatureMap;
+	static thread_local CHILD_OBJECT<ActionFeatureMap> m_pGlobalActionFeatureMap;
 
 	bool m_bReplayingExperience= false;
+	double m_replayedTupleDiscount= 1.0; //gamma^n of the n-step tuple being replayed
 
 	MULTI_VALUE_FACTORY<Simion> m_simions;
 	
@@ -36,9 +37,12 @@ class SimGod
 	Reward *m_pReward;
 
 	//lists that must be initialized before the constructor is actually called
-	static std::vector<std::pair<DeferredLoad*, unsigned int>> m_deferredLoadSteps;
+	static thread_local std::vector<std::pair<DeferredLoad*, unsigned int>> m_deferredLoadSteps;
 
 	CHILD_OBJECT<ExperienceReplay> m_pExperienceReplay;
+
+	//profiled time of each simion's update (nullptr if steps are not profiled)
+	std::vector<double*> m_simionUpdateTimes;
 public:
 	SimGod(ConfigNode* pParameters);
 	SimGod() = default;
@@ -57,6 +61,8 @@ public:
 
 	//delayed load
 	static void registerDeferredLoadStep(DeferredLoad* deferredLoadObject,unsigned int orderLoad);
+	//objects destroyed before the SimGod (i.e., if the construction of the app fails) must not be loaded by the next app
+	static void unregisterDeferredLoadStep(DeferredLoad* deferredLoadObject);
 	void deferredLoad();
 
 	//global feature maps
@@ -64,6 +70,8 @@ public:
 	static std::shared_ptr<ActionFeatureMap> getGlobalActionFeatureMap();
 
 	//global learning parameters
+	//While experience is replayed, the discount of the value of s_p in the tuple being replayed: gamma^n if its reward
+	//is an n-step return
 	double getGamma();
 
 	//Target-Function freeze
@@ -27,6 +27,63 @@
 #include "config.h"
 #include <algorithm>
 #include <fstream>
+#include <math.h>
+
+#define UNIFORM_AXIS_TOLERANCE 1e-9 //relative to the step
+
+void InterpolationAxis::init(const double* pValues, size_t numValues)
+{
+	m_pValues = pValues;
+	m_numValues = numValues;
+	m_bUniform = false;
+	if (numValues < 2)
+		return;
+
+	double step = (pValues[numValues - 1] - pValues[0]) / (numValues - 1);
+	if (step <= 0.0)
+		return;
+	m_bUniform = true;
+	for (size_t i = 1; i < numValues && m_bUniform; ++i)
+	{
+		if (fabs(pValues[i] - pValues[i - 1] - step) > UNIFORM_AXIS_TOLERANCE * step)
+			m_bUniform = false;
+	}
+	m_invStep = 1.0 / step;
+}
+
+size_t InterpolationAxis::getSegment(double value, double& u) const
+{
+	u = 0.0;
+	if (m_numValues < 2)
+		return 0;
+
+	const size_t lastSegment = m_numValues - 2;
+	if (value <= m_pValues[0])
+		return 0;
+	if (value >= m_pValues[m_numValues - 1])
+	{
+		u = 1.0;
+		return lastSegment;
+	}
+
+	size_t index;
+	if (m_bUniform)
+	{
+		index = std::min(lastSegment, (size_t)((value - m_pValues[0]) * m_invStep));
+		//correct rounding errors so that we get the same segment as the binary search
+		if (value < m_pValues[index] && index > 0)
+			--index;
+		else if (value > m_pValues[index + 1] && index < lastSegment)
+			++index;
+	}
+	else
+	{
+		//first point >= value. It can't be the first one, because value > m_pValues[0]
+		index = (size_t)(std::lower_bound(m_pValues, m_pValues + m_numValues, value) - m_pValues) - 1;
+	}
+	u = (value - m_pValues[index]) / (m_pValues[index + 1] - m_pValues[index]);
+	return index;
+}
 
 Table::Table()
 {
@@ -86,6 +143,8 @@ bool Table::readFromFile(string filename)
 
 		if (numRows*numColumns == (int) m_values.size())
 		{
+			m_columnAxis.init(m_columns.data(), m_columns.size());
+			m_rowAxis.init(m_rows.data(), m_rows.size());
 			m_bSuccess = true;
 			return true;
 		}
@@ -96,31 +155,32 @@ bool Table::readFromFile(string filename)
 
 double Table::getInterpolatedValue(double columnValue, double rowValue) const
 {
-	//check column and row values are within the defined ranges
-	columnValue = std::max(m_columns[0], std::min(m_columns[m_columns.size() - 1], columnValue));
-	rowValue = std::max(m_rows[0], std::min(m_rows[m_rows.size() - 1], rowValue));
-
-	//search for the columns/rows where the given values are in
-	int colIndex = 1, rowIndex = 1;
-	while (m_columns[colIndex] < columnValue) ++colIndex;
-	while (m_rows[rowIndex] < rowValue) ++rowIndex;
-	--colIndex;
-	--rowIndex;
-
-	//interpolation factors
-	double colU, rowU, colRange, rowRange;
-	colRange = m_columns[colIndex + 1] - m_columns[colIndex];
-	rowRange = m_rows[rowIndex + 1] - m_rows[rowIndex];
-	colU = (columnValue - m_columns[colIndex]) / colRange;
-	rowU = (rowValue - m_rows[rowIndex]) / rowRange;
+	//values outside the table are clamped to its ranges
+	double colU, rowU;
+	size_t colIndex = m_columnAxis.getSegment(columnValue, colU);
+	size_t rowIndex = m_rowAxis.getSegment(rowValue, rowU);
+
+	const size_t numColumns = m_columns.size();
+	if (numColumns < 2 || m_rows.size() < 2)
+		return getValue(colIndex, rowIndex);
+
+	//the four corners of the cell, indexed directly: getSegment() always returns a valid cell
+	const double* pCell = &m_values[rowIndex * numColumns + colIndex];
 	double value= 0.0;
-	value += (1 - colU) * (1- rowU) * getValue(colIndex,rowIndex);
-	value += (1 - colU) * rowU * getValue(colIndex,rowIndex + 1);
-	value += colU * (1 - rowU) * getValue(colIndex + 1, rowIndex);
-	value += colU * rowU * getValue(colIndex + 1, rowIndex + 1);
+	value += (1 - colU) * (1- rowU) * pCell[0];
+	value += (1 - colU) * rowU * pCell[numColumns];
+	value += colU * (1 - rowU) * pCell[1];
+	value += colU * rowU * pCell[numColumns + 1];
 	return value;
 }
 
+void Table::getInterpolatedValues(const double* pColValues, const double* pRowValues, double* pOutValues
+	, size_t numValues) const
+{
+	for (size_t i = 0; i < numValues; ++i)
+		pOutValues[i] = getInterpolatedValue(pColValues[i], pRowValues[i]);
+}
+
 double Table::getValue(size_t col, size_t row) const
 {
 	col = std::max((size_t)0, std::min(col, m_columns.size() - 1));
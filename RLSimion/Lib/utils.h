@@ -5,12 +5,31 @@ using namespace std;
 
 class ConfigNode;
 
+//Finds the segment of a sorted axis where a value lies. If the values are evenly spaced, the segment is computed
+//directly (O(1)). Otherwise, it is found with a binary search (O(log n))
+class InterpolationAxis
+{
+	const double* m_pValues = nullptr;
+	size_t m_numValues = 0;
+	bool m_bUniform = false;
+	double m_invStep = 0.0;
+public:
+	//The axis doesn't copy the values: they must be kept alive and unchanged while it is used
+	void init(const double* pValues, size_t numValues);
+	bool isUniform() const { return m_bUniform; }
+
+	//Values outside the axis are clamped to it. Returns the index of the first point of the segment and
+	//the interpolation factor u in [0,1] between it and the next point
+	size_t getSegment(double value, double& u) const;
+};
 
 class Table
 {
 	vector<double> m_columns;
 	vector<double> m_rows;
 	vector<double> m_values;
+	InterpolationAxis m_columnAxis;
+	InterpolationAxis m_rowAxis;
 	bool m_bSuccess = false;
 public:
 	Table();
@@ -25,4 +44,7 @@ public:
 	double getValue(size_t col, size_t row) const;
 	bool readFromFile(string filename);
 	double getInterpolatedValue(double colValue, double rowValue) const;
+	//Batched version: interpolates the table in numValues (column, row) points
+	void getInterpolatedValues(const double* pColValues, const double* pRowValues, double* pOutValues
+		, size_t numValues) const;
 };
\ No newline at end of file
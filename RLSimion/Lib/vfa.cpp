@@ -33,18 +33,16 @@
 #include <assert.h>
 #include <algorithm>
 #include "mem-manager.h"
+#include "noise.h"
 
 //LINEAR VFA. Common functionalities: getSample (FeatureList*), saturate, save, load, ....
 LinearVFA::LinearVFA(MemManager<SimionMemPool>* pMemManager)
 {
 	m_pMemManager = pMemManager;
-	m_pPendingUpdates = new FeatureList("Pending-vfa-updates", OverwriteMode::AllowDuplicates);
 }
 
 LinearVFA::~LinearVFA()
 {
-	if (m_pPendingUpdates)
-		delete m_pPendingUpdates;
 }
 
 void LinearVFA::setCanUseDeferredUpdates(bool bCanUseDeferredUpdates)
@@ -71,12 +69,43 @@ double LinearVFA::get(const FeatureList *pFeatures,bool bUseFrozenWeights)
 			//offset
 			localIndex = pFeatures->m_pFeatures[i].m_index - m_minIndex;
 
-			value += (*pWeights)[localIndex] * pFeatures->m_pFeatures[i].m_factor;
+			value += pWeights->get(localIndex) * pFeatures->m_pFeatures[i].m_factor;
 		}
 	}
 	return value;
 }
 
+void LinearVFA::getBatch(const vector<Feature>& batchFeatures, const vector<size_t>& sampleEnds, double* pOutValues)
+{
+	IMemBuffer *pWeights;
+
+	if (!m_bCanBeFrozen || SimionApp::get()->pSimGod->getTargetFunctionUpdateFreq() == 0)
+		pWeights = m_pWeights;
+	else
+		pWeights = m_pFrozenWeights;
+
+	//blocks are allocated when they are first accessed, which can't be done by several threads at once: the first batch
+	//allocates all of them, so that the weights can then be read without holding the lock. If they can't be allocated
+	//at the same time (the pool has a memory limit), batches are read one at a time
+	IMemPool* pPool = pWeights->getMemPool();
+	unique_lock<mutex> lock(pPool->getAllocationMutex());
+	pPool->allocateAll();
+	if (pPool->bPreallocated())
+		lock.unlock();
+
+	size_t feature = 0;
+	for (size_t sample = 0; sample < sampleEnds.size(); ++sample)
+	{
+		double value = 0.0;
+		for (; feature < sampleEnds[sample]; ++feature)
+		{
+			if (m_minIndex <= batchFeatures[feature].m_index && m_maxIndex > batchFeatures[feature].m_index)
+				value += pWeights->get(batchFeatures[feature].m_index - m_minIndex) * batchFeatures[feature].m_factor;
+		}
+		pOutValues[sample] = value;
+	}
+}
+
 void LinearVFA::saturateOutput(double min, double max)
 {
 	m_bSaturateOutput = true;
@@ -91,6 +120,36 @@ void LinearVFA::setIndexOffset(unsigned int offset)
 }
 
 
+void LinearVFA::setDirty(size_t localIndex)
+{
+	size_t block = localIndex / DIRTY_BLOCK_SIZE;
+	if (m_dirtyBlocks.empty())
+		m_dirtyBlocks.resize((m_numWeights / DIRTY_BLOCK_SIZE) / 64 + 1, 0);
+	m_dirtyBlocks[block / 64] |= 1ull << (block % 64);
+}
+
+void LinearVFA::syncFrozenWeights()
+{
+	for (size_t word = 0; word < m_dirtyBlocks.size(); ++word)
+	{
+		//most of the words are expected to be clean when the features are sparse
+		if (!m_dirtyBlocks[word])
+			continue;
+
+		for (size_t bit = 0; bit < 64; ++bit)
+		{
+			if (!(m_dirtyBlocks[word] & (1ull << bit)))
+				continue;
+
+			size_t firstWeight = (word * 64 + bit) * DIRTY_BLOCK_SIZE;
+			size_t lastWeight = std::min(firstWeight + DIRTY_BLOCK_SIZE, m_numWeights);
+			for (size_t i = firstWeight; i < lastWeight; ++i)
+				m_pFrozenWeights->set(i, m_pWeights->get(i));
+		}
+		m_dirtyBlocks[word] = 0;
+	}
+}
+
 void LinearVFA::add(const FeatureList* pFeatures, double alpha)
 {
 	int vUpdateFreq = 0;
@@ -109,23 +168,19 @@ void LinearVFA::add(const FeatureList* pFeatures, double alpha)
 		if (pFeatures->m_pFeatures[i].m_index < m_minIndex)
 			continue;
 		//index is too high, does not correspond to this map, too!
-		if (pFeatures->m_pFeatures[i].m_index - m_minIndex > m_maxIndex)
+		if (pFeatures->m_pFeatures[i].m_index >= m_maxIndex)
 			continue;
 
 		//IF instead of assert because some features may not belong to this specific VFA
 		//and would still be a valid operation
 		//(for example, in a VFAPolicy with 2 VFAs: StochasticPolicyGaussianNose)
-		double inc;
-		if (!m_bSaturateOutput)
-			inc= alpha*pFeatures->m_pFeatures[i].m_factor;
-		else
-		{
-			inc= std::min(m_maxOutput, std::max(m_minOutput, (*m_pWeights)[pFeatures->m_pFeatures[i].m_index - m_minIndex]
-				+ alpha * pFeatures->m_pFeatures[i].m_factor)) - (*m_pWeights)[pFeatures->m_pFeatures[i].m_index - m_minIndex];
-		}
-		(*m_pWeights)[pFeatures->m_pFeatures[i].m_index - m_minIndex] += inc;
+		size_t localIndex = pFeatures->m_pFeatures[i].m_index - m_minIndex;
+		double weight = m_pWeights->get(localIndex) + alpha * pFeatures->m_pFeatures[i].m_factor;
+		if (m_bSaturateOutput)
+			weight = std::min(m_maxOutput, std::max(m_minOutput, weight));
+		m_pWeights->set(localIndex, weight);
 		if (bFreezeTarget)
-			m_pPendingUpdates->add(pFeatures->m_pFeatures[i].m_index, inc);
+			setDirty(localIndex);
 	}
 
 	if (bFreezeTarget && !SimionApp::get()->pSimGod->bReplayingExperience())
@@ -133,20 +188,15 @@ void LinearVFA::add(const FeatureList* pFeatures, double alpha)
 		experimentStep = SimionApp::get()->pExperiment->getExperimentStep();
 
 		if (experimentStep % vUpdateFreq == 0)
-		{
-			for (unsigned int i = 0; i < m_pPendingUpdates->m_numFeatures; ++i)
-			{
-				(*m_pFrozenWeights)[m_pPendingUpdates->m_pFeatures[i].m_index]
-					+= m_pPendingUpdates->m_pFeatures[i].m_factor;
-			}
-			m_pPendingUpdates->clear();
-		}
+			syncFrozenWeights();
 	}
 }
 
 void LinearVFA::set(size_t feature, double value)
 {
-	(*m_pWeights)[feature] = value;
+	m_pWeights->set(feature, value);
+	if (m_bCanBeFrozen)
+		setDirty(feature);
 }
 
 
@@ -164,6 +214,9 @@ LinearStateVFA::LinearStateVFA(ConfigNode* pConfigNode)
 
 	m_pAux = new FeatureList("LinearStateVFA/aux");
 	m_initValue= DOUBLE_PARAM(pConfigNode, "Init-Value", "The initial value given to the weights on initialization", 0.0);
+	m_weightPrecision = ENUM_PARAM<WeightPrecision>(pConfigNode, "Weight-Precision"
+		, "The precision with which the weights are stored. Reduced precisions save memory and bandwidth, values are always accumulated in double precision"
+		, WeightPrecision::float64);
 
 	m_bSaturateOutput = false;
 	m_minOutput = 0.0;
@@ -172,13 +225,18 @@ LinearStateVFA::LinearStateVFA(ConfigNode* pConfigNode)
 void LinearStateVFA::deferredLoadStep()
 {
 	//weights
-	m_pWeights = m_pMemManager->getMemBuffer(m_numWeights);
+	if (m_pSharedWeights)
+	{
+		m_pWeights = new StridedMemBuffer(m_pSharedWeights->getWeights(), m_pSharedWeights->getNumOutputs(), m_sharedOutput);
+		return;
+	}
+	m_pWeights = m_pMemManager->getMemBuffer(m_numWeights, m_weightPrecision.get());
 	m_pWeights->setInitValue(m_initValue.get());
 
 	//frozen weights
 	if (m_bCanBeFrozen)
 	{
-		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights);
+		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights, m_weightPrecision.get());
 		m_pFrozenWeights->setInitValue(m_initValue.get());
 	}
 }
@@ -192,6 +250,7 @@ LinearStateVFA::LinearStateVFA(MemManager<SimionMemPool>* pMemManager, std::shar
 	:LinearVFA(pMemManager)
 {
 	m_pStateFeatureMap = stateFeatureMap;
+	m_weightPrecision.set(WeightPrecision::float64);
 }
 
 
@@ -200,6 +259,8 @@ LinearStateVFA::~LinearStateVFA()
 	//now SimGod owns the feature map, his duty to free the memory
 	//if (m_pStateFeatureMap) delete m_pStateFeatureMap;
 	if (m_pAux) delete m_pAux;
+	//the views of a multi-output function own their buffer
+	if (m_pSharedWeights && m_pWeights) delete m_pWeights;
 }
 
 
@@ -207,7 +268,10 @@ void LinearStateVFA::getFeatures(const State* s, FeatureList* outFeatures)
 {
 	assert (s);
 	assert (outFeatures);
-	m_pStateFeatureMap->getFeatures(s, nullptr,outFeatures);
+	if (m_pSharedWeights)
+		m_pSharedWeights->getFeatures(s, outFeatures);
+	else
+		m_pStateFeatureMap->getFeatures(s, nullptr,outFeatures);
 	outFeatures->offsetIndices(m_minIndex);
 }
 
@@ -219,11 +283,51 @@ void LinearStateVFA::getFeatureState(size_t feature, State* s)
 
 double LinearStateVFA::get(const State *s)
 {
+	if (m_pSharedWeights)
+		return m_pSharedWeights->get(s, m_sharedOutput);
+
 	getFeatures(s, m_pAux);
 
 	return LinearVFA::get(m_pAux);
 }
 
+double LinearStateVFA::get(const FeatureList *pFeatures, bool bUseFrozenWeights)
+{
+	if (m_pSharedWeights)
+		m_pSharedWeights->applyPendingUpdates();
+
+	return LinearVFA::get(pFeatures, bUseFrozenWeights);
+}
+
+IMemBuffer* LinearStateVFA::getWeights()
+{
+	//the weights may be modified by the caller
+	if (m_pSharedWeights)
+	{
+		m_pSharedWeights->applyPendingUpdates();
+		m_pSharedWeights->invalidateOutputValues();
+	}
+	return m_pWeights;
+}
+
+void LinearStateVFA::add(const FeatureList* pFeatures, double alpha)
+{
+	if (m_pSharedWeights)
+		m_pSharedWeights->add(m_sharedOutput, pFeatures, alpha);
+	else
+		LinearVFA::add(pFeatures, alpha);
+}
+
+void LinearStateVFA::set(size_t feature, double value)
+{
+	if (m_pSharedWeights)
+	{
+		m_pSharedWeights->applyPendingUpdates();
+		m_pSharedWeights->invalidateOutputValues();
+	}
+	LinearVFA::set(feature, value);
+}
+
 unsigned int LinearStateVFA::getNumOutputs()
 {
 	return 1;
@@ -234,6 +338,33 @@ vector<double>& LinearStateVFA::evaluate(const State* s, const Action* a)
 	m_output[0] = get(s);
 	return m_output;
 }
+
+void LinearStateVFA::evaluateBatch(const State* const* pStates, const Action* const*, size_t numSamples
+	, size_t, double* pOutValues)
+{
+	//local buffers instead of m_pAux so that several threads can evaluate the function at the same time
+	FeatureList features("LinearStateVFA/batch");
+	FeatureList auxFeatures("LinearStateVFA/batch-aux");
+	vector<double> variableValues;
+	vector<Feature> batchFeatures;
+	vector<size_t> sampleEnds(numSamples);
+
+	for (size_t i = 0; i < numSamples; ++i)
+	{
+		m_pStateFeatureMap->getFeatures(pStates[i], nullptr, &features, variableValues, &auxFeatures);
+		features.offsetIndices(m_minIndex);
+		batchFeatures.insert(batchFeatures.end(), features.m_pFeatures, features.m_pFeatures + features.m_numFeatures);
+		sampleEnds[i] = batchFeatures.size();
+	}
+	if (m_pSharedWeights)
+	{
+		//the first thread applies the updates of the multi-output function before any of them reads the weights
+		lock_guard<mutex> lock(m_pSharedWeights->getPendingUpdatesMutex());
+		m_pSharedWeights->applyPendingUpdates();
+	}
+	getBatch(batchFeatures, sampleEnds, pOutValues);
+}
+
 const vector<string>& LinearStateVFA::getInputStateVariables()
 {
 	return m_pStateFeatureMap->getInputStateVariables();
@@ -246,6 +377,212 @@ const vector<string>& LinearStateVFA::getInputActionVariables()
 
 
 
+//MULTI-OUTPUT STATE VFA: pi_1(s), ..., pi_K(s)/////////////////////////////////////////////////////////////////////
+
+mutex LinearStateMultiVFA::m_instancesMutex;
+vector<LinearStateMultiVFA*> LinearStateMultiVFA::m_instances;
+
+LinearStateMultiVFA::LinearStateMultiVFA(MemManager<SimionMemPool>* pMemManager
+	, std::shared_ptr<StateFeatureMap> pStateFeatureMap, double initValue, WeightPrecision precision)
+{
+	m_pMemManager = pMemManager;
+	m_pStateFeatureMap = pStateFeatureMap;
+	m_numFeatures = pStateFeatureMap->getTotalNumFeatures();
+	m_initValue = initValue;
+	m_precision = precision;
+
+	m_pFeatures = new FeatureList("LinearStateMultiVFA/features");
+	m_pAuxFeatures = new FeatureList("LinearStateMultiVFA/aux");
+	m_pPendingFeatures = new FeatureList("LinearStateMultiVFA/pending");
+
+	lock_guard<mutex> lock(m_instancesMutex);
+	m_instances.push_back(this);
+}
+
+LinearStateMultiVFA::~LinearStateMultiVFA()
+{
+	{
+		lock_guard<mutex> lock(m_instancesMutex);
+		m_instances.erase(std::find(m_instances.begin(), m_instances.end(), this));
+	}
+	delete m_pFeatures;
+	delete m_pAuxFeatures;
+	delete m_pPendingFeatures;
+}
+
+void LinearStateMultiVFA::shareWeights(const vector<LinearStateVFA*>& functions)
+{
+	vector<bool> bGrouped(functions.size(), false);
+	for (size_t i = 0; i < functions.size(); ++i)
+	{
+		LinearStateVFA* pFirst = functions[i];
+		if (bGrouped[i] || !pFirst || pFirst->m_pSharedWeights || pFirst->m_bCanBeFrozen || pFirst->m_minIndex != 0
+			|| !pFirst->m_pStateFeatureMap)
+			continue;
+
+		vector<LinearStateVFA*> group = { pFirst };
+		for (size_t j = i + 1; j < functions.size(); ++j)
+		{
+			LinearStateVFA* pFunction = functions[j];
+			if (!bGrouped[j] && pFunction && pFunction != pFirst && !pFunction->m_pSharedWeights
+				&& !pFunction->m_bCanBeFrozen && pFunction->m_minIndex == 0
+				&& pFunction->m_pStateFeatureMap == pFirst->m_pStateFeatureMap
+				&& pFunction->m_initValue.get() == pFirst->m_initValue.get()
+				&& pFunction->m_weightPrecision.get() == pFirst->m_weightPrecision.get())
+			{
+				group.push_back(pFunction);
+				bGrouped[j] = true;
+			}
+		}
+		//a single function gains nothing from it
+		if (group.size() < 2)
+			continue;
+
+		std::shared_ptr<LinearStateMultiVFA> pMultiVFA = std::shared_ptr<LinearStateMultiVFA>(
+			new LinearStateMultiVFA(pFirst->m_pMemManager, pFirst->m_pStateFeatureMap, pFirst->m_initValue.get()
+				, pFirst->m_weightPrecision.get()));
+		for (LinearStateVFA* pFunction : group)
+		{
+			pFunction->m_pSharedWeights = pMultiVFA;
+			pFunction->m_sharedOutput = pMultiVFA->m_outputs.size();
+			pMultiVFA->m_outputs.push_back(pFunction);
+		}
+		pMultiVFA->m_outputValues.resize(group.size());
+		pMultiVFA->m_pendingAlphas.resize(group.size());
+		pMultiVFA->m_bPendingOutput.resize(group.size());
+	}
+}
+
+IMemBuffer* LinearStateMultiVFA::getWeights()
+{
+	if (!m_pWeights)
+	{
+		m_pWeights = m_pMemManager->getMemBuffer(m_numFeatures * m_outputs.size(), m_precision);
+		m_pWeights->setInitValue(m_initValue);
+	}
+	return m_pWeights;
+}
+
+void LinearStateMultiVFA::mapState(const State* s)
+{
+	//the features only depend on the values of the input variables of the feature map
+	size_t numInputs = m_pStateFeatureMap->getInputStateVariables().size();
+	bool bSameState = m_bFeaturesValid && m_stateValues.size() == numInputs;
+	m_stateValues.resize(numInputs);
+	for (size_t i = 0; i < numInputs; ++i)
+	{
+		double value = m_pStateFeatureMap->getInputVariableValue(i, s, nullptr);
+		bSameState = bSameState && m_stateValues[i] == value;
+		m_stateValues[i] = value;
+	}
+	if (bSameState)
+		return;
+
+	m_pStateFeatureMap->getFeatures(s, nullptr, m_pFeatures, m_variableValues, m_pAuxFeatures);
+	m_bFeaturesValid = true;
+	m_bOutputValuesValid = false;
+}
+
+void LinearStateMultiVFA::getFeatures(const State* s, FeatureList* outFeatures)
+{
+	mapState(s);
+	outFeatures->copy(m_pFeatures);
+}
+
+double LinearStateMultiVFA::get(const State* s, size_t output)
+{
+	applyPendingUpdates();
+	mapState(s);
+
+	if (!m_bOutputValuesValid || m_outputValuesVersion != m_pMemManager->getValuesVersion())
+	{
+		size_t numOutputs = m_outputs.size();
+		std::fill(m_outputValues.begin(), m_outputValues.end(), 0.0);
+		for (size_t i = 0; i < m_pFeatures->m_numFeatures; ++i)
+		{
+			size_t firstWeight = m_pFeatures->m_pFeatures[i].m_index * numOutputs;
+			double factor = m_pFeatures->m_pFeatures[i].m_factor;
+			for (size_t k = 0; k < numOutputs; ++k)
+				m_outputValues[k] += m_pWeights->get(firstWeight + k) * factor;
+		}
+		m_bOutputValuesValid = true;
+		m_outputValuesVersion = m_pMemManager->getValuesVersion();
+	}
+	return m_outputValues[output];
+}
+
+bool LinearStateMultiVFA::bSameFeatures(const FeatureList* pFeatures1, const FeatureList* pFeatures2) const
+{
+	if (pFeatures1->m_numFeatures != pFeatures2->m_numFeatures)
+		return false;
+	for (size_t i = 0; i < pFeatures1->m_numFeatures; ++i)
+	{
+		if (pFeatures1->m_pFeatures[i].m_index != pFeatures2->m_pFeatures[i].m_index
+			|| pFeatures1->m_pFeatures[i].m_factor != pFeatures2->m_pFeatures[i].m_factor)
+			return false;
+	}
+	return true;
+}
+
+void LinearStateMultiVFA::add(size_t output, const FeatureList* pFeatures, double alpha)
+{
+	//updates can only be accumulated if they use the same features and each output is updated once
+	if (m_bPendingUpdates && (m_bPendingOutput[output] || !bSameFeatures(pFeatures, m_pPendingFeatures)))
+		applyPendingUpdates();
+
+	if (!m_bPendingUpdates)
+	{
+		m_pPendingFeatures->copy(pFeatures);
+		m_bPendingUpdates = true;
+	}
+	m_pendingAlphas[output] = alpha;
+	m_bPendingOutput[output] = true;
+	m_bOutputValuesValid = false;
+}
+
+void LinearStateMultiVFA::applyPendingUpdates()
+{
+	if (!m_bPendingUpdates)
+		return;
+
+	size_t numOutputs = m_outputs.size();
+	for (size_t i = 0; i < m_pPendingFeatures->m_numFeatures; ++i)
+	{
+		//features that don't belong to this function (i.e., the sigma features of a StochasticGaussianPolicy)
+		if (m_pPendingFeatures->m_pFeatures[i].m_index >= m_numFeatures)
+			continue;
+
+		size_t firstWeight = m_pPendingFeatures->m_pFeatures[i].m_index * numOutputs;
+		double factor = m_pPendingFeatures->m_pFeatures[i].m_factor;
+		for (size_t k = 0; k < numOutputs; ++k)
+		{
+			if (!m_bPendingOutput[k])
+				continue;
+
+			LinearStateVFA* pOutput = m_outputs[k];
+			double weight = m_pWeights->get(firstWeight + k) + m_pendingAlphas[k] * factor;
+			if (pOutput->m_bSaturateOutput)
+				weight = std::min(pOutput->m_maxOutput, std::max(pOutput->m_minOutput, weight));
+			m_pWeights->set(firstWeight + k, weight);
+		}
+	}
+	std::fill(m_bPendingOutput.begin(), m_bPendingOutput.end(), false);
+	m_bPendingUpdates = false;
+}
+
+void LinearStateMultiVFA::applyPendingUpdates(MemManager<SimionMemPool>* pMemManager)
+{
+	lock_guard<mutex> lock(m_instancesMutex);
+	for (LinearStateMultiVFA* pInstance : m_instances)
+	{
+		if (pInstance->m_pMemManager == pMemManager)
+			pInstance->applyPendingUpdates();
+	}
+}
+
+
+
+
 //STATE-ACTION VFA: Q(s,a), A(s,a), .../////////////////////////////////////////////////////////////////////
 
 LinearStateActionVFA::LinearStateActionVFA(MemManager<SimionMemPool>* pMemManager, std::shared_ptr<StateFeatureMap> pStateFeatureMap, std::shared_ptr<ActionFeatureMap> pActionFeatureMap)
@@ -253,6 +590,7 @@ LinearStateActionVFA::LinearStateActionVFA(MemManager<SimionMemPool>* pMemManage
 {
 	m_pStateFeatureMap = pStateFeatureMap;
 	m_pActionFeatureMap = pActionFeatureMap;
+	m_weightPrecision.set(WeightPrecision::float64);
 
 	m_numStateWeights = m_pStateFeatureMap->getTotalNumFeatures();
 	m_numActionWeights = m_pActionFeatureMap->getTotalNumFeatures();
@@ -275,12 +613,16 @@ LinearStateActionVFA::LinearStateActionVFA(ConfigNode* pConfigNode)
 	:LinearStateActionVFA(SimionApp::get()->pMemManager, SimGod::getGlobalStateFeatureMap(),SimGod::getGlobalActionFeatureMap())
 {
 	m_initValue= DOUBLE_PARAM(pConfigNode, "Init-Value","The initial value given to the weights on initialization", 0.0);
+	m_weightPrecision = ENUM_PARAM<WeightPrecision>(pConfigNode, "Weight-Precision"
+		, "The precision with which the weights are stored. Reduced precisions save memory and bandwidth, values are always accumulated in double precision"
+		, WeightPrecision::float64);
 }
 
 LinearStateActionVFA::LinearStateActionVFA(LinearStateActionVFA* pSourceVFA)
 	: LinearStateActionVFA(SimionApp::get()->pMemManager, SimGod::getGlobalStateFeatureMap(), SimGod::getGlobalActionFeatureMap())
 {
 	m_initValue = pSourceVFA->m_initValue;
+	m_weightPrecision = pSourceVFA->m_weightPrecision;
 }
 
 LinearStateActionVFA::~LinearStateActionVFA()
@@ -300,13 +642,13 @@ void LinearStateActionVFA::setInitValue(double initValue)
 void LinearStateActionVFA::deferredLoadStep()
 {
 	//weights
-	m_pWeights= m_pMemManager->getMemBuffer(m_numWeights);
+	m_pWeights= m_pMemManager->getMemBuffer(m_numWeights, m_weightPrecision.get());
 	m_pWeights->setInitValue(m_initValue.get());
 
 	//frozen weights
 	if (m_bCanBeFrozen)
 	{
-		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights);
+		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights, m_weightPrecision.get());
 		m_pFrozenWeights->setInitValue(m_initValue.get());
 	}
 
@@ -392,7 +734,7 @@ void LinearStateActionVFA::argMax(const State *s, Action* a, bool bSolveTiesRand
 	{
 		//any ties?
 		if (numTies > 1)
-			arg = m_pArgMaxTies[rand() % numTies]; //select one randomly
+			arg = m_pArgMaxTies[getRandomIndex(numTies)]; //select one randomly
 	}
 	else arg = m_pArgMaxTies[0];
 
@@ -449,6 +791,29 @@ vector<double>& LinearStateActionVFA::evaluate(const State* s, const Action* a)
 	return m_output;
 }
 
+void LinearStateActionVFA::evaluateBatch(const State* const* pStates, const Action* const* pActions, size_t numSamples
+	, size_t, double* pOutValues)
+{
+	//local buffers instead of m_pAux/m_pAux2 so that several threads can evaluate the function at the same time
+	FeatureList features("LinearStateActionVFA/batch");
+	FeatureList actionFeatures("LinearStateActionVFA/batch-action");
+	FeatureList auxFeatures("LinearStateActionVFA/batch-aux");
+	vector<double> variableValues;
+	vector<Feature> batchFeatures;
+	vector<size_t> sampleEnds(numSamples);
+
+	for (size_t i = 0; i < numSamples; ++i)
+	{
+		m_pStateFeatureMap->getFeatures(pStates[i], nullptr, &features, variableValues, &auxFeatures);
+		m_pActionFeatureMap->getFeatures(nullptr, pActions[i], &actionFeatures, variableValues, &auxFeatures);
+		features.spawn(&actionFeatures, m_numStateWeights);
+		features.offsetIndices(m_minIndex);
+		batchFeatures.insert(batchFeatures.end(), features.m_pFeatures, features.m_pFeatures + features.m_numFeatures);
+		sampleEnds[i] = batchFeatures.size();
+	}
+	getBatch(batchFeatures, sampleEnds, pOutValues);
+}
+
 const vector<string>& LinearStateActionVFA::getInputStateVariables()
 {
 	return m_pStateFeatureMap->getInputStateVariables();
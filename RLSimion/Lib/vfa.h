@@ -3,6 +3,7 @@
 class StateFeatureMap;
 class ActionFeatureMap;
 class FeatureList;
+struct Feature;
 class NamedVarSet;
 typedef NamedVarSet State;
 typedef NamedVarSet Action;
@@ -13,7 +14,9 @@ class ConfigFile;
 #include "deferred-load.h"
 #include "../Common/state-action-function.h"
 #include "mem-manager.h"
+#include <mutex>
 class IMemBuffer;
+class LinearStateMultiVFA;
 
 
 //LinearVFA////////////////////////////////////////////////////////////////////
@@ -26,7 +29,6 @@ protected:
 	vector<double> m_output = vector<double>(1);
 
 	MemManager<SimionMemPool>* m_pMemManager;
-	FeatureList* m_pPendingUpdates= nullptr;
 	IMemBuffer* m_pFrozenWeights = nullptr;
 	IMemBuffer* m_pWeights= nullptr;
 	size_t m_numWeights= 0;
@@ -36,8 +38,19 @@ protected:
 
 	bool m_bCanBeFrozen= false;
 
+	//Bitmap of the blocks of weights updated since the frozen weights were last synchronized. Only these blocks are
+	//copied to the frozen weights, so the cost of a sync is bounded by the number of weights, not the number of updates
+	static const size_t DIRTY_BLOCK_SIZE = 64;
+	vector<unsigned long long> m_dirtyBlocks;
+	void setDirty(size_t localIndex);
+	void syncFrozenWeights();
+
 	size_t m_minIndex;
 	size_t m_maxIndex;
+
+	//Same as get() for a batch of samples whose features are stored consecutively in batchFeatures: the features of
+	//the i-th sample end at sampleEnds[i]. Can be called from several threads at the same time
+	void getBatch(const vector<Feature>& batchFeatures, const vector<size_t>& sampleEnds, double* pOutValues);
 public:
 	LinearVFA() = default;
 	LinearVFA(MemManager<SimionMemPool>* pMemManager);
@@ -59,11 +72,17 @@ public:
 
 class LinearStateVFA: public LinearVFA, public StateActionFunction, public DeferredLoad
 {
+	friend class LinearStateMultiVFA;
 protected:
 	std::shared_ptr<StateFeatureMap> m_pStateFeatureMap;
 	FeatureList *m_pAux;
 	DOUBLE_PARAM m_initValue;
+	ENUM_PARAM<WeightPrecision> m_weightPrecision;
 	virtual void deferredLoadStep();
+
+	//if set, this function is a view of one of the outputs of a multi-output function and its weights are stored there
+	std::shared_ptr<LinearStateMultiVFA> m_pSharedWeights;
+	size_t m_sharedOutput = 0;
 public:
 	LinearStateVFA() = default;
 	LinearStateVFA(MemManager<SimionMemPool>* pMemManager, std::shared_ptr<StateFeatureMap> stateFeatureMap);
@@ -72,9 +91,13 @@ public:
 	void setInitValue(double initValue);
 
 	virtual ~LinearStateVFA();
-	using LinearVFA::get;
+	double get(const FeatureList *pFeatures, bool bUseFrozenWeights = true);
 	double get(const State *s);
 
+	IMemBuffer *getWeights();
+	void add(const FeatureList* pFeatures, double alpha = 1.0);
+	void set(size_t feature, double value);
+
 	void getFeatures(const State* s,FeatureList* outFeatures);
 	void getFeatureState(size_t feature, State* s);
 
@@ -85,6 +108,78 @@ public:
 	vector<double>& evaluate(const State* s, const Action* a);
 	const vector<string>& getInputStateVariables();
 	const vector<string>& getInputActionVariables();
+	void evaluateBatch(const State* const* pStates, const Action* const* pActions, size_t numSamples, size_t outputIndex
+		, double* pOutValues);
+	bool isBatchEvaluationThreadSafe() { return true; }
+};
+
+
+//The policies of the different action dimensions of an actor are linear state functions over the same state feature
+//map. LinearStateMultiVFA stores K of them as a single function with K outputs whose weights are stored feature-major
+//(the K outputs of each feature next to each other): the state is mapped once and a single pass over the features
+//gathers all the outputs. The original functions are kept as views of one output each (see LinearStateVFA::shareWeights())
+//so that the Policy interface doesn't change. The updates of the different outputs with the same features are
+//accumulated and applied in a single pass over the features when the weights are read next
+class LinearStateMultiVFA
+{
+	MemManager<SimionMemPool>* m_pMemManager;
+	std::shared_ptr<StateFeatureMap> m_pStateFeatureMap;
+	vector<LinearStateVFA*> m_outputs;
+	size_t m_numFeatures;
+	double m_initValue;
+	WeightPrecision m_precision;
+	IMemBuffer* m_pWeights = nullptr;
+
+	//the input values of the last state mapped, its features and the outputs calculated from them
+	vector<double> m_stateValues;
+	vector<double> m_variableValues;
+	FeatureList *m_pFeatures, *m_pAuxFeatures;
+	bool m_bFeaturesValid = false;
+	vector<double> m_outputValues;
+	bool m_bOutputValuesValid = false;
+	unsigned int m_outputValuesVersion = 0; //see MemManager::getValuesVersion()
+	void mapState(const State* s);
+
+	//updates not yet applied: all of them use the same features
+	FeatureList* m_pPendingFeatures;
+	vector<double> m_pendingAlphas;
+	vector<bool> m_bPendingOutput;
+	bool m_bPendingUpdates = false;
+	mutex m_pendingUpdatesMutex;
+	bool bSameFeatures(const FeatureList* pFeatures1, const FeatureList* pFeatures2) const;
+
+	//all the multi-output functions in the process, so that their updates can be applied before their weights are copied
+	static mutex m_instancesMutex;
+	static vector<LinearStateMultiVFA*> m_instances;
+
+	LinearStateMultiVFA(MemManager<SimionMemPool>* pMemManager, std::shared_ptr<StateFeatureMap> pStateFeatureMap
+		, double initValue, WeightPrecision precision);
+public:
+	virtual ~LinearStateMultiVFA();
+
+	//Groups the functions given by state feature map, initial value and weight precision, and makes each function of a
+	//group a view of one output of a multi-output function. Functions with frozen weights or index offsets are left as
+	//they are. Must be called before the deferred load steps are taken
+	static void shareWeights(const vector<LinearStateVFA*>& functions);
+
+	size_t getNumOutputs() const { return m_outputs.size(); }
+	size_t getNumFeatures() const { return m_numFeatures; }
+
+	//Allocates the buffer the first time it is called
+	IMemBuffer* getWeights();
+
+	void getFeatures(const State* s, FeatureList* outFeatures);
+	double get(const State* s, size_t output);
+	void add(size_t output, const FeatureList* pFeatures, double alpha);
+
+	void applyPendingUpdates();
+	//Applies the pending updates of every function whose weights are stored by pMemManager. Must be called by the thread
+	//that updates them before the values of pMemManager are copied (see ParallelEvaluator)
+	static void applyPendingUpdates(MemManager<SimionMemPool>* pMemManager);
+	//held by the threads that evaluate the outputs in batches (see LinearStateVFA::evaluateBatch())
+	mutex& getPendingUpdatesMutex() { return m_pendingUpdatesMutex; }
+	//must be called whenever the weights are changed without add()
+	void invalidateOutputValues() { m_bOutputValuesValid = false; }
 };
 
 
@@ -99,6 +194,7 @@ protected:
 	FeatureList *m_pAux = nullptr;
 	FeatureList *m_pAux2 = nullptr;
 	DOUBLE_PARAM m_initValue;
+	ENUM_PARAM<WeightPrecision> m_weightPrecision;
 	int *m_pArgMaxTies= nullptr;
 
 public:
@@ -138,4 +234,7 @@ public:
 	vector<double>& evaluate(const State* s, const Action* a);
 	const vector<string>& getInputStateVariables();
 	const vector<string>& getInputActionVariables();
+	void evaluateBatch(const State* const* pStates, const Action* const* pActions, size_t numSamples, size_t outputIndex
+		, double* pOutValues);
+	bool isBatchEvaluationThreadSafe() { return true; }
 };
@@ -0,0 +1,138 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "work-stealing-pool.h"
+#include "app.h"
+#include <thread>
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned int numThreads, size_t maxNumTasks)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (maxNumTasks > 0)
+		numThreads = (unsigned int)std::min((size_t)numThreads, maxNumTasks);
+	for (unsigned int i = 0; i < numThreads; ++i)
+		m_queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+	//the thread that calls run() is worker 0
+	for (size_t worker = 1; worker < m_queues.size(); ++worker)
+		m_workers.push_back(thread(&WorkStealingPool::workerLoop, this, worker));
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		lock_guard<mutex> lock(m_jobMutex);
+		m_bStop = true;
+	}
+	m_jobStarted.notify_all();
+	for (thread& workerThread : m_workers)
+		workerThread.join();
+}
+
+bool WorkStealingPool::popTask(size_t worker, size_t& task)
+{
+	WorkerQueue& queue = *m_queues[worker];
+	lock_guard<mutex> lock(queue.queueMutex);
+	if (queue.tasks.empty())
+		return false;
+	task = queue.tasks.front();
+	queue.tasks.pop_front();
+	return true;
+}
+
+bool WorkStealingPool::stealTask(size_t worker, size_t& task)
+{
+	//start with the next worker so that not every idle thread tries to steal from the same one
+	for (size_t i = 1; i < m_queues.size(); ++i)
+	{
+		WorkerQueue& queue = *m_queues[(worker + i) % m_queues.size()];
+		lock_guard<mutex> lock(queue.queueMutex);
+		if (!queue.tasks.empty())
+		{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::runTasks(size_t worker, const function<void(size_t)>& task, SimionApp* pApp)
+{
+	//tasks run within the app of the thread that called run() (if any), so that they can use SimionApp::get()
+	SimionApp::setThreadInstance(pApp);
+
+	//no tasks are added once the pool is running, so a worker can finish as soon as all the queues are empty
+	size_t nextTask;
+	while (popTask(worker, nextTask) || stealTask(worker, nextTask))
+		task(nextTask);
+}
+
+void WorkStealingPool::workerLoop(size_t worker)
+{
+	size_t lastJobIndex = 0;
+	while (true)
+	{
+		const function<void(size_t)>* pTask;
+		SimionApp* pApp;
+		{
+			unique_lock<mutex> lock(m_jobMutex);
+			m_jobStarted.wait(lock, [this, lastJobIndex]() { return m_bStop || m_jobIndex != lastJobIndex; });
+			if (m_bStop)
+				return;
+			lastJobIndex = m_jobIndex;
+			pTask = m_pTask;
+			pApp = m_pApp;
+		}
+		runTasks(worker, *pTask, pApp);
+		{
+			lock_guard<mutex> lock(m_jobMutex);
+			--m_numBusyWorkers;
+		}
+		m_jobFinished.notify_one();
+	}
+}
+
+void WorkStealingPool::run(size_t numTasks, const function<void(size_t)>& task)
+{
+	for (size_t i = 0; i < numTasks; ++i)
+		m_queues[i % m_queues.size()]->tasks.push_back(i);
+
+	SimionApp* pApp = SimionApp::get();
+	{
+		lock_guard<mutex> lock(m_jobMutex);
+		m_pTask = &task;
+		m_pApp = pApp;
+		m_numBusyWorkers = m_workers.size();
+		++m_jobIndex;
+	}
+	m_jobStarted.notify_all();
+	runTasks(0, task, pApp);
+
+	//the task can't be released until every worker has stopped using it
+	unique_lock<mutex> lock(m_jobMutex);
+	m_jobFinished.wait(lock, [this]() { return m_numBusyWorkers == 0; });
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <functional>
+using namespace std;
+
+class SimionApp;
+
+//Pool of threads that runs a fixed set of tasks. Tasks are distributed evenly in per-thread queues and threads that run
+//out of work steal tasks from the back of other threads' queues, so that a few long tasks don't leave threads idle.
+//The worker threads are created with the pool and wait for the next run() in between, so that a pool can be run often
+//(i.e., every time a function is sampled) without creating threads each time
+class WorkStealingPool
+{
+	struct WorkerQueue
+	{
+		mutex queueMutex;
+		deque<size_t> tasks;
+	};
+	vector<unique_ptr<WorkerQueue>> m_queues;
+	vector<thread> m_workers;
+
+	//the job being run: workers wake up when the job index changes and run() returns once all of them are done
+	mutex m_jobMutex;
+	condition_variable m_jobStarted;
+	condition_variable m_jobFinished;
+	size_t m_jobIndex = 0;
+	size_t m_numBusyWorkers = 0;
+	bool m_bStop = false;
+	const function<void(size_t)>* m_pTask = nullptr;
+	SimionApp* m_pApp = nullptr;
+
+	bool popTask(size_t worker, size_t& task);
+	bool stealTask(size_t worker, size_t& task);
+	void runTasks(size_t worker, const function<void(size_t)>& task, SimionApp* pApp);
+	void workerLoop(size_t worker);
+public:
+	//0 uses all the hardware threads. Pools that are run once pass their number of tasks as maxNumTasks, so that no more
+	//threads than tasks are created
+	WorkStealingPool(unsigned int numThreads = 0, size_t maxNumTasks = 0);
+	virtual ~WorkStealingPool();
+
+	unsigned int getNumThreads() const { return (unsigned int) m_queues.size(); }
+
+	//Calls task(i) for every i in [0, numTasks) and returns when all of them have finished. The calling thread is used
+	//as one of the workers, and the other workers see the same SimionApp::get() as the calling thread
+	void run(size_t numTasks, const function<void(size_t)>& task);
+};
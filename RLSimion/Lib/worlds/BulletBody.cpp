@@ -24,6 +24,7 @@
 */
 
 #include "BulletBody.h"
+#include "BulletSnapshot.h"
 
 BulletBody::BulletBody(double mass, const btVector3& origin, btCollisionShape* shape, int objType)
 {
@@ -147,3 +148,51 @@ void BulletBody::updateYawState(State* s)
 		s->set(m_thetaId, (double)yaw);
 	}
 }
+
+void BulletBody::saveState(BulletWorldSnapshot& snapshot)
+{
+	if (!m_pBody) return;
+
+	btTransform motionStateTransform;
+	m_pBody->getMotionState()->getWorldTransform(motionStateTransform);
+
+	snapshot.write(m_pBody->getWorldTransform());
+	snapshot.write(m_pBody->getInterpolationWorldTransform());
+	snapshot.write(motionStateTransform);
+	snapshot.write(m_pBody->getLinearVelocity());
+	snapshot.write(m_pBody->getAngularVelocity());
+	snapshot.write(m_pBody->getInterpolationLinearVelocity());
+	snapshot.write(m_pBody->getInterpolationAngularVelocity());
+	snapshot.write(m_pBody->getDeactivationTime());
+	snapshot.write((double)m_pBody->getActivationState());
+}
+
+void BulletBody::restoreState(BulletSnapshotReader& reader)
+{
+	if (!m_pBody) return;
+
+	btTransform transform;
+	btVector3 vector;
+
+	reader.read(transform);
+	//unlike setWorldTransform(), this also updates the inertia tensor in world coordinates
+	m_pBody->setCenterOfMassTransform(transform);
+	reader.read(transform);
+	m_pBody->setInterpolationWorldTransform(transform);
+	reader.read(transform);
+	m_pBody->getMotionState()->setWorldTransform(transform);
+	reader.read(vector);
+	m_pBody->setLinearVelocity(vector);
+	reader.read(vector);
+	m_pBody->setAngularVelocity(vector);
+	reader.read(vector);
+	m_pBody->setInterpolationLinearVelocity(vector);
+	reader.read(vector);
+	m_pBody->setInterpolationAngularVelocity(vector);
+	m_pBody->setDeactivationTime((btScalar)reader.read());
+	//setActivationState() wouldn't change the state of bodies with deactivation disabled
+	m_pBody->forceActivationState((int)reader.read());
+
+	//forces are cleared after each simulation step, so they aren't saved
+	m_pBody->clearForces();
+}
@@ -2,6 +2,9 @@
 #include "world.h"
 #include "../../../3rd-party/bullet3-2.86/src/btBulletDynamicsCommon.h"
 
+class BulletWorldSnapshot;
+class BulletSnapshotReader;
+
 class BulletBody
 {
 	btVector3 m_localInertia;
@@ -44,6 +47,11 @@ public:
 	virtual void updateState(State* s);
 	virtual void updateBulletState(State *s, const Action *a, double dt) {}
 
+	//Subclasses with state kept outside Bullet must override these two methods and save/restore it after the
+	//state of the rigid body
+	virtual void saveState(BulletWorldSnapshot& snapshot);
+	virtual void restoreState(BulletSnapshotReader& reader);
+
 	btRigidBody* getBody();
 	btCollisionShape* getShape();
 	virtual bool bIsRigidBody() { return true; }
@@ -4,6 +4,8 @@
 #include "../../../3rd-party/bullet3-2.86/src/BulletSoftBody/btSoftRigidDynamicsWorld.h"
 #include "../../../3rd-party/bullet3-2.86/src/BulletSoftBody/btSoftBodyHelpers.h"
 #include "../../../3rd-party/bullet3-2.86/src/BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
+#include "../../../3rd-party/bullet3-2.86/src/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletMultithreading.h"
 
 struct BulletCreationInterface
 {
@@ -74,6 +76,27 @@ struct BulletCreationInterface
 		m_dynamicsWorld->setGravity(btVector3(0.f, -9.8f, 0.f));
 	}
 
+	//Same as createEmptyDynamicsWorld(), but the simulation islands are solved in parallel using numThreads threads
+	//(0: all the hardware threads). Bullet merges small islands before solving them, so worlds with only a few bodies
+	//are still solved in a single thread
+	virtual void createEmptyDynamicsWorldMt(unsigned int numThreads)
+	{
+		m_collisionConfiguration = new btDefaultCollisionConfiguration();
+		m_dispatcher = new	btCollisionDispatcher(m_collisionConfiguration);
+
+		m_broadphase = new btDbvtBroadphase();
+
+		numThreads = BulletTaskScheduler::get().reserveThreads(numThreads);
+		m_solver = new BulletConstraintSolverPool(numThreads);
+
+		BulletDynamicsWorldMt* pDynamicsWorld = new BulletDynamicsWorldMt(numThreads, m_dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+		btSimulationIslandManagerMt* pIslandManager = (btSimulationIslandManagerMt*)pDynamicsWorld->getSimulationIslandManager();
+		pIslandManager->setIslandDispatchFunction(BulletTaskScheduler::dispatchIslands);
+		m_dynamicsWorld = pDynamicsWorld;
+
+		m_dynamicsWorld->setGravity(btVector3(0.f, -9.8f, 0.f));
+	}
+
 
 	virtual void stepSimulation(float deltaTime, int maxSubSteps)
 	{
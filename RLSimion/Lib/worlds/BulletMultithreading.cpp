@@ -0,0 +1,195 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "BulletMultithreading.h"
+#include <algorithm>
+
+thread_local unsigned int BulletTaskScheduler::m_numStepThreads = 1;
+
+BulletTaskScheduler& BulletTaskScheduler::get()
+{
+	static BulletTaskScheduler scheduler;
+	return scheduler;
+}
+
+BulletTaskScheduler::BulletTaskScheduler()
+{
+	m_nextIsland = 0;
+}
+
+BulletTaskScheduler::~BulletTaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bExit = true;
+	}
+	m_jobAvailable.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+unsigned int BulletTaskScheduler::reserveThreads(unsigned int numThreads)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (m_workers.size() + 1 < numThreads)
+		m_workers.push_back(std::thread(&BulletTaskScheduler::workerLoop, this, (unsigned int)m_workers.size()));
+	return numThreads;
+}
+
+void BulletTaskScheduler::solveIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>& islands
+	, btSimulationIslandManagerMt::IslandCallback* pCallback, std::atomic<int>& nextIsland)
+{
+	//islands are sorted by decreasing size, so taking them one by one balances the load between threads
+	for (int i = nextIsland++; i < islands.size(); i = nextIsland++)
+	{
+		btSimulationIslandManagerMt::Island* pIsland = islands[i];
+		pCallback->processIsland(&pIsland->bodyArray[0], pIsland->bodyArray.size()
+			, pIsland->manifoldArray.size() ? &pIsland->manifoldArray[0] : nullptr, pIsland->manifoldArray.size()
+			, pIsland->constraintArray.size() ? &pIsland->constraintArray[0] : nullptr, pIsland->constraintArray.size()
+			, pIsland->id);
+	}
+}
+
+void BulletTaskScheduler::workerLoop(unsigned int workerIndex)
+{
+	unsigned int lastJobId = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		//workers beyond the number of threads of the world being stepped stay idle
+		m_jobAvailable.wait(lock, [&]()
+		{
+			return m_bExit || (m_pIslands != nullptr && m_jobId != lastJobId && workerIndex + 1 < m_jobNumThreads);
+		});
+		if (m_bExit)
+			return;
+
+		lastJobId = m_jobId;
+		btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* pIslands = m_pIslands;
+		btSimulationIslandManagerMt::IslandCallback* pCallback = m_pCallback;
+		++m_numBusyWorkers;
+		lock.unlock();
+
+		solveIslands(*pIslands, pCallback, m_nextIsland);
+
+		lock.lock();
+		if (--m_numBusyWorkers == 0)
+			m_jobDone.notify_one();
+	}
+}
+
+void BulletTaskScheduler::dispatchIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* pIslands
+	, btSimulationIslandManagerMt::IslandCallback* pCallback)
+{
+	static std::mutex dispatchMutex;
+	BulletTaskScheduler& scheduler = get();
+
+	//Waking up the workers costs more than solving a single island. If another world is using the workers (worlds
+	//stepped from different threads), the islands are solved in the calling thread too
+	std::unique_lock<std::mutex> dispatchLock(dispatchMutex, std::try_to_lock);
+	if (m_numStepThreads <= 1 || pIslands->size() <= 1 || !dispatchLock.owns_lock())
+	{
+		btSimulationIslandManagerMt::defaultIslandDispatch(pIslands, pCallback);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(scheduler.m_mutex);
+		scheduler.m_pIslands = pIslands;
+		scheduler.m_pCallback = pCallback;
+		scheduler.m_nextIsland = 0;
+		scheduler.m_jobNumThreads = m_numStepThreads;
+		++scheduler.m_jobId;
+	}
+	scheduler.m_jobAvailable.notify_all();
+
+	solveIslands(*pIslands, pCallback, scheduler.m_nextIsland);
+
+	//workers that didn't wake up before the job is finished won't take part in it
+	std::unique_lock<std::mutex> lock(scheduler.m_mutex);
+	scheduler.m_jobDone.wait(lock, [&]() { return scheduler.m_numBusyWorkers == 0; });
+	scheduler.m_pIslands = nullptr;
+	scheduler.m_pCallback = nullptr;
+}
+
+BulletDynamicsWorldMt::BulletDynamicsWorldMt(unsigned int numThreads, btDispatcher* dispatcher
+	, btBroadphaseInterface* pairCache, btConstraintSolver* constraintSolver, btCollisionConfiguration* collisionConfiguration)
+	: btDiscreteDynamicsWorldMt(dispatcher, pairCache, constraintSolver, collisionConfiguration)
+{
+	m_numThreads = numThreads;
+}
+
+void BulletDynamicsWorldMt::solveConstraints(btContactSolverInfo& solverInfo)
+{
+	//islands are dispatched from the thread that steps the world
+	BulletTaskScheduler::setStepThreads(m_numThreads);
+	btDiscreteDynamicsWorldMt::solveConstraints(solverInfo);
+}
+
+BulletConstraintSolverPool::BulletConstraintSolverPool(unsigned int numSolvers)
+{
+	for (unsigned int i = 0; i < std::max(1u, numSolvers); ++i)
+		m_solvers.push_back(new PooledSolver());
+}
+
+BulletConstraintSolverPool::~BulletConstraintSolverPool()
+{
+	for (PooledSolver* pSolver : m_solvers)
+		delete pSolver;
+}
+
+btScalar BulletConstraintSolverPool::solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds
+	, int numManifolds, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info
+	, btIDebugDraw* debugDrawer, btDispatcher* dispatcher)
+{
+	//there is a solver per thread used by the world, so one should always be free
+	PooledSolver* pFreeSolver = nullptr;
+	for (PooledSolver* pSolver : m_solvers)
+	{
+		if (pSolver->mutex.try_lock())
+		{
+			pFreeSolver = pSolver;
+			break;
+		}
+	}
+	if (!pFreeSolver)
+	{
+		pFreeSolver = m_solvers[0];
+		pFreeSolver->mutex.lock();
+	}
+	btScalar residual = pFreeSolver->solver.solveGroup(bodies, numBodies, manifolds, numManifolds, constraints, numConstraints
+		, info, debugDrawer, dispatcher);
+	pFreeSolver->mutex.unlock();
+	return residual;
+}
+
+void BulletConstraintSolverPool::reset()
+{
+	for (PooledSolver* pSolver : m_solvers)
+		pSolver->solver.reset();
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "../../../3rd-party/bullet3-2.86/src/btBulletDynamicsCommon.h"
+#include "../../../3rd-party/bullet3-2.86/src/BulletDynamics/Dynamics/btSimulationIslandManagerMt.h"
+#include "../../../3rd-party/bullet3-2.86/src/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//Pool of worker threads used by the multithreaded Bullet worlds (see BulletCreationInterface::createEmptyDynamicsWorldMt())
+//to solve their simulation islands in parallel. Bullet 2.86 has no task scheduler and the island dispatch function of
+//btSimulationIslandManagerMt has no user data, so a single scheduler is shared by all the worlds. The pool grows to the
+//largest number of threads requested by a world, but each world only uses the number of threads it was created with:
+//it is set for the thread stepping the world (see BulletDynamicsWorldMt) before its islands are dispatched.
+//Worker threads are never destroyed until the program exits: Bullet gives each thread a fixed index the first time it
+//runs Bullet code, and only a limited number of indices are available
+class BulletTaskScheduler
+{
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_jobAvailable;
+	std::condition_variable m_jobDone;
+	bool m_bExit = false;
+
+	//the current job. m_pIslands is null when there is none
+	unsigned int m_jobId = 0;
+	unsigned int m_jobNumThreads = 1; //the calling thread + the workers used
+	btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* m_pIslands = nullptr;
+	btSimulationIslandManagerMt::IslandCallback* m_pCallback = nullptr;
+	std::atomic<int> m_nextIsland;
+	unsigned int m_numBusyWorkers = 0;
+
+	//number of threads used by the world being stepped by each thread
+	static thread_local unsigned int m_numStepThreads;
+
+	BulletTaskScheduler();
+	~BulletTaskScheduler();
+
+	void workerLoop(unsigned int workerIndex);
+	static void solveIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>& islands
+		, btSimulationIslandManagerMt::IslandCallback* pCallback, std::atomic<int>& nextIsland);
+public:
+	static BulletTaskScheduler& get();
+
+	//Adds the workers needed by a world that uses numThreads threads, including the thread that steps it, and returns
+	//that number. 0 uses all the hardware threads. It doesn't change the number of threads used by other worlds
+	unsigned int reserveThreads(unsigned int numThreads);
+
+	//Sets the number of threads used to solve the islands of the worlds stepped from the calling thread
+	static void setStepThreads(unsigned int numThreads) { m_numStepThreads = numThreads; }
+
+	//The btSimulationIslandManagerMt::IslandDispatchFunc set in multithreaded worlds
+	static void dispatchIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* pIslands
+		, btSimulationIslandManagerMt::IslandCallback* pCallback);
+};
+
+//Multithreaded world that solves its islands with the number of threads it was created with
+ATTRIBUTE_ALIGNED16(class) BulletDynamicsWorldMt : public btDiscreteDynamicsWorldMt
+{
+	unsigned int m_numThreads;
+protected:
+	virtual void solveConstraints(btContactSolverInfo& solverInfo);
+public:
+	BT_DECLARE_ALIGNED_ALLOCATOR();
+
+	BulletDynamicsWorldMt(unsigned int numThreads, btDispatcher* dispatcher, btBroadphaseInterface* pairCache
+		, btConstraintSolver* constraintSolver, btCollisionConfiguration* collisionConfiguration);
+	unsigned int getNumThreads() const { return m_numThreads; }
+};
+
+//Constraint solver that can be used by several threads at the same time. btSequentialImpulseConstraintSolver keeps its
+//temporary buffers in the object, so each solveGroup() call is forwarded to a solver not being used by other thread
+class BulletConstraintSolverPool : public btConstraintSolver
+{
+	struct PooledSolver
+	{
+		BT_DECLARE_ALIGNED_ALLOCATOR();
+		btSequentialImpulseConstraintSolver solver;
+		std::mutex mutex;
+	};
+	std::vector<PooledSolver*> m_solvers;
+public:
+	BulletConstraintSolverPool(unsigned int numSolvers);
+	virtual ~BulletConstraintSolverPool();
+
+	virtual btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds
+		, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer
+		, btDispatcher* dispatcher);
+	virtual void reset();
+	virtual btConstraintSolverType getSolverType() const { return BT_SEQUENTIAL_IMPULSE_SOLVER; }
+};
@@ -26,6 +26,9 @@
 #include "BulletPhysics.h"
 #include "BulletBody.h"
 #include "Box.h"
+#include "BulletSnapshot.h"
+#include "../app.h"
+#include <algorithm>
 
 //static public constants
 const double BulletPhysics::MASS_ROBOT = 0.5f;
@@ -56,9 +59,21 @@ const double BulletPhysics::theta_o1 = 0.0;
 const double BulletPhysics::theta_o2 = 0.0;
 
 // Initialization of physics
-void BulletPhysics::initPhysics()
+void BulletPhysics::initPhysics(int numThreads)
 {
-	createEmptyDynamicsWorld();
+	if (numThreads == 1)
+	{
+		createEmptyDynamicsWorld();
+		return;
+	}
+	unsigned int numRequestedThreads = (unsigned int)std::max(0, numThreads);
+	createEmptyDynamicsWorldMt(numRequestedThreads);
+
+	//the threads are requested as CPU cores, so that they are reserved when the experiment is run remotely
+	SimionApp* pApp = SimionApp::get();
+	if (pApp && pApp->getNumCPUCores() != 0
+		&& (numRequestedThreads == 0 || numRequestedThreads > pApp->getNumCPUCores()))
+		pApp->setNumCPUCores(numRequestedThreads);
 }
 
 // Initialization of soft physics
@@ -130,8 +145,136 @@ void BulletPhysics::initPlayground()
 
 void BulletPhysics::reset(State* s)
 {
+	if (m_initialState.isEmpty())
+	{
+		for (auto it = m_bulletObjects.begin(); it != m_bulletObjects.end(); ++it)
+			(*it)->reset(s);
+		saveState(m_initialState);
+	}
+	//the first episode also restores the initial state so that all of them start with the same broadphase
+	restoreState(m_initialState);
+	updateState(s);
+}
+
+//Bullet doesn't give access to the time accumulated between fixed substeps, which is part of the state of the
+//world. A derived class can name the protected member to get a pointer that can be used with any world
+struct DynamicsWorldLocalTime : public btDiscreteDynamicsWorld
+{
+	static btScalar btDiscreteDynamicsWorld::* get() { return &DynamicsWorldLocalTime::m_localTime; }
+};
+
+void BulletPhysics::saveState(BulletWorldSnapshot& snapshot)
+{
+	snapshot.clear();
+
+	//the number of objects of each type is saved to check that the snapshot is restored in a world with the same layout
+	snapshot.write((double)m_bulletObjects.size());
+	snapshot.write((double)m_pSoftObjects.size());
+	snapshot.write((double)m_dynamicsWorld->getNumConstraints());
+	snapshot.write(m_dynamicsWorld->*DynamicsWorldLocalTime::get());
+
 	for (auto it = m_bulletObjects.begin(); it != m_bulletObjects.end(); ++it)
-		(*it)->reset(s);
+		(*it)->saveState(snapshot);
+
+	for (auto it = m_pSoftObjects.begin(); it != m_pSoftObjects.end(); ++it)
+	{
+		btSoftBody::tNodeArray& nodes = (*it)->m_nodes;
+		snapshot.write((double)nodes.size());
+		for (int i = 0; i < nodes.size(); ++i)
+		{
+			snapshot.write(nodes[i].m_x);
+			snapshot.write(nodes[i].m_q);
+			snapshot.write(nodes[i].m_v);
+			snapshot.write(nodes[i].m_f);
+		}
+	}
+
+	for (int i = 0; i < m_dynamicsWorld->getNumConstraints(); ++i)
+	{
+		btTypedConstraint* pConstraint = m_dynamicsWorld->getConstraint(i);
+		snapshot.write(pConstraint->isEnabled() ? 1.0 : 0.0);
+		snapshot.write(pConstraint->getAppliedImpulse());
+	}
+}
+
+bool BulletPhysics::restoreState(const BulletWorldSnapshot& snapshot)
+{
+	BulletSnapshotReader reader(snapshot);
+
+	if (reader.read() != (double)m_bulletObjects.size() || reader.read() != (double)m_pSoftObjects.size()
+		|| reader.read() != (double)m_dynamicsWorld->getNumConstraints())
+		return false;
+	m_dynamicsWorld->*DynamicsWorldLocalTime::get() = (btScalar)reader.read();
+
+	for (auto it = m_bulletObjects.begin(); it != m_bulletObjects.end(); ++it)
+		(*it)->restoreState(reader);
+
+	for (auto it = m_pSoftObjects.begin(); it != m_pSoftObjects.end(); ++it)
+	{
+		btSoftBody* pSoftBody = *it;
+		btSoftBody::tNodeArray& nodes = pSoftBody->m_nodes;
+		if (reader.read() != (double)nodes.size())
+			return false;
+		for (int i = 0; i < nodes.size(); ++i)
+		{
+			reader.read(nodes[i].m_x);
+			reader.read(nodes[i].m_q);
+			reader.read(nodes[i].m_v);
+			reader.read(nodes[i].m_f);
+		}
+		//the tree of bounding volumes of the nodes depends on the previous steps (and so does the order in which
+		//contacts are found), so it is built again as btSoftBody's constructor does
+		const btScalar margin = pSoftBody->getCollisionShape()->getMargin();
+		pSoftBody->m_ndbvt.clear();
+		for (int i = 0; i < nodes.size(); ++i)
+			nodes[i].m_leaf = pSoftBody->m_ndbvt.insert(btDbvtVolume::FromCR(nodes[i].m_x, margin), &nodes[i]);
+		pSoftBody->updateBounds();
+	}
+
+	for (int i = 0; i < m_dynamicsWorld->getNumConstraints(); ++i)
+	{
+		btTypedConstraint* pConstraint = m_dynamicsWorld->getConstraint(i);
+		pConstraint->setEnabled(reader.read() != 0.0);
+		pConstraint->internalSetAppliedImpulse((btScalar)reader.read());
+	}
+
+	//must be done after restoring the transforms: the bounding boxes of the bodies are calculated when they are added
+	rebuildBroadphase();
+
+	return reader.isOk() && reader.isAtEnd();
+}
+
+void BulletPhysics::rebuildBroadphase()
+{
+	//All the collision objects are removed and added again in the same order with an empty broadphase in between, so
+	//that pairs, contact points and the solver start from the same state every time a snapshot is restored.
+	//Otherwise, the simulation would depend on the contacts found before restoring the snapshot
+	btCollisionObjectArray& collisionObjects = m_dynamicsWorld->getCollisionObjectArray();
+	m_collisionObjectEntries.resize(collisionObjects.size());
+	for (int i = 0; i < collisionObjects.size(); ++i)
+	{
+		btBroadphaseProxy* pProxy = collisionObjects[i]->getBroadphaseHandle();
+		m_collisionObjectEntries[i].pObject = collisionObjects[i];
+		m_collisionObjectEntries[i].group = pProxy ? pProxy->m_collisionFilterGroup : btBroadphaseProxy::DefaultFilter;
+		m_collisionObjectEntries[i].mask = pProxy ? pProxy->m_collisionFilterMask : btBroadphaseProxy::AllFilter;
+	}
+	for (int i = (int)m_collisionObjectEntries.size() - 1; i >= 0; --i)
+		m_dynamicsWorld->removeCollisionObject(m_collisionObjectEntries[i].pObject);
+
+	m_dynamicsWorld->getBroadphase()->resetPool(m_dynamicsWorld->getDispatcher());
+	m_dynamicsWorld->getConstraintSolver()->reset();
+
+	for (auto it = m_collisionObjectEntries.begin(); it != m_collisionObjectEntries.end(); ++it)
+	{
+		btRigidBody* pRigidBody = btRigidBody::upcast(it->pObject);
+		btSoftBody* pSoftBody = btSoftBody::upcast(it->pObject);
+		if (pRigidBody)
+			m_dynamicsWorld->addRigidBody(pRigidBody, it->group, it->mask);
+		else if (pSoftBody)
+			getSoftDynamicsWorld()->addSoftBody(pSoftBody, it->group, it->mask);
+		else
+			m_dynamicsWorld->addCollisionObject(it->pObject, it->group, it->mask);
+	}
 }
 
 void BulletPhysics::updateState(State* s)
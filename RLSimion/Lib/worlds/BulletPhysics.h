@@ -2,6 +2,7 @@
 #include "../../../3rd-party/bullet3-2.86/src/btBulletDynamicsCommon.h"
 
 #include "BulletCreationInterface.h"
+#include "BulletSnapshot.h"
 
 #include <stdio.h>
 #include <vector>
@@ -16,6 +17,18 @@ class BulletPhysics : public BulletCreationInterface
 	std::vector<btSoftBody*> m_pSoftObjects;
 
 	std::vector<BulletBody*> m_bulletObjects;
+
+	//state of the world after placing all the bodies in their origins. Episodes start by restoring it
+	BulletWorldSnapshot m_initialState;
+
+	struct CollisionObjectEntry
+	{
+		btCollisionObject* pObject;
+		int group;
+		int mask;
+	};
+	std::vector<CollisionObjectEntry> m_collisionObjectEntries;
+	void rebuildBroadphase();
 public:
 	//CONSTANTS
 	static const double MASS_ROBOT;
@@ -50,7 +63,8 @@ public:
 	BulletPhysics() : BulletCreationInterface() {}
 	~BulletPhysics();
 
-	virtual void initPhysics();
+	//numThreads > 1 (or 0: all the CPU cores) creates a multithreaded world (see createEmptyDynamicsWorldMt())
+	virtual void initPhysics(int numThreads = 1);
 	virtual void initSoftPhysics();
 	void initPlayground();
 
@@ -64,5 +78,14 @@ public:
 	void updateState(State* s);
 	void updateBulletState(State* s, const Action* a, double dt);
 
+	//Saves the dynamic state of the world: rigid bodies (transforms, velocities, activation), soft-body nodes,
+	//constraints and the time accumulated between fixed substeps
+	void saveState(BulletWorldSnapshot& snapshot);
+	//Restores a snapshot saved from this world or from an identical one (same bodies added in the same order).
+	//Restoring the same snapshot always leads to the same simulation: contacts cached in the broadphase are
+	//discarded. updateState() must be called afterwards to update the state variables.
+	//Returns false if the snapshot doesn't match the layout of this world
+	bool restoreState(const BulletWorldSnapshot& snapshot);
+
 	btAlignedObjectArray<btCollisionShape*> getCollisionShape();
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "BulletSnapshot.h"
+
+void BulletWorldSnapshot::write(const btVector3& vector)
+{
+	write(vector.x());
+	write(vector.y());
+	write(vector.z());
+}
+
+void BulletWorldSnapshot::write(const btTransform& transform)
+{
+	const btMatrix3x3& basis = transform.getBasis();
+	for (int row = 0; row < 3; ++row)
+		write(basis[row]);
+	write(transform.getOrigin());
+}
+
+BulletSnapshotReader::BulletSnapshotReader(const BulletWorldSnapshot& snapshot)
+{
+	m_pData = snapshot.getData();
+	m_pEnd = m_pData + snapshot.getSize();
+}
+
+double BulletSnapshotReader::read()
+{
+	if (m_pData == m_pEnd)
+	{
+		m_bOk = false;
+		return 0.0;
+	}
+	return *(m_pData++);
+}
+
+void BulletSnapshotReader::read(btVector3& vector)
+{
+	btScalar x = (btScalar)read();
+	btScalar y = (btScalar)read();
+	btScalar z = (btScalar)read();
+	vector.setValue(x, y, z);
+}
+
+void BulletSnapshotReader::read(btTransform& transform)
+{
+	btVector3 rows[3];
+	for (int row = 0; row < 3; ++row)
+		read(rows[row]);
+	transform.getBasis().setValue(rows[0].x(), rows[0].y(), rows[0].z()
+		, rows[1].x(), rows[1].y(), rows[1].z()
+		, rows[2].x(), rows[2].y(), rows[2].z());
+	btVector3 origin;
+	read(origin);
+	transform.setOrigin(origin);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "../../../3rd-party/bullet3-2.86/src/btBulletDynamicsCommon.h"
+#include <vector>
+
+//Copy of the dynamic state of a Bullet world (see BulletPhysics::saveState()). All the values are stored as doubles in
+//a single flat buffer: copying a snapshot is a single memcpy, and the buffer can be written/read as is
+class BulletWorldSnapshot
+{
+	std::vector<double> m_data;
+public:
+	//the buffer keeps its capacity, so saving again to the same snapshot doesn't allocate memory
+	void clear() { m_data.clear(); }
+	bool isEmpty() const { return m_data.empty(); }
+
+	const double* getData() const { return m_data.data(); }
+	size_t getSize() const { return m_data.size(); }
+	void setData(const double* pData, size_t size) { m_data.assign(pData, pData + size); }
+
+	void write(double value) { m_data.push_back(value); }
+	void write(const btVector3& vector);
+	void write(const btTransform& transform);
+};
+
+//Reads the values of a snapshot in the same order they were written. Reading past the end returns zeros and
+//the reader is flagged as failed
+class BulletSnapshotReader
+{
+	const double* m_pData;
+	const double* m_pEnd;
+	bool m_bOk = true;
+public:
+	BulletSnapshotReader(const BulletWorldSnapshot& snapshot);
+
+	double read();
+	void read(btVector3& vector);
+	void read(btTransform& transform);
+
+	bool isOk() const { return m_bOk; }
+	bool isAtEnd() const { return m_pData == m_pEnd; }
+};
@@ -31,6 +31,7 @@
 #include "../app.h"
 #include "../logger.h"
 #include "../experiment.h"
+#include "../noise.h"
 #include "../../../tools/System/Process.h"
 #include "../../../tools/System/CrossPlatform.h"
 #include <string>
@@ -48,6 +49,8 @@ using namespace std;
 #define SERVO_MODULE_CONFIG_FILE "../config/world/FAST/NRELOffshrBsline5MW_Onshore_ServoDyn.dat"
 #define PORTAL_CONFIG_FILE "FASTDimensionalPortal.xml"
 #define DIMENSIONAL_PORTAL_PIPE_NAME "FASTDimensionalPortal"
+#define DIMENSIONAL_PORTAL_SHARED_MEMORY_NAME "FASTDimensionalPortal"
+#define PORTAL_CONNECTION_POLL_MS 100
 #define DIMENSIONAL_PORTAL_DLL "../bin/FASTDimensionalPortal.dll"
 
 #define TRAINING_WIND_BASE_FILE_NAME "training-wind-file-"
@@ -64,6 +67,7 @@ FASTWindTurbine::FASTWindTurbine(ConfigNode* pConfigNode)
 	{
 		m_trainingMeanWindSpeeds = MULTI_VALUE_SIMPLE_PARAM<DOUBLE_PARAM, double>(pConfigNode, "Training-Mean-Wind-Speeds", "Mean wind speeds used in training episodes", 12.5);
 		m_evaluationMeanWindSpeeds = MULTI_VALUE_SIMPLE_PARAM<DOUBLE_PARAM, double>(pConfigNode, "Evaluation-Mean-Wind-Speeds", "Mean wind speeds in evaluation episodes", 12.5);
+		m_bSharedMemoryPortal = BOOL_PARAM(pConfigNode, "Shared-Memory-Portal", "Exchange data with FASTDimensionalPortal using shared memory instead of a named pipe", true);
 	}
 
 	//model constants
@@ -251,10 +255,55 @@ void FASTWindTurbine::deferredLoadStep()
 
 FASTWindTurbine::~FASTWindTurbine()
 {
-	m_namedPipeServer.closeServer();
+	closePortalServer();
 	Logger::logMessage(MessageType::Info, "Closed connection to FASTDimensionalPortal");
 }
 
+bool FASTWindTurbine::openPortalServer()
+{
+	m_bUsingSharedMemory = m_bSharedMemoryPortal.get()
+		&& m_sharedMemoryServer.openUniqueChannelServer(DIMENSIONAL_PORTAL_SHARED_MEMORY_NAME);
+	if (m_bUsingSharedMemory)
+		return true;
+	if (m_bSharedMemoryPortal.get())
+		Logger::logMessage(MessageType::Warning, "Couldn't open shared memory channel. Using a named pipe instead");
+	return m_namedPipeServer.openUniqueNamedPipeServer(DIMENSIONAL_PORTAL_PIPE_NAME);
+}
+
+void FASTWindTurbine::closePortalServer()
+{
+	m_sharedMemoryServer.closeServer();
+	m_namedPipeServer.closeServer();
+}
+
+bool FASTWindTurbine::waitForPortalClient()
+{
+	if (!m_bUsingSharedMemory)
+		return m_namedPipeServer.waitForClientConnection();
+
+	//FAST may fail before loading the DLL, so we check it is still running while we wait
+	while (FASTprocess.isRunning())
+	{
+		if (m_sharedMemoryServer.waitForClientConnection(PORTAL_CONNECTION_POLL_MS))
+			return true;
+	}
+	return false;
+}
+
+int FASTWindTurbine::writeToPortal(const void* pBuffer, int numBytes)
+{
+	if (m_bUsingSharedMemory)
+		return m_sharedMemoryServer.writeBuffer(pBuffer, numBytes);
+	return m_namedPipeServer.writeBuffer(pBuffer, numBytes);
+}
+
+int FASTWindTurbine::readFromPortal(void* pBuffer, int numBytes)
+{
+	if (m_bUsingSharedMemory)
+		return m_sharedMemoryServer.readToBuffer(pBuffer, numBytes);
+	return m_namedPipeServer.readToBuffer(pBuffer, numBytes);
+}
+
 
 
 void FASTWindTurbine::reset(State *s)
@@ -266,27 +315,32 @@ void FASTWindTurbine::reset(State *s)
 	//This may happen for slight inaccuracies of DT
 	if (FASTprocess.isRunning())
 		FASTprocess.stop();
-	//If the named pipe is already open, close it
-	m_namedPipeServer.closeServer();
+	//If the portal server is already open, close it
+	closePortalServer();
 
-	//Open the named pipe server
-	//FASTDimensionalPortal.xml -> used to pass the pipe's name to the dll
-	bool pipeServerOpened = m_namedPipeServer.openUniqueNamedPipeServer(DIMENSIONAL_PORTAL_PIPE_NAME);
-	if (pipeServerOpened)
+	//Open the portal server (shared memory channel or named pipe)
+	//FASTDimensionalPortal.xml -> used to pass the channel's name to the dll
+	bool portalServerOpened = openPortalServer();
+	if (portalServerOpened)
 	{
 		outConfigFileName = string(SimionApp::get()->getOutputDirectory()) + string("/")
 			+ string(PORTAL_CONFIG_FILE);
 		CrossPlatform::Fopen_s(&pOutConfigFile, outConfigFileName.c_str(), "w");
 		if (pOutConfigFile)
 		{
-			CrossPlatform::Fprintf_s(pOutConfigFile, "<?xml version=\"1.0\"?>\n<FAST-DIMENSIONAL-PORTAL>\n  <PIPE-NAME>%s</PIPE-NAME>\n</FAST-DIMENSIONAL-PORTAL>"
-				, m_namedPipeServer.getPipeFullName());
+			if (m_bUsingSharedMemory)
+				CrossPlatform::Fprintf_s(pOutConfigFile, "<?xml version=\"1.0\"?>\n<FAST-DIMENSIONAL-PORTAL>\n  <SHARED-MEMORY-NAME>%s</SHARED-MEMORY-NAME>\n</FAST-DIMENSIONAL-PORTAL>"
+					, m_sharedMemoryServer.getFullName());
+			else
+				CrossPlatform::Fprintf_s(pOutConfigFile, "<?xml version=\"1.0\"?>\n<FAST-DIMENSIONAL-PORTAL>\n  <PIPE-NAME>%s</PIPE-NAME>\n</FAST-DIMENSIONAL-PORTAL>"
+					, m_namedPipeServer.getPipeFullName());
 			fclose(pOutConfigFile);
-			Logger::logMessage(MessageType::Info, "FASTDimensionalPortal.dll: pipe server created");
+			Logger::logMessage(MessageType::Info, m_bUsingSharedMemory ? "FASTDimensionalPortal.dll: shared memory server created"
+				: "FASTDimensionalPortal.dll: pipe server created");
 		}
 		else Logger::logMessage(MessageType::Error, (string("Couldn't create config file: ") + outConfigFileName).c_str());
 	}
-	else Logger::logMessage(MessageType::Error, "Couldn't open named pipe server");
+	else Logger::logMessage(MessageType::Error, "Couldn't open portal server");
 
 
 	//Instantiate the templated FAST config file
@@ -305,7 +359,7 @@ void FASTWindTurbine::reset(State *s)
 		else
 		{
 			//training wind file
-			index = ((size_t)rand()) % m_trainingMeanWindSpeeds.size();
+			index = getRandomIndex(m_trainingMeanWindSpeeds.size());
 			windFile = string(TRAINING_WIND_BASE_FILE_NAME)
 				+ to_string(index) + string(".bts");
 		}
@@ -338,10 +392,15 @@ void FASTWindTurbine::reset(State *s)
 	if (bSpawned && FASTprocess.isRunning())
 	{
 		Logger::logMessage(MessageType::Info, "Waiting for the client to connect");
-		m_namedPipeServer.waitForClientConnection();
+		if (!waitForPortalClient())
+		{
+			Logger::logMessage(MessageType::Info, "FAST process ended prematurely");
+			SimionApp::get()->pExperiment->setTerminalState();
+			return;
+		}
 		Logger::logMessage(MessageType::Info, "Client connected");
 		//receive(s)
-		m_namedPipeServer.readToBuffer(s->getValueVector(), (int) s->getNumVars() * sizeof(double));
+		readFromPortal(s->getValueVector(), (int) s->getNumVars() * sizeof(double));
 	}
 	else
 	{
@@ -366,7 +425,7 @@ void FASTWindTurbine::executeAction(State *s,const Action *a,double dt)
 	//here we have to cheat the compiler (const). We don't want to, but we have to
 	double* pActionValues = ((Action*)a)->getValueVector();
 	int numBytesToWrite = sizeof(double) * 2; //hard-coded because there might be auxiliary actions added by the controller
-	int numBytesWritten= m_namedPipeServer.writeBuffer(pActionValues, numBytesToWrite);
+	int numBytesWritten= writeToPortal(pActionValues, numBytesToWrite);
 	if (numBytesToWrite != numBytesWritten)
 	{
 		Logger::logMessage(MessageType::Info, "FAST process ended prematurely");
@@ -377,7 +436,7 @@ void FASTWindTurbine::executeAction(State *s,const Action *a,double dt)
 
 	//receive(s')
 	size_t numBytesToRead = s->getNumVars() * sizeof(double);
-	size_t numBytesRead= m_namedPipeServer.readToBuffer(s->getValueVector(), (int) numBytesToRead);
+	size_t numBytesRead= readFromPortal(s->getValueVector(), (int) numBytesToRead);
 	if (numBytesToRead!=numBytesRead)
 	{
 		Logger::logMessage(MessageType::Info, "FAST process ended prematurely");
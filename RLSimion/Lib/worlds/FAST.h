@@ -3,6 +3,7 @@
 #include "world.h"
 #include "../deferred-load.h"
 #include "../../../tools/System/NamedPipe.h"
+#include "../../../tools/System/SharedMemoryChannel.h"
 #include "../../../tools/System/Process.h"
 #include "../parameters.h"
 #include "templatedConfigFile.h"
@@ -14,12 +15,22 @@ class FASTWindTurbine : public DynamicModel, public DeferredLoad
 {
 	Process FASTprocess,TurbSimProcess;
 	NamedPipeServer m_namedPipeServer;
+	SharedMemoryChannelServer m_sharedMemoryServer;
+	bool m_bUsingSharedMemory = false;
+	BOOL_PARAM m_bSharedMemoryPortal;
 
 	TemplatedConfigFile m_FASTConfigTemplate, m_FASTWindConfigTemplate, m_TurbSimConfigTemplate;
 
 	MULTI_VALUE_SIMPLE_PARAM<DOUBLE_PARAM,double> m_trainingMeanWindSpeeds;
 	MULTI_VALUE_SIMPLE_PARAM<DOUBLE_PARAM, double> m_evaluationMeanWindSpeeds;
 
+	//the shared memory channel is used if it could be opened. Otherwise, the named pipe is used
+	bool openPortalServer();
+	void closePortalServer();
+	bool waitForPortalClient();
+	int writeToPortal(const void* pBuffer, int numBytes);
+	int readFromPortal(void* pBuffer, int numBytes);
+
 public:
 
 	FASTWindTurbine(ConfigNode* pParameters);
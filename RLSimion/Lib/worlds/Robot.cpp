@@ -24,6 +24,7 @@
 */
 
 #include "Robot.h"
+#include "BulletSnapshot.h"
 
 
 Robot::Robot(double mass, const btVector3& pos, btCollisionShape* shape)
@@ -60,4 +61,16 @@ void Robot::updateYawState(State* s)
 	//because this value is calculated in updateBulletVelocities() internally, we don't retrieve
 	//it from bullet, but from the locally stored value
 	s->set(m_thetaId, m_theta);
+}
+
+void Robot::saveState(BulletWorldSnapshot& snapshot)
+{
+	BulletBody::saveState(snapshot);
+	snapshot.write(m_theta);
+}
+
+void Robot::restoreState(BulletSnapshotReader& reader)
+{
+	BulletBody::restoreState(reader);
+	m_theta = reader.read();
 }
\ No newline at end of file
@@ -17,4 +17,7 @@ public:
 	void setActionIds(const char* v, const char* omega) { m_vId = v; m_omegaId = omega; }
 
 	virtual void updateYawState(State* s);
+
+	virtual void saveState(BulletWorldSnapshot& snapshot);
+	virtual void restoreState(BulletSnapshotReader& reader);
 };
\ No newline at end of file
@@ -36,25 +36,29 @@ double static getDistanceBetweenPoints(double x1, double y1, double x2, double y
 }
 
 DistanceReward2D::DistanceReward2D(Descriptor& stateDescr, const char* var1xName, const char* var1yName, const char* var2xName, const char* var2yName)
+	: m_var1x(var1xName), m_var1y(var1yName), m_var2x(var2xName), m_var2y(var2yName)
 {
-	m_var1xId = var1xName;
-	m_var1yId = var1yName;
-	m_var2xId = var2xName;
-	m_var2yId = var2yName;
-
 	//here we assume both variables have the same value range
-	m_maxDist = sqrt(stateDescr.getProperties(m_var1xId)->getRangeWidth()
-		* stateDescr.getProperties(m_var1xId)->getRangeWidth()
-		+ stateDescr.getProperties(m_var1yId)->getRangeWidth()
-		* stateDescr.getProperties(m_var1yId)->getRangeWidth());
+	m_maxDist = sqrt(stateDescr.getProperties(var1xName)->getRangeWidth()
+		* stateDescr.getProperties(var1xName)->getRangeWidth()
+		+ stateDescr.getProperties(var1yName)->getRangeWidth()
+		* stateDescr.getProperties(var1yName)->getRangeWidth());
+}
+
+void DistanceReward2D::initialize(Descriptor& stateDescriptor, Descriptor&)
+{
+	m_var1x.resolve(stateDescriptor);
+	m_var1y.resolve(stateDescriptor);
+	m_var2x.resolve(stateDescriptor);
+	m_var2y.resolve(stateDescriptor);
 }
 
 double DistanceReward2D::getReward(const State* s, const Action* a, const State* s_p)
 {
-	double boxX = s_p->get(m_var1xId);
-	double boxY = s_p->get(m_var1yId);
-	double targetX = s_p->get(m_var2xId);
-	double targetY = s_p->get(m_var2yId);
+	double boxX = m_var1x.get(s_p);
+	double boxY = m_var1y.get(s_p);
+	double targetX = m_var2x.get(s_p);
+	double targetY = m_var2y.get(s_p);
 
 	double distance = getDistanceBetweenPoints(targetX, targetY, boxX, boxY);
 
@@ -8,10 +8,11 @@ class Descriptor;
 
 class DistanceReward2D : public IRewardComponent
 {
-	const char *m_var1xId = nullptr, *m_var1yId = nullptr, *m_var2xId = nullptr, *m_var2yId = nullptr;
+	RewardVariable m_var1x, m_var1y, m_var2x, m_var2y;
 	double m_maxDist= 1.0;
 public:
 	DistanceReward2D(Descriptor& stateDescr, const char* var1xName, const char* var1yName, const char* var2xName, const char* var2yName);
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action *a, const State *s_p);
 	const char* getName() { return "reward"; }
 	double getMin();
@@ -113,10 +113,16 @@ void BalancingPole::executeAction(State *s, const Action *a, double dt)
 }
 
 #define twelve_degrees 0.2094384
+void BalancingPoleReward::initialize(Descriptor& stateDescriptor, Descriptor&)
+{
+	m_theta.resolve(stateDescriptor);
+	m_x.resolve(stateDescriptor);
+}
+
 double BalancingPoleReward::getReward(const State* s, const Action* a, const State* s_p)
 {
-	double theta = s_p->get("theta");
-	double x = s_p->get("x");
+	double theta = m_theta.get(s_p);
+	double x = m_x.get(s_p);
 
 	if (x < -2.4 || x > 2.4 || theta < -twelve_degrees || theta > twelve_degrees)
 	{
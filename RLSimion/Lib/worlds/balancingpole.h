@@ -32,7 +32,10 @@ public:
 
 class BalancingPoleReward : public IRewardComponent
 {
+	RewardVariable m_theta{ "theta" };
+	RewardVariable m_x{ "x" };
 public:
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action *a, const State *s_p);
 	const char* getName(){ return "reward"; }
 	double getMin();
@@ -109,11 +109,17 @@ void DoublePendulum::executeAction(State *s, const Action *a, double dt)
 	s->set(m_sTheta2Dot, theta_2_dot + theta_2_dot_dot * dt);
 }
 
+void DoublePendulumReward::initialize(Descriptor& stateDescriptor, Descriptor&)
+{
+	m_theta1.resolve(stateDescriptor);
+	m_theta2.resolve(stateDescriptor);
+}
+
 double DoublePendulumReward::getReward(const State* s, const Action* a, const State* s_p)
 {
 	//https://scholarworks.umass.edu/cgi/viewcontent.cgi?referer=https://www.google.com/&httpsredir=1&article=1130&context=cs_faculty_pubs
-	double theta_1 = s->get("theta_1");
-	double theta_2 = s->get("theta_2");
+	double theta_1 = m_theta1.get(s);
+	double theta_2 = m_theta2.get(s);
 	double dist1 = std::min(abs(3.1415 - theta_1), abs(-3.1415 - theta_1));
 	double dist2 = std::min(abs(3.1415 - theta_2), abs(-3.1415 - theta_2));
 	double tolerance = 0.75;
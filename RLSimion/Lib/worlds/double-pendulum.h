@@ -30,8 +30,11 @@ public:
 class DoublePendulumReward : public IRewardComponent
 {
 	double m_timeInGoal= 0.0;
+	RewardVariable m_theta1{ "theta_1" };
+	RewardVariable m_theta2{ "theta_2" };
 public:
 	DoublePendulumReward() = default;
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action *a, const State *s_p);
 	const char* getName() { return "reward"; }
 	double getMin();
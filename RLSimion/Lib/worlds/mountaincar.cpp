@@ -109,19 +109,26 @@ void MountainCar::executeAction(State *s, const Action *a, double dt)
 }
 
 
+void MountainCarReward::initialize(Descriptor& stateDescriptor, Descriptor&)
+{
+	m_position.resolve(stateDescriptor);
+	m_minPosition = stateDescriptor.getProperties("position")->getMin();
+	m_maxPosition = stateDescriptor.getProperties("position")->getMax();
+}
+
 double MountainCarReward::getReward(const State* s, const Action* a, const State* s_p)
 {
-	double position = s_p->get("position");
+	double position = m_position.get(s_p);
 
 	//reached the goal?
-	if (position == s_p->getProperties("position")->getMax())
+	if (position == m_maxPosition)
 	{
 		SimionApp::get()->pExperiment->setTerminalState();
 		return 1.0;
 	}
 
 	//reached the minimum position to the left?
-	if (position == s_p->getProperties("position")->getMin())
+	if (position == m_minPosition)
 	{
 		//in Sutton's description the experiment would now be terminated.
 		//In the Degris' the experiment is only terminated at the right side of the world.
@@ -28,8 +28,11 @@ public:
 
 class MountainCarReward : public IRewardComponent
 {
+	RewardVariable m_position{ "position" };
+	double m_minPosition = 0.0, m_maxPosition = 0.0;
 public:
 	MountainCarReward() = default;
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action *a, const State *s_p);
 	const char* getName(){ return "reward"; }
 	double getMin();
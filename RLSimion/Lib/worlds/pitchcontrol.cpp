@@ -31,6 +31,7 @@
 #include "../experiment.h"
 #include "../config.h"
 #include "../app.h"
+#include "../noise.h"
 
 PitchControl::PitchControl(ConfigNode* pConfigNode)
 {
@@ -46,7 +47,6 @@ PitchControl::PitchControl(ConfigNode* pConfigNode)
 	FILE_PATH_PARAM filename= FILE_PATH_PARAM(pConfigNode, "Set-Point-File","The setpoint file", "../config/world/pitch-control/setpoint.txt");
 	m_pSetpoint = new FileSetPoint(filename.get());
 
-	m_pRewardFunction = new RewardFunction();
 	m_pRewardFunction->addRewardComponent(new ToleranceRegionReward("control-deviation", 0.02, 1.0));
 	m_pRewardFunction->initialize();
 }
@@ -66,7 +66,7 @@ void PitchControl::reset(State *s)
 	else
 	{
 		//random point in [-0.5,0.5]
-		u= ((double)(rand()%10000))/ 10000.0;
+		u= ((double)getRandomIndex(10000))/ 10000.0;
 		s->set(m_sSetpointPitch, (2 * u - 0.5)*0.5);
 	}
 	s->set(m_sAttackAngle,0.0);
@@ -59,10 +59,13 @@ PushBox1::PushBox1(ConfigNode* pConfigNode)
 	addActionVariable("robot1-v", "m/s", -2.0, 2.0);
 	addActionVariable("robot1-omega", "rad/s", -8.0, 8.0);
 
+	m_numPhysicsThreads = INT_PARAM(pConfigNode, "Num-Physics-Threads"
+		, "Threads used to solve the physics simulation (0: all the CPU cores)", 1);
+
 	//Init Bullet
 	m_pBulletPhysics = new BulletPhysics();
 
-	m_pBulletPhysics->initPhysics();
+	m_pBulletPhysics->initPhysics(m_numPhysicsThreads.get());
 	m_pBulletPhysics->initPlayground();
 
 	/// Creating target point, kinematic
@@ -16,6 +16,8 @@ class PushBox1 : public DynamicModel
 	size_t m_theta;
 	size_t m_boxTheta;
 
+	INT_PARAM m_numPhysicsThreads;
+
 	///Graphic initialization
 	BulletPhysics* m_pBulletPhysics;
 
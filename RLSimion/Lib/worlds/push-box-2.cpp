@@ -70,9 +70,12 @@ PushBox2::PushBox2(ConfigNode* pConfigNode)
 	addActionVariable("robot2-v", "m/s", -2.0, 2.0);
 	addActionVariable("robot2-omega", "rad/s", -8.0, 8.0);
 
+	m_numPhysicsThreads = INT_PARAM(pConfigNode, "Num-Physics-Threads"
+		, "Threads used to solve the physics simulation (0: all the CPU cores)", 1);
+
 	m_pBulletPhysics = new BulletPhysics();
 
-	m_pBulletPhysics->initPhysics();
+	m_pBulletPhysics->initPhysics(m_numPhysicsThreads.get());
 	m_pBulletPhysics->initPlayground();
 
 	/// Creating target point, kinematic
@@ -19,6 +19,8 @@ class PushBox2 : public DynamicModel
 	size_t m_theta_r1;
 	size_t m_theta_r2;
 	
+	INT_PARAM m_numPhysicsThreads;
+
 	BulletPhysics* m_pBulletPhysics;
 
 public:
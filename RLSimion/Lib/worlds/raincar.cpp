@@ -77,11 +77,18 @@ void RainCar::executeAction(State *s, const Action *a, double dt)
 }
 
 
-double RainCarReward::getReward(const State* s, const Action* a, const State* s_p)
+void RainCarReward::initialize(Descriptor& stateDescriptor, Descriptor&)
 {
-	double position = s_p->get("position");
-	if ((position == s->getProperties("position")->getMin() && a->get((size_t)0) < 0.0)
-		|| (position == s->getProperties("position")->getMax() && a->get((size_t)0) > 0.0))
+	m_position.resolve(stateDescriptor);
+	m_minPosition = stateDescriptor.getProperties("position")->getMin();
+	m_maxPosition = stateDescriptor.getProperties("position")->getMax();
+}
+
+double RainCarReward::getReward(const State*, const Action* a, const State* s_p)
+{
+	double position = m_position.get(s_p);
+	if ((position == m_minPosition && a->get((size_t)0) < 0.0)
+		|| (position == m_maxPosition && a->get((size_t)0) > 0.0))
 		return -10;
 	double targetPosition = 24.0;
 
@@ -27,8 +27,11 @@ public:
 
 class RainCarReward : public IRewardComponent
 {
+	RewardVariable m_position{ "position" };
+	double m_minPosition = 0.0, m_maxPosition = 0.0;
 public:
 	RainCarReward() = default;
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action *a, const State *s_p);
 	const char* getName(){ return "reward"; }
 	double getMin();
@@ -52,8 +52,11 @@ RobotControl::RobotControl(ConfigNode* pConfigNode)
 	MASS_GROUND = 0.f;
 	MASS_TARGET = 0.1f;
 
+	m_numPhysicsThreads = INT_PARAM(pConfigNode, "Num-Physics-Threads"
+		, "Threads used to solve the physics simulation (0: all the CPU cores)", 1);
+
 	m_pBulletPhysics = new BulletPhysics();
-	m_pBulletPhysics->initPhysics();
+	m_pBulletPhysics->initPhysics(m_numPhysicsThreads.get());
 	m_pBulletPhysics->initPlayground();
 	
 	/// Creating target point, kinematic
@@ -24,6 +24,8 @@ class RobotControl : public DynamicModel
 	// Action variables
 	size_t m_linear_vel;
 
+	INT_PARAM m_numPhysicsThreads;
+
 	///inicializacin
 	BulletPhysics* m_pBulletPhysics;
 
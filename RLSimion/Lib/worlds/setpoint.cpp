@@ -27,7 +27,9 @@
 #include "../config.h"
 #include "../logger.h"
 #include "../app.h"
+#include "../noise.h"
 #include "../../../tools/System/CrossPlatform.h"
+#include <math.h>
 
 //FileSetPoint//////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////
@@ -82,9 +84,9 @@ FileSetPoint::FileSetPoint(const char* filename)
 		m_pSetPoints= new double [numLines];
 		m_pTimes= new double [numLines];
 
-		while (!feof(pFile))
+		//the last line would be parsed twice if we didn't check the value returned by fgets
+		while (fgets(buffer,1024,pFile))
 		{
-			fgets(buffer,1024,pFile);
 			if (CrossPlatform::Sscanf_s(buffer,"%lf %lf\n",&m_pTimes[m_numSteps],&m_pSetPoints[m_numSteps])==2)
 				m_numSteps++;
 		}
@@ -96,6 +98,12 @@ FileSetPoint::FileSetPoint(const char* filename)
 	}
 
 	m_totalTime= m_pTimes[m_numSteps-1];
+	initTimeAxis();
+}
+
+void FileSetPoint::initTimeAxis()
+{
+	m_timeAxis.init(m_pTimes, m_numSteps);
 }
 
 
@@ -115,31 +123,27 @@ FileSetPoint::~FileSetPoint()
 
 double FileSetPoint::getPointSet(double time)
 {
-	int i= 0;
-
 	if (m_totalTime==0) return 0.0;
 
-	while (time>m_totalTime)
-		time-= m_totalTime;
-
-	//first approach: assume equal-lenght time points
-	i= (int) (time/(m_totalTime/m_numSteps));
-
-	//forward?
-	while (i< m_numSteps-1 && time>m_pTimes[i+1])
-		i++;
-	//backward?
-	while (i>=0 && time<m_pTimes[i])
-		i--;
-
-	if (i<m_numSteps-1)
+	//the set point is repeated periodically
+	if (time>m_totalTime)
 	{
-		double u;
-		u= ((time-m_pTimes[i])/(m_pTimes[i+1]-m_pTimes[i]));
-		return m_pSetPoints[i] + u* (m_pSetPoints[i+1]-m_pSetPoints[i]);
+		time= fmod(time, m_totalTime);
+		if (time==0.0) time= m_totalTime;
 	}
 
-	return m_pSetPoints[m_numSteps-1];//step % m_numSteps];
+	double u;
+	size_t i= m_timeAxis.getSegment(time, u);
+	if ((int) i<m_numSteps-1)
+		return m_pSetPoints[i] + u* (m_pSetPoints[i+1]-m_pSetPoints[i]);
+
+	return m_pSetPoints[m_numSteps-1];
+}
+
+void FileSetPoint::getPointSets(const double* pTimes, double* pOutValues, size_t numValues)
+{
+	for (size_t i = 0; i < numValues; ++i)
+		pOutValues[i] = getPointSet(pTimes[i]);
 }
 
 //HHFileSetPoint//////////////////////////////////////////////
@@ -162,9 +166,8 @@ HHFileSetPoint::HHFileSetPoint(const char* filename) : FileSetPoint()
 		m_pSetPoints = new double[numLines];
 		m_pTimes = new double[numLines];
 
-		while (!feof(pHHFile))
+		while (fgets(buffer, 1024, pHHFile))
 		{
-			fgets(buffer, 1024, pHHFile);
 			if (buffer[0] != '!') //skip comments
 			{
 				m_pTimes[m_numSteps] = strtod(buffer, &pNext);		//first value is the time
@@ -174,6 +177,7 @@ HHFileSetPoint::HHFileSetPoint(const char* filename) : FileSetPoint()
 			}
 		}
 		m_totalTime = m_pTimes[m_numSteps - 1];
+		initTimeAxis();
 		fclose(pHHFile);
 	}
 	else
@@ -201,7 +205,7 @@ double FixedStepSizeSetPoint::getPointSet(double time)
 {
 	if (time==0.0 || (time-m_lastStepTime>m_stepTime))
 	{
-		m_lastSetPoint= ((double)(rand()%10000))*(m_max-m_min) + m_min;
+		m_lastSetPoint= ((double)getRandomIndex(10000))*(m_max-m_min) + m_min;
 		m_lastStepTime= time;
 	}
 	return m_lastSetPoint;
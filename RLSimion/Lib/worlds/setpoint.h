@@ -1,4 +1,5 @@
 #pragma once
+#include "../utils.h"
 
 class ConfigNode;
 
@@ -18,12 +19,18 @@ protected:
 	double *m_pSetPoints;
 	double *m_pTimes;
 	double m_totalTime;
+	InterpolationAxis m_timeAxis;
+
+	//must be called by the constructors once the set points have been read
+	void initTimeAxis();
 public:
 	FileSetPoint();
 	FileSetPoint(const char* filename);
 	virtual ~FileSetPoint();
 
 	double getPointSet(double time);
+	//Batched version: evaluates the set point in numValues time points
+	void getPointSets(const double* pTimes, double* pOutValues, size_t numValues);
 };
 
 class HHFileSetPoint : public FileSetPoint
@@ -85,9 +85,14 @@ void SwingupPendulum::executeAction(State *s, const Action *a, double dt)
 	s->set(m_sAngularVelocity, angularVelocity);
 }
 
+void SwingupPendulumReward::initialize(Descriptor& stateDescriptor, Descriptor&)
+{
+	m_angle.resolve(stateDescriptor);
+}
+
 double SwingupPendulumReward::getReward(const State* s, const Action* a, const State* s_p)
 {
-	double angle = s_p->get("angle");
+	double angle = m_angle.get(s_p);
 
 	if (abs(angle) < 0.05)
 		//measure the time within the target angle range
@@ -29,8 +29,10 @@ public:
 class SwingupPendulumReward : public IRewardComponent
 {
 	double m_timeInGoal= 0.0;
+	RewardVariable m_angle{ "angle" };
 public:
 	SwingupPendulumReward() = default;
+	void initialize(Descriptor& stateDescriptor, Descriptor& actionDescriptor);
 	double getReward(const State *s, const Action *a, const State *s_p);
 	const char* getName() { return "reward"; }
 	double getMin();
@@ -32,6 +32,7 @@
 #include "../logger.h"
 #include "../app.h"
 #include "../reward.h"
+#include "../noise.h"
 
 #include <math.h>
 
@@ -211,7 +212,7 @@ void WindTurbine::reset(State *s)
 	if (SimionApp::get()->pExperiment->isEvaluationEpisode())
 		m_pCurrentWindData = m_pEvaluationWindData;
 	else
-		m_pCurrentWindData = m_pTrainingWindData[rand() % m_numDataFiles];
+		m_pCurrentWindData = m_pTrainingWindData[getRandomIndex(m_numDataFiles)];
 
 	double initial_wind_speed = getConstant("RatedWindSpeed");
 	double initial_rotor_speed= getConstant("RatedRotorSpeed");
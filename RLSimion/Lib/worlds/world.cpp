@@ -46,7 +46,7 @@
 #include "../logger.h"
 #include "../experiment.h"
 
-CHILD_OBJECT_FACTORY<DynamicModel> World::m_pDynamicModel;
+thread_local CHILD_OBJECT_FACTORY<DynamicModel> World::m_pDynamicModel;
 
 World::World(ConfigNode* pConfigNode)
 {
@@ -135,7 +135,7 @@ DynamicModel::DynamicModel()
 	m_pStateDescriptor = new Descriptor(pSimionApp);	//the simion app is the default wire manager
 	m_pActionDescriptor = new Descriptor(pSimionApp);
 
-	m_pRewardFunction = new RewardFunction();
+	m_pRewardFunction = new RewardFunction(*m_pStateDescriptor, *m_pActionDescriptor);
 }
 
 size_t DynamicModel::addStateVariable(const char* name, const char* units, double min, double max, bool bCircular)
@@ -66,7 +66,7 @@ public:
 
 class World
 {
-	static CHILD_OBJECT_FACTORY<DynamicModel> m_pDynamicModel;
+	static thread_local CHILD_OBJECT_FACTORY<DynamicModel> m_pDynamicModel;
 	INT_PARAM m_numIntegrationSteps;
 	DOUBLE_PARAM m_dt;
 
@@ -0,0 +1,41 @@
+// benchmarks.cpp : Defines the entry point for the console application.
+//
+
+#include "stdafx.h"
+#include "benchmarks.h"
+#include <string.h>
+
+struct Benchmark
+{
+	const char* name;
+	const char* usage;
+	int(*run)(int argc, char** argv);
+};
+
+Benchmark benchmarks[] =
+{
+	{ "logger", "logger <experiment-file> [num-episodes] [num-repetitions]", loggerBenchmark },
+	{ "portal", "portal [num-round-trips]", portalBenchmark },
+	{ "interpolation", "interpolation [table-file] [num-lookups]", interpolationBenchmark },
+	{ "bullet", "bullet [num-steps] [max-num-threads]", bulletBenchmark },
+	{ "hotpaths", "hotpaths [experiment-files...] [-json=<file>] [-baseline=<file>] [-tolerance=<percent>] [-min-time=<seconds>] [-filter=<text>]", hotpathsBenchmark },
+	{ "precision", "precision <experiment-files...> [-num-episodes=<n>]", precisionBenchmark },
+	{ "memory", "memory [num-weights] [num-gathers] [num-init-threads]", memoryBenchmark }
+};
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+	{
+		for (const Benchmark& benchmark : benchmarks)
+		{
+			if (!strcmp(argv[1], benchmark.name))
+				return benchmark.run(argc - 1, argv + 1);
+		}
+	}
+
+	printf("Usage: Benchmarks <benchmark> [arguments]\nAvailable benchmarks:\n");
+	for (const Benchmark& benchmark : benchmarks)
+		printf("  %s\n", benchmark.usage);
+	return 1;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+//Each benchmark is run from the command line: Benchmarks <benchmark-name> [benchmark-arguments...]
+//argv[0] is the name of the benchmark
+int loggerBenchmark(int argc, char** argv);
+int portalBenchmark(int argc, char** argv);
+int interpolationBenchmark(int argc, char** argv);
+int bulletBenchmark(int argc, char** argv);
+int hotpathsBenchmark(int argc, char** argv);
+int precisionBenchmark(int argc, char** argv);
+int memoryBenchmark(int argc, char** argv);
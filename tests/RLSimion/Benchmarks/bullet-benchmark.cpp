@@ -0,0 +1,117 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Lib/worlds/push-box-1.h"
+#include "../../../RLSimion/Lib/worlds/push-box-2.h"
+#include "../../../RLSimion/Lib/worlds/robot-control.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <math.h>
+
+//Measures the simulation steps per second of the Bullet worlds with the sequential world and with the multithreaded
+//world (Num-Physics-Threads) using an increasing number of threads. The random actions are the same in every run, so the
+//final state of each run is compared with the one of the sequential world
+
+namespace BulletBenchmark
+{
+	const double dt = 0.1; //the Delta-T used in the experiments with these worlds
+	const int numEpisodeSteps = 200;
+
+	struct WorldType
+	{
+		const char* name;
+		DynamicModel* (*create)(ConfigNode* pConfigNode);
+	};
+
+	template <typename World>
+	DynamicModel* create(ConfigNode* pConfigNode)
+	{
+		return new World(pConfigNode);
+	}
+
+	WorldType worldTypes[] =
+	{
+		{ "Push-Box-1", create<PushBox1> },
+		{ "Push-Box-2", create<PushBox2> },
+		{ "Robot-control", create<RobotControl> }
+	};
+
+	struct Results
+	{
+		double stepsPerSecond;
+		vector<double> finalState;
+	};
+
+	Results run(const WorldType& worldType, int numThreads, int numSteps)
+	{
+		ConfigFile configFile;
+		string xml = "<World><Num-Physics-Threads>" + to_string(numThreads) + "</Num-Physics-Threads></World>";
+		configFile.Parse(xml.c_str());
+		DynamicModel* pWorld = worldType.create((ConfigNode*)configFile.FirstChildElement());
+		State* s = pWorld->getStateInstance();
+		Action* a = pWorld->getActionInstance();
+
+		std::mt19937 generator(1);
+		std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < numSteps; ++i)
+		{
+			if (i % numEpisodeSteps == 0)
+				pWorld->reset(s);
+			for (size_t j = 0; j < a->getNumVars(); ++j)
+			{
+				NamedVarProperties* pProperties = a->getProperties(j);
+				a->set(j, pProperties->getMin() + distribution(generator) * pProperties->getRangeWidth());
+			}
+			pWorld->executeAction(s, a, dt);
+		}
+		double elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		Results results;
+		results.stepsPerSecond = numSteps / elapsedTime;
+		results.finalState.assign(s->getValueVector(), s->getValueVector() + s->getNumVars());
+		delete s;
+		delete a;
+		delete pWorld;
+		return results;
+	}
+
+	double maxDifference(const vector<double>& a, const vector<double>& b)
+	{
+		double maxDifference = 0.0;
+		for (size_t i = 0; i < a.size() && i < b.size(); ++i)
+			maxDifference = std::max(maxDifference, fabs(a[i] - b[i]));
+		return maxDifference;
+	}
+}
+
+int bulletBenchmark(int argc, char** argv)
+{
+	using namespace BulletBenchmark;
+
+	int numSteps = argc > 1 ? std::max(1, atoi(argv[1])) : 10 * numEpisodeSteps;
+	int maxNumThreads = argc > 2 ? std::max(1, atoi(argv[2])) : (int)std::max(1u, std::thread::hardware_concurrency());
+
+	printf("Bullet benchmark: %d steps of %.2fs, episodes of %d steps\n", numSteps, dt, numEpisodeSteps);
+	printf("%-14s %-12s %14s %10s %14s\n", "world", "threads", "steps/s", "speed-up", "max. diff.");
+	for (const WorldType& worldType : worldTypes)
+	{
+		Results sequential = run(worldType, 1, numSteps);
+		printf("%-14s %-12s %14.0f %10.2f %14g\n", worldType.name, "sequential", sequential.stepsPerSecond, 1.0, 0.0);
+
+		for (int numThreads = 2; numThreads <= std::max(2, maxNumThreads); numThreads *= 2)
+		{
+			Results multithreaded = run(worldType, numThreads, numSteps);
+			printf("%-14s %-12s %14.0f %10.2f %14g\n", worldType.name, ("mt-" + to_string(numThreads)).c_str()
+				, multithreaded.stepsPerSecond, multithreaded.stepsPerSecond / sequential.stepsPerSecond
+				, maxDifference(sequential.finalState, multithreaded.finalState));
+		}
+	}
+	return 0;
+}
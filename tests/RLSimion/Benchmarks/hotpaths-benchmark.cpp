@@ -0,0 +1,634 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/simgod.h"
+#include "../../../RLSimion/Lib/vfa.h"
+#include "../../../RLSimion/Lib/features.h"
+#include "../../../RLSimion/Lib/featuremap.h"
+#include "../../../RLSimion/Lib/etraces.h"
+#include "../../../RLSimion/Lib/experience-replay.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Lib/worlds/windturbine.h"
+#include "../../../RLSimion/Lib/worlds/underwatervehicle.h"
+#include "../../../RLSimion/Lib/worlds/pitchcontrol.h"
+#include "../../../RLSimion/Lib/worlds/balancingpole.h"
+#include "../../../RLSimion/Lib/worlds/push-box-1.h"
+#include "../../../RLSimion/Lib/worlds/push-box-2.h"
+#include "../../../RLSimion/Lib/worlds/pull-box-1.h"
+#include "../../../RLSimion/Lib/worlds/pull-box-2.h"
+#include "../../../RLSimion/Lib/worlds/robot-control.h"
+#include "../../../RLSimion/Lib/worlds/mountaincar.h"
+#include "../../../RLSimion/Lib/worlds/swinguppendulum.h"
+#include "../../../RLSimion/Lib/worlds/double-pendulum.h"
+#include "../../../RLSimion/Lib/worlds/raincar.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include "../../../tools/System/FileUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <math.h>
+
+//Micro-benchmarks of the hot paths of RLSimion: the time (ns) and the number of heap allocations per operation of
+//NamedVarSet access, feature mapping, LinearVFA get/add/argMax, eligibility traces, experience replay, the
+//executeAction() of each world, and the selectAction/update/postUpdate steps of a set of agents (one for each critic and
+//actor). Other agents can be measured passing their experiment files.
+//Results can be saved as JSON (-json=<file>) and compared with a previously saved baseline (-baseline=<file>): operations
+//slower than the baseline by more than the tolerance (-tolerance=<percent>, 10 by default) are reported as regressions
+//and make the benchmark return 1
+
+namespace HotPathsBenchmark
+{
+	//every heap allocation in the process is counted by the operator new below. The global operators new and delete
+	//are replaced for the whole Benchmarks binary, so they affect every benchmark linked into it, not only this one
+	std::atomic<size_t> numAllocations(0);
+
+	struct Result
+	{
+		string name;
+		double nsPerOp;
+		double allocsPerOp;
+		size_t numOps;
+	};
+	vector<Result> results;
+
+	double minTime = 0.25; //minimum time (s) spent measuring each operation
+	const char* filter = nullptr;
+
+	//Runs op(i) enough times to take at least minTime seconds (split in 5 runs) and keeps the best run
+	template <typename Operation>
+	void measure(const string& name, Operation op)
+	{
+		if (filter && name.find(filter) == string::npos)
+			return;
+
+		//warm-up and calibration: the number of operations per run is doubled until a run takes minTime/5
+		size_t numOps = 1;
+		size_t i = 0;
+		while (true)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (size_t j = 0; j < numOps; ++j)
+				op(i++);
+			if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= minTime / 5
+				|| numOps >= ((size_t)1 << 30))
+				break;
+			numOps *= 2;
+		}
+
+		const int numRuns = 5;
+		double bestTime = std::numeric_limits<double>::max();
+		size_t allocationsBefore = numAllocations;
+		for (int run = 0; run < numRuns; ++run)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (size_t j = 0; j < numOps; ++j)
+				op(i++);
+			bestTime = std::min(bestTime, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		Result result;
+		result.name = name;
+		result.nsPerOp = 1e9 * bestTime / numOps;
+		result.allocsPerOp = (double)(numAllocations - allocationsBefore) / (numRuns * numOps);
+		result.numOps = numOps;
+		results.push_back(result);
+		printf("%-56s %14.1f %12.2f\n", name.c_str(), result.nsPerOp, result.allocsPerOp);
+	}
+
+	//XML of the experiments used as context. They all use the swing-up pendulum
+	string constant(const char* name, double value)
+	{
+		return string("<") + name + "><Schedule><Constant><Value>" + to_string(value) + "</Value></Constant></Schedule></"
+			+ name + ">";
+	}
+
+	string featureMap(const char* name, const char* inputTag, const vector<const char*>& variables)
+	{
+		string xml = string("<") + name + "><Num-Features-Per-Dimension>20</Num-Features-Per-Dimension>";
+		for (const char* variable : variables)
+			xml += string("<") + inputTag + "><" + inputTag + ">" + variable + "</" + inputTag + "></" + inputTag + ">";
+		return xml + "<Feature-Mapper><Type><Tile-Coding><Num-Tiles>10</Num-Tiles><Tile-Offset>0.05</Tile-Offset>"
+			"</Tile-Coding></Type></Feature-Mapper></" + name + ">";
+	}
+
+	const string eTraces = "<E-Traces><Threshold>0.001</Threshold><Lambda>0.9</Lambda><Replace>true</Replace></E-Traces>";
+
+	string qLearner(const char* type)
+	{
+		return string("<") + type + "><Policy><Policy><Epsilon-Greedy>" + constant("Epsilon", 0.1) + "</Epsilon-Greedy>"
+			"</Policy></Policy><Q-Function><Init-Value>0.0</Init-Value></Q-Function>" + eTraces + constant("Alpha", 0.1)
+			+ "</" + type + ">";
+	}
+
+	//The outputs of actors with more than one output all drive the torque, so that the cost of several action
+	//dimensions can be measured in the same world
+	string actorCritic(const char* actor, const char* critic, int numOutputs = 1)
+	{
+		string criticXml = string("<") + critic + ">" + eTraces + constant("Alpha", 0.01);
+		if (!strcmp(critic, "TDC-Lambda"))
+			criticXml += constant("Beta", 0.001);
+		criticXml += string("<V-Function><Init-Value>0.0</Init-Value></V-Function></") + critic + ">";
+
+		string outputXml = string("<Output><Policy-Learner><") + actor + ">" + constant("Alpha", 0.001)
+			+ "<Policy><Policy><Deterministic-Policy-Gaussian-Noise><Output-Action>torque</Output-Action>"
+			"<Deterministic-Policy-VFA><Init-Value>0.0</Init-Value></Deterministic-Policy-VFA><Exploration-Noise><Noise>"
+			"<Ornstein-Uhlenbeck><Mu>0.0</Mu><Sigma>1.0</Sigma><Theta>0.5</Theta>" + constant("Scale", 1.0)
+			+ "</Ornstein-Uhlenbeck></Noise></Exploration-Noise></Deterministic-Policy-Gaussian-Noise></Policy></Policy></"
+			+ actor + "></Policy-Learner></Output>";
+		string actorXml;
+		for (int i = 0; i < numOutputs; ++i)
+			actorXml += outputXml;
+		return "<Actor-Critic><Actor>" + actorXml + "</Actor><Critic><Critic>" + criticXml + "</Critic></Critic></Actor-Critic>";
+	}
+
+	string experiment(const string& simion)
+	{
+		return "<RLSimion><RLSimion><Log><Log-Eval-Episodes>false</Log-Eval-Episodes>"
+			"<Log-Training-Episodes>false</Log-Training-Episodes></Log>"
+			"<World><Num-Integration-Steps>4</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+			"<Dynamic-Model><Model><Swing-up-pendulum/></Model></Dynamic-Model></World>"
+			"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>100</Num-Episodes><Episode-Length>10.0</Episode-Length>"
+			"</Experiment><SimGod><Gamma>0.9</Gamma>"
+			"<Experience-Replay><Buffer-Size>1000</Buffer-Size><Update-Batch-Size>10</Update-Batch-Size></Experience-Replay>"
+			+ featureMap("State-Feature-Map", "Input-State", { "angle", "angular-velocity" })
+			+ featureMap("Action-Feature-Map", "Input-Action", { "torque" })
+			+ "<Simion><Type>" + simion + "</Type></Simion></SimGod></RLSimion></RLSimion>";
+	}
+
+	struct Agent
+	{
+		const char* id;
+		string xml;
+	};
+
+	vector<Agent> getAgents()
+	{
+		return
+		{
+			{ "q-learning", qLearner("Q-Learning") },
+			{ "sarsa", qLearner("SARSA") },
+			{ "double-q-learning", qLearner("Double-Q-Learning") },
+			{ "cacla+td-lambda", actorCritic("CACLA", "TD-Lambda") },
+			{ "cacla+true-online-td-lambda", actorCritic("CACLA", "True-Online-TD-Lambda") },
+			{ "cacla+tdc-lambda", actorCritic("CACLA", "TDC-Lambda") },
+			{ "cacla-3-outputs+td-lambda", actorCritic("CACLA", "TD-Lambda", 3) },
+			{ "regular-gradient+td-lambda", actorCritic("Regular-Gradient", "TD-Lambda") }
+		};
+	}
+
+	struct WorldType
+	{
+		const char* name;
+		DynamicModel* (*create)(ConfigNode* pConfigNode);
+	};
+
+	template <typename World>
+	DynamicModel* create(ConfigNode* pConfigNode)
+	{
+		return new World(pConfigNode);
+	}
+
+	//FAST-Wind-turbine is left out because it runs in an external process
+	WorldType worldTypes[] =
+	{
+		{ "Wind-turbine", create<WindTurbine> },
+		{ "Underwater-vehicle", create<UnderwaterVehicle> },
+		{ "Pitch-control", create<PitchControl> },
+		{ "Balancing-pole", create<BalancingPole> },
+		{ "Push-Box-2", create<PushBox2> },
+		{ "Push-Box-1", create<PushBox1> },
+		{ "Robot-control", create<RobotControl> },
+		{ "Pull-Box-2", create<PullBox2> },
+		{ "Pull-Box-1", create<PullBox1> },
+		{ "Mountain-car", create<MountainCar> },
+		{ "Swing-up-pendulum", create<SwingupPendulum> },
+		{ "Double-pendulum", create<DoublePendulum> },
+		{ "Rain-car", create<RainCar> }
+	};
+
+	void randomize(NamedVarSet* pVars, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<double> distribution(0.0, 1.0);
+		for (size_t i = 0; i < pVars->getNumVars(); ++i)
+		{
+			NamedVarProperties* pProperties = pVars->getProperties(i);
+			pVars->set(i, pProperties->getMin() + distribution(generator) * pProperties->getRangeWidth());
+		}
+	}
+
+	//Agents are only updated in training episodes
+	void startTrainingEpisode(SimionApp* pApp)
+	{
+		pApp->pExperiment->nextEpisode();
+		while (pApp->pExperiment->isEvaluationEpisode() && pApp->pExperiment->isValidEpisode())
+			pApp->pExperiment->nextEpisode();
+		pApp->pExperiment->nextStep();
+	}
+
+	//Benchmarks of the components that don't depend on the experiment. They need an app because some of them use the
+	//SimGod and the experiment
+	void runComponentBenchmarks(SimionApp* pApp)
+	{
+		const size_t numSamples = 1024;
+		std::mt19937 generator(1);
+
+		Descriptor stateDescriptor;
+		size_t hX = stateDescriptor.addVariable("x", "m", -1.0, 1.0);
+		size_t hY = stateDescriptor.addVariable("y", "m", -5.0, 5.0, true);
+		stateDescriptor.addVariable("z", "m", 0.0, 10.0);
+		Descriptor actionDescriptor;
+		size_t hU = actionDescriptor.addVariable("u", "N", -1.0, 1.0);
+
+		vector<State*> states(numSamples);
+		vector<Action*> actions(numSamples);
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			states[i] = stateDescriptor.getInstance();
+			randomize(states[i], generator);
+			actions[i] = actionDescriptor.getInstance();
+			randomize(actions[i], generator);
+		}
+
+		//NamedVarSet access
+		double sum = 0.0;
+		measure("named-var-set.get(index)", [&](size_t i) { sum += states[i % numSamples]->get(hY); });
+		measure("named-var-set.get(name)", [&](size_t i) { sum += states[i % numSamples]->get("y"); });
+		measure("named-var-set.set(index)", [&](size_t i) { states[i % numSamples]->set(hY, (double)(i % 10)); });
+		measure("named-var-set.copy", [&](size_t i) { states[i % numSamples]->copy(states[(i + 1) % numSamples]); });
+		for (State* s : states)
+			randomize(s, generator);
+
+		//feature maps
+		FeatureList features("hotpaths/features");
+		struct FeatureMapType
+		{
+			const char* name;
+			FeatureMapper* pMapper;
+		};
+		FeatureMapType featureMapTypes[] =
+		{
+			{ "feature-map.tile-coding", new TileCodingFeatureMap(10, 0.05) },
+			{ "feature-map.rbf-grid", new GaussianRBFGridFeatureMap() },
+			{ "feature-map.discrete", new DiscreteFeatureMap() }
+		};
+		for (FeatureMapType& featureMapType : featureMapTypes)
+		{
+			StateFeatureMap featureMap(featureMapType.pMapper, stateDescriptor, { hX, hY }, 20);
+			measure(featureMapType.name, [&](size_t i) { featureMap.getFeatures(states[i % numSamples], nullptr, &features); });
+		}
+
+		//linear VFA
+		MemManager<SimionMemPool> memManager;
+		std::shared_ptr<StateFeatureMap> pStateFeatureMap
+			= std::make_shared<StateFeatureMap>(new TileCodingFeatureMap(10, 0.05), stateDescriptor, vector<size_t>{ hX, hY }, 20);
+		std::shared_ptr<ActionFeatureMap> pActionFeatureMap
+			= std::make_shared<ActionFeatureMap>(new GaussianRBFGridFeatureMap(), actionDescriptor, vector<size_t>{ hU }, 20);
+		LinearStateActionVFA vfa(&memManager, pStateFeatureMap, pActionFeatureMap);
+		vfa.setInitValue(0.0);
+		vfa.deferredLoadStep();
+		memManager.deferredLoadStep();
+
+		vector<FeatureList*> sampleFeatures(numSamples);
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			sampleFeatures[i] = new FeatureList("hotpaths/sample-features");
+			vfa.getFeatures(states[i], actions[i], sampleFeatures[i]);
+		}
+		measure("linear-vfa.getFeatures", [&](size_t i) { vfa.getFeatures(states[i % numSamples], actions[i % numSamples], &features); });
+		measure("linear-vfa.add", [&](size_t i) { vfa.add(sampleFeatures[i % numSamples], 0.001); });
+		measure("linear-vfa.get", [&](size_t i) { sum += vfa.get(sampleFeatures[i % numSamples]); });
+		measure("linear-vfa.argMax", [&](size_t i) { vfa.argMax(states[i % numSamples], actions[i % numSamples]); });
+
+		//eligibility traces. The first step of an episode resets them, so we move to the second one
+		startTrainingEpisode(pApp);
+		pApp->pExperiment->nextStep();
+		ConfigFile eTracesConfig;
+		eTracesConfig.Parse(eTraces.c_str());
+		ETraces traces((ConfigNode*)eTracesConfig.FirstChildElement());
+		measure("etraces.update+addFeatureList", [&](size_t i)
+		{
+			traces.update(0.9);
+			traces.addFeatureList(sampleFeatures[i % numSamples], 1.0);
+		});
+
+		//experience replay. Tuples are made of the states and actions of the app's world
+		ConfigFile replayConfig;
+		replayConfig.Parse("<Experience-Replay><Buffer-Size>10000</Buffer-Size><Update-Batch-Size>10</Update-Batch-Size></Experience-Replay>");
+		ExperienceReplay replay((ConfigNode*)replayConfig.FirstChildElement());
+		replay.deferredLoadStep();
+		State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+		State* s_p = pApp->pWorld->getDynamicModel()->getStateInstance();
+		Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+		measure("experience-replay.addTuple", [&](size_t) { replay.addTuple(s, a, s_p, 1.0, 1.0); });
+		measure("experience-replay.getRandomTupleFromBuffer", [&](size_t) { sum += replay.getRandomTupleFromBuffer()->r; });
+		measure("experience-replay.sampleBatch", [&](size_t) { sum += replay.sampleBatch(0.9)[0].nStepReturn; });
+
+		//lambda-returns truncated after 8 steps, with episodes of 100 steps
+		ConfigFile lambdaReplayConfig;
+		lambdaReplayConfig.Parse("<Experience-Replay><Buffer-Size>10000</Buffer-Size><Update-Batch-Size>10</Update-Batch-Size>"
+			"<Return-Steps>8</Return-Steps><Return-Lambda>0.9</Return-Lambda></Experience-Replay>");
+		ExperienceReplay lambdaReplay((ConfigNode*)lambdaReplayConfig.FirstChildElement());
+		lambdaReplay.deferredLoadStep();
+		for (size_t i = 0; i < 10000; ++i)
+			lambdaReplay.addTuple(s, a, s_p, 1.0, 1.0, i % 100 == 99);
+		measure("experience-replay.sampleBatch(lambda)", [&](size_t) { sum += lambdaReplay.sampleBatch(0.9)[0].nStepReturn; });
+		delete s;
+		delete s_p;
+		delete a;
+
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			delete states[i];
+			delete actions[i];
+			delete sampleFeatures[i];
+		}
+		if (sum == 1.2345) printf(" "); //keeps the compiler from removing the reads
+	}
+
+	//The dynamic model of each world, with random actions
+	void runWorldBenchmarks()
+	{
+		const int numEpisodeSteps = 200;
+		const double dt = 0.01;
+		ConfigFile configFile;
+		configFile.Parse("<World></World>");
+		std::mt19937 generator(1);
+
+		for (const WorldType& worldType : worldTypes)
+		{
+			string name = string("world.") + worldType.name + ".executeAction";
+			if (filter && name.find(filter) == string::npos)
+				continue;
+
+			DynamicModel* pWorld;
+			try
+			{
+				pWorld = worldType.create((ConfigNode*)configFile.FirstChildElement());
+			}
+			catch (std::exception& e)
+			{
+				printf("%-56s skipped: %s\n", name.c_str(), e.what());
+				continue;
+			}
+			State* s = pWorld->getStateInstance();
+			Action* a = pWorld->getActionInstance();
+			measure(name, [&](size_t i)
+			{
+				if (i % numEpisodeSteps == 0)
+					pWorld->reset(s);
+				randomize(a, generator);
+				pWorld->executeAction(s, a, dt);
+			});
+			delete s;
+			delete a;
+			delete pWorld;
+		}
+	}
+
+	//The step of an agent: selectAction(), the world (with its integration steps and the reward), update() (every
+	//critic/actor/q-learner of the agent) and postUpdate() (experience replay)
+	void runAgentBenchmarks(SimionApp* pApp, const string& id)
+	{
+		const size_t numTuples = 1000;
+		pApp->pSimGod->deferredLoad();
+
+		State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+		Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+		vector<State*> states(numTuples), nextStates(numTuples);
+		vector<Action*> actions(numTuples);
+		vector<double> rewards(numTuples), probabilities(numTuples);
+
+		//tuples are collected following the agent's policy, as the app would. They also fill the replay buffer
+		startTrainingEpisode(pApp);
+		pApp->pWorld->reset(s);
+		for (size_t i = 0; i < numTuples; ++i)
+		{
+			states[i] = pApp->pWorld->getDynamicModel()->getStateInstance();
+			nextStates[i] = pApp->pWorld->getDynamicModel()->getStateInstance();
+			actions[i] = pApp->pWorld->getDynamicModel()->getActionInstance();
+			states[i]->copy(s);
+			probabilities[i] = pApp->pSimGod->selectAction(states[i], actions[i]);
+			rewards[i] = pApp->pWorld->executeAction(states[i], actions[i], nextStates[i]);
+			pApp->pSimGod->update(states[i], actions[i], nextStates[i], rewards[i], probabilities[i]);
+			pApp->pExperiment->nextStep();
+			if (!pApp->pExperiment->isValidStep())
+			{
+				startTrainingEpisode(pApp);
+				pApp->pWorld->reset(s);
+			}
+			else
+				s->copy(nextStates[i]);
+		}
+		//the first step of an episode resets the traces
+		if (pApp->pExperiment->isFirstStep())
+			pApp->pExperiment->nextStep();
+
+		measure(id + "/selectAction", [&](size_t i) { pApp->pSimGod->selectAction(states[i % numTuples], a); });
+		measure(id + "/world.executeAction", [&](size_t i)
+		{
+			s->copy(states[i % numTuples]);
+			pApp->pWorld->executeAction(s, actions[i % numTuples], nextStates[i % numTuples]);
+		});
+		measure(id + "/update", [&](size_t i)
+		{
+			pApp->pSimGod->update(states[i % numTuples], actions[i % numTuples], nextStates[i % numTuples]
+				, rewards[i % numTuples], probabilities[i % numTuples]);
+		});
+		measure(id + "/postUpdate", [&](size_t) { pApp->pSimGod->postUpdate(); });
+
+		for (size_t i = 0; i < numTuples; ++i)
+		{
+			delete states[i];
+			delete nextStates[i];
+			delete actions[i];
+		}
+		delete s;
+		delete a;
+	}
+
+	bool runAgent(ConfigNode* pRoot, const string& id, bool bRunComponentBenchmarks)
+	{
+		try
+		{
+			SimionApp app(pRoot);
+			app.setConfigFile("hotpaths-benchmark.simion.exp");
+			app.setExecutedRemotely(true);
+			if (bRunComponentBenchmarks)
+			{
+				runComponentBenchmarks(&app);
+				runWorldBenchmarks();
+			}
+			runAgentBenchmarks(&app, id);
+		}
+		catch (std::exception& e)
+		{
+			printf("%-56s failed: %s\n", id.c_str(), e.what());
+			return false;
+		}
+		return true;
+	}
+
+	void saveResults(const char* filename)
+	{
+		ofstream outputFile(filename);
+		outputFile << "{\n  \"benchmark\": \"hotpaths\",\n  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			char line[512];
+			snprintf(line, sizeof(line), "    { \"name\": \"%s\", \"ns-per-op\": %.3f, \"allocs-per-op\": %.4f, \"ops\": %zu }%s\n"
+				, results[i].name.c_str(), results[i].nsPerOp, results[i].allocsPerOp, results[i].numOps
+				, i + 1 < results.size() ? "," : "");
+			outputFile << line;
+		}
+		outputFile << "  ]\n}\n";
+	}
+
+	//Reads the results saved by saveResults(): one result per line
+	vector<Result> loadResults(const char* filename)
+	{
+		vector<Result> baseline;
+		ifstream inputFile(filename);
+		string line;
+		while (getline(inputFile, line))
+		{
+			const string nameKey = "\"name\": \"", nsKey = "\"ns-per-op\": ", allocsKey = "\"allocs-per-op\": ";
+			size_t namePos = line.find(nameKey), nsPos = line.find(nsKey), allocsPos = line.find(allocsKey);
+			if (namePos == string::npos || nsPos == string::npos || allocsPos == string::npos)
+				continue;
+
+			Result result;
+			namePos += nameKey.size();
+			result.name = line.substr(namePos, line.find('"', namePos) - namePos);
+			result.nsPerOp = atof(line.c_str() + nsPos + nsKey.size());
+			result.allocsPerOp = atof(line.c_str() + allocsPos + allocsKey.size());
+			result.numOps = 0;
+			baseline.push_back(result);
+		}
+		return baseline;
+	}
+
+	//Returns the number of regressions
+	int compareResults(const vector<Result>& baseline, double tolerance)
+	{
+		int numRegressions = 0;
+		printf("\nComparison with the baseline (tolerance: %.1f%%)\n", tolerance);
+		printf("%-56s %14s %14s %10s\n", "operation", "base ns/op", "ns/op", "change");
+		for (const Result& result : results)
+		{
+			auto it = std::find_if(baseline.begin(), baseline.end(), [&](const Result& r) { return r.name == result.name; });
+			if (it == baseline.end())
+			{
+				printf("%-56s %14s %14.1f %10s\n", result.name.c_str(), "-", result.nsPerOp, "new");
+				continue;
+			}
+			double change = 100.0 * (result.nsPerOp - it->nsPerOp) / it->nsPerOp;
+			bool bRegression = change > tolerance || result.allocsPerOp > it->allocsPerOp + 0.01;
+			if (bRegression)
+				++numRegressions;
+			printf("%-56s %14.1f %14.1f %9.1f%%%s\n", result.name.c_str(), it->nsPerOp, result.nsPerOp, change
+				, bRegression ? "  REGRESSION" : "");
+		}
+		printf("%d regressions\n", numRegressions);
+		return numRegressions;
+	}
+}
+
+void* operator new(size_t size)
+{
+	++HotPathsBenchmark::numAllocations;
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete[](void* p) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+
+int hotpathsBenchmark(int argc, char** argv)
+{
+	using namespace HotPathsBenchmark;
+
+	const char* jsonFile = SimionApp::getArgValue(argc, argv, "json");
+	const char* baselineFile = SimionApp::getArgValue(argc, argv, "baseline");
+	const char* tolerance = SimionApp::getArgValue(argc, argv, "tolerance");
+	const char* minTimeArg = SimionApp::getArgValue(argc, argv, "min-time");
+	filter = SimionApp::getArgValue(argc, argv, "filter");
+	if (minTimeArg)
+		minTime = std::max(0.001, atof(minTimeArg));
+
+	vector<Result> baseline;
+	if (baselineFile)
+	{
+		baseline = loadResults(baselineFile);
+		if (baseline.empty())
+		{
+			printf("Couldn't read the baseline: %s\n", baselineFile);
+			return 1;
+		}
+	}
+
+	Logger::enableLogMessages(false);
+	printf("%-56s %14s %12s\n", "operation", "ns/op", "allocs/op");
+
+	bool bFirst = true;
+	for (const Agent& agent : getAgents())
+	{
+		ConfigFile configFile;
+		configFile.Parse(experiment(agent.xml).c_str());
+		runAgent((ConfigNode*)configFile.FirstChildElement(), agent.id, bFirst);
+		bFirst = false;
+	}
+	for (int i = 1; i < argc; ++i)
+	{
+		if (argv[i][0] == '-')
+			continue;
+		ConfigFile configFile;
+		try
+		{
+			ConfigNode* pRoot = configFile.loadFile(argv[i]);
+			string filename = argv[i];
+			size_t lastBar = filename.find_last_of("/\\");
+			runAgent(pRoot, removeExtension(lastBar == string::npos ? filename : filename.substr(lastBar + 1), 2), false);
+		}
+		catch (std::exception& e)
+		{
+			printf("%-56s failed: %s\n", argv[i], e.what());
+		}
+	}
+	Logger::enableLogMessages(true);
+
+	if (jsonFile)
+		saveResults(jsonFile);
+	if (baselineFile)
+		return compareResults(baseline, tolerance ? atof(tolerance) : 10.0) > 0 ? 1 : 0;
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../RLSimion/Lib/utils.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <math.h>
+
+//Compares the lookups of Table::getInterpolatedValue() with the linear scan it used to do, using the Cp table of the
+//wind-turbine world (the world evaluates it in every integration step)
+
+namespace InterpolationBenchmark
+{
+	//The table is read again here so that the reference implementation has access to the axes
+	struct ReferenceTable
+	{
+		vector<double> columns;
+		vector<double> rows;
+		vector<double> values;
+
+		bool readFromFile(const char* filename)
+		{
+			ifstream inputFile(filename);
+			if (!inputFile.is_open())
+				return false;
+			string header;
+			getline(inputFile, header);
+			const char* pt = header.c_str();
+			char* pEnd;
+			for (double value = strtod(pt, &pEnd); pEnd != pt; value = strtod(pt, &pEnd))
+			{
+				columns.push_back(value);
+				pt = pEnd;
+			}
+			double value;
+			while (inputFile >> value)
+			{
+				rows.push_back(value);
+				for (size_t i = 0; i < columns.size() && inputFile >> value; ++i)
+					values.push_back(value);
+			}
+			return columns.size() > 1 && rows.size() > 1 && values.size() == columns.size() * rows.size();
+		}
+
+		double getValue(size_t col, size_t row) const
+		{
+			return values[row * columns.size() + col];
+		}
+
+		//the linear scan done before by Table::getInterpolatedValue()
+		double getInterpolatedValue(double columnValue, double rowValue) const
+		{
+			columnValue = std::max(columns[0], std::min(columns[columns.size() - 1], columnValue));
+			rowValue = std::max(rows[0], std::min(rows[rows.size() - 1], rowValue));
+
+			int colIndex = 1, rowIndex = 1;
+			while (columns[colIndex] < columnValue) ++colIndex;
+			while (rows[rowIndex] < rowValue) ++rowIndex;
+			--colIndex;
+			--rowIndex;
+
+			double colU = (columnValue - columns[colIndex]) / (columns[colIndex + 1] - columns[colIndex]);
+			double rowU = (rowValue - rows[rowIndex]) / (rows[rowIndex + 1] - rows[rowIndex]);
+			double value = 0.0;
+			value += (1 - colU) * (1 - rowU) * getValue(colIndex, rowIndex);
+			value += (1 - colU) * rowU * getValue(colIndex, rowIndex + 1);
+			value += colU * (1 - rowU) * getValue(colIndex + 1, rowIndex);
+			value += colU * rowU * getValue(colIndex + 1, rowIndex + 1);
+			return value;
+		}
+	};
+
+	template <typename Function>
+	double measureNsPerLookup(int numRepetitions, size_t numLookups, Function function)
+	{
+		double bestTime = std::numeric_limits<double>::max();
+		for (int i = 0; i < numRepetitions; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			function();
+			bestTime = std::min(bestTime, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+		}
+		return bestTime / numLookups;
+	}
+}
+
+int interpolationBenchmark(int argc, char** argv)
+{
+	using namespace InterpolationBenchmark;
+
+	const char* filename = argc > 1 ? argv[1] : "../config/world/wind-turbine/cp-table.txt";
+	size_t numLookups = argc > 2 ? (size_t)std::max(1, atoi(argv[2])) : 1000000;
+	const int numRepetitions = 5;
+
+	Table table;
+	ReferenceTable reference;
+	if (!table.readFromFile(filename) || !reference.readFromFile(filename))
+	{
+		printf("Couldn't read the table: %s\n", filename);
+		return 1;
+	}
+
+	//lookups are spread over a slightly bigger range than the table's to include clamped values
+	std::mt19937 generator(1);
+	double colMargin = 0.05 * (table.getMaxCol() - table.getMinCol());
+	double rowMargin = 0.05 * (table.getMaxRow() - table.getMinRow());
+	std::uniform_real_distribution<double> colDistribution(table.getMinCol() - colMargin, table.getMaxCol() + colMargin);
+	std::uniform_real_distribution<double> rowDistribution(table.getMinRow() - rowMargin, table.getMaxRow() + rowMargin);
+	vector<double> colValues(numLookups), rowValues(numLookups);
+	for (size_t i = 0; i < numLookups; ++i)
+	{
+		colValues[i] = colDistribution(generator);
+		rowValues[i] = rowDistribution(generator);
+	}
+	vector<double> referenceOutput(numLookups), output(numLookups), batchedOutput(numLookups);
+
+	double referenceTime = measureNsPerLookup(numRepetitions, numLookups, [&]()
+	{
+		for (size_t i = 0; i < numLookups; ++i)
+			referenceOutput[i] = reference.getInterpolatedValue(colValues[i], rowValues[i]);
+	});
+	double tableTime = measureNsPerLookup(numRepetitions, numLookups, [&]()
+	{
+		for (size_t i = 0; i < numLookups; ++i)
+			output[i] = table.getInterpolatedValue(colValues[i], rowValues[i]);
+	});
+	double batchedTime = measureNsPerLookup(numRepetitions, numLookups, [&]()
+	{
+		table.getInterpolatedValues(colValues.data(), rowValues.data(), batchedOutput.data(), numLookups);
+	});
+
+	double maxError = 0.0;
+	for (size_t i = 0; i < numLookups; ++i)
+	{
+		maxError = std::max(maxError, fabs(output[i] - referenceOutput[i]));
+		maxError = std::max(maxError, fabs(batchedOutput[i] - referenceOutput[i]));
+	}
+
+	printf("Interpolation benchmark: %s (%d columns x %d rows), %zu lookups, best of %d runs\n", filename
+		, (int)reference.columns.size(), (int)reference.rows.size(), numLookups, numRepetitions);
+	printf("%-14s %12s %10s\n", "lookup", "ns/lookup", "speed-up");
+	printf("%-14s %12.2f %10.2f\n", "linear-scan", referenceTime, 1.0);
+	printf("%-14s %12.2f %10.2f\n", "table", tableTime, referenceTime / tableTime);
+	printf("%-14s %12.2f %10.2f\n", "table-batched", batchedTime, referenceTime / batchedTime);
+	printf("Max. difference with the linear scan: %g\n", maxError);
+	return maxError < 1e-9 ? 0 : 1;
+}
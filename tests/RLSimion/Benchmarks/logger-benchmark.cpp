@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../tools/System/Timer.h"
+#include <algorithm>
+
+//Runs the same experiment with logging disabled, with synchronous logging and with the asynchronous log writer,
+//and compares the wall time of the step loop (SimionApp::run())
+
+namespace LoggerBenchmark
+{
+	struct LoggingMode
+	{
+		const char* name;
+		bool bLogging;
+		bool bAsync;
+	};
+
+	void setParameter(ConfigNode* pNode, const char* name, const char* value)
+	{
+		tinyxml2::XMLElement* pParameter = pNode->FirstChildElement(name);
+		if (!pParameter)
+		{
+			pParameter = pNode->GetDocument()->NewElement(name);
+			pNode->InsertEndChild(pParameter);
+		}
+		pParameter->SetText(value);
+	}
+
+	ConfigNode* getOrAddChild(ConfigNode* pNode, const char* name)
+	{
+		if (!pNode->getChild(name))
+			pNode->InsertEndChild(pNode->GetDocument()->NewElement(name));
+		return pNode->getChild(name);
+	}
+
+	//returns the wall time of SimionApp::run() in seconds and the number of steps simulated
+	double runExperiment(ConfigNode* pRoot, const LoggingMode& mode, const char* numEpisodes, unsigned int& numSteps)
+	{
+		ConfigNode* pAppConfig = pRoot->getChild("RLSimion");
+		ConfigNode* pLogConfig = getOrAddChild(pAppConfig, "Log");
+		//log every step of every episode to maximize the logging cost
+		setParameter(pLogConfig, "Log-Freq", "0.0");
+		setParameter(pLogConfig, "Log-Eval-Episodes", mode.bLogging ? "true" : "false");
+		setParameter(pLogConfig, "Log-Training-Episodes", mode.bLogging ? "true" : "false");
+		setParameter(pLogConfig, "Log-Functions", mode.bLogging ? "true" : "false");
+		setParameter(pLogConfig, "Async-Log-Writer", mode.bAsync ? "true" : "false");
+		if (numEpisodes)
+			setParameter(getOrAddChild(pAppConfig, "Experiment"), "Num-Episodes", numEpisodes);
+
+		SimionApp* pApp = new SimionApp(pRoot);
+		pApp->setConfigFile("logger-benchmark.simion.exp");
+		pApp->setExecutedRemotely(true);
+
+		Timer timer;
+		timer.start();
+		pApp->run();
+		double elapsedTime = timer.getElapsedTime();
+
+		numSteps = pApp->pExperiment->getExperimentStep();
+		delete pApp;
+		return elapsedTime;
+	}
+}
+
+int loggerBenchmark(int argc, char** argv)
+{
+	using namespace LoggerBenchmark;
+
+	if (argc < 2)
+	{
+		printf("Usage: logger <experiment-file> [num-episodes] [num-repetitions]\n");
+		return 1;
+	}
+	const char* numEpisodes = argc > 2 ? argv[2] : nullptr;
+	int numRepetitions = argc > 3 ? std::max(1, atoi(argv[3])) : 3;
+
+	LoggingMode modes[] = { { "off", false, false }, { "sync", true, false }, { "async", true, true } };
+	const int numModes = sizeof(modes) / sizeof(LoggingMode);
+	double minTimes[numModes];
+	unsigned int numSteps = 0;
+
+	Logger::enableLogMessages(false);
+	try
+	{
+		ConfigFile configFile;
+		ConfigNode* pRoot = configFile.loadFile(argv[1]);
+
+		for (int mode = 0; mode < numModes; ++mode)
+		{
+			minTimes[mode] = std::numeric_limits<double>::max();
+			//we keep the best time of all the repetitions to filter out noise
+			for (int i = 0; i < numRepetitions; ++i)
+				minTimes[mode] = std::min(minTimes[mode], runExperiment(pRoot, modes[mode], numEpisodes, numSteps));
+		}
+	}
+	catch (std::exception& e)
+	{
+		Logger::enableLogMessages(true);
+		printf("Benchmark failed: %s\n", e.what());
+		return 1;
+	}
+	Logger::enableLogMessages(true);
+
+	printf("Logger benchmark: %s (%u steps, best of %d runs)\n", argv[1], numSteps, numRepetitions);
+	printf("%-8s %12s %14s %12s\n", "logging", "time (s)", "steps/s", "overhead");
+	for (int mode = 0; mode < numModes; ++mode)
+	{
+		printf("%-8s %12.3f %14.0f %11.1f%%\n", modes[mode].name, minTimes[mode], numSteps / minTimes[mode]
+			, 100.0 * (minTimes[mode] - minTimes[0]) / minTimes[0]);
+	}
+	return 0;
+}
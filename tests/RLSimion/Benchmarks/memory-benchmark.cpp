@@ -0,0 +1,178 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../RLSimion/Lib/mem-manager.h"
+#include "../../../tools/System/PageAllocator.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Measures the cost of the random weight gathers done by big linear VFAs (i.e., tile coding) with the memory blocks of a
+//SimionMemPool allocated in the heap, with regular pages and with huge pages, and also the time needed to allocate and
+//initialize all the blocks. Under Linux, data-TLB misses are counted with the CPU's performance counters (if the kernel
+//allows it: see /proc/sys/kernel/perf_event_paranoid)
+
+namespace MemoryBenchmark
+{
+	const int numActiveFeatures = 32; //features gathered in each evaluation, as with 32 tilings
+	const double initValue = 0.5;
+
+	struct Configuration
+	{
+		const char* name;
+		bool bPageAllocator;
+		bool bHugePages;
+		NumaPolicy numaPolicy;
+	};
+
+	Configuration configurations[] =
+	{
+		{ "heap", false, false, NumaPolicy::Local },
+		{ "pages", true, false, NumaPolicy::Local },
+		{ "huge-pages", true, true, NumaPolicy::Local },
+		{ "huge-pages+interleave", true, true, NumaPolicy::Interleave }
+	};
+
+	struct Results
+	{
+		double initTime; //in seconds
+		double gatherTime; //in nanoseconds per gathered weight
+		double tlbMissesPerGather; //negative if not available
+		double hugePagesRatio;
+		double checksum;
+	};
+
+	//Counts the data-TLB misses of the calling thread while it's enabled
+	class TLBMissCounter
+	{
+		int m_fileDescriptor = -1;
+	public:
+		TLBMissCounter()
+		{
+#ifdef __linux__
+			perf_event_attr attributes = {};
+			attributes.type = PERF_TYPE_HW_CACHE;
+			attributes.size = sizeof(attributes);
+			attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+				| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			attributes.disabled = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			m_fileDescriptor = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+		}
+		~TLBMissCounter()
+		{
+#ifdef __linux__
+			if (m_fileDescriptor >= 0)
+				close(m_fileDescriptor);
+#endif
+		}
+		void start()
+		{
+#ifdef __linux__
+			if (m_fileDescriptor >= 0)
+			{
+				ioctl(m_fileDescriptor, PERF_EVENT_IOC_RESET, 0);
+				ioctl(m_fileDescriptor, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+		long long stop()
+		{
+			long long count = -1;
+#ifdef __linux__
+			if (m_fileDescriptor >= 0)
+			{
+				ioctl(m_fileDescriptor, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(m_fileDescriptor, &count, sizeof(count)) != sizeof(count))
+					count = -1;
+			}
+#endif
+			return count;
+		}
+	};
+
+	Results run(const Configuration& configuration, size_t numWeights, int numGathers, unsigned int numInitThreads)
+	{
+		Results results = {};
+		MemManager<SimionMemPool> memManager;
+		//two interleaved buffers, as the weights of a VFA and their frozen copy
+		IMemBuffer* pWeights = memManager.getMemBuffer(numWeights);
+		pWeights->setInitValue(initValue);
+		IMemBuffer* pFrozenWeights = memManager.getMemBuffer(numWeights);
+		pFrozenWeights->setInitValue(initValue);
+		if (configuration.bPageAllocator)
+			memManager.usePageAllocator(configuration.bHugePages, configuration.numaPolicy);
+		memManager.setNumInitThreads(numInitThreads);
+		memManager.init();
+
+		//blocks are allocated and initialized the first time they are accessed
+		auto start = std::chrono::steady_clock::now();
+		size_t blockSize = ((SimionMemPool*)pWeights->getMemPool())->getBlockSize();
+		for (size_t i = 0; i < numWeights; i += std::max((size_t)1, blockSize / 2))
+			pWeights->get(i);
+		pWeights->get(numWeights - 1);
+		results.initTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		const PageAllocator* pPageAllocator = memManager.getPageAllocator();
+		if (pPageAllocator && pPageAllocator->getAllocatedBytes() > 0)
+			results.hugePagesRatio = (double)pPageAllocator->getHugePageBytes() / pPageAllocator->getAllocatedBytes();
+
+		//the same random features in every configuration
+		std::mt19937 generator(1);
+		std::uniform_int_distribution<size_t> distribution(0, numWeights - 1);
+		vector<size_t> features(numGathers * numActiveFeatures);
+		for (size_t& feature : features)
+			feature = distribution(generator);
+
+		TLBMissCounter tlbMissCounter;
+		start = std::chrono::steady_clock::now();
+		tlbMissCounter.start();
+		for (size_t i = 0; i < features.size(); ++i)
+			results.checksum += pWeights->get(features[i]);
+		long long numTLBMisses = tlbMissCounter.stop();
+		results.gatherTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+			/ features.size();
+		results.tlbMissesPerGather = numTLBMisses >= 0 ? (double)numTLBMisses / numGathers : -1.0;
+		return results;
+	}
+}
+
+int memoryBenchmark(int argc, char** argv)
+{
+	using namespace MemoryBenchmark;
+
+	size_t numWeights = argc > 1 ? (size_t)std::max(1, atoi(argv[1])) : 16 * 1024 * 1024;
+	int numGathers = argc > 2 ? std::max(1, atoi(argv[2])) : 200000;
+	unsigned int numInitThreads = argc > 3 ? (unsigned int)std::max(0, atoi(argv[3])) : 1;
+
+	printf("Memory benchmark: 2 interleaved buffers of %zu weights (%.1f MB), %d gathers of %d features, %d NUMA node(s)\n"
+		, numWeights, 2 * numWeights * sizeof(double) / (1024.0 * 1024.0), numGathers, numActiveFeatures
+		, PageAllocator::getNumNumaNodes());
+	printf("%-24s %12s %12s %16s %12s\n", "allocation", "init (ms)", "ns/weight", "dTLB miss/gather", "huge pages");
+	double checksum = 0.0;
+	for (const Configuration& configuration : configurations)
+	{
+		if (configuration.numaPolicy == NumaPolicy::Interleave && PageAllocator::getNumNumaNodes() < 2)
+			continue;
+
+		Results results = run(configuration, numWeights, numGathers, numInitThreads);
+		string tlbMisses = results.tlbMissesPerGather >= 0.0 ? to_string(results.tlbMissesPerGather) : string("n/a");
+		printf("%-24s %12.2f %12.2f %16s %11.0f%%\n", configuration.name, results.initTime * 1000.0, results.gatherTime
+			, tlbMisses.c_str(), results.hugePagesRatio * 100.0);
+		if (checksum == 0.0)
+			checksum = results.checksum;
+		else if (checksum != results.checksum)
+			printf("Error: the weights read differ from those read with the first configuration\n");
+	}
+	return 0;
+}
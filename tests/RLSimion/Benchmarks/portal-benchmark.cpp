@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../tools/System/SharedMemoryChannel.h"
+#ifdef _WIN32
+#include "../../../tools/System/NamedPipe.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+
+//Measures the round-trip latency of the transports used by the FAST dimensional portal: the client sends the state
+//(FAST's 19 state variables) and waits for the action (2 variables), as FAST does in each control step.
+//The client runs in a thread of the same process, so that the measure doesn't depend on FAST
+
+namespace PortalBenchmark
+{
+	const int numStateVariables = 19;
+	const int numActionVariables = 2;
+
+	struct Results
+	{
+		double meanLatency; //in microseconds
+		double p50Latency;
+		double p99Latency;
+		double roundTripsPerSecond;
+		bool bOk;
+	};
+
+	//Adapters to use both transports with the same code
+	struct SharedMemoryTransport
+	{
+		typedef SharedMemoryChannelServer Server;
+		typedef SharedMemoryChannelClient Client;
+		static const char* name() { return "shm"; }
+		static bool open(Server& server) { return server.openUniqueChannelServer("PortalBenchmark"); }
+		static const char* getName(Server& server) { return server.getFullName(); }
+		static bool waitForClient(Server& server) { return server.waitForClientConnection(5000); }
+		static bool connect(Client& client, const char* name) { return client.connectToServer(name, false); }
+	};
+
+#ifdef _WIN32
+	struct NamedPipeTransport
+	{
+		typedef NamedPipeServer Server;
+		typedef NamedPipeClient Client;
+		static const char* name() { return "pipe"; }
+		static bool open(Server& server) { return server.openUniqueNamedPipeServer("PortalBenchmark"); }
+		static const char* getName(Server& server) { return server.getPipeFullName(); }
+		//ConnectNamedPipe() fails if the client connected before the call, so the result is ignored
+		static bool waitForClient(Server& server) { server.waitForClientConnection(); return true; }
+		static bool connect(Client& client, const char* name) { return client.connectToServer(name, false); }
+	};
+#endif
+
+	template <typename Transport>
+	Results run(int numRoundTrips)
+	{
+		Results results = {};
+		typename Transport::Server server;
+		if (!Transport::open(server))
+			return results;
+		std::string channelName = Transport::getName(server);
+
+		std::vector<double> latencies(numRoundTrips);
+		bool bClientOk = false;
+		double totalTime = 0.0;
+
+		std::thread clientThread([&]()
+		{
+			typename Transport::Client client;
+			if (!Transport::connect(client, channelName.c_str()))
+				return;
+			double state[numStateVariables] = {};
+			double action[numActionVariables];
+
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < numRoundTrips; ++i)
+			{
+				state[0] = (double)i;
+				auto sendTime = std::chrono::steady_clock::now();
+				if (client.writeBuffer(state, sizeof(state)) != sizeof(state)
+					|| client.readToBuffer(action, sizeof(action)) != sizeof(action)
+					|| action[0] != (double)i)
+				{
+					client.closeConnection();
+					return;
+				}
+				latencies[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sendTime).count();
+			}
+			totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			bClientOk = true;
+			client.closeConnection();
+		});
+
+		if (Transport::waitForClient(server))
+		{
+			//the server answers each state with an action, like the FAST world in RLSimion
+			double state[numStateVariables];
+			double action[numActionVariables] = {};
+			for (int i = 0; i < numRoundTrips; ++i)
+			{
+				if (server.readToBuffer(state, sizeof(state)) != sizeof(state))
+					break;
+				action[0] = state[0];
+				if (server.writeBuffer(action, sizeof(action)) != sizeof(action))
+					break;
+			}
+		}
+		clientThread.join();
+		server.closeServer();
+
+		if (!bClientOk || numRoundTrips == 0)
+			return results;
+
+		double sum = 0.0;
+		for (double latency : latencies)
+			sum += latency;
+		std::sort(latencies.begin(), latencies.end());
+		results.meanLatency = sum / numRoundTrips;
+		results.p50Latency = latencies[numRoundTrips / 2];
+		results.p99Latency = latencies[std::min(numRoundTrips - 1, (int)(numRoundTrips * 0.99))];
+		results.roundTripsPerSecond = numRoundTrips / totalTime;
+		results.bOk = true;
+		return results;
+	}
+
+	template <typename Transport>
+	bool runAndPrint(int numRoundTrips)
+	{
+		Results results = run<Transport>(numRoundTrips);
+		if (!results.bOk)
+		{
+			printf("%-8s failed\n", Transport::name());
+			return false;
+		}
+		printf("%-8s %10.2f %10.2f %10.2f %14.0f\n", Transport::name(), results.meanLatency, results.p50Latency
+			, results.p99Latency, results.roundTripsPerSecond);
+		return true;
+	}
+}
+
+int portalBenchmark(int argc, char** argv)
+{
+	using namespace PortalBenchmark;
+
+	int numRoundTrips = argc > 1 ? std::max(1, atoi(argv[1])) : 100000;
+
+	printf("Portal benchmark: %d round trips (%d state doubles, %d action doubles)\n", numRoundTrips
+		, numStateVariables, numActionVariables);
+	printf("%-8s %10s %10s %10s %14s\n", "channel", "mean (us)", "p50 (us)", "p99 (us)", "round-trips/s");
+	bool bOk = runAndPrint<SharedMemoryTransport>(numRoundTrips);
+#ifdef _WIN32
+	bOk = runAndPrint<NamedPipeTransport>(numRoundTrips) && bOk;
+#endif
+	return bOk ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+#include "stdafx.h"
+#include "benchmarks.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/mem-manager.h"
+#include "../../../tools/System/Timer.h"
+#include <string.h>
+#include <string>
+#include <vector>
+
+//Runs the same experiments storing the weights of all the linear VFAs with each of the available precisions
+//(Weight-Precision), and compares the wall time, the memory allocated for the weights and the average reward of the
+//last evaluation. The random seed is the same in every run, so with float64 the results are those of the original
+//experiment
+
+namespace PrecisionBenchmark
+{
+	struct Precision
+	{
+		const char* name;
+	};
+
+	Precision precisions[] = { { "float64" }, { "float32" }, { "float16" }, { "bfloat16" } };
+
+	struct Results
+	{
+		double time;
+		unsigned int numSteps;
+		double allocatedMem;
+		double lastEvaluationReward;
+	};
+
+	void setParameter(tinyxml2::XMLElement* pNode, const char* name, const char* value)
+	{
+		tinyxml2::XMLElement* pParameter = pNode->FirstChildElement(name);
+		if (!pParameter)
+		{
+			pParameter = pNode->GetDocument()->NewElement(name);
+			pNode->InsertEndChild(pParameter);
+		}
+		pParameter->SetText(value);
+	}
+
+	//Linear VFAs are the only objects with an Init-Value parameter
+	void setWeightPrecision(tinyxml2::XMLElement* pNode, const char* precision)
+	{
+		if (pNode->FirstChildElement("Init-Value"))
+			setParameter(pNode, "Weight-Precision", precision);
+		for (tinyxml2::XMLElement* pChild = pNode->FirstChildElement(); pChild; pChild = pChild->NextSiblingElement())
+			setWeightPrecision(pChild, precision);
+	}
+
+	Results runExperiment(ConfigNode* pRoot, const Precision& precision, const char* numEpisodes)
+	{
+		ConfigNode* pAppConfig = pRoot->getChild("RLSimion");
+		setWeightPrecision(pAppConfig, precision.name);
+		//the evaluations are only reported if evaluation episodes are logged
+		tinyxml2::XMLElement* pLogConfig = pAppConfig->FirstChildElement("Log");
+		if (!pLogConfig)
+			pLogConfig = pAppConfig->InsertEndChild(pAppConfig->GetDocument()->NewElement("Log"))->ToElement();
+		setParameter(pLogConfig, "Log-Eval-Episodes", "true");
+		setParameter(pLogConfig, "Log-Training-Episodes", "false");
+		setParameter(pLogConfig, "Log-Functions", "false");
+		if (numEpisodes)
+			setParameter(pAppConfig->FirstChildElement("Experiment"), "Num-Episodes", numEpisodes);
+
+		SimionApp* pApp = new SimionApp(pRoot);
+		pApp->setConfigFile("precision-benchmark.simion.exp");
+		pApp->setExecutedRemotely(true);
+
+		Timer timer;
+		timer.start();
+		pApp->run();
+
+		Results results;
+		results.time = timer.getElapsedTime();
+		results.numSteps = pApp->pExperiment->getExperimentStep();
+		results.allocatedMem = pApp->pMemManager->getTotalAllocatedMem() / (1024.0 * 1024.0);
+		results.lastEvaluationReward = pApp->pLogger->getLastEvaluationAvgReward();
+		delete pApp;
+		return results;
+	}
+}
+
+int precisionBenchmark(int argc, char** argv)
+{
+	using namespace PrecisionBenchmark;
+
+	const char* numEpisodes = nullptr;
+	vector<const char*> experimentFiles;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strncmp(argv[i], "-num-episodes=", strlen("-num-episodes=")))
+			numEpisodes = argv[i] + strlen("-num-episodes=");
+		else
+			experimentFiles.push_back(argv[i]);
+	}
+	if (experimentFiles.empty())
+	{
+		printf("Usage: precision <experiment-files...> [-num-episodes=<n>]\n");
+		return 1;
+	}
+
+	printf("%-40s %-10s %10s %12s %12s %14s\n", "experiment", "precision", "time (s)", "steps/s", "weights (MB)"
+		, "last eval.");
+	for (const char* experimentFile : experimentFiles)
+	{
+		const char* experimentName = experimentFile;
+		for (const char* pChar = experimentFile; *pChar; ++pChar)
+		{
+			if (*pChar == '/' || *pChar == '\\')
+				experimentName = pChar + 1;
+		}
+		for (const Precision& precision : precisions)
+		{
+			Results results;
+			Logger::enableLogMessages(false);
+			try
+			{
+				ConfigFile configFile;
+				ConfigNode* pRoot = configFile.loadFile(experimentFile);
+				if (!pRoot)
+					throw std::runtime_error("Couldn't load the experiment file");
+				results = runExperiment(pRoot, precision, numEpisodes);
+			}
+			catch (std::exception& e)
+			{
+				Logger::enableLogMessages(true);
+				printf("%-40s %-10s failed: %s\n", experimentName, precision.name, e.what());
+				continue;
+			}
+			Logger::enableLogMessages(true);
+
+			printf("%-40s %-10s %10.3f %12.0f %12.2f %14.6f\n", experimentName, precision.name, results.time
+				, results.numSteps / results.time, results.allocatedMem, results.lastEvaluationReward);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,188 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/worlds/BulletPhysics.h"
+#include "../../../RLSimion/Lib/worlds/BulletBody.h"
+#include "../../../RLSimion/Lib/worlds/Box.h"
+#include "../../../RLSimion/Lib/worlds/Robot.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <string.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#define DT 0.01
+#define MAX_SUB_STEPS 20
+#define NUM_STEPS 50
+
+namespace BulletSnapshotTest
+{
+	//A world like Push-Box-1's: the robot drives towards the box, so that the snapshot is taken while they are in contact
+	class TestWorld
+	{
+	public:
+		Descriptor stateDescriptor;
+		Descriptor actionDescriptor;
+		State* s;
+		Action* a;
+		BulletPhysics physics;
+		std::vector<BulletBody*> bodies;
+
+		TestWorld()
+		{
+			stateDescriptor.addVariable("robot1-x", "m", -10.0, 10.0);
+			stateDescriptor.addVariable("robot1-y", "m", -10.0, 10.0);
+			stateDescriptor.addVariable("robot1-theta", "rad", -3.15, 3.15, true);
+			stateDescriptor.addVariable("box-x", "m", -10.0, 10.0);
+			stateDescriptor.addVariable("box-y", "m", -10.0, 10.0);
+			stateDescriptor.addVariable("box-theta", "rad", -3.15, 3.15, true);
+			actionDescriptor.addVariable("robot1-v", "m/s", -2.0, 2.0);
+			actionDescriptor.addVariable("robot1-omega", "rad/s", -8.0, 8.0);
+			s = stateDescriptor.getInstance();
+			a = actionDescriptor.getInstance();
+
+			physics.initPhysics();
+			physics.initPlayground();
+
+			BulletBox* pBox = new BulletBox(BulletPhysics::MASS_BOX
+				, btVector3(BulletPhysics::boxOrigin_x, BulletPhysics::boxOrigin_z, BulletPhysics::boxOrigin_y)
+				, new btBoxShape(btVector3(0.6, 0.6, 0.6)));
+			pBox->setAbsoluteStateVarIds("box-x", "box-y", "box-theta");
+			physics.add(pBox);
+			bodies.push_back(pBox);
+
+			Robot* pRobot = new Robot(BulletPhysics::MASS_ROBOT
+				, btVector3(BulletPhysics::r1origin_x, BulletPhysics::r1origin_z, BulletPhysics::r1origin_y)
+				, new btSphereShape(0.5));
+			pRobot->setAbsoluteStateVarIds("robot1-x", "robot1-y", "robot1-theta");
+			pRobot->setActionIds("robot1-v", "robot1-omega");
+			physics.add(pRobot);
+			bodies.push_back(pRobot);
+
+			a->set("robot1-v", 2.0);
+			a->set("robot1-omega", 0.6);
+			physics.reset(s);
+		}
+		~TestWorld()
+		{
+			delete s;
+			delete a;
+		}
+
+		void step()
+		{
+			physics.updateBulletState(s, a, DT);
+			physics.stepSimulation((float)DT, MAX_SUB_STEPS);
+			physics.updateState(s);
+		}
+
+		//The transforms and the velocities of the bodies, followed by the state variables. The robot's angle isn't
+		//read from Bullet, so it is only restored by Robot::restoreState()
+		std::vector<double> capture() const
+		{
+			std::vector<double> values;
+			for (BulletBody* pBody : bodies)
+			{
+				const btTransform& transform = pBody->getBody()->getWorldTransform();
+				for (int row = 0; row < 3; ++row)
+					for (int column = 0; column < 3; ++column)
+						values.push_back(transform.getBasis()[row][column]);
+				for (int i = 0; i < 3; ++i)
+				{
+					values.push_back(transform.getOrigin()[i]);
+					values.push_back(pBody->getBody()->getLinearVelocity()[i]);
+					values.push_back(pBody->getBody()->getAngularVelocity()[i]);
+				}
+			}
+			for (size_t i = 0; i < s->getNumVars(); ++i)
+				values.push_back(s->get(i));
+			return values;
+		}
+
+		std::vector<std::vector<double>> run(int numSteps)
+		{
+			std::vector<std::vector<double>> trajectory;
+			for (int i = 0; i < numSteps; ++i)
+			{
+				step();
+				trajectory.push_back(capture());
+			}
+			return trajectory;
+		}
+	};
+
+	void checkBitIdentical(const std::vector<double>& expected, const std::vector<double>& actual)
+	{
+		Assert::AreEqual(expected.size(), actual.size());
+		Assert::IsTrue(memcmp(expected.data(), actual.data(), expected.size() * sizeof(double)) == 0);
+	}
+
+	void checkBitIdentical(const std::vector<std::vector<double>>& expected, const std::vector<std::vector<double>>& actual)
+	{
+		Assert::AreEqual(expected.size(), actual.size());
+		for (size_t i = 0; i < expected.size(); ++i)
+			checkBitIdentical(expected[i], actual[i]);
+	}
+
+	TEST_CLASS(UnitTest1)
+	{
+	public:
+
+		TEST_METHOD(BulletSnapshot_RestoreState)
+		{
+			TestWorld world;
+			world.run(NUM_STEPS);
+
+			BulletWorldSnapshot snapshot;
+			world.physics.saveState(snapshot);
+			std::vector<double> savedValues = world.capture();
+			world.run(NUM_STEPS);
+			Assert::IsFalse(world.capture() == savedValues);
+
+			//the bodies are back where they were, and the robot's angle is restored too
+			Assert::IsTrue(world.physics.restoreState(snapshot));
+			world.physics.updateState(world.s);
+			checkBitIdentical(savedValues, world.capture());
+
+			//contacts found before restoring the snapshot are discarded, so every time the snapshot is restored the
+			//simulation goes on exactly the same way
+			std::vector<std::vector<double>> trajectory = world.run(NUM_STEPS);
+			Assert::IsTrue(world.physics.restoreState(snapshot));
+			world.physics.updateState(world.s);
+			checkBitIdentical(savedValues, world.capture());
+			checkBitIdentical(trajectory, world.run(NUM_STEPS));
+		}
+
+		TEST_METHOD(BulletSnapshot_RestoreInIdenticalWorld)
+		{
+			TestWorld world;
+			world.run(NUM_STEPS);
+			BulletWorldSnapshot snapshot;
+			world.physics.saveState(snapshot);
+			std::vector<double> savedValues = world.capture();
+			Assert::IsTrue(world.physics.restoreState(snapshot));
+			world.physics.updateState(world.s);
+			std::vector<std::vector<double>> trajectory = world.run(NUM_STEPS);
+
+			//the other world has run for a different number of steps before the snapshot is restored
+			TestWorld otherWorld;
+			otherWorld.run(NUM_STEPS / 2);
+			Assert::IsTrue(otherWorld.physics.restoreState(snapshot));
+			otherWorld.physics.updateState(otherWorld.s);
+			checkBitIdentical(savedValues, otherWorld.capture());
+			checkBitIdentical(trajectory, otherWorld.run(NUM_STEPS));
+		}
+
+		TEST_METHOD(BulletSnapshot_MismatchedLayout)
+		{
+			TestWorld world;
+			BulletWorldSnapshot snapshot;
+			world.physics.saveState(snapshot);
+
+			//a world with one more body can't restore the snapshot
+			TestWorld otherWorld;
+			otherWorld.physics.add(new BulletBox(BulletPhysics::MASS_BOX, btVector3(-3.0, 0.5, -3.0)
+				, new btBoxShape(btVector3(0.6, 0.6, 0.6))));
+			Assert::IsFalse(otherWorld.physics.restoreState(snapshot));
+		}
+	};
+}
@@ -0,0 +1,179 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/etraces.h"
+#include "../../../RLSimion/Lib/features.h"
+#include <algorithm>
+#include <vector>
+#include <math.h>
+#include <stdlib.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#define THRESHOLD 0.001
+#define LAMBDA 0.9
+
+namespace ETracesTest
+{
+	//The reference traces are a plain FeatureList with the same overwrite mode: features are searched linearly and
+	//traces are decayed with mult() and applyThreshold(), as ETraces did before the position table was added
+	void decayReference(FeatureList& reference, double factor)
+	{
+		reference.mult(factor * LAMBDA);
+		reference.applyThreshold(THRESHOLD);
+	}
+
+	//Checks that the traces hold the same features and factors as the reference and that there are no duplicates
+	void checkTraces(ETraces& traces, FeatureList& reference)
+	{
+		Assert::AreEqual((int)reference.m_numFeatures, (int)traces.m_numFeatures);
+		for (size_t i = 0; i < reference.m_numFeatures; ++i)
+		{
+			Assert::AreEqual(reference.m_pFeatures[i].m_factor, traces.getFactor(reference.m_pFeatures[i].m_index));
+			Assert::AreEqual((int)i, (int)traces.getFeaturePos(traces.m_pFeatures[i].m_index));
+		}
+	}
+
+	void randomFeatures(FeatureList& outList, size_t numFeatures, size_t maxIndex)
+	{
+		outList.clear();
+		for (size_t i = 0; i < numFeatures; ++i)
+			outList.add(rand() % maxIndex, (double)(rand() % 2000 - 1000) / 1000.0);
+	}
+
+	void checkModeAgainstReference(bool bReplace)
+	{
+		ETraces traces(THRESHOLD, LAMBDA, bReplace);
+		FeatureList reference("reference", bReplace ? OverwriteMode::Replace : OverwriteMode::Add);
+		FeatureList features("features");
+
+		srand(1);
+		for (int step = 0; step < 200; ++step)
+		{
+			randomFeatures(features, 10, 100);
+			traces.addFeatureList(&features, 0.5);
+			reference.addFeatureList(&features, 0.5);
+			checkTraces(traces, reference);
+
+			traces.decay(1.0);
+			decayReference(reference, 1.0);
+			checkTraces(traces, reference);
+		}
+	}
+
+	TEST_CLASS(UnitTest1)
+	{
+	public:
+
+		TEST_METHOD(ETraces_Replace)
+		{
+			checkModeAgainstReference(true);
+		}
+
+		TEST_METHOD(ETraces_Add)
+		{
+			checkModeAgainstReference(false);
+		}
+
+		TEST_METHOD(ETraces_UpdateAfterCompaction)
+		{
+			ETraces traces(THRESHOLD, LAMBDA, false);
+			FeatureList reference("reference", OverwriteMode::Add);
+			FeatureList features("features");
+
+			//every other trace falls under the threshold when decayed, so the rest are moved to new positions
+			for (size_t i = 0; i < 20; ++i)
+				features.add(i, i % 2 == 0 ? THRESHOLD * 0.5 : 1.0);
+			traces.addFeatureList(&features);
+			reference.addFeatureList(&features);
+			traces.decay(1.0);
+			decayReference(reference, 1.0);
+			Assert::AreEqual(10, (int)traces.m_numFeatures);
+			checkTraces(traces, reference);
+
+			//traces that were moved are updated in place and the removed ones are added again
+			features.clear();
+			for (size_t i = 0; i < 20; ++i)
+				features.add(19 - i, 0.25);
+			traces.addFeatureList(&features);
+			reference.addFeatureList(&features);
+			Assert::AreEqual(20, (int)traces.m_numFeatures);
+			checkTraces(traces, reference);
+			Assert::AreEqual(1.0 * LAMBDA + 0.25, traces.getFactor(1));
+			Assert::AreEqual(0.25, traces.getFactor(0));
+		}
+
+		TEST_METHOD(ETraces_Regrowth)
+		{
+			ETraces traces(THRESHOLD, LAMBDA, true);
+			FeatureList reference("reference", OverwriteMode::Replace);
+			FeatureList features("features");
+
+			//many more traces than the initial size of the table, with indices far apart
+			for (size_t i = 0; i < 5000; ++i)
+				features.add(i * 4099 + (i % 7) * 1000003, 1.0 + (double)i);
+			traces.addFeatureList(&features);
+			reference.addFeatureList(&features);
+			checkTraces(traces, reference);
+
+			//adding the same indices again must find all of them
+			traces.addFeatureList(&features, 2.0);
+			reference.addFeatureList(&features, 2.0);
+			Assert::AreEqual(5000, (int)traces.m_numFeatures);
+			checkTraces(traces, reference);
+
+			traces.decay(1.0);
+			decayReference(reference, 1.0);
+			traces.addFeatureList(&features, -1.0);
+			reference.addFeatureList(&features, -1.0);
+			checkTraces(traces, reference);
+		}
+
+		TEST_METHOD(ETraces_MaxNumTraces)
+		{
+			const int maxNumTraces = 10;
+			ETraces traces(THRESHOLD, LAMBDA, true, maxNumTraces);
+			FeatureList features("features");
+
+			srand(2);
+			for (int step = 0; step < 20; ++step)
+			{
+				randomFeatures(features, 25, 1000);
+
+				//the traces kept are the largest (in absolute value) of the old traces and the new features
+				vector<Feature> expected(traces.m_pFeatures, traces.m_pFeatures + traces.m_numFeatures);
+				for (size_t i = 0; i < features.m_numFeatures; ++i)
+				{
+					auto it = std::find_if(expected.begin(), expected.end()
+						, [&](const Feature& f) { return f.m_index == features.m_pFeatures[i].m_index; });
+					if (it != expected.end()) it->m_factor = features.m_pFeatures[i].m_factor;
+					else expected.push_back(features.m_pFeatures[i]);
+				}
+				std::sort(expected.begin(), expected.end()
+					, [](const Feature& a, const Feature& b) { return fabs(a.m_factor) > fabs(b.m_factor); });
+
+				traces.addFeatureList(&features);
+				size_t numExpected = std::min(expected.size(), (size_t)maxNumTraces);
+				Assert::AreEqual((int)numExpected, (int)traces.m_numFeatures);
+
+				//the smallest trace kept can't be smaller than any trace removed (ties may be kept in any order)
+				double smallestKept = fabs(expected[numExpected - 1].m_factor);
+				for (size_t i = 0; i < traces.m_numFeatures; ++i)
+					Assert::IsTrue(fabs(traces.m_pFeatures[i].m_factor) >= smallestKept);
+				for (size_t i = 0; i < expected.size(); ++i)
+				{
+					if (fabs(expected[i].m_factor) > smallestKept)
+						Assert::AreEqual(expected[i].m_factor, traces.getFactor(expected[i].m_index));
+				}
+
+				//the traces kept must still be found when they are updated
+				FeatureList update("update");
+				update.add(traces.m_pFeatures[0].m_index, 2.0);
+				traces.addFeatureList(&update);
+				Assert::AreEqual((int)numExpected, (int)traces.m_numFeatures);
+				Assert::AreEqual(2.0, traces.getFactor(update.m_pFeatures[0].m_index));
+
+				traces.decay(1.0);
+			}
+		}
+	};
+}
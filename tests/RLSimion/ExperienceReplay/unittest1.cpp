@@ -0,0 +1,109 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/experience-replay.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/noise.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#define GAMMA 0.9
+#define RETURN_STEPS 3
+
+namespace ExperienceReplayTest
+{
+	//Tuple t has s= t, s_p= t + 0.5 and r= 1 + t, so that replayed tuples can be told apart
+	void addTuples(ExperienceReplay& replay, Descriptor& stateDescriptor, Descriptor& actionDescriptor
+		, size_t numTuples, const vector<size_t>& episodeEnds)
+	{
+		State* s = stateDescriptor.getInstance();
+		State* s_p = stateDescriptor.getInstance();
+		Action* a = actionDescriptor.getInstance();
+		for (size_t t = 0; t < numTuples; ++t)
+		{
+			s->set((size_t)0, (double)t);
+			s_p->set((size_t)0, (double)t + 0.5);
+			bool bEpisodeEnd = std::find(episodeEnds.begin(), episodeEnds.end(), t) != episodeEnds.end();
+			replay.addTuple(s, a, s_p, 1.0 + (double)t, 1.0, bEpisodeEnd);
+		}
+		delete s;
+		delete s_p;
+		delete a;
+	}
+
+	//Samples several batches, so that every tuple in the buffer is replayed, and checks the return, the last state and the
+	//discount of each replayed tuple against the number of steps expected for the trajectory that begins with it
+	void checkReturns(ExperienceReplay& replay, size_t firstTuple, const vector<size_t>& expectedNumSteps)
+	{
+		vector<bool> bReplayed(expectedNumSteps.size(), false);
+		getRandomEngine().seed(1);
+		for (int batch = 0; batch < 20; ++batch)
+		{
+			const vector<ReplayedTuple>& replayedTuples = replay.sampleBatch(GAMMA);
+			Assert::AreEqual(64, (int)replayedTuples.size());
+			for (const ReplayedTuple& replayedTuple : replayedTuples)
+			{
+				size_t t = (size_t)replayedTuple.pTuple->s->get((size_t)0);
+				Assert::IsTrue(t >= firstTuple && t < firstTuple + expectedNumSteps.size());
+				size_t numSteps = expectedNumSteps[t - firstTuple];
+				bReplayed[t - firstTuple] = true;
+
+				double expectedReturn = 0.0, discount = 1.0;
+				for (size_t step = 0; step < numSteps; ++step)
+				{
+					expectedReturn += discount * (1.0 + (double)(t + step));
+					discount *= GAMMA;
+				}
+				Assert::AreEqual(expectedReturn, replayedTuple.nStepReturn, 1e-12);
+				Assert::AreEqual(discount, replayedTuple.discount, 1e-12);
+				Assert::AreEqual((double)(t + numSteps - 1) + 0.5, replayedTuple.s_n->get((size_t)0));
+			}
+		}
+		for (size_t i = 0; i < bReplayed.size(); ++i)
+			Assert::IsTrue(bReplayed[i]);
+	}
+
+	TEST_CLASS(UnitTest1)
+	{
+	public:
+
+		TEST_METHOD(ExperienceReplay_EpisodeEnd)
+		{
+			Descriptor stateDescriptor;
+			stateDescriptor.addVariable("t", "s", 0.0, 100.0);
+			Descriptor actionDescriptor;
+			actionDescriptor.addVariable("u", "N", -1.0, 1.0);
+
+			ConfigFile config;
+			config.Parse("<Experience-Replay><Buffer-Size>8</Buffer-Size><Update-Batch-Size>64</Update-Batch-Size>"
+				"<Return-Steps>3</Return-Steps><Return-Lambda>0</Return-Lambda></Experience-Replay>");
+			ExperienceReplay replay((ConfigNode*)config.FirstChildElement());
+			replay.init(stateDescriptor, actionDescriptor);
+
+			//tuple 2 ends an episode and tuple 5 is the most recent one, so trajectories are cut after them
+			addTuples(replay, stateDescriptor, actionDescriptor, 6, { 2 });
+			checkReturns(replay, 0, { RETURN_STEPS, 2, 1, RETURN_STEPS, 2, 1 });
+		}
+
+		TEST_METHOD(ExperienceReplay_WrappedBuffer)
+		{
+			Descriptor stateDescriptor;
+			stateDescriptor.addVariable("t", "s", 0.0, 100.0);
+			Descriptor actionDescriptor;
+			actionDescriptor.addVariable("u", "N", -1.0, 1.0);
+
+			ConfigFile config;
+			config.Parse("<Experience-Replay><Buffer-Size>4</Buffer-Size><Update-Batch-Size>64</Update-Batch-Size>"
+				"<Return-Steps>3</Return-Steps><Return-Lambda>0</Return-Lambda></Experience-Replay>");
+			ExperienceReplay replay((ConfigNode*)config.FirstChildElement());
+			replay.init(stateDescriptor, actionDescriptor);
+
+			//the buffer holds tuples [4, 5, 2, 3]: trajectories go on from the end of the buffer to its beginning, but
+			//never past the most recent tuple (5) to the oldest one (2)
+			addTuples(replay, stateDescriptor, actionDescriptor, 6, {});
+			checkReturns(replay, 2, { RETURN_STEPS, RETURN_STEPS, 2, 1 });
+		}
+	};
+}
@@ -0,0 +1,190 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/function-log-encoder.h"
+#include "../../../RLSimion/Common/function-log-format.h"
+#include "../../../tools/SimionLogViewer/LogLoader.h"
+#include <stdio.h>
+#include <math.h>
+#include <limits>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#define TEST_FUNCTION_LOG_FILE "function-log-test.bin"
+#define NUM_VALUES 4
+#define PRECISION 1e-5
+
+namespace FunctionLogTest
+{
+	//Encodes the samples with a FunctionLogEncoder, writes them to a version 2 function log file and returns the
+	//encodings and quantums used
+	void writeFunctionLog(const vector<vector<double>>& samples, bool bDelta, bool bFloat32
+		, vector<long long int>& outEncodings, vector<double>& outQuantums)
+	{
+		FILE* pFile = fopen(TEST_FUNCTION_LOG_FILE, "wb");
+		Assert::IsTrue(pFile != nullptr);
+
+		FunctionLogHeader logHeader;
+		logHeader.fileVersion = FUNCTION_LOG_FILE_VERSION_ENCODED;
+		logHeader.numFunctions = 1;
+		fwrite(&logHeader, sizeof(FunctionLogHeader), 1, pFile);
+
+		FunctionDeclarationHeader declarationHeader;
+		memset(declarationHeader.name, 0, MAX_FUNCTION_ID_LENGTH);
+		strcpy(declarationHeader.name, "test-function");
+		declarationHeader.id = 0;
+		declarationHeader.numSamplesX = samples.empty() ? 0 : samples[0].size();
+		declarationHeader.numSamplesY = 1;
+		declarationHeader.numSamplesZ = 1;
+		fwrite(&declarationHeader, sizeof(FunctionDeclarationHeader), 1, pFile);
+
+		FunctionLogEncoder encoder(1, bDelta, bFloat32, PRECISION);
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			FunctionSampleHeader sampleHeader;
+			sampleHeader.episode = i + 1;
+			sampleHeader.step = 0;
+			sampleHeader.experimentStep = i;
+			sampleHeader.id = 0;
+			fwrite(&sampleHeader, sizeof(FunctionSampleHeader), 1, pFile);
+
+			FunctionSampleEncodingHeader encodingHeader;
+			const vector<char>& encodedValues = encoder.encode(0, samples[i], encodingHeader);
+			fwrite(&encodingHeader, sizeof(FunctionSampleEncodingHeader), 1, pFile);
+			if (!encodedValues.empty())
+				fwrite(encodedValues.data(), 1, encodedValues.size(), pFile);
+
+			outEncodings.push_back(encodingHeader.encoding);
+			outQuantums.push_back(encodingHeader.quantum);
+		}
+		fclose(pFile);
+	}
+
+	void checkDecodedValues(const vector<double>& expected, const vector<double>& decoded, double quantum)
+	{
+		Assert::AreEqual(expected.size(), decoded.size());
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			if (isnan(expected[i]))
+				Assert::IsTrue(isnan(decoded[i]));
+			else if (quantum == 0.0)
+				Assert::AreEqual(expected[i], decoded[i]);
+			else
+				Assert::IsTrue(fabs(expected[i] - decoded[i]) <= quantum * 0.5 + 1e-12);
+		}
+	}
+
+	TEST_CLASS(UnitTest1)
+	{
+	public:
+
+		TEST_METHOD(FunctionLog_EncodedRoundTrip)
+		{
+			//the range of the first samples is 3, so values change by a multiple of the quantum 3e-5
+			vector<vector<double>> samples;
+			samples.push_back({ 0.0, 1.0, 2.0, 3.0 });
+			samples.push_back({ 0.001, 1.001, 2.001, 3.001 });
+			samples.push_back({ 0.001, 1.001, 2.001, 3.001 });
+			samples.push_back({ 0.001, 1.011, 2.001, 3.001 });
+			//a change over 32767 quanta overflows the 16-bit deltas
+			samples.push_back({ 0.001, 1.011, 2.001, 5.001 });
+			samples.push_back({ 0.001, numeric_limits<double>::quiet_NaN(), 2.001, 5.001 });
+			//the previous sample isn't finite, so this one can't be delta-encoded either
+			samples.push_back({ 0.001, 1.011, 2.001, 5.001 });
+			for (size_t i = 0; i <= FunctionLogEncoder::MAX_DELTA_SAMPLES + 1; ++i)
+			{
+				vector<double> sample = samples.back();
+				sample[i % NUM_VALUES] += 0.0003;
+				samples.push_back(sample);
+			}
+
+			vector<long long int> encodings;
+			vector<double> quantums;
+			writeFunctionLog(samples, true, false, encodings, quantums);
+
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_DOUBLE, encodings[0]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_DELTA_INT8, encodings[1]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_UNCHANGED, encodings[2]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_DELTA_INT16, encodings[3]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_DOUBLE, encodings[4]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_DOUBLE, encodings[5]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_DOUBLE, encodings[6]);
+			//after a full sample, MAX_DELTA_SAMPLES samples are delta-encoded and the next one is saved in full
+			size_t forcedFullSample = 6 + FunctionLogEncoder::MAX_DELTA_SAMPLES + 1;
+			for (size_t i = 7; i < forcedFullSample; ++i)
+				Assert::AreEqual((long long int)FUNCTION_SAMPLE_DELTA_INT8, encodings[i]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_DOUBLE, encodings[forcedFullSample]);
+			Assert::AreEqual((long long int)FUNCTION_SAMPLE_DELTA_INT8, encodings[forcedFullSample + 1]);
+
+			{
+				FunctionLog functionLog;
+				functionLog.load(TEST_FUNCTION_LOG_FILE);
+				Assert::AreEqual((size_t)1, functionLog.getFunctions().size());
+				Function* pFunction = functionLog.getFunctions()[0];
+				Assert::AreEqual((size_t)NUM_VALUES, pFunction->numSamples());
+				Assert::AreEqual(samples.size(), pFunction->numSavedSamples());
+
+				//decode the samples in order
+				for (size_t i = 0; i < samples.size(); ++i)
+				{
+					Assert::AreEqual(encodings[i] == FUNCTION_SAMPLE_FULL_DOUBLE, pFunction->getSavedSample(i).bFull());
+					Assert::AreEqual(i + 1, pFunction->getSavedSample(i).episode());
+					checkDecodedValues(samples[i], pFunction->getSavedSampleValues(i), quantums[i]);
+				}
+				//and backwards, so that delta-encoded samples are decoded from the previous full sample
+				for (size_t i = samples.size(); i > 0; --i)
+					checkDecodedValues(samples[i - 1], pFunction->getSavedSampleValues(i - 1), quantums[i - 1]);
+			}
+			remove(TEST_FUNCTION_LOG_FILE);
+		}
+
+		TEST_METHOD(FunctionLog_Float32RoundTrip)
+		{
+			vector<vector<double>> samples;
+			samples.push_back({ 0.1, 1.1, 2.1, 3.1 });
+			samples.push_back({ 0.2, 1.2, 2.2, 3.2 });
+
+			//without delta encoding, every sample is saved in full as floats
+			vector<long long int> encodings;
+			vector<double> quantums;
+			writeFunctionLog(samples, false, true, encodings, quantums);
+			for (size_t i = 0; i < samples.size(); ++i)
+				Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_FLOAT, encodings[i]);
+
+			{
+				FunctionLog functionLog;
+				functionLog.load(TEST_FUNCTION_LOG_FILE);
+				Function* pFunction = functionLog.getFunctions()[0];
+				Assert::AreEqual(samples.size(), pFunction->numSavedSamples());
+				for (size_t i = 0; i < samples.size(); ++i)
+				{
+					const vector<double>& values = pFunction->getSavedSampleValues(i);
+					for (size_t j = 0; j < NUM_VALUES; ++j)
+						Assert::AreEqual((double)(float)samples[i][j], values[j]);
+				}
+			}
+			remove(TEST_FUNCTION_LOG_FILE);
+		}
+
+		TEST_METHOD(FunctionLog_EmptySamples)
+		{
+			//a function without samples can't be delta-encoded: every sample is saved in full, with no values
+			vector<vector<double>> samples(3);
+			vector<long long int> encodings;
+			vector<double> quantums;
+			writeFunctionLog(samples, true, false, encodings, quantums);
+			for (size_t i = 0; i < samples.size(); ++i)
+				Assert::AreEqual((long long int)FUNCTION_SAMPLE_FULL_DOUBLE, encodings[i]);
+
+			{
+				FunctionLog functionLog;
+				functionLog.load(TEST_FUNCTION_LOG_FILE);
+				Function* pFunction = functionLog.getFunctions()[0];
+				Assert::AreEqual((size_t)0, pFunction->numSamples());
+				Assert::AreEqual(samples.size(), pFunction->numSavedSamples());
+				for (size_t i = 0; i < samples.size(); ++i)
+					Assert::IsTrue(pFunction->getSavedSampleValues(i).empty());
+			}
+			remove(TEST_FUNCTION_LOG_FILE);
+		}
+	};
+}
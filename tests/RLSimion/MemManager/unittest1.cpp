@@ -215,5 +215,187 @@ namespace MemManagerTest
 
 			delete pMemManager;
 		}
+		TEST_METHOD(MemManager_Preallocated)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pBuffer = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer->setInitValue(1.0);
+			pMemManager->init(SMALL_BLOCK_SIZE);
+			pBuffer->getMemPool()->allocateAll();
+			Assert::IsTrue(pBuffer->getMemPool()->bPreallocated());
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+				Assert::AreEqual(1.0, (*pBuffer)[i]);
+			delete pMemManager;
+
+			//with a memory limit, allocating the last blocks swaps out the first ones
+			pMemManager = new MemManager<SimionMemPool>();
+			pBuffer = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pMemManager->setMaxAllocatedMem(SMALL_BUFER_SIZE * sizeof(double) / 2);
+			pMemManager->init(SMALL_BLOCK_SIZE);
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+				(*pBuffer)[i] = i;
+			pBuffer->getMemPool()->allocateAll();
+			Assert::IsFalse(pBuffer->getMemPool()->bPreallocated());
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+				Assert::AreEqual((double)i, (*pBuffer)[i]);
+			delete pMemManager;
+		}
+		TEST_METHOD(MemManager_ReducedPrecision)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pBuffer64 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			IMemBuffer* pBuffer32 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE, WeightPrecision::float32);
+			pBuffer32->setInitValue(0.5);
+			IMemBuffer* pBuffer16 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE, WeightPrecision::float16);
+			pBuffer16->setInitValue(0.5);
+			IMemBuffer* pBufferB16 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE, WeightPrecision::bfloat16);
+			pBufferB16->setInitValue(0.5);
+
+			//buffers with different precisions are never interleaved
+			Assert::IsTrue(pBuffer64->getMemPool() != pBuffer32->getMemPool());
+			Assert::IsTrue(pBuffer32->getMemPool() != pBuffer16->getMemPool());
+			Assert::IsTrue(pBuffer16->getMemPool() != pBufferB16->getMemPool());
+
+			pMemManager->init(SMALL_BLOCK_SIZE);
+
+			Assert::AreEqual(0.5, pBuffer32->get(0));
+			Assert::AreEqual(0.5, pBuffer16->get(0));
+			Assert::AreEqual(0.5, pBufferB16->get(0));
+
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+			{
+				pBuffer64->set(i, i * 0.01);
+				pBuffer32->set(i, i * 0.01);
+				pBuffer16->set(i, i * 0.01);
+				pBufferB16->set(i, i * 0.01);
+			}
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+			{
+				Assert::AreEqual(i * 0.01, pBuffer64->get(i));
+				Assert::AreEqual(i * 0.01, pBuffer32->get(i), 1e-6);
+				Assert::AreEqual(i * 0.01, pBuffer16->get(i), 1e-2);
+				Assert::AreEqual(i * 0.01, pBufferB16->get(i), 1e-1);
+			}
+
+			//values are stored in 8, 4, 2 and 2 bytes
+			size_t blockSize64 = dynamic_cast<SimionMemBuffer*>(pBuffer64)->getBlockSizeInBytes();
+			Assert::AreEqual(blockSize64 / 2, dynamic_cast<SimionMemBuffer*>(pBuffer32)->getBlockSizeInBytes());
+			Assert::AreEqual(blockSize64 / 4, dynamic_cast<SimionMemBuffer*>(pBuffer16)->getBlockSizeInBytes());
+			Assert::AreEqual(blockSize64 / 4, dynamic_cast<SimionMemBuffer*>(pBufferB16)->getBlockSizeInBytes());
+
+			delete pMemManager;
+
+			//simple memory pools only store doubles
+			MemManager<SimpleMemPool>* pSimpleMemManager = new MemManager<SimpleMemPool>();
+			pSimpleMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			bool bPrecisionRejected = false;
+			try
+			{
+				pSimpleMemManager->getMemBuffer(SMALL_BUFER_SIZE, WeightPrecision::float32);
+			}
+			catch (std::exception&)
+			{
+				bPrecisionRejected = true;
+			}
+			Assert::IsTrue(bPrecisionRejected);
+			delete pSimpleMemManager;
+		}
+		TEST_METHOD(MemManager_PageAllocator)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pBuffer1 = pMemManager->getMemBuffer(BUFFER_SIZE);
+			pBuffer1->setInitValue(1.0);
+			IMemBuffer* pBuffer2 = pMemManager->getMemBuffer(BUFFER_SIZE);
+			pBuffer2->setInitValue(2.0);
+			IMemBuffer* pSmallBuffer = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pSmallBuffer->setInitValue(3.0);
+
+			pMemManager->usePageAllocator(true);
+			pMemManager->setNumInitThreads(4);
+			pMemManager->init(BLOCK_SIZE);
+
+			//blocks span a whole number of huge pages unless the pool is smaller than that
+			size_t blockSizeInBytes = dynamic_cast<SimionMemBuffer*>(pBuffer1)->getBlockSizeInBytes();
+			Assert::AreEqual((size_t)0, blockSizeInBytes % PageAllocator::HUGE_PAGE_SIZE);
+
+			for (int i = 0; i < BUFFER_SIZE; i += 1000)
+			{
+				Assert::AreEqual(1.0, (*pBuffer1)[i]);
+				Assert::AreEqual(2.0, (*pBuffer2)[i]);
+				(*pBuffer1)[i] = -1.0;
+			}
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+				Assert::AreEqual(3.0, (*pSmallBuffer)[i]);
+			for (int i = 0; i < BUFFER_SIZE; i += 1000)
+				Assert::AreEqual(-1.0, (*pBuffer1)[i]);
+
+			Assert::AreEqual(pMemManager->getTotalAllocatedMem(), pMemManager->getPageAllocator()->getAllocatedBytes());
+
+			delete pMemManager;
+		}
+		TEST_METHOD(MemManager_PageAllocatorOptionsChanged)
+		{
+			PageAllocator allocator(true);
+			size_t size = PageAllocator::HUGE_PAGE_SIZE + 1;
+			void* pHugePageAddress = allocator.allocate(size);
+			Assert::IsTrue(pHugePageAddress != nullptr);
+			Assert::AreEqual(2 * PageAllocator::HUGE_PAGE_SIZE, allocator.getAllocatedBytes());
+
+			//memory is freed as it was allocated, even if huge pages are no longer used
+			allocator.setHugePages(false);
+			void* pAddress = allocator.allocate(size);
+			Assert::AreEqual(3 * PageAllocator::HUGE_PAGE_SIZE + 1, allocator.getAllocatedBytes());
+			allocator.free(pHugePageAddress);
+			Assert::AreEqual(size, allocator.getAllocatedBytes());
+			allocator.free(pAddress);
+			Assert::AreEqual((size_t)0, allocator.getAllocatedBytes());
+			Assert::AreEqual((size_t)0, allocator.getHugePageBytes());
+		}
+		TEST_METHOD(MemManager_SharedBuffers)
+		{
+			MemManager<SimionMemPool>* pSharedManager = new MemManager<SimionMemPool>();
+			MemManager<SimionMemPool>* pMemManager1 = new MemManager<SimionMemPool>();
+			MemManager<SimionMemPool>* pMemManager2 = new MemManager<SimionMemPool>();
+			pMemManager1->shareMemBuffers(pSharedManager);
+			pMemManager2->shareMemBuffers(pSharedManager);
+
+			//buffers are matched by the order in which they are requested
+			IMemBuffer* pBuffer1 = pMemManager1->getMemBuffer(BUFFER_SIZE);
+			pBuffer1->setInitValue(1.0);
+			IMemBuffer* pSmallBuffer1 = pMemManager1->getMemBuffer(SMALL_BUFER_SIZE);
+			IMemBuffer* pBuffer2 = pMemManager2->getMemBuffer(BUFFER_SIZE);
+			IMemBuffer* pSmallBuffer2 = pMemManager2->getMemBuffer(SMALL_BUFER_SIZE);
+			Assert::IsTrue(pBuffer1 == pBuffer2);
+			Assert::IsTrue(pSmallBuffer1 == pSmallBuffer2);
+
+			pMemManager1->init(BLOCK_SIZE);
+			pMemManager2->init(BLOCK_SIZE);
+			//the workers access the shared buffers without tracking the accesses
+			Assert::IsTrue(pBuffer1->getMemPool()->bPreallocated());
+
+			for (int i = 0; i < BUFFER_SIZE; i += 1000)
+			{
+				Assert::AreEqual(1.0, (*pBuffer2)[i]);
+				(*pBuffer1)[i] = -1.0;
+				Assert::AreEqual(-1.0, (*pBuffer2)[i]);
+			}
+			Assert::AreEqual(pSharedManager->getTotalAllocatedMem(), pMemManager1->getTotalAllocatedMem());
+
+			//no more buffers can be requested once the shared buffers have been initialized
+			bool bMismatchDetected = false;
+			try
+			{
+				pMemManager2->getMemBuffer(BUFFER_SIZE);
+			}
+			catch (std::exception&)
+			{
+				bMismatchDetected = true;
+			}
+			Assert::IsTrue(bMismatchDetected);
+
+			delete pMemManager1;
+			delete pMemManager2;
+			delete pSharedManager;
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/vfa.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/features.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#define NUM_OUTPUTS 3
+#define NUM_STEPS 500
+#define SNAPSHOT_FREQ 50
+
+namespace MultiOutputVFATest
+{
+	//The swing-up pendulum with a tile-coding state feature map. Target functions are frozen, so that functions with
+	//frozen weights can be created
+	const char* experimentConfig = "<RLSimion><RLSimion><Log><Log-Eval-Episodes>false</Log-Eval-Episodes>"
+		"<Log-Training-Episodes>false</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+		"<World><Num-Integration-Steps>4</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+		"<Dynamic-Model><Model><Swing-up-pendulum/></Model></Dynamic-Model></World>"
+		"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>100</Num-Episodes><Episode-Length>10.0</Episode-Length>"
+		"</Experiment><SimGod><Gamma>0.9</Gamma>"
+		"<Freeze-Target-Function>true</Freeze-Target-Function><Target-Function-Update-Freq>7</Target-Function-Update-Freq>"
+		"<State-Feature-Map><Num-Features-Per-Dimension>10</Num-Features-Per-Dimension>"
+		"<Input-State><Input-State>angle</Input-State></Input-State>"
+		"<Input-State><Input-State>angular-velocity</Input-State></Input-State>"
+		"<Feature-Mapper><Type><Tile-Coding><Num-Tiles>4</Num-Tiles><Tile-Offset>0.05</Tile-Offset></Tile-Coding></Type>"
+		"</Feature-Mapper></State-Feature-Map></SimGod></RLSimion></RLSimion>";
+
+	const char* functionConfig = "<Function><Init-Value>0.1</Init-Value></Function>";
+
+	//NUM_OUTPUTS functions (the second one with saturated output) and one more whose weights can be frozen, created by
+	//an app whose memory manager is pMemManager. If bShared, they are given to LinearStateMultiVFA::shareWeights(): the
+	//first NUM_OUTPUTS become views of a multi-output function and the last one is left as it is
+	class Functions
+	{
+	public:
+		vector<LinearStateVFA*> functions;
+
+		Functions(SimionApp& app, MemManager<SimionMemPool>* pMemManager, bool bShared)
+		{
+			ConfigFile config;
+			config.Parse(functionConfig);
+			MemManager<SimionMemPool>* pAppMemManager = app.pMemManager;
+			app.pMemManager = pMemManager;
+			for (size_t i = 0; i <= NUM_OUTPUTS; ++i)
+				functions.push_back(new LinearStateVFA((ConfigNode*)config.FirstChildElement()));
+			app.pMemManager = pAppMemManager;
+
+			functions[1]->saturateOutput(-0.2, 0.3);
+			functions[NUM_OUTPUTS]->setCanUseDeferredUpdates(true);
+			if (bShared)
+				LinearStateMultiVFA::shareWeights(functions);
+			for (LinearStateVFA* pFunction : functions)
+				static_cast<DeferredLoad*>(pFunction)->deferredLoadStep();
+		}
+		~Functions()
+		{
+			for (LinearStateVFA* pFunction : functions)
+				delete pFunction;
+		}
+	};
+
+	void randomState(State* s, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<double> distribution(0.0, 1.0);
+		for (size_t i = 0; i < s->getNumVars(); ++i)
+			s->set(i, s->getProperties(i)->getMin() + distribution(generator) * s->getProperties(i)->getRangeWidth());
+	}
+
+	//The same updates are made to both sets of functions: every output is updated with the features of the same state
+	//(so the updates of the views are accumulated), some outputs are updated twice or with the features of another
+	//state, and weights are set directly now and then
+	void update(Functions& independent, Functions& shared, const State* s, const State* otherState, size_t step
+		, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<double> alpha(-0.5, 0.5);
+		FeatureList features("features"), otherFeatures("other-features");
+		independent.functions[0]->getFeatures(s, &features);
+		independent.functions[0]->getFeatures(otherState, &otherFeatures);
+
+		for (size_t i = 0; i < independent.functions.size(); ++i)
+		{
+			if ((step + i) % 5 == 0)
+				continue;
+			double value = alpha(generator);
+			const FeatureList* pFeatures = (step + i) % 7 == 0 ? &otherFeatures : &features;
+			independent.functions[i]->add(pFeatures, value);
+			shared.functions[i]->add(pFeatures, value);
+		}
+		if (step % 3 == 0)
+		{
+			double value = alpha(generator);
+			independent.functions[2]->add(&features, value);
+			shared.functions[2]->add(&features, value);
+		}
+		if (step % 37 == 0)
+		{
+			size_t feature = features.m_pFeatures[0].m_index;
+			double value = alpha(generator);
+			independent.functions[0]->set(feature, value);
+			shared.functions[0]->set(feature, value);
+		}
+	}
+
+	void checkSameOutputs(Functions& expected, Functions& actual, const State* s)
+	{
+		FeatureList expectedFeatures("expected-features"), actualFeatures("actual-features");
+		for (size_t i = 0; i < expected.functions.size(); ++i)
+		{
+			Assert::AreEqual(expected.functions[i]->get(s), actual.functions[i]->get(s));
+
+			expected.functions[i]->getFeatures(s, &expectedFeatures);
+			actual.functions[i]->getFeatures(s, &actualFeatures);
+			Assert::AreEqual(expectedFeatures.m_numFeatures, actualFeatures.m_numFeatures);
+			for (size_t j = 0; j < expectedFeatures.m_numFeatures; ++j)
+			{
+				Assert::AreEqual(expectedFeatures.m_pFeatures[j].m_index, actualFeatures.m_pFeatures[j].m_index);
+				Assert::AreEqual(expectedFeatures.m_pFeatures[j].m_factor, actualFeatures.m_pFeatures[j].m_factor);
+			}
+			//frozen weights of the last function, current weights of the rest
+			Assert::AreEqual(expected.functions[i]->get(&expectedFeatures, true), actual.functions[i]->get(&actualFeatures, true));
+		}
+	}
+
+	void checkSameWeights(Functions& expected, Functions& actual)
+	{
+		for (size_t i = 0; i < expected.functions.size(); ++i)
+		{
+			IMemBuffer* pExpectedWeights = expected.functions[i]->getWeights();
+			IMemBuffer* pActualWeights = actual.functions[i]->getWeights();
+			Assert::AreEqual(pExpectedWeights->getNumElements(), pActualWeights->getNumElements());
+			for (size_t j = 0; j < pExpectedWeights->getNumElements(); ++j)
+				Assert::AreEqual(pExpectedWeights->get(j), pActualWeights->get(j));
+		}
+	}
+
+	TEST_CLASS(UnitTest1)
+	{
+	public:
+
+		TEST_METHOD(MultiOutputVFA_SameAsIndependentFunctions)
+		{
+			ConfigFile configFile;
+			configFile.Parse(experimentConfig);
+			SimionApp app((ConfigNode*)configFile.FirstChildElement());
+
+			Functions independent(app, app.pMemManager, false);
+			Functions shared(app, app.pMemManager, true);
+			app.pMemManager->deferredLoadStep();
+
+			State* s = World::getDynamicModel()->getStateDescriptor().getInstance();
+			State* otherState = World::getDynamicModel()->getStateDescriptor().getInstance();
+			std::mt19937 generator(1);
+			app.pExperiment->nextEpisode();
+			for (size_t step = 0; step < NUM_STEPS; ++step)
+			{
+				app.pExperiment->nextStep();
+				randomState(s, generator);
+				randomState(otherState, generator);
+				checkSameOutputs(independent, shared, s);
+				update(independent, shared, s, otherState, step, generator);
+				//outputs calculated before the updates of the same state must not be used
+				checkSameOutputs(independent, shared, s);
+				checkSameOutputs(independent, shared, otherState);
+			}
+			checkSameWeights(independent, shared);
+			delete s;
+			delete otherState;
+		}
+
+		TEST_METHOD(MultiOutputVFA_CopyValues)
+		{
+			ConfigFile configFile;
+			configFile.Parse(experimentConfig);
+			SimionApp app((ConfigNode*)configFile.FirstChildElement());
+
+			//the functions of a parallel evaluator are created by another app in the same order (see ParallelEvaluator)
+			Functions independent(app, app.pMemManager, false);
+			Functions shared(app, app.pMemManager, true);
+			app.pMemManager->deferredLoadStep();
+			MemManager<SimionMemPool> evaluatorMemManager;
+			Functions evaluatorIndependent(app, &evaluatorMemManager, false);
+			Functions evaluatorShared(app, &evaluatorMemManager, true);
+			evaluatorMemManager.deferredLoadStep();
+
+			State* s = World::getDynamicModel()->getStateDescriptor().getInstance();
+			State* otherState = World::getDynamicModel()->getStateDescriptor().getInstance();
+			std::mt19937 generator(2);
+			app.pExperiment->nextEpisode();
+			for (size_t step = 0; step < NUM_STEPS; ++step)
+			{
+				app.pExperiment->nextStep();
+				randomState(s, generator);
+				randomState(otherState, generator);
+				update(independent, shared, s, otherState, step, generator);
+				if (step % SNAPSHOT_FREQ != 0)
+					continue;
+
+				//the outputs of the evaluator calculated before the snapshot must not be used after it. The updates of the
+				//multi-output functions not yet applied are part of the snapshot
+				evaluatorShared.functions[0]->get(s);
+				LinearStateMultiVFA::applyPendingUpdates(app.pMemManager);
+				evaluatorMemManager.copyValues(app.pMemManager);
+				checkSameOutputs(independent, evaluatorShared, s);
+				checkSameOutputs(independent, evaluatorIndependent, s);
+				checkSameWeights(independent, evaluatorShared);
+			}
+			delete s;
+			delete otherState;
+		}
+	};
+}
@@ -1,6 +1,10 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 #include "../../../3rd-party/FAST/FASTDimensionalPortal/FASTDimensionalPortalDLL.h"
+#include "../../../tools/System/SharedMemoryChannel.h"
+#include <thread>
+#include <vector>
+#include <string>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -31,5 +35,43 @@ namespace PortalDimensionLoadTest
 #endif
 		}
 
+		TEST_METHOD(SharedMemoryChannel_RoundTrip)
+		{
+			SharedMemoryChannelServer server;
+			Assert::IsTrue(server.openUniqueChannelServer("PortalTest"), L"Failed to create the shared memory channel");
+			std::string channelName = server.getFullName();
+
+			//the message is bigger than the ring buffer so that it has to wrap around several times
+			const int numValues = 3 * SHARED_MEMORY_RING_SIZE / sizeof(double) + 7;
+			const int numBytes = numValues * sizeof(double);
+			std::thread clientThread([&]()
+			{
+				SharedMemoryChannelClient client;
+				if (!client.connectToServer(channelName.c_str(), false))
+					return;
+				std::vector<double> values(numValues);
+				if (client.readToBuffer(values.data(), numBytes) == numBytes)
+					client.writeBuffer(values.data(), numBytes); //echo
+				client.closeConnection();
+			});
+
+			bool bConnected = server.waitForClientConnection(5000);
+			std::vector<double> sent(numValues), received(numValues);
+			for (int i = 0; i < numValues; ++i)
+				sent[i] = (double)i * 0.5;
+			int numBytesWritten = bConnected ? server.writeBuffer(sent.data(), numBytes) : 0;
+			int numBytesRead = bConnected ? server.readToBuffer(received.data(), numBytes) : 0;
+			clientThread.join();
+
+			Assert::IsTrue(bConnected, L"The client didn't connect");
+			Assert::AreEqual(numBytes, numBytesWritten);
+			Assert::AreEqual(numBytes, numBytesRead);
+			Assert::IsTrue(sent == received, L"The data received doesn't match the data sent");
+
+			//once the client has closed the connection, reads must return instead of blocking
+			double value;
+			Assert::AreEqual(0, server.readToBuffer(&value, sizeof(double)));
+			server.closeServer();
+		}
 	};
 }
\ No newline at end of file
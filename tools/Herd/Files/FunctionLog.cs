@@ -38,6 +38,7 @@ namespace Herd.Files
     //#define FUNCTION_DECLARATION_HEADER 5432
     //#define FUNCTION_LOG_FILE_HEADER 4321
     //#define FUNCTION_LOG_FILE_VERSION 1
+    //#define FUNCTION_LOG_FILE_VERSION_ENCODED 2
 
     //#define MAX_FUNCTION_ID_LENGTH 128
 
@@ -69,6 +70,13 @@ namespace Herd.Files
     //    __int64 id;
     //};
 
+    ////Version 2 files: every FunctionSampleHeader is followed by this header
+    //struct FunctionSampleEncodingHeader
+    //{
+    //    __int64 encoding;
+    //    double quantum;
+    //};
+
 
     public class FunctionSample
     {
@@ -108,6 +116,56 @@ public void ReadData(BinaryReader binaryReader, int sizeX, int sizeY)
                 m_functionData[i] = binaryReader.ReadDouble();
         }
 
+        /// <summary>
+        /// Reads the data of a sample in a version 2 file: the encoding header and the values. Delta-encoded values
+        /// are applied over the values of the previous sample of the same function
+        /// </summary>
+        public void ReadEncodedData(BinaryReader binaryReader, int sizeX, int sizeY, FunctionSample previousSample)
+        {
+            int encoding = (int)binaryReader.ReadInt64();
+            double quantum = binaryReader.ReadDouble();
+            int numValues = sizeX * sizeY;
+            int numBytes;
+
+            m_functionData = new double[numValues];
+            if (encoding != FunctionLog.SAMPLE_FULL_DOUBLE && encoding != FunctionLog.SAMPLE_FULL_FLOAT)
+            {
+                if (previousSample == null)
+                    throw new Exception("Delta-encoded function sample without a previous sample");
+                Array.Copy(previousSample.m_functionData, m_functionData, numValues);
+            }
+            switch (encoding)
+            {
+                case FunctionLog.SAMPLE_FULL_DOUBLE:
+                    for (int i = 0; i < numValues; ++i)
+                        m_functionData[i] = binaryReader.ReadDouble();
+                    numBytes = numValues * sizeof(double);
+                    break;
+                case FunctionLog.SAMPLE_FULL_FLOAT:
+                    for (int i = 0; i < numValues; ++i)
+                        m_functionData[i] = binaryReader.ReadSingle();
+                    numBytes = numValues * sizeof(float);
+                    break;
+                case FunctionLog.SAMPLE_DELTA_INT8:
+                    for (int i = 0; i < numValues; ++i)
+                        m_functionData[i] += (double)binaryReader.ReadSByte() * quantum;
+                    numBytes = numValues * sizeof(sbyte);
+                    break;
+                case FunctionLog.SAMPLE_DELTA_INT16:
+                    for (int i = 0; i < numValues; ++i)
+                        m_functionData[i] += (double)binaryReader.ReadInt16() * quantum;
+                    numBytes = numValues * sizeof(short);
+                    break;
+                case FunctionLog.SAMPLE_UNCHANGED:
+                    numBytes = 0;
+                    break;
+                default:
+                    throw new Exception("Unknown function sample encoding");
+            }
+            //values are padded to a multiple of 8 bytes
+            binaryReader.ReadBytes((8 - numBytes % 8) % 8);
+        }
+
         public void CalculateValueRange(int sizeX, int sizeY, ref double minValue, ref double maxValue)
         {
             for (int i = 0; i < sizeX * sizeY; ++i)
@@ -193,6 +251,13 @@ public class FunctionLog
         public const int DECLARATION_HEADER = 5432;
         public const int FILE_HEADER = 4321;
         public const int FILE_VERSION = 1;
+        public const int FILE_VERSION_ENCODED = 2;
+
+        public const int SAMPLE_FULL_DOUBLE = 0;
+        public const int SAMPLE_FULL_FLOAT = 1;
+        public const int SAMPLE_DELTA_INT8 = 2;
+        public const int SAMPLE_DELTA_INT16 = 3;
+        public const int SAMPLE_UNCHANGED = 4;
 
         public const int MAX_FUNCTION_ID_LENGTH = 128;
 
@@ -223,7 +288,7 @@ public void Load(string filename)
                     if (magicNumber != FILE_HEADER)
                         throw new Exception("Wrong magic number read in function log");
                     int fileVersion = (int)binaryReader.ReadInt64();
-                    if (fileVersion != FILE_VERSION)
+                    if (fileVersion != FILE_VERSION && fileVersion != FILE_VERSION_ENCODED)
                         throw new Exception("Wrong file version read in function log");
                     int numFunctions = (int)binaryReader.ReadInt64();
 
@@ -247,7 +312,13 @@ public void Load(string filename)
                             && function.NumSamplesY > 0 && function.NumSamplesZ == 1)
                         {
                             //Read the data of the sample and add it to the function
-                            sample.ReadData(binaryReader, function.NumSamplesX, function.NumSamplesY);
+                            if (fileVersion == FILE_VERSION_ENCODED)
+                            {
+                                FunctionSample previousSample = function.Samples.Count > 0 ? function.Samples[function.Samples.Count - 1] : null;
+                                sample.ReadEncodedData(binaryReader, function.NumSamplesX, function.NumSamplesY, previousSample);
+                            }
+                            else
+                                sample.ReadData(binaryReader, function.NumSamplesX, function.NumSamplesY);
                             function.Samples.Add(sample);
                         }
                     }
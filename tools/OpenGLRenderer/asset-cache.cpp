@@ -0,0 +1,141 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "stdafx.h"
+#include "asset-cache.h"
+#include <stdio.h>
+#include <random>
+
+namespace AssetCache
+{
+	const uint32_t MAGIC = 0x43415a53; //"SZAC"
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t type;
+		uint32_t reserved;
+		uint64_t contentHash;
+	};
+
+	uint64_t hashContents(const char* pData, size_t size)
+	{
+		//64-bit FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= (unsigned char)pData[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	string getCacheFilename(const string& assetFilename)
+	{
+		return assetFilename + ".asset-cache";
+	}
+}
+
+AssetCacheWriter::AssetCacheWriter(AssetCache::AssetType type, uint64_t contentHash)
+{
+	AssetCache::Header header = { AssetCache::MAGIC, AssetCache::VERSION, (uint32_t)type, 0, contentHash };
+	write(header);
+}
+
+void AssetCacheWriter::write(const void* pData, size_t numBytes)
+{
+	m_buffer.insert(m_buffer.end(), (const char*)pData, (const char*)pData + numBytes);
+}
+
+void AssetCacheWriter::writeString(const string& value)
+{
+	write((uint32_t)value.size());
+	write(value.data(), value.size());
+	//padded so that the arrays that follow are aligned
+	const char padding[4] = {};
+	write(padding, (4 - value.size() % 4) % 4);
+}
+
+bool AssetCacheWriter::save(const string& filename)
+{
+	//the temporary name must be unique among all the threads and processes that may be writing the same file
+	random_device randomDevice;
+	string tempFilename = filename + "." + to_string(randomDevice()) + ".tmp";
+
+	FILE* pFile = fopen(tempFilename.c_str(), "wb");
+	if (!pFile)
+		return false;
+	bool bWritten = fwrite(m_buffer.data(), 1, m_buffer.size(), pFile) == m_buffer.size();
+	bWritten = (fclose(pFile) == 0) && bWritten;
+
+	//rename() doesn't replace existing files under Windows
+	remove(filename.c_str());
+	if (!bWritten || rename(tempFilename.c_str(), filename.c_str()) != 0)
+	{
+		remove(tempFilename.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool AssetCacheReader::open(const string& filename, AssetCache::AssetType type, uint64_t contentHash)
+{
+	m_offset = 0;
+	m_bError = false;
+	if (!m_file.open(filename.c_str()))
+		return false;
+
+	AssetCache::Header header = read<AssetCache::Header>();
+	if (m_bError || header.magic != AssetCache::MAGIC || header.version != AssetCache::VERSION
+		|| header.type != (uint32_t)type || header.contentHash != contentHash)
+	{
+		m_file.close();
+		return false;
+	}
+	return true;
+}
+
+const char* AssetCacheReader::read(size_t numBytes)
+{
+	if (m_bError || numBytes > m_file.size() - m_offset)
+	{
+		m_bError = true;
+		return nullptr;
+	}
+	const char* pData = m_file.data() + m_offset;
+	m_offset += numBytes;
+	return pData;
+}
+
+string AssetCacheReader::readString()
+{
+	uint32_t length = read<uint32_t>();
+	const char* pData = read(length);
+	read((4 - length % 4) % 4);
+	if (!pData || m_bError)
+		return string();
+	return string(pData, length);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../System/MemoryMappedFile.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+using namespace std;
+
+//Binary cache of the assets loaded by the renderer: Collada models already converted to meshes and decoded textures.
+//Each asset has its own cache file next to it (<asset>.asset-cache) that stores the hash of the contents of the asset
+//it was built from, so it's rebuilt whenever the asset changes. Cache files are memory-mapped when they are read.
+//If a cache file can't be written (i.e., a read-only folder), assets are simply loaded from their source every time
+namespace AssetCache
+{
+	//the version must be increased whenever the format of any cache file changes
+	const uint32_t VERSION = 1;
+	enum class AssetType : uint32_t { ColladaModel = 1, Texture = 2 };
+
+	uint64_t hashContents(const char* pData, size_t size);
+	string getCacheFilename(const string& assetFilename);
+}
+
+class AssetCacheWriter
+{
+	vector<char> m_buffer;
+public:
+	AssetCacheWriter(AssetCache::AssetType type, uint64_t contentHash);
+
+	void write(const void* pData, size_t numBytes);
+	template <typename T>
+	void write(const T& value) { write(&value, sizeof(T)); }
+	//Values are written as they are in memory. Arrays of 4-byte values are read in place, so strings are padded to
+	//keep them aligned
+	void writeString(const string& value);
+
+	//The file is written under a temporary name and then renamed, so that other processes (or experiments running in
+	//parallel) never read an incomplete cache file. Returns false if it couldn't be written
+	bool save(const string& filename);
+};
+
+class AssetCacheReader
+{
+	MemoryMappedFile m_file;
+	size_t m_offset = 0;
+	bool m_bError = false;
+public:
+	//Returns false if the file doesn't exist or it wasn't built from an asset of this type with these contents
+	bool open(const string& filename, AssetCache::AssetType type, uint64_t contentHash);
+
+	//The data read points into the mapped file. Reading past the end of the file sets the error flag and returns zeros/nullptr, so that a corrupt cache file can
+	//be detected with bError() once it has been read
+	const char* read(size_t numBytes);
+	template <typename T>
+	T read()
+	{
+		T value = T();
+		const char* pData = read(sizeof(T));
+		if (pData)
+			memcpy(&value, pData, sizeof(T));
+		return value;
+	}
+	string readString();
+
+	bool bError() const { return m_bError; }
+	//the whole file must have been read
+	bool bComplete() const { return !m_bError && m_offset == m_file.size(); }
+};
@@ -70,16 +70,16 @@ void Sprite2D::draw()
 	if (m_pMaterial)
 		m_pMaterial->set();
 
-	glBegin(GL_QUADS);
-	glTexCoord2d(0.0, 1.0);
-	glVertex2d(m_minCoord.x(), m_minCoord.y());
-	glTexCoord2d(1.0, 1.0);
-	glVertex2d(m_maxCoord.x(), m_minCoord.y());
-	glTexCoord2d(1.0, 0.0);
-	glVertex2d(m_maxCoord.x(), m_maxCoord.y());
-	glTexCoord2d(0.0, 0.0);
-	glVertex2d(m_minCoord.x(), m_maxCoord.y());
-	glEnd();
+	const float texCoords[] = { 0.f, 1.f, 1.f, 1.f, 1.f, 0.f, 0.f, 0.f };
+	const float vertices[] = { (float)m_minCoord.x(), (float)m_minCoord.y(), (float)m_maxCoord.x(), (float)m_minCoord.y()
+		, (float)m_maxCoord.x(), (float)m_maxCoord.y(), (float)m_minCoord.x(), (float)m_maxCoord.y() };
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, vertices);
+	glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
+	glDrawArrays(GL_QUADS, 0, 4);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
 
 	drawChildren();
 }
@@ -108,24 +108,28 @@ void Meter2D::draw()
 	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_LIGHTING);
 	glDisable(GL_BLEND);
+	//the frame and the bar are drawn with a single call each
+	const float frameVertices[] = { 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 0.f };
+	glEnableClientState(GL_VERTEX_ARRAY);
 	glColor3f(0.0, 0.0, 0.0);
-	glBegin(GL_LINE_STRIP);
-		glVertex2d(0.0, 0.0);
-		glVertex2d(0.0, 1.0);
-		glVertex2d(1.0, 1.0);
-		glVertex2d(1.0, 0.0);
-		glVertex2d(0.0, 0.0);
-	glEnd();
-
-	glBegin(GL_QUADS);
-		glColor3fv(m_startColor.rgba());
-		glVertex2d(0.0, 0.0);
-		glColor3fv(m_valueColor.rgba());
-		glVertex2d(normValue, 0.0);
-		glVertex2d(normValue, 1.0);
-		glColor3fv(m_startColor.rgba());
-		glVertex2d(0.0, 1.0);
-	glEnd();
+	glVertexPointer(2, GL_FLOAT, 0, frameVertices);
+	glDrawArrays(GL_LINE_LOOP, 0, 4);
+
+	const float barVertices[] = { 0.f, 0.f, (float)normValue, 0.f, (float)normValue, 1.f, 0.f, 1.f };
+	float barColors[4 * 3];
+	const float* pStartColor = m_startColor.rgba();
+	const float* pValueColor = m_valueColor.rgba();
+	for (int i = 0; i < 3; ++i)
+	{
+		barColors[i] = barColors[9 + i] = pStartColor[i];
+		barColors[3 + i] = barColors[6 + i] = pValueColor[i];
+	}
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, barVertices);
+	glColorPointer(3, GL_FLOAT, 0, barColors);
+	glDrawArrays(GL_QUADS, 0, 4);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
 
 	drawChildren();
 }
@@ -177,6 +181,9 @@ FunctionViewer2D::FunctionViewer2D(string name, Vector2D origin, Vector2D size,
 	:FunctionViewer(name, origin, size, depth, new LineMaterial())
 {
 	m_lastValues = vector<double>(pixelRes);
+	m_lineVertices = vector<float>(2 * pixelRes);
+	for (unsigned int i = 0; i < pixelRes; ++i)
+		m_lineVertices[2 * i] = pixelRes > 1 ? (float)i / (float)(pixelRes - 1) : 0.f;
 }
 
 FunctionViewer2D::~FunctionViewer2D()
@@ -201,18 +208,18 @@ void FunctionViewer2D::update(const vector<double>& pBuffer)
 		invValueRange = 1.0 / 0.02;
 	}
 
-	for (size_t i = 0; i < pBuffer.size(); ++i)
+	for (size_t i = 0; i < pBuffer.size() && i < m_lastValues.size(); ++i)
 	{
 		m_lastValues[i] = (pBuffer[i] - minValue) * invValueRange;
+		m_lineVertices[2 * i + 1] = (float)m_lastValues[i];
 	}
 }
 
 void FunctionViewer2D::draw()
 {
-	glBegin(GL_LINE_STRIP);
-	for (size_t i = 0; i < m_lastValues.size(); ++i)
-	{
-		glVertex2d(((double)i) / (double)(m_lastValues.size() - 1) , m_lastValues[i]);
-	}
-	glEnd();
+	//the line is only rebuilt when the function is updated, and drawn with a single call
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, m_lineVertices.data());
+	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)(m_lineVertices.size() / 2));
+	glDisableClientState(GL_VERTEX_ARRAY);
 }
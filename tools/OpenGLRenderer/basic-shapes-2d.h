@@ -34,6 +34,7 @@ public:
 class FunctionViewer2D : public FunctionViewer
 {
 	vector<double> m_lastValues;
+	vector<float> m_lineVertices; //x,y of each point of the line
 public:
 	FunctionViewer2D(string name, Vector2D origin, Vector2D size, unsigned int pixelRes, double depth = 0);
 	virtual ~FunctionViewer2D();
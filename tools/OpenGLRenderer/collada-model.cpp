@@ -32,6 +32,7 @@
 #include "mesh.h"
 #include "../GeometryLib/bounding-cylinder.h"
 #include <algorithm>
+#include "asset-cache.h"
 #include "../System/FileUtils.h"
 
 
@@ -274,7 +275,8 @@ Mesh* ColladaModel::loadMesh(tinyxml2::XMLElement* pRoot, tinyxml2::XMLElement*
 
 	if (numParsedIndices<pMesh->getNumIndices())
 		pMesh->setNumIndices(numParsedIndices);
-	
+
+	pMesh->interleaveVertices();
 	return pMesh;
 }
 
@@ -609,12 +611,26 @@ void ColladaModel::loadSkin(tinyxml2::XMLElement* pRootNode)
 
 void ColladaModel::loadFromFile(const char* file)
 {
-	tinyxml2::XMLDocument doc;
-
 	string path = Renderer::get()->getDataFolder() + string(file);
 
 	Renderer::get()->logMessage("Opening Collada file" + path);
-	doc.LoadFile(path.c_str());
+	//the contents are hashed to validate the cached meshes, and parsed from memory if they have to be loaded again
+	MemoryMappedFile colladaFile;
+	if (!colladaFile.open(path.c_str()))
+	{
+		Renderer::get()->logMessage("ERROR: Cound not open Collada file");
+		return;
+	}
+	uint64_t contentHash = AssetCache::hashContents(colladaFile.data(), colladaFile.size());
+	string cacheFile = AssetCache::getCacheFilename(path);
+	if (loadFromCache(cacheFile, contentHash))
+	{
+		Renderer::get()->logMessage("Loaded from the asset cache");
+		return;
+	}
+
+	tinyxml2::XMLDocument doc;
+	doc.Parse(colladaFile.data(), colladaFile.size());
 	if (doc.Error() == tinyxml2::XML_SUCCESS)
 	{
 		Renderer::get()->logMessage("File found. Parsing");
@@ -625,10 +641,124 @@ void ColladaModel::loadFromFile(const char* file)
 		//some collada files link the geometry only via the controller's skin
 		//this is yet one more shortcut to get the geometry loaded
 		loadSkin(pColladaRoot);
+
+		saveToCache(cacheFile, contentHash);
 	}
 	else Renderer::get()->logMessage("ERROR: Cound not open Collada file");
 }
 
+//Cached Collada model: the number of meshes and, for each of them:
+// - flags (uint32): has normals (bit 0), has texture coordinates (bit 1), has material (bit 2)
+// - the material (if any): ambient, diffuse, specular and emission colors (4 floats each), shininess (double) and
+//   texture file (string, empty if none)
+// - the interleaved vertices (uint32 count followed by the floats) and their indices (uint32 count and values)
+void ColladaModel::saveToCache(const string& cacheFile, uint64_t contentHash)
+{
+	AssetCacheWriter writer(AssetCache::AssetType::ColladaModel, contentHash);
+	writer.write((uint32_t)m_meshes.size());
+	for (Mesh* pMesh : m_meshes)
+	{
+		//materials loaded from Collada files are always SimpleTLMaterial
+		SimpleTLMaterial* pMaterial = dynamic_cast<SimpleTLMaterial*>(pMesh->getMaterial());
+		if (pMesh->getMaterial() != nullptr && pMaterial == nullptr)
+			return;
+
+		writer.write((uint32_t)((pMesh->hasNormals() ? 1 : 0) | (pMesh->hasTexCoords() ? 2 : 0) | (pMaterial ? 4 : 0)));
+		if (pMaterial)
+		{
+			Color colors[] = { pMaterial->getAmbient(), pMaterial->getDiffuse(), pMaterial->getSpecular()
+				, pMaterial->getEmission() };
+			for (Color& color : colors)
+				writer.write(color.rgba(), 4 * sizeof(float));
+			writer.write(pMaterial->getShininess());
+			auto textureFile = m_textureFiles.find(pMaterial->getTexture());
+			writer.writeString(textureFile != m_textureFiles.end() ? textureFile->second : string());
+		}
+
+		const vector<float>& vertices = pMesh->getInterleavedVertices();
+		const vector<unsigned int>& indices = pMesh->getInterleavedIndices();
+		writer.write((uint32_t)vertices.size());
+		writer.write(vertices.data(), vertices.size() * sizeof(float));
+		writer.write((uint32_t)indices.size());
+		writer.write(indices.data(), indices.size() * sizeof(unsigned int));
+	}
+	if (!writer.save(cacheFile))
+		Renderer::get()->logMessage("Couldn't save the model to the asset cache: " + cacheFile);
+}
+
+SimpleTLMaterial* ColladaModel::loadMaterialFromCache(AssetCacheReader& reader)
+{
+	SimpleTLMaterial* pMaterial = new SimpleTLMaterial();
+	Color colors[4];
+	for (Color& color : colors)
+	{
+		const char* pRGBA = reader.read(4 * sizeof(float));
+		if (pRGBA)
+			memcpy(color.rgba(), pRGBA, 4 * sizeof(float));
+	}
+	pMaterial->setAmbient(colors[0]);
+	pMaterial->setDiffuse(colors[1]);
+	pMaterial->setSpecular(colors[2]);
+	pMaterial->setEmission(colors[3]);
+	pMaterial->setShininess(reader.read<double>());
+	string textureFile = reader.readString();
+	if (!textureFile.empty() && !reader.bError())
+	{
+		int textureId = (int)Renderer::get()->getTextureManager()->loadTexture(textureFile);
+		m_textureFiles[textureId] = textureFile;
+		pMaterial->setTexture(textureId);
+	}
+	return pMaterial;
+}
+
+bool ColladaModel::loadFromCache(const string& cacheFile, uint64_t contentHash)
+{
+	AssetCacheReader reader;
+	if (!reader.open(cacheFile, AssetCache::AssetType::ColladaModel, contentHash))
+		return false;
+
+	//the cache is only used if it can be read completely
+	vector<Mesh*> meshes;
+	bool bCorrupt = false;
+	uint32_t numMeshes = reader.read<uint32_t>();
+	for (uint32_t i = 0; i < numMeshes && !bCorrupt; ++i)
+	{
+		uint32_t flags = reader.read<uint32_t>();
+		bool bNormals = (flags & 1) != 0;
+		bool bTexCoords = (flags & 2) != 0;
+		bool bMaterial = (flags & 4) != 0;
+		Mesh* pMesh = new Mesh();
+		meshes.push_back(pMesh);
+		if (bMaterial)
+			pMesh->setMaterial(loadMaterialFromCache(reader));
+
+		unsigned int stride = 3 + (bNormals ? 3 : 0) + (bTexCoords ? 2 : 0);
+		uint32_t numFloats = reader.read<uint32_t>();
+		const float* pVertices = (const float*)reader.read(numFloats * sizeof(float));
+		uint32_t numIndices = reader.read<uint32_t>();
+		const unsigned int* pIndices = (const unsigned int*)reader.read(numIndices * sizeof(unsigned int));
+		bCorrupt = reader.bError() || numFloats % stride != 0;
+		//the indices must reference existing vertices
+		unsigned int numVertices = numFloats / stride;
+		for (uint32_t index = 0; index < numIndices && !bCorrupt; ++index)
+			bCorrupt = pIndices[index] >= numVertices;
+		if (!bCorrupt)
+			pMesh->setInterleavedVertices(bNormals, bTexCoords, pVertices, numVertices, pIndices, numIndices);
+	}
+
+	if (bCorrupt || !reader.bComplete())
+	{
+		Renderer::get()->logMessage("The asset cache is corrupt: " + cacheFile);
+		for (Mesh* pMesh : meshes)
+			delete pMesh;
+		m_textureFiles.clear();
+		return false;
+	}
+	for (Mesh* pMesh : meshes)
+		addMesh(pMesh);
+	return true;
+}
+
 const char* ColladaModel::findTexture(tinyxml2::XMLElement* pRootNode, string textureName)
 {
 	static string imageFile;
@@ -702,6 +832,7 @@ int ColladaModel::loadTexture(tinyxml2::XMLElement* pRootNode, tinyxml2::XMLElem
 	if (imageFile != nullptr)
 	{
 		textureId = Renderer::get()->getTextureManager()->loadTexture(imageFile);
+		m_textureFiles[(int)textureId] = imageFile;
 		return (int)textureId;
 	}
 
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <stdint.h>
 
 namespace tinyxml2 { class XMLElement; }
 class ColladaModel;
@@ -11,6 +12,7 @@ class Geometry;
 class Source;
 class SimpleTLMaterial;
 class Mesh;
+class AssetCacheReader;
 
 using namespace std;
 
@@ -88,8 +90,14 @@ public:
 class ColladaModel: public GraphicObject3D
 {
 	string m_path;
+	//the texture files loaded by the materials (texture id -> file), needed to save them in the asset cache
+	map<int, string> m_textureFiles;
 
 	void loadFromFile(const char* file);
+	//the meshes loaded from the file and their materials are saved to/loaded from the asset cache
+	bool loadFromCache(const string& cacheFile, uint64_t contentHash);
+	void saveToCache(const string& cacheFile, uint64_t contentHash);
+	SimpleTLMaterial* loadMaterialFromCache(AssetCacheReader& reader);
 
 	const char* findMaterialFxName(tinyxml2::XMLElement* pRootNode, string fxMaterial);
 	int loadTexture(tinyxml2::XMLElement* pRootNode, tinyxml2::XMLElement* pFxProfile, string textureName);
@@ -68,6 +68,12 @@ public:
 	void setEmission(Color color) { m_emission = color; }
 	void setShininess(double value) { m_shininess = value; }
 	void setTextureWrapMode(int mode) { m_textureWrapModeS = mode; m_textureWrapModeT = mode; }
+	int getTexture() const { return m_textureId; }
+	Color getAmbient() const { return m_ambient; }
+	Color getDiffuse() const { return m_diffuse; }
+	Color getSpecular() const { return m_specular; }
+	Color getEmission() const { return m_emission; }
+	double getShininess() const { return m_shininess; }
 	virtual void set();
 };
 
@@ -29,6 +29,8 @@
 #include "xml-load.h"
 #include "material.h"
 #include <algorithm>
+#include <map>
+#include <tuple>
 
 Mesh::Mesh()
 {
@@ -51,32 +53,155 @@ Mesh::~Mesh()
 		delete[] m_pIndices;
 	if (m_pMaterial != nullptr)
 		delete m_pMaterial;
+	if (m_vertexBuffer != 0)
+		glDeleteBuffers(1, &m_vertexBuffer);
+	if (m_indexBuffer != 0)
+		glDeleteBuffers(1, &m_indexBuffer);
 }
 
 
-void Mesh::draw()
+void Mesh::interleaveVertices()
 {
-	if (m_pMaterial)
-		m_pMaterial->set();
+	m_interleavedVertices.clear();
+	m_interleavedIndices.clear();
+	m_vertexStride = 3 + (m_pNormals ? 3 : 0) + (m_pTexCoords ? 2 : 0);
 
-	glBegin(m_primitiveType);
-
-	for (unsigned int i = 0; i<m_numIndices; i+=m_numIndicesPerVertex)
+	//each different combination of position, normal and texture coordinates becomes a vertex
+	map<tuple<unsigned int, unsigned int, unsigned int>, unsigned int> vertices;
+	for (unsigned int i = 0; i + m_numIndicesPerVertex <= m_numIndices; i += m_numIndicesPerVertex)
 	{
-		if (m_pNormals)
+		unsigned int posIndex = m_pIndices[i + m_posOffset];
+		unsigned int normalIndex = m_pNormals ? m_pIndices[i + m_normalOffset] : 0;
+		unsigned int texCoordIndex = m_pTexCoords ? m_pIndices[i + m_texCoordOffset] : 0;
+
+		auto vertex = vertices.insert(make_pair(make_tuple(posIndex, normalIndex, texCoordIndex)
+			, (unsigned int)vertices.size()));
+		if (vertex.second)
 		{
-			int normalIndex = m_pIndices[i + m_normalOffset];
-			glNormal3d(m_pNormals[normalIndex].x(), m_pNormals[normalIndex].y(), m_pNormals[normalIndex].z());
+			m_interleavedVertices.push_back((float)m_pPositions[posIndex].x());
+			m_interleavedVertices.push_back((float)m_pPositions[posIndex].y());
+			m_interleavedVertices.push_back((float)m_pPositions[posIndex].z());
+			if (m_pNormals)
+			{
+				m_interleavedVertices.push_back((float)m_pNormals[normalIndex].x());
+				m_interleavedVertices.push_back((float)m_pNormals[normalIndex].y());
+				m_interleavedVertices.push_back((float)m_pNormals[normalIndex].z());
+			}
+			if (m_pTexCoords)
+			{
+				m_interleavedVertices.push_back((float)m_pTexCoords[texCoordIndex].s());
+				m_interleavedVertices.push_back((float)m_pTexCoords[texCoordIndex].t());
+			}
 		}
-		if (m_pTexCoords)
+		m_interleavedIndices.push_back(vertex.first->second);
+	}
+	m_bInterleaved = true;
+	m_bBuffersUploaded = false;
+}
+
+void Mesh::setInterleavedVertices(bool bNormals, bool bTexCoords, const float* pVertices, unsigned int numVertices
+	, const unsigned int* pIndices, unsigned int numIndices)
+{
+	unsigned int stride = 3 + (bNormals ? 3 : 0) + (bTexCoords ? 2 : 0);
+	allocPositions(numVertices);
+	if (bNormals)
+		allocNormals(numVertices);
+	if (bTexCoords)
+		allocTexCoords(numVertices);
+	for (unsigned int i = 0; i < numVertices; ++i)
+	{
+		const float* pVertex = pVertices + i * stride;
+		m_pPositions[i] = Point3D(pVertex[0], pVertex[1], pVertex[2]);
+		pVertex += 3;
+		if (bNormals)
 		{
-			int texCoordIndex = m_pIndices[i + m_texCoordOffset];
-			glTexCoord2d(m_pTexCoords[texCoordIndex].s(), m_pTexCoords[texCoordIndex].t());
+			m_pNormals[i] = Vector3D(pVertex[0], pVertex[1], pVertex[2]);
+			pVertex += 3;
 		}
-		int posIndex = m_pIndices[i + m_posOffset];
-		glVertex3d(m_pPositions[posIndex].x(), m_pPositions[posIndex].y(), m_pPositions[posIndex].z());
+		if (bTexCoords)
+			m_pTexCoords[i] = Vector2D(pVertex[0], pVertex[1]);
+	}
+	allocIndices(numIndices);
+	memcpy(m_pIndices, pIndices, numIndices * sizeof(unsigned int));
+	m_numIndicesPerVertex = 1;
+	m_posOffset = m_normalOffset = m_texCoordOffset = 0;
+
+	m_interleavedVertices.assign(pVertices, pVertices + (size_t)numVertices * stride);
+	m_interleavedIndices.assign(pIndices, pIndices + numIndices);
+	m_vertexStride = stride;
+	m_bInterleaved = true;
+	m_bBuffersUploaded = false;
+}
+
+void Mesh::uploadBuffers()
+{
+	//buffer objects are core since OpenGL 1.5. Without them, the vertices are drawn from client memory
+	if (glGenBuffers != nullptr)
+	{
+		if (m_vertexBuffer == 0)
+			glGenBuffers(1, &m_vertexBuffer);
+		if (m_indexBuffer == 0)
+			glGenBuffers(1, &m_indexBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, m_interleavedVertices.size() * sizeof(float), m_interleavedVertices.data()
+			, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_interleavedIndices.size() * sizeof(unsigned int)
+			, m_interleavedIndices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	m_bBuffersUploaded = true;
+}
+
+void Mesh::draw()
+{
+	if (!m_bInterleaved)
+		interleaveVertices();
+	if (!m_bBuffersUploaded)
+		uploadBuffers();
+	if (m_interleavedIndices.empty())
+		return;
+
+	if (m_pMaterial)
+		m_pMaterial->set();
+
+	//with buffer objects bound, pointers are offsets into them
+	const float* pVertices = m_interleavedVertices.data();
+	const unsigned int* pIndices = m_interleavedIndices.data();
+	if (m_vertexBuffer != 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+		pVertices = nullptr;
+		pIndices = nullptr;
+	}
+	GLsizei stride = m_vertexStride * sizeof(float);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, stride, pVertices);
+	unsigned int offset = 3;
+	if (m_pNormals)
+	{
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(GL_FLOAT, stride, pVertices + offset);
+		offset += 3;
+	}
+	if (m_pTexCoords)
+	{
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, stride, pVertices + offset);
+	}
+
+	glDrawElements(m_primitiveType, (GLsizei)m_interleavedIndices.size(), GL_UNSIGNED_INT, pIndices);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (m_vertexBuffer != 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
-	glEnd();
 }
 
 void Mesh::updateBoundingBox(BoundingBox3D& bb)
@@ -93,6 +218,7 @@ void Mesh::transformVertices(Vector3D& translation, Vector3D& scale)
 		m_pPositions[i] += translation;
 		m_pPositions[i] *= scale;
 	}
+	m_bInterleaved = false;
 }
 
 void Mesh::flipYZAxis()
@@ -112,12 +238,14 @@ void Mesh::flipYZAxis()
 		m_pNormals[i].setZ(-m_pNormals[i].y());
 		m_pNormals[i].setY(tmp);
 	}
+	m_bInterleaved = false;
 }
 
 void Mesh::flipVTexCoord()
 {
 	for (unsigned int i = 0; i < m_numTexCoords; ++i)
 		m_pTexCoords[i].setY(1.0 - m_pTexCoords[i].t());
+	m_bInterleaved = false;
 }
 
 void Mesh::reorderIndices()
@@ -129,4 +257,5 @@ void Mesh::reorderIndices()
 		m_pIndices[i*m_numIndicesPerVertex + m_posOffset] = m_pIndices[(i+2)*m_numIndicesPerVertex + m_posOffset];
 		m_pIndices[(i + 2)*m_numIndicesPerVertex + m_posOffset] = tmp;
 	}
+	m_bInterleaved = false;
 }
\ No newline at end of file
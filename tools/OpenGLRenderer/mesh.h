@@ -9,6 +9,7 @@ class ColladaModel;
 class Geometry;
 namespace tinyxml2 { class XMLElement; }
 #include <string>
+#include <vector>
 using namespace std;
 
 
@@ -35,13 +36,39 @@ class Mesh
 	//material
 	Material* m_pMaterial = 0;
 
+	//Vertices de-indexed and interleaved (position, normal if any, texture coordinates if any) with their own indices,
+	//so that the mesh is drawn with a single call. They are uploaded to buffer objects in the first draw() if the
+	//driver supports them, or drawn from client memory otherwise
+	vector<float> m_interleavedVertices;
+	vector<unsigned int> m_interleavedIndices;
+	unsigned int m_vertexStride = 0; //in floats
+	bool m_bInterleaved = false;
+	unsigned int m_vertexBuffer = 0;
+	unsigned int m_indexBuffer = 0;
+	bool m_bBuffersUploaded = false;
+	void uploadBuffers();
+
 public:
 	Mesh();
 	~Mesh();
 
 	void draw();
 
+	//Builds the interleaved vertices from the current attributes and indices. Called by the loaders once the mesh is
+	//complete, and by draw() if the attributes have changed since (see transformVertices(), flipYZAxis()...)
+	void interleaveVertices();
+
+	//Sets the mesh from vertices already interleaved by interleaveVertices() (i.e., from the asset cache). Each vertex
+	//gets its own position, normal and texture coordinates, so the mesh can still be transformed
+	void setInterleavedVertices(bool bNormals, bool bTexCoords, const float* pVertices, unsigned int numVertices
+		, const unsigned int* pIndices, unsigned int numIndices);
+	const vector<float>& getInterleavedVertices() { if (!m_bInterleaved) interleaveVertices(); return m_interleavedVertices; }
+	const vector<unsigned int>& getInterleavedIndices() { if (!m_bInterleaved) interleaveVertices(); return m_interleavedIndices; }
+	bool hasNormals() const { return m_pNormals != nullptr; }
+	bool hasTexCoords() const { return m_pTexCoords != nullptr; }
+
 	void setMaterial(Material* pMaterial) { m_pMaterial = pMaterial; }
+	Material* getMaterial() { return m_pMaterial; }
 	void updateBoundingBox(BoundingBox3D& bb);
 	void transformVertices(Vector3D& translation, Vector3D& scale);
 
@@ -66,7 +93,7 @@ public:
 	void setTexCoordOffset(unsigned int offset) { m_texCoordOffset = offset; }
 	void setNumIndicesPerVertex(unsigned int numIndices) { m_numIndicesPerVertex = numIndices; }
 	unsigned int* getIndexArray() { return m_pIndices; }
-	void setNumIndices(unsigned int actualNum) { if (actualNum < m_numIndices) m_numIndices = actualNum; }
+	void setNumIndices(unsigned int actualNum) { if (actualNum < m_numIndices) m_numIndices = actualNum; m_bInterleaved = false; }
 	int getNumIndices() const { return m_numIndices; }
 
 	void flipYZAxis();
@@ -0,0 +1,50 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "stdafx.h"
+#include "offscreen-context.h"
+#include <stdexcept>
+
+//Windows: there is always a display, so we create a hidden window and use its context
+OffscreenContext::OffscreenContext()
+{
+	char arguments[] = "RLSimion";
+	char* argv = arguments;
+	int argc = 1;
+	if (!glutGet(GLUT_INIT_STATE))
+		glutInit(&argc, &argv);
+	glutInitDisplayMode(GLUT_RGB | GLUT_DEPTH);
+	glutInitWindowSize(1, 1);
+	m_window = glutCreateWindow(argv);
+	if (m_window <= 0)
+		throw std::runtime_error("Couldn't create the window of the offscreen OpenGL context");
+	glutHideWindow();
+}
+
+OffscreenContext::~OffscreenContext()
+{
+	if (m_window > 0)
+		glutDestroyWindow(m_window);
+}
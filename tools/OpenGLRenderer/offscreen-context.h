@@ -0,0 +1,16 @@
+#pragma once
+
+//An OpenGL context that isn't tied to a window, so that scenes can be rendered on machines without a display (i.e.,
+//headless nodes) into a framebuffer object (see Renderer::initOffscreen()). Under Linux, it is created with EGL, which
+//Mesa implements without any display server (llvmpipe if there is no GPU). Under Windows, the context of a hidden
+//window is used. The context is made current to the calling thread
+class OffscreenContext
+{
+	void* m_pDisplay = nullptr;
+	void* m_pContext = nullptr;
+	int m_window = 0;
+public:
+	//throws an exception if the context can't be created
+	OffscreenContext();
+	virtual ~OffscreenContext();
+};
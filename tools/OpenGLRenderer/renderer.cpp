@@ -32,14 +32,16 @@
 #include "camera.h"
 #include "light.h"
 #include "xml-load.h"
+#include "offscreen-context.h"
 #include "../GeometryLib/bounding-box.h"
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 using namespace tinyxml2;
 using namespace std;
 
-Renderer* Renderer::m_pInstance = 0;
+thread_local Renderer* Renderer::m_pInstance = 0;
 
 Renderer::Renderer()
 {
@@ -66,6 +68,13 @@ Renderer::~Renderer()
 	for (auto viewport : m_viewPorts) delete viewport;
 	logMessage("Renderer::~Renderer(): texture manager");
 	delete m_pTextureManager;
+	if (m_pOffscreenContext)
+	{
+		glDeleteFramebuffers(1, &m_frameBuffer);
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		delete m_pOffscreenContext;
+	}
 	m_pInstance = nullptr;
 }
 
@@ -97,20 +106,56 @@ void Renderer::init(int argc, char** argv, int screenWidth, int screenHeight)
 	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
 	glutInitWindowSize(screenWidth, screenHeight);
 	glutCreateWindow(argv[0]);
+	//entry points of the extensions and versions above 1.1 (buffer objects...). Meshes are drawn from client memory
+	//if they are not available
+	if (glewInit() != GLEW_OK)
+		printf("Warning: GLEW couldn't be initialized\n");
+
+	//callback functions
+	glutDisplayFunc(_drawViewPorts);
+	glutReshapeFunc(_reshapeWindow);
 
+	initGLState(screenWidth, screenHeight);
+}
+
+void Renderer::initOffscreen(int sizeX, int sizeY)
+{
+	m_pOffscreenContext = new OffscreenContext();
+	if (glewInit() != GLEW_OK || glGenFramebuffers == nullptr || glGenRenderbuffers == nullptr)
+		throw std::runtime_error("Offscreen rendering requires framebuffer objects (OpenGL 3.0)");
+
+	//color and depth buffers of the frames
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, sizeX, sizeY);
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, sizeX, sizeY);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_frameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		throw std::runtime_error("The offscreen framebuffer is incomplete");
+	glDrawBuffer(GL_COLOR_ATTACHMENT0);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+	initGLState(sizeX, sizeY);
+}
+
+void Renderer::initGLState(int sizeX, int sizeY)
+{
 	//set the size of the window before creating the viewport
-	m_windowWidth = screenWidth;
-	m_windowHeight = screenHeight;
+	m_windowWidth = sizeX;
+	m_windowHeight = sizeY;
 
 	//create the default viewport that covers the whole screen (normalized coordinates are used)
 	//this default viewport can be resized (by the user) if more viewports are to be used
 	m_pDefaultViewPort = new ViewPort(0, 0, 1.0, 1.0);
 	m_viewPorts.push_back(m_pDefaultViewPort);
 
-	//callback functions
-	glutDisplayFunc(_drawViewPorts);
-	glutReshapeFunc(_reshapeWindow);
-
 	glEnable(GL_DEPTH_TEST);
 
 	glEnable(GL_CULL_FACE);
@@ -118,6 +163,12 @@ void Renderer::init(int argc, char** argv, int screenWidth, int screenHeight)
 	glClearColor(1.0, 1.0, 1.0, 1.0);
 }
 
+void Renderer::readFrame(unsigned char* pOutPixels)
+{
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_windowWidth, m_windowHeight, GL_RGB, GL_UNSIGNED_BYTE, pOutPixels);
+}
+
 Renderer* Renderer::get()
 {
 	return m_pInstance;
@@ -312,8 +363,17 @@ void Renderer::loadSceneObjects(tinyxml2::XMLElement* pNode)
 
 void Renderer::draw()
 {
-	glutPostRedisplay();
-	glutSwapBuffers();
+	if (m_pOffscreenContext)
+	{
+		//there's no window to post the redisplay to
+		drawViewPorts();
+		glFinish();
+	}
+	else
+	{
+		glutPostRedisplay();
+		glutSwapBuffers();
+	}
 	updateFPS();
 }
 
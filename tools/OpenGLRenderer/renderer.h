@@ -16,6 +16,7 @@ class Camera;
 class Light;
 class BoundingBox3D;
 class BoundingBox2D;
+class OffscreenContext;
 
 
 class Renderer
@@ -34,7 +35,15 @@ class Renderer
 
 	string m_dataFolder;
 
-	static Renderer* m_pInstance;
+	//thread_local: each renderer is used by a single thread, and several of them can draw in parallel offscreen
+	static thread_local Renderer* m_pInstance;
+
+	//offscreen rendering: the scene is drawn to a framebuffer object instead of a window
+	OffscreenContext* m_pOffscreenContext = nullptr;
+	unsigned int m_frameBuffer = 0;
+	unsigned int m_colorBuffer = 0;
+	unsigned int m_depthBuffer = 0;
+	void initGLState(int sizeX, int sizeY);
 
 	vector<GraphicObject3D*> m_3DgraphicObjects;
 	vector<GraphicObject2D*> m_2DgraphicObjects;
@@ -75,6 +84,13 @@ public:
 	void draw();
 
 	void init(int argc, char** argv, int sizeX, int sizeY);
+	//Initializes the renderer without a window: frames are drawn to a framebuffer object of the given size and read
+	//with readFrame(). Throws an exception if no offscreen context can be created. Text isn't drawn, because bitmap
+	//fonts need GLUT
+	void initOffscreen(int sizeX, int sizeY);
+	bool isOffscreen() const { return m_pOffscreenContext != nullptr; }
+	//Copies the last frame drawn offscreen as sizeX*sizeY RGB pixels, bottom row first
+	void readFrame(unsigned char* pOutPixels);
 
 	//Access to the renderer instance
 	static Renderer* get();
@@ -49,6 +49,9 @@ Text2D::~Text2D()
 
 void Text2D::draw()
 {
+	//GLUT's bitmap fonts can't be used without its window
+	if (Renderer::get()->isOffscreen())
+		return;
 	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_LIGHTING);
 	glDisable(GL_BLEND);
@@ -26,6 +26,7 @@
 #include "stdafx.h"
 #include "texture-manager.h"
 #include "renderer.h"
+#include "asset-cache.h"
 
 
 Texture::Texture()
@@ -71,9 +72,7 @@ size_t TextureManager::loadTexture(string filename)
 		++id;
 	}
 	//texture not found, must load it
-	unsigned int numChannelsRead;
-	int oglId = SOIL_load_OGL_texture(filename.c_str(), 0, 0
-		, SOIL_FLAG_POWER_OF_TWO | SOIL_FLAG_MIPMAPS,&numChannelsRead);
+	unsigned int oglId = createTexture(filename);
 	if (oglId != 0)
 	{
 		Renderer::get()->logMessage("Success");
@@ -88,6 +87,109 @@ size_t TextureManager::loadTexture(string filename)
 	return -1;
 }
 
+//Cached texture: the levels of the texture as SOIL creates them (resized to a power of two, with all its mipmaps),
+//so that they are only uploaded. The number of channels and levels (uint32 each) are followed by each level: width and
+//height (uint32 each) and the pixels, padded to 4 bytes
+static unsigned int getPixelFormat(unsigned int numChannels)
+{
+	const unsigned int formats[] = { GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+	return formats[numChannels - 1];
+}
+
+unsigned int TextureManager::createTexture(const string& filename)
+{
+	MemoryMappedFile imageFile;
+	if (!imageFile.open(filename.c_str()))
+		return 0;
+	uint64_t contentHash = AssetCache::hashContents(imageFile.data(), imageFile.size());
+	string cacheFile = AssetCache::getCacheFilename(filename);
+	const char padding[4] = {};
+	int previousAlignment;
+
+	AssetCacheReader reader;
+	if (reader.open(cacheFile, AssetCache::AssetType::Texture, contentHash))
+	{
+		uint32_t numChannels = reader.read<uint32_t>();
+		uint32_t numLevels = reader.read<uint32_t>();
+		if (numChannels >= 1 && numChannels <= 4 && numLevels > 0)
+		{
+			unsigned int format = getPixelFormat(numChannels);
+			unsigned int oglId = 0;
+			glGenTextures(1, &oglId);
+			glBindTexture(GL_TEXTURE_2D, oglId);
+			glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			for (uint32_t level = 0; level < numLevels && !reader.bError(); ++level)
+			{
+				uint32_t width = reader.read<uint32_t>();
+				uint32_t height = reader.read<uint32_t>();
+				size_t levelSize = (size_t)width * height * numChannels;
+				const char* pPixels = reader.read(levelSize);
+				reader.read((4 - levelSize % 4) % 4);
+				if (pPixels)
+					glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, pPixels);
+			}
+			glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+			if (reader.bComplete())
+			{
+				//the same parameters set by SOIL
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+				Renderer::get()->logMessage("Loaded from the asset cache");
+				return oglId;
+			}
+			glDeleteTextures(1, &oglId);
+		}
+		Renderer::get()->logMessage("The asset cache is corrupt: " + cacheFile);
+	}
+
+	int width, height, numChannels;
+	unsigned char* pImage = SOIL_load_image_from_memory((const unsigned char*)imageFile.data(), (int)imageFile.size()
+		, &width, &height, &numChannels, SOIL_LOAD_AUTO);
+	if (!pImage)
+		return 0;
+	unsigned int oglId = SOIL_create_OGL_texture(pImage, width, height, numChannels, 0
+		, SOIL_FLAG_POWER_OF_TWO | SOIL_FLAG_MIPMAPS);
+	SOIL_free_image_data(pImage);
+	if (oglId == 0 || numChannels < 1 || numChannels > 4)
+		return oglId;
+
+	//the levels are read back from the texture
+	vector<pair<int, int>> levelSizes;
+	glBindTexture(GL_TEXTURE_2D, oglId);
+	for (int level = 0; ; ++level)
+	{
+		int levelWidth = 0, levelHeight = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &levelWidth);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &levelHeight);
+		if (levelWidth <= 0 || levelHeight <= 0)
+			break;
+		levelSizes.push_back(make_pair(levelWidth, levelHeight));
+	}
+	AssetCacheWriter writer(AssetCache::AssetType::Texture, contentHash);
+	writer.write((uint32_t)numChannels);
+	writer.write((uint32_t)levelSizes.size());
+	vector<unsigned char> pixels;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	for (size_t level = 0; level < levelSizes.size(); ++level)
+	{
+		size_t levelSize = (size_t)levelSizes[level].first * levelSizes[level].second * numChannels;
+		pixels.resize(levelSize);
+		glGetTexImage(GL_TEXTURE_2D, (int)level, getPixelFormat(numChannels), GL_UNSIGNED_BYTE, pixels.data());
+		writer.write((uint32_t)levelSizes[level].first);
+		writer.write((uint32_t)levelSizes[level].second);
+		writer.write(pixels.data(), levelSize);
+		writer.write(padding, (4 - levelSize % 4) % 4);
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment);
+	if (levelSizes.empty() || !writer.save(cacheFile))
+		Renderer::get()->logMessage("Couldn't save the texture to the asset cache: " + cacheFile);
+	return oglId;
+}
+
 void TextureManager::set(int textureId)
 {
 	if (textureId >= 0 && textureId < (int)m_textures.size() )
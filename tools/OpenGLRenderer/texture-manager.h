@@ -24,6 +24,10 @@ class TextureManager
 {
 	string m_folder;
 	vector<Texture*> m_textures;
+
+	//Decodes the image (or takes it already decoded from the asset cache) and creates the OpenGL texture. Returns 0
+	//if it fails
+	unsigned int createTexture(const string& filename);
 public:
 	TextureManager();
 	virtual ~TextureManager();
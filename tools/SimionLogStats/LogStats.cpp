@@ -0,0 +1,344 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "LogStats.h"
+#include "../SimionLogViewer/LogLoader.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#define EVALUATION_EPISODE 0
+#define TRAINING_EPISODE 1
+
+void RunningStats::add(double value)
+{
+	if (m_count == 0)
+		m_min = m_max = value;
+	else
+	{
+		m_min = std::min(m_min, value);
+		m_max = std::max(m_max, value);
+	}
+	++m_count;
+	double delta = value - m_mean;
+	m_mean += delta / m_count;
+	m_m2 += delta * (value - m_mean);
+}
+
+void RunningStats::merge(const RunningStats& other)
+{
+	if (other.m_count == 0)
+		return;
+	if (m_count == 0)
+	{
+		*this = other;
+		return;
+	}
+	//Chan et al.'s parallel update
+	size_t count = m_count + other.m_count;
+	double delta = other.m_mean - m_mean;
+	m_mean += delta * other.m_count / count;
+	m_m2 += other.m_m2 + delta * delta * ((double)m_count * other.m_count / count);
+	m_min = std::min(m_min, other.m_min);
+	m_max = std::max(m_max, other.m_max);
+	m_count = count;
+}
+
+double RunningStats::variance() const
+{
+	if (m_count < 2)
+		return 0.0;
+	return m_m2 / (m_count - 1);
+}
+
+double RunningStats::stdDev() const
+{
+	return sqrt(variance());
+}
+
+P2Quantile::P2Quantile(double p)
+{
+	m_p = std::max(0.0, std::min(1.0, p));
+
+	for (int i = 0; i < 5; ++i)
+	{
+		m_heights[i] = 0.0;
+		m_positions[i] = i;
+	}
+	m_desiredPositions[0] = 0.0;
+	m_desiredPositions[1] = 2.0 * m_p;
+	m_desiredPositions[2] = 4.0 * m_p;
+	m_desiredPositions[3] = 2.0 + 2.0 * m_p;
+	m_desiredPositions[4] = 4.0;
+	m_increments[0] = 0.0;
+	m_increments[1] = m_p / 2.0;
+	m_increments[2] = m_p;
+	m_increments[3] = (1.0 + m_p) / 2.0;
+	m_increments[4] = 1.0;
+}
+
+double P2Quantile::parabolic(int i, double d) const
+{
+	const double* q = m_heights;
+	const double* n = m_positions;
+	return q[i] + d / (n[i + 1] - n[i - 1])
+		* ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i])
+			+ (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+	return m_heights[i] + d * (m_heights[i + d] - m_heights[i]) / (m_positions[i + d] - m_positions[i]);
+}
+
+void P2Quantile::add(double value)
+{
+	//the first five values are used as the initial markers
+	if (m_count < 5)
+	{
+		m_heights[m_count++] = value;
+		if (m_count == 5)
+			std::sort(m_heights, m_heights + 5);
+		return;
+	}
+	++m_count;
+
+	//find the cell k such that heights[k] <= value < heights[k+1], adjusting the extreme markers if needed
+	int k;
+	if (value < m_heights[0])
+	{
+		m_heights[0] = value;
+		k = 0;
+	}
+	else if (value >= m_heights[4])
+	{
+		m_heights[4] = value;
+		k = 3;
+	}
+	else
+	{
+		k = 0;
+		while (value >= m_heights[k + 1])
+			++k;
+	}
+
+	for (int i = k + 1; i < 5; ++i)
+		m_positions[i] += 1.0;
+	for (int i = 0; i < 5; ++i)
+		m_desiredPositions[i] += m_increments[i];
+
+	//adjust the heights of the middle markers if they are off their desired positions
+	for (int i = 1; i < 4; ++i)
+	{
+		double d = m_desiredPositions[i] - m_positions[i];
+		if ((d >= 1.0 && m_positions[i + 1] - m_positions[i] > 1.0)
+			|| (d <= -1.0 && m_positions[i - 1] - m_positions[i] < -1.0))
+		{
+			int sign = d > 0.0 ? 1 : -1;
+			double height = parabolic(i, sign);
+			if (m_heights[i - 1] < height && height < m_heights[i + 1])
+				m_heights[i] = height;
+			else
+				m_heights[i] = linear(i, sign);
+			m_positions[i] += sign;
+		}
+	}
+}
+
+double P2Quantile::get() const
+{
+	if (m_count == 0)
+		return 0.0;
+	if (m_count < 5)
+	{
+		//not enough values yet to use the markers: use the exact quantile
+		double values[5];
+		std::copy(m_heights, m_heights + m_count, values);
+		std::sort(values, values + m_count);
+		return values[(size_t)std::round(m_p * (m_count - 1))];
+	}
+	return m_heights[2];
+}
+
+bool LogStats::compute(const string& logDescriptorFile, const LogStatsConfig& config)
+{
+	m_logFile = logDescriptorFile;
+
+	ExperimentLog log;
+	string sceneFile;
+	try
+	{
+		if (!log.load(logDescriptorFile, sceneFile))
+		{
+			m_error = "Couldn't load the log files";
+			return false;
+		}
+		processEpisodes(log, config);
+	}
+	catch (std::exception& e)
+	{
+		m_error = e.what();
+		return false;
+	}
+	return true;
+}
+
+//Each point of a downsampled series aggregates numEpisodes / numPoints consecutive episodes of the same type
+static vector<SeriesPoint> createSeries(size_t numEpisodes, size_t numPoints)
+{
+	return vector<SeriesPoint>(std::min(numEpisodes, numPoints));
+}
+
+static void addToSeries(vector<SeriesPoint>& series, size_t episodeInSeries, size_t numEpisodes
+	, long long int episodeIndex, const RunningStats& episodeStats)
+{
+	SeriesPoint& point = series[episodeInSeries * series.size() / numEpisodes];
+	if (point.firstEpisode < 0)
+		point.firstEpisode = episodeIndex;
+	point.lastEpisode = episodeIndex;
+	point.stats.merge(episodeStats);
+}
+
+void LogStats::processEpisodes(ExperimentLog& log, const LogStatsConfig& config)
+{
+	//episode headers are already indexed: count the episodes of each type to know the size of each series point
+	for (int e = 0; e < log.getNumEpisodes(); ++e)
+	{
+		if (log.getEpisode(e)->getEpisodeType() == EVALUATION_EPISODE)
+			++m_numEvaluationEpisodes;
+		else
+			++m_numTrainingEpisodes;
+	}
+
+	Descriptor& descriptor = log.getDescriptor();
+	for (size_t i = 0; i < descriptor.size(); ++i)
+	{
+		string name = descriptor[i].getName();
+		if (!config.variables.empty()
+			&& std::find(config.variables.begin(), config.variables.end(), name) == config.variables.end())
+			continue;
+
+		VariableStats variable;
+		variable.name = name;
+		variable.index = (int)i;
+		for (double percentile : config.percentiles)
+			variable.percentiles.push_back(P2Quantile(percentile / 100.0));
+		variable.evaluationSeries = createSeries(m_numEvaluationEpisodes, config.numPoints);
+		variable.trainingSeries = createSeries(m_numTrainingEpisodes, config.numPoints);
+		m_variables.push_back(variable);
+	}
+
+	vector<RunningStats> episodeStats(m_variables.size());
+	size_t numEvaluationEpisodes = 0, numTrainingEpisodes = 0;
+	for (int e = 0; e < log.getNumEpisodes(); ++e)
+	{
+		Episode* pEpisode = log.getEpisode(e);
+		std::fill(episodeStats.begin(), episodeStats.end(), RunningStats());
+
+		//steps are read in file order, so the mapped file is accessed sequentially
+		for (int s = 0; s < (int)pEpisode->getNumSteps(); ++s)
+		{
+			Step step = pEpisode->getStep(s);
+			for (size_t v = 0; v < m_variables.size(); ++v)
+			{
+				double value = step.getValue(m_variables[v].index);
+				episodeStats[v].add(value);
+				for (P2Quantile& percentile : m_variables[v].percentiles)
+					percentile.add(value);
+			}
+		}
+		m_numSteps += pEpisode->getNumSteps();
+
+		bool bEvaluation = pEpisode->getEpisodeType() == EVALUATION_EPISODE;
+		for (size_t v = 0; v < m_variables.size(); ++v)
+		{
+			m_variables[v].stats.merge(episodeStats[v]);
+			if (bEvaluation)
+				addToSeries(m_variables[v].evaluationSeries, numEvaluationEpisodes, m_numEvaluationEpisodes
+					, pEpisode->getEpisodeIndex(), episodeStats[v]);
+			else
+				addToSeries(m_variables[v].trainingSeries, numTrainingEpisodes, m_numTrainingEpisodes
+					, pEpisode->getEpisodeIndex(), episodeStats[v]);
+		}
+		if (bEvaluation)
+			++numEvaluationEpisodes;
+		else
+			++numTrainingEpisodes;
+	}
+}
+
+static string escapeXML(const string& text)
+{
+	string escaped;
+	for (char c : text)
+	{
+		switch (c)
+		{
+		case '&': escaped += "&amp;"; break;
+		case '<': escaped += "&lt;"; break;
+		case '>': escaped += "&gt;"; break;
+		case '"': escaped += "&quot;"; break;
+		default: escaped += c;
+		}
+	}
+	return escaped;
+}
+
+static void writeSeries(FILE* pOutFile, const char* type, const vector<SeriesPoint>& series)
+{
+	if (series.empty())
+		return;
+	fprintf(pOutFile, "      <Series Type=\"%s\">\n", type);
+	for (const SeriesPoint& point : series)
+	{
+		fprintf(pOutFile, "        <Point First-Episode=\"%lld\" Last-Episode=\"%lld\" Mean=\"%.9g\" Min=\"%.9g\" Max=\"%.9g\" Std-Dev=\"%.9g\"/>\n"
+			, point.firstEpisode, point.lastEpisode, point.stats.mean(), point.stats.min(), point.stats.max(), point.stats.stdDev());
+	}
+	fprintf(pOutFile, "      </Series>\n");
+}
+
+void LogStats::write(FILE* pOutFile) const
+{
+	if (!m_error.empty())
+	{
+		fprintf(pOutFile, "  <Log File=\"%s\" Error=\"%s\"/>\n", escapeXML(m_logFile).c_str(), escapeXML(m_error).c_str());
+		return;
+	}
+
+	fprintf(pOutFile, "  <Log File=\"%s\" Evaluation-Episodes=\"%zu\" Training-Episodes=\"%zu\" Steps=\"%zu\">\n"
+		, escapeXML(m_logFile).c_str(), m_numEvaluationEpisodes, m_numTrainingEpisodes, m_numSteps);
+	for (const VariableStats& variable : m_variables)
+	{
+		fprintf(pOutFile, "    <Variable Name=\"%s\" Mean=\"%.9g\" Min=\"%.9g\" Max=\"%.9g\" Std-Dev=\"%.9g\">\n"
+			, escapeXML(variable.name).c_str(), variable.stats.mean(), variable.stats.min(), variable.stats.max()
+			, variable.stats.stdDev());
+		for (const P2Quantile& percentile : variable.percentiles)
+			fprintf(pOutFile, "      <Percentile P=\"%g\" Value=\"%.9g\"/>\n", percentile.p() * 100.0, percentile.get());
+		writeSeries(pOutFile, "Evaluation", variable.evaluationSeries);
+		writeSeries(pOutFile, "Training", variable.trainingSeries);
+		fprintf(pOutFile, "    </Variable>\n");
+	}
+	fprintf(pOutFile, "  </Log>\n");
+}
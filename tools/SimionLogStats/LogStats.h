@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdio.h>
+using namespace std;
+
+class ExperimentLog;
+
+//Running count/mean/variance/min/max of a series of values (Welford's algorithm). Two accumulators can be merged, so
+//the statistics of consecutive episodes can be combined without storing any value
+class RunningStats
+{
+	size_t m_count = 0;
+	double m_mean = 0.0;
+	double m_m2 = 0.0;
+	double m_min = 0.0;
+	double m_max = 0.0;
+public:
+	void add(double value);
+	void merge(const RunningStats& other);
+
+	size_t count() const { return m_count; }
+	double mean() const { return m_mean; }
+	double min() const { return m_min; }
+	double max() const { return m_max; }
+	double variance() const;
+	double stdDev() const;
+};
+
+//Streaming estimation of a quantile with the P-square algorithm (Jain & Chlamtac, 1985). Only five markers are kept,
+//so the memory used doesn't depend on the number of values
+class P2Quantile
+{
+	double m_p;
+	size_t m_count = 0;
+	double m_heights[5];
+	double m_positions[5];
+	double m_desiredPositions[5];
+	double m_increments[5];
+
+	double parabolic(int i, double d) const;
+	double linear(int i, int d) const;
+public:
+	//p must be in [0,1]
+	P2Quantile(double p);
+
+	void add(double value);
+	double get() const;
+	double p() const { return m_p; }
+};
+
+struct LogStatsConfig
+{
+	//percentiles in [0,100]
+	vector<double> percentiles = { 5.0, 25.0, 50.0, 75.0, 95.0 };
+	//maximum number of points of the downsampled series of each episode type
+	size_t numPoints = 100;
+	//only these variables are processed. If empty, all of them are
+	vector<string> variables;
+};
+
+//Aggregated statistics of a set of consecutive episodes of the same type
+struct SeriesPoint
+{
+	long long int firstEpisode = -1;
+	long long int lastEpisode = -1;
+	RunningStats stats;
+};
+
+class VariableStats
+{
+public:
+	string name;
+	int index;
+	RunningStats stats;
+	vector<P2Quantile> percentiles;
+	vector<SeriesPoint> evaluationSeries;
+	vector<SeriesPoint> trainingSeries;
+};
+
+//Statistics of a single experiment log. Steps are read from the memory-mapped file episode by episode, so the memory
+//needed only depends on the number of variables and the number of points of the downsampled series
+class LogStats
+{
+	string m_logFile;
+	string m_error;
+	size_t m_numEvaluationEpisodes = 0;
+	size_t m_numTrainingEpisodes = 0;
+	size_t m_numSteps = 0;
+	vector<VariableStats> m_variables;
+
+	void processEpisodes(ExperimentLog& log, const LogStatsConfig& config);
+public:
+	LogStats() {}
+
+	//Returns false if the log couldn't be loaded. The reason can be retrieved with getError()
+	bool compute(const string& logDescriptorFile, const LogStatsConfig& config);
+
+	const string& getLogFile() const { return m_logFile; }
+	const string& getError() const { return m_error; }
+
+	void write(FILE* pOutFile) const;
+};
@@ -0,0 +1,158 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// SimionLogStats: computes summary statistics of experiment logs without loading them in memory
+//
+
+#include "stdafx.h"
+#include "LogStats.h"
+#include "../System/FileUtils.h"
+#include "../System/Timer.h"
+#include "../System/CrossPlatform.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+
+#define LOG_DESCRIPTOR_EXTENSION ".log"
+
+//returns the value of an argument given as "-name=value", or nullptr if it wasn't passed
+const char* getArgValue(int argc, char** argv, const char* argName)
+{
+	string argPrefix = string("-") + argName + "=";
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strstr(argv[i], argPrefix.c_str()) == argv[i])
+			return argv[i] + argPrefix.size();
+	}
+	return nullptr;
+}
+
+vector<string> split(const string& text, char separator)
+{
+	vector<string> tokens;
+	size_t start = 0, end;
+	while ((end = text.find(separator, start)) != string::npos)
+	{
+		if (end > start) tokens.push_back(text.substr(start, end - start));
+		start = end + 1;
+	}
+	if (start < text.size()) tokens.push_back(text.substr(start));
+	return tokens;
+}
+
+void printUsage()
+{
+	printf("Usage: SimionLogStats [options] <log-descriptor-file|directory>...\n");
+	printf("Directories are searched recursively for log descriptor files (*%s)\n", LOG_DESCRIPTOR_EXTENSION);
+	printf("Options:\n");
+	printf("  -output=<file>          Output file. The summary is written to the standard output by default\n");
+	printf("  -points=<n>             Maximum number of points of the downsampled episode series (default: 100)\n");
+	printf("  -percentiles=<p1,p2..>  Percentiles in [0,100] (default: 5,25,50,75,95)\n");
+	printf("  -variables=<v1,v2..>    Only process these variables (default: all)\n");
+	printf("  -threads=<n>            Number of logs processed in parallel (default: number of cores)\n");
+}
+
+int main(int argc, char** argv)
+{
+	LogStatsConfig config;
+	vector<string> logFiles;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (argv[i][0] == '-')
+			continue;
+		string path = argv[i];
+		size_t extensionLength = strlen(LOG_DESCRIPTOR_EXTENSION);
+		if (path.size() > extensionLength && path.compare(path.size() - extensionLength, extensionLength, LOG_DESCRIPTOR_EXTENSION) == 0)
+			logFiles.push_back(path);
+		else
+			findFiles(path, LOG_DESCRIPTOR_EXTENSION, logFiles);
+	}
+	if (logFiles.empty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	if (getArgValue(argc, argv, "points"))
+		config.numPoints = (size_t) std::max(1, atoi(getArgValue(argc, argv, "points")));
+	if (getArgValue(argc, argv, "percentiles"))
+	{
+		config.percentiles.clear();
+		for (const string& percentile : split(getArgValue(argc, argv, "percentiles"), ','))
+			config.percentiles.push_back(atof(percentile.c_str()));
+	}
+	if (getArgValue(argc, argv, "variables"))
+		config.variables = split(getArgValue(argc, argv, "variables"), ',');
+
+	unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (getArgValue(argc, argv, "threads"))
+		numThreads = (unsigned int) std::max(1, atoi(getArgValue(argc, argv, "threads")));
+	numThreads = std::min(numThreads, (unsigned int) logFiles.size());
+
+	FILE* pOutFile = stdout;
+	if (getArgValue(argc, argv, "output"))
+	{
+		CrossPlatform::Fopen_s(&pOutFile, getArgValue(argc, argv, "output"), "w");
+		if (!pOutFile)
+		{
+			fprintf(stderr, "Couldn't open the output file: %s\n", getArgValue(argc, argv, "output"));
+			return 1;
+		}
+	}
+
+	//logs are processed in parallel: each thread takes the next log not yet processed
+	Timer timer;
+	timer.start();
+	vector<LogStats> stats(logFiles.size());
+	std::atomic<size_t> nextLog(0);
+	vector<std::thread> threads;
+	for (unsigned int t = 0; t < numThreads; ++t)
+	{
+		threads.push_back(std::thread([&]()
+		{
+			size_t log;
+			while ((log = nextLog.fetch_add(1)) < logFiles.size())
+			{
+				if (!stats[log].compute(logFiles[log], config))
+					fprintf(stderr, "Error processing %s: %s\n", logFiles[log].c_str(), stats[log].getError().c_str());
+			}
+		}));
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	fprintf(pOutFile, "<LogStats>\n");
+	for (const LogStats& logStats : stats)
+		logStats.write(pOutFile);
+	fprintf(pOutFile, "</LogStats>\n");
+	if (pOutFile != stdout)
+		fclose(pOutFile);
+
+	fprintf(stderr, "%zu logs processed in %.2f seconds using %u threads\n", logFiles.size(), timer.getElapsedTime(), numThreads);
+	return 0;
+}
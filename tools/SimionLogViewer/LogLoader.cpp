@@ -23,29 +23,18 @@
 	SOFTWARE.
 */
 
-#include "stdafx.h"
 #include "LogLoader.h"
 #include "../System/FileUtils.h"
+#include "../../3rd-party/tinyxml2/tinyxml2.h"
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 
-Step::Step(int numVariables)
+Step::Step(const char* pData, int numValues)
 {
-	m_numValues = numVariables;
-	m_pValues = new double[numVariables];
-}
-
-Step::~Step()
-{
-	if (m_pValues) delete [] m_pValues;
-}
-
-void Step::load(FILE* pFile)
-{
-	size_t elementsRead = fread_s((void*)&m_header, sizeof(StepHeader), sizeof(StepHeader), 1, pFile);
-	if (elementsRead == 1 && !bEnd())
-	{
-		elementsRead = fread_s(m_pValues, sizeof(double)*m_numValues, sizeof(double), m_numValues, pFile);
-	}
+	m_pHeader = (const StepHeader*)pData;
+	m_pValues = (const double*)(pData + sizeof(StepHeader));
+	m_numValues = numValues;
 }
 
 double Step::getValue(int i) const
@@ -55,58 +44,59 @@ double Step::getValue(int i) const
 	return 0.0;
 }
 
-void Step::setValue(int i, double value)
-{
-	if (i >= 0 && i<m_numValues)
-		m_pValues[i]= value;
-}
-
 double Step::getExperimentRealTime() const
 {
-	return m_header.experimentRealTime;
+	if (!m_pHeader) return 0.0;
+	return m_pHeader->experimentRealTime;
 }
 double Step::getEpisodeSimTime() const
 {
-	return m_header.m_episodeSimTime;
+	if (!m_pHeader) return 0.0;
+	return m_pHeader->m_episodeSimTime;
 }
 double Step::getEpisodeRealTime() const
 {
-	return m_header.episodeRealTime;
+	if (!m_pHeader) return 0.0;
+	return m_pHeader->episodeRealTime;
 }
 
-bool Step::bEnd()
+bool Step::bEnd() const
 {
-	return m_header.magicNumber == EPISODE_END_HEADER;
+	return m_pHeader != nullptr && m_pHeader->magicNumber == EPISODE_END_HEADER;
 }
 
-void Episode::load(FILE* pFile)
+const char* Episode::index(const char* pData, const char* pDataEnd)
 {
-	size_t elementsRead = fread_s((void*)&m_header, sizeof(EpisodeHeader), sizeof(EpisodeHeader), 1, pFile);
-	if (elementsRead == 1)
+	if (pData + sizeof(EpisodeHeader) > pDataEnd)
+		return nullptr;
+	m_pHeader = (const EpisodeHeader*)pData;
+	if (m_pHeader->magicNumber != EPISODE_HEADER || m_pHeader->numVariablesLogged < 0)
+		return nullptr;
+
+	m_pFirstStep = pData + sizeof(EpisodeHeader);
+	m_stepSize = sizeof(StepHeader) + sizeof(double) * (size_t)m_pHeader->numVariablesLogged;
+	m_numSteps = 0;
+
+	//steps have a fixed size, so we only need to check the magic number of each step header until the end header
+	const char* pStep = m_pFirstStep;
+	while (pStep + sizeof(StepHeader) <= pDataEnd)
 	{
-		Step *pStep= new Step((int)m_header.numVariablesLogged);
-		pStep->load(pFile);
-		while (!pStep->bEnd())
-		{
-			m_pSteps.push_back(pStep);
-
-			pStep = new Step((int)m_header.numVariablesLogged);
-			pStep->load(pFile);
-		}
+		long long int magicNumber = ((const StepHeader*)pStep)->magicNumber;
+		if (magicNumber == EPISODE_END_HEADER)
+			return pStep + sizeof(StepHeader);
+		if (magicNumber != STEP_HEADER || pStep + m_stepSize > pDataEnd)
+			break;
+		++m_numSteps;
+		pStep += m_stepSize;
 	}
+	return nullptr;
 }
 
-Episode::~Episode()
+Step Episode::getStep(int i) const
 {
-	for (auto it = m_pSteps.begin(); it != m_pSteps.end(); ++it)
-		delete (*it);
-}
-
-Step* Episode::getStep(int i)
-{
-	if (i>=0 && i<m_pSteps.size())
-		return m_pSteps[i];
-	return nullptr;
+	if (i>=0 && i<(int)m_numSteps)
+		return Step(m_pFirstStep + m_stepSize * i, (int)m_pHeader->numVariablesLogged);
+	return Step();
 }
 
 
@@ -159,25 +149,30 @@ bool ExperimentLog::load(string descriptorFile, string& outSceneFile)
 	}
 	else return false;
 
-	//Load the binary file from the same directory
-	FILE* pFile;
-
+	//Map the binary file from the same directory and index the episodes
 	string logDirectory = getDirectory(descriptorFile);
-	fopen_s(&pFile, (logDirectory + binaryFile).c_str(), "rb");
-	if (pFile)
+	if (!m_logFile.open((logDirectory + binaryFile).c_str()) || m_logFile.size() < sizeof(ExperimentHeader))
+		return false;
+	m_logFile.adviseSequentialAccess();
+
+	const char* pData = m_logFile.data();
+	const char* pDataEnd = pData + m_logFile.size();
+	m_pHeader = (const ExperimentHeader*)pData;
+	if (m_pHeader->magicNumber != EXPERIMENT_HEADER)
+		return false;
+	pData += sizeof(ExperimentHeader);
+
+	//the number of episodes in the header is only trusted as far as the size of the file allows
+	m_episodes.reserve((size_t)std::max((long long int)0, std::min(m_pHeader->numEpisodes
+		, (long long int)(m_logFile.size() / sizeof(EpisodeHeader)))));
+	for (long long int i = 0; i < m_pHeader->numEpisodes && pData != nullptr; ++i)
 	{
-		size_t elementsRead = fread_s((void*)&m_header, sizeof(ExperimentHeader), sizeof(ExperimentHeader), 1, pFile);
-		if (elementsRead == 1)
-		{
-			m_pEpisodes = new Episode[getNumEpisodes()];
-			for (int i = 0; i < getNumEpisodes(); ++i)
-			{
-				m_pEpisodes[i].load(pFile);
-			}
-		}
-		fclose(pFile);
+		Episode episode;
+		pData = episode.index(pData, pDataEnd);
+		//incomplete episodes at the end of the file are ignored
+		if (pData != nullptr)
+			m_episodes.push_back(episode);
 	}
-	else return false;
 
 	//Load the function log file from the same directory
 	if (!functionLogFile.empty())
@@ -188,28 +183,73 @@ bool ExperimentLog::load(string descriptorFile, string& outSceneFile)
 
 ExperimentLog::~ExperimentLog()
 {
-	if (m_pEpisodes) delete [] m_pEpisodes;
 }
 
 int ExperimentLog::getVariableIndex(string variableName) const
 {
-	for (int i = 0; i < m_descriptor.size(); ++i)
+	for (size_t i = 0; i < m_descriptor.size(); ++i)
 		if (string(m_descriptor[i].getName()) == variableName)
-			return i;
+			return (int)i;
 	return -1;
 }
 
-#define FUNCTION_SAMPLE_HEADER 6543
-#define FUNCTION_DECLARATION_HEADER 5432
-#define FUNCTION_LOG_FILE_HEADER 4321
-#define FUNCTION_LOG_FILE_VERSION 1
+FunctionSample::FunctionSample(const FunctionSampleHeader* pHeader, const FunctionSampleEncodingHeader* pEncodingHeader
+	, const char* pValues)
+{
+	m_pHeader = pHeader;
+	m_pEncodingHeader = pEncodingHeader;
+	m_pValues = pValues;
+}
 
-FunctionSample::FunctionSample(size_t episode, size_t step, size_t experimentStep, size_t numSamples)
+size_t FunctionSample::valuesSize(const FunctionSampleEncodingHeader* pEncodingHeader, size_t numValues)
 {
-	m_episode = episode;
-	m_step = step;
-	m_experimentStep = experimentStep;
-	m_values = vector<double>(numSamples);
+	size_t size;
+	if (!pEncodingHeader)
+		return numValues * sizeof(double);
+	switch (pEncodingHeader->encoding)
+	{
+	case FUNCTION_SAMPLE_FULL_DOUBLE: size = numValues * sizeof(double); break;
+	case FUNCTION_SAMPLE_FULL_FLOAT: size = numValues * sizeof(float); break;
+	case FUNCTION_SAMPLE_DELTA_INT8: size = numValues * sizeof(signed char); break;
+	case FUNCTION_SAMPLE_DELTA_INT16: size = numValues * sizeof(short); break;
+	case FUNCTION_SAMPLE_UNCHANGED: size = 0; break;
+	default: throw std::runtime_error("Unknown function sample encoding trying to read function log file");
+	}
+	//values are padded to a multiple of 8 bytes
+	return size + (8 - size % 8) % 8;
+}
+
+bool FunctionSample::bFull() const
+{
+	return !m_pEncodingHeader || m_pEncodingHeader->encoding == FUNCTION_SAMPLE_FULL_DOUBLE
+		|| m_pEncodingHeader->encoding == FUNCTION_SAMPLE_FULL_FLOAT;
+}
+
+void FunctionSample::decode(vector<double>& outValues) const
+{
+	size_t numValues = outValues.size();
+	if (!m_pEncodingHeader || m_pEncodingHeader->encoding == FUNCTION_SAMPLE_FULL_DOUBLE)
+	{
+		const double* pValues = (const double*)m_pValues;
+		outValues.assign(pValues, pValues + numValues);
+		return;
+	}
+	double quantum = m_pEncodingHeader->quantum;
+	switch (m_pEncodingHeader->encoding)
+	{
+	case FUNCTION_SAMPLE_FULL_FLOAT:
+		for (size_t i = 0; i < numValues; ++i)
+			outValues[i] = ((const float*)m_pValues)[i];
+		break;
+	case FUNCTION_SAMPLE_DELTA_INT8:
+		for (size_t i = 0; i < numValues; ++i)
+			outValues[i] += (double)((const signed char*)m_pValues)[i] * quantum;
+		break;
+	case FUNCTION_SAMPLE_DELTA_INT16:
+		for (size_t i = 0; i < numValues; ++i)
+			outValues[i] += (double)((const short*)m_pValues)[i] * quantum;
+		break;
+	}
 }
 
 Function::Function(string name, size_t numSamplesX, size_t numSamplesY, size_t numSamplesZ)
@@ -220,17 +260,40 @@ Function::Function(string name, size_t numSamplesX, size_t numSamplesY, size_t n
 	m_numSamplesZ = numSamplesZ;
 
 	m_interpolatedValues = vector<double>(numSamples());
+	m_decodedValues = vector<double>(numSamples());
 }
 
-const vector<double>& Function::getInterpolatedData(size_t episode, size_t step, bool &dataChanged)
+const vector<double>& Function::getSavedSampleValues(size_t i)
 {
-	int previous = 0, next;
+	if ((int)i == m_lastDecodedSample)
+		return m_decodedValues;
+
+	//decode forward from the last decoded sample if possible. Otherwise, from the last sample saved in full
+	size_t first;
+	if (m_lastDecodedSample >= 0 && (int)i > m_lastDecodedSample)
+		first = m_lastDecodedSample + 1;
+	else
+	{
+		first = i;
+		while (first > 0 && !m_samples[first].bFull())
+			--first;
+	}
+	for (size_t sample = first; sample <= i; ++sample)
+		m_samples[sample].decode(m_decodedValues);
+
+	m_lastDecodedSample = (int)i;
+	return m_decodedValues;
+}
+
+const vector<double>& Function::getInterpolatedData(size_t episode, size_t, bool &dataChanged)
+{
+	size_t previous = 0, next;
 	episode++; //saved episodes start from 1
-	if (episode != m_lastInterpolatedEpisode)
+	if ((int)episode != m_lastInterpolatedEpisode)
 	{
 		if (m_samples.size() > 1)
 		{
-			while (previous < m_samples.size() - 2 && m_samples[previous + 1]->episode() < episode)
+			while (previous < m_samples.size() - 2 && m_samples[previous + 1].episode() < episode)
 				++previous;
 
 			next = previous + 1;
@@ -238,11 +301,13 @@ const vector<double>& Function::getInterpolatedData(size_t episode, size_t step,
 		else
 			previous = next = 0;
 
-		double u = ((double)(episode - m_samples[previous]->episode())) / (double)(m_samples[next]->episode() - m_samples[previous]->episode());
+		double u = ((double)(episode - m_samples[previous].episode())) / (double)(m_samples[next].episode() - m_samples[previous].episode());
 		double inv_u = 1. - u;
 
+		m_previousValues = getSavedSampleValues(previous);
+		const vector<double>& nextValues = getSavedSampleValues(next);
 		for (size_t i = 0; i < numSamples(); i++)
-			m_interpolatedValues[i] = m_samples[previous]->value(i)*inv_u + m_samples[next]->value(i)*u;
+			m_interpolatedValues[i] = m_previousValues[i]*inv_u + nextValues[i]*u;
 
 		m_lastInterpolatedEpisode = (int)episode;
 		dataChanged = true;
@@ -253,61 +318,69 @@ const vector<double>& Function::getInterpolatedData(size_t episode, size_t step,
 
 void FunctionLog::load(const char* functionLogFile)
 {
-	FunctionLogHeader logHeader;
-	FunctionDeclarationHeader funDeclHeader;
-	FunctionSampleHeader sampleHeader;
-	FILE* pFile;
-	
-	fopen_s(&pFile, functionLogFile, "rb");
-	if (pFile)
+	//the file is only indexed: sample values are read from the mapped file when they are interpolated
+	if (!m_file.open(functionLogFile))
+		return;
+
+	const char* pData = m_file.data();
+	const char* pDataEnd = pData + m_file.size();
+
+	//read function log header
+	if (pData + sizeof(FunctionLogHeader) > pDataEnd)
+		return;
+	const FunctionLogHeader* pLogHeader = (const FunctionLogHeader*)pData;
+	if (pLogHeader->magicNumber != FUNCTION_LOG_FILE_HEADER)
+		throw std::runtime_error("Incorrect magic number trying to read function log file");
+	if (pLogHeader->fileVersion != FUNCTION_LOG_FILE_VERSION && pLogHeader->fileVersion != FUNCTION_LOG_FILE_VERSION_ENCODED)
+		throw std::runtime_error("Missmatched function log file version read");
+	bool bEncoded = pLogHeader->fileVersion == FUNCTION_LOG_FILE_VERSION_ENCODED;
+	pData += sizeof(FunctionLogHeader);
+
+	//read function declarations
+	for (size_t f = 0; f < (size_t) pLogHeader->numFunctions; ++f)
 	{
-		//read function log header
-		fread_s(&logHeader, sizeof(FunctionLogHeader), sizeof(FunctionLogHeader), 1, pFile);
-		if (logHeader.magicNumber != FUNCTION_LOG_FILE_HEADER)
-			throw exception("Incorrect magic number trying to read function log file");
-		if (logHeader.fileVersion != FUNCTION_LOG_FILE_VERSION)
-			throw exception("Missmatched function log file version read");
-
-		//read function declarations
-		for (size_t f = 0; f < (size_t) logHeader.numFunctions; ++f)
-		{
-			fread_s(&funDeclHeader, sizeof(FunctionDeclarationHeader), sizeof(FunctionDeclarationHeader), 1, pFile);
-			if (funDeclHeader.magicNumber != FUNCTION_DECLARATION_HEADER)
-				throw exception("Incorrect magic number trying to read function log file");
-			Function* pFunction = new Function(funDeclHeader.name, (size_t) funDeclHeader.numSamplesX
-				, (size_t)funDeclHeader.numSamplesY, (size_t) funDeclHeader.numSamplesZ);
-			m_functions.push_back(pFunction);
-		}
+		if (pData + sizeof(FunctionDeclarationHeader) > pDataEnd)
+			return;
+		const FunctionDeclarationHeader* pFunDeclHeader = (const FunctionDeclarationHeader*)pData;
+		if (pFunDeclHeader->magicNumber != FUNCTION_DECLARATION_HEADER)
+			throw std::runtime_error("Incorrect magic number trying to read function log file");
+		Function* pFunction = new Function(pFunDeclHeader->name, (size_t) pFunDeclHeader->numSamplesX
+			, (size_t)pFunDeclHeader->numSamplesY, (size_t) pFunDeclHeader->numSamplesZ);
+		m_functions.push_back(pFunction);
+		pData += sizeof(FunctionDeclarationHeader);
+	}
 
-		//read saved samples
-		while (!feof(pFile))
+	//index saved samples
+	while (pData + sizeof(FunctionSampleHeader) <= pDataEnd)
+	{
+		const FunctionSampleHeader* pSampleHeader = (const FunctionSampleHeader*)pData;
+		if (pSampleHeader->magicNumber != FUNCTION_SAMPLE_HEADER)
+			throw std::runtime_error("Incorrect magic number trying to read function log file");
+		if ((size_t)pSampleHeader->id >= m_functions.size() || pSampleHeader->id < 0)
+			throw std::runtime_error("Wrong function Id trying to read function log file");
+		size_t numSamples = m_functions[pSampleHeader->id]->numSamples();
+		pData += sizeof(FunctionSampleHeader);
+
+		const FunctionSampleEncodingHeader* pEncodingHeader = nullptr;
+		if (bEncoded)
 		{
-			if (fread_s(&sampleHeader, sizeof(FunctionSampleHeader), sizeof(FunctionSampleHeader), 1, pFile)==1)
-			{
-				if (sampleHeader.magicNumber != FUNCTION_SAMPLE_HEADER)
-					throw exception("Incorrect magic number trying to read function log file");
-				if ((size_t)sampleHeader.id >= m_functions.size() || sampleHeader.id < 0)
-					throw exception("Wrong function Id trying to read function log file");
-				size_t numSamples = m_functions[sampleHeader.id]->numSamples();
-
-				FunctionSample* pSample = new FunctionSample(sampleHeader.episode, sampleHeader.step, sampleHeader.experimentStep, numSamples);
-
-				if (fread_s(&pSample->values()[0], numSamples * sizeof(double), sizeof(double), numSamples, pFile) == numSamples)
-					m_functions[sampleHeader.id]->addSample(pSample);
-				else
-					break; //file wasn't fully saved. Silent error, this is expected to happen sometimes
-			}
-			else
+			pEncodingHeader = (const FunctionSampleEncodingHeader*)pData;
+			pData += sizeof(FunctionSampleEncodingHeader);
+			if (pData > pDataEnd)
 				break;
 		}
+		const char* pValues = pData;
+		pData += FunctionSample::valuesSize(pEncodingHeader, numSamples);
+		if (pData > pDataEnd)
+			break; //file wasn't fully saved. Silent error, this is expected to happen sometimes
 
-		fclose(pFile);
+		m_functions[pSampleHeader->id]->addSample(FunctionSample(pSampleHeader, pEncodingHeader, pValues));
 	}
 }
 
 FunctionLog::~FunctionLog()
 {
-	for each (Function* pFunction in m_functions)
+	for (Function* pFunction : m_functions)
 	{
 		delete pFunction;
 	}
@@ -315,12 +388,4 @@ FunctionLog::~FunctionLog()
 
 Function::~Function()
 {
-	for each (FunctionSample* pSample in m_samples)
-	{
-		delete pSample;
-	}
 }
-
-FunctionSample::~FunctionSample()
-{
-}
\ No newline at end of file
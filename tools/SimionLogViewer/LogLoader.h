@@ -1,7 +1,10 @@
 #pragma once
 #include "../../RLSimion/Common/named-var-set.h"
+#include "../../RLSimion/Common/function-log-format.h"
+#include "../System/MemoryMappedFile.h"
 #include <vector>
 #include <string>
+#include <string.h>
 using namespace std;
 
 #define HEADER_MAX_SIZE 16
@@ -12,82 +15,90 @@ using namespace std;
 
 struct StepHeader
 {
-	__int64 magicNumber = STEP_HEADER;
-	__int64 stepIndex;
+	long long int magicNumber = STEP_HEADER;
+	long long int stepIndex;
 
 	double experimentRealTime;
 	double m_episodeSimTime;
 	double episodeRealTime;
 
-	__int64 padding[HEADER_MAX_SIZE - 5]; //extra space
+	long long int padding[HEADER_MAX_SIZE - 5]; //extra space
 	StepHeader()
 	{
 		memset(padding, 0, sizeof(padding));
 	}
 };
 
+//Read-only view of a logged step. The header and the values point directly to the memory-mapped log file
 class Step
 {
-	StepHeader m_header;
-	int m_numValues;
-	double *m_pValues;
+	const StepHeader* m_pHeader = nullptr;
+	const double* m_pValues = nullptr;
+	int m_numValues = 0;
 public:
-	Step(int numVars);
-	~Step();
+	Step() {}
+	Step(const char* pData, int numValues);
 
-	int getNumValues() { return m_numValues; }
+	int getNumValues() const { return m_numValues; }
 	double getValue(int i) const;
-	void setValue(int i, double value);
 
 	double getExperimentRealTime() const;
 	double getEpisodeSimTime() const;
 	double getEpisodeRealTime() const;
 
-	void load(FILE* pFile);
-	bool bEnd();
+	bool bEnd() const;
 };
 
 struct EpisodeHeader
 {
-	__int64 magicNumber = EPISODE_HEADER;
-	__int64 episodeType;
-	__int64 episodeIndex;
-	__int64 numVariablesLogged;
+	long long int magicNumber = EPISODE_HEADER;
+	long long int episodeType;
+	long long int episodeIndex;
+	long long int numVariablesLogged;
 
 	//Added in version 2: if the m_episodeIndex belongs to an evaluation, the number of episodes per evaluation might be >1
 	//the episodeSubIndex will be in [1..numEpisodesPerEvaluation]
-	__int64 episodeSubIndex;
+	long long int episodeSubIndex;
 
-	__int64 padding[HEADER_MAX_SIZE - 5]; //extra space
+	long long int padding[HEADER_MAX_SIZE - 5]; //extra space
 	EpisodeHeader()
 	{
 		memset(padding, 0, sizeof(padding));
 	}
 };
 
+//Index of an episode in the memory-mapped log file. All the steps in an episode have the same size, so only the
+//position of the first step and the number of steps are stored
 class Episode
 {
-	EpisodeHeader m_header;
-	vector<Step*> m_pSteps;
+	const EpisodeHeader* m_pHeader = nullptr;
+	const char* m_pFirstStep = nullptr;
+	size_t m_numSteps = 0;
+	size_t m_stepSize = 0;
 public:
 	Episode() { }
-	~Episode();
 
-	size_t getNumSteps() const { return m_pSteps.size(); }
-	Step* getStep(int i);
-	int getNumValuesPerStep() const { if (m_pSteps.size() == 0) return 0; return m_pSteps[0]->getNumValues(); }
-	double getSimTimeLength()const { if (m_pSteps.size() == 0) return 0.0; return m_pSteps[m_pSteps.size() - 1]->getEpisodeSimTime(); }
-	void load(FILE* pFile);
-};
+	size_t getNumSteps() const { return m_numSteps; }
+	Step getStep(int i) const;
+	int getNumValuesPerStep() const { if (!m_pHeader) return 0; return (int)m_pHeader->numVariablesLogged; }
+	double getSimTimeLength() const { if (m_numSteps == 0) return 0.0; return getStep((int)m_numSteps - 1).getEpisodeSimTime(); }
+
+	long long int getEpisodeType() const { return m_pHeader->episodeType; }
+	long long int getEpisodeIndex() const { return m_pHeader->episodeIndex; }
+	long long int getEpisodeSubIndex() const { return m_pHeader->episodeSubIndex; }
 
+	//Indexes the episode beginning at pData. Returns a pointer to the data following the episode, or nullptr if the
+	//episode is incomplete (i.e. the experiment was stopped or is still running)
+	const char* index(const char* pData, const char* pDataEnd);
+};
 
 struct ExperimentHeader
 {
-	__int64 magicNumber = EXPERIMENT_HEADER;
-	__int64 fileVersion = 0;
-	__int64 numEpisodes = 0;
+	long long int magicNumber = EXPERIMENT_HEADER;
+	long long int fileVersion = 0;
+	long long int numEpisodes = 0;
 
-	__int64 padding[HEADER_MAX_SIZE - 3]; //extra space
+	long long int padding[HEADER_MAX_SIZE - 3]; //extra space
 	ExperimentHeader()
 	{
 		memset(padding, 0, sizeof(padding));
@@ -97,57 +108,33 @@ struct ExperimentHeader
 
 
 
-#define MAX_FUNCTION_ID_LENGTH 128
-
-//using __int64 to assure C# data-type compatibility
-
-struct FunctionLogHeader
-{
-	__int64 magicNumber;
-	__int64 fileVersion;
-	__int64 numFunctions = 0;
-};
-
-
-struct FunctionDeclarationHeader
+//View of a function sample in the memory-mapped function log file. The values are only read from disk when decoded
+class FunctionSample
 {
-	__int64 magicNumber;
-	__int64 id;
-	char name[MAX_FUNCTION_ID_LENGTH];
-	__int64 numSamplesX;
-	__int64 numSamplesY;
-	__int64 numSamplesZ;
-};
+	const FunctionSampleHeader* m_pHeader;
+	const FunctionSampleEncodingHeader* m_pEncodingHeader;
+	const char* m_pValues;
+public:
+	//pEncodingHeader is null in version 1 files, where values are always saved in full as doubles
+	FunctionSample(const FunctionSampleHeader* pHeader, const FunctionSampleEncodingHeader* pEncodingHeader, const char* pValues);
 
+	//Size in bytes of the values of a sample with the given encoding
+	static size_t valuesSize(const FunctionSampleEncodingHeader* pEncodingHeader, size_t numValues);
 
+	//Whether the values are saved in full, so that they can be decoded without the previous sample
+	bool bFull() const;
+	//Decodes the values of the sample. Delta-encoded samples are applied over outValues, which must hold the values of
+	//the previous sample of the function
+	void decode(vector<double>& outValues) const;
 
-struct FunctionSampleHeader
-{
-	__int64 magicNumber;
-	__int64 episode;
-	__int64 step;
-	__int64 experimentStep;
-	__int64 id;
-};
-
-class FunctionSample
-{
-	size_t m_episode, m_step, m_experimentStep;
-	vector<double> m_values;
-public:
-	FunctionSample(size_t episode, size_t step, size_t experimentStep, size_t numSamples);
-	~FunctionSample();
-
-	vector<double>& values() { return m_values; }
-	double value(size_t index) { return m_values[index]; }
-	size_t episode() { return m_episode; }
-	size_t step() { return m_step; }
-	size_t experimentStep() { return m_experimentStep; }
+	size_t episode() const { return (size_t)m_pHeader->episode; }
+	size_t step() const { return (size_t)m_pHeader->step; }
+	size_t experimentStep() const { return (size_t)m_pHeader->experimentStep; }
 };
 
 class Function
 {
-	vector<FunctionSample*> m_samples;
+	vector<FunctionSample> m_samples;
 	size_t m_numSamplesX = 0;
 	size_t m_numSamplesY = 0;
 	size_t m_numSamplesZ = 0;
@@ -155,6 +142,11 @@ class Function
 
 	int m_lastInterpolatedEpisode = -1; //set -1 to mark it as "not yet done"
 	vector<double> m_interpolatedValues;
+
+	//the last sample decoded, so that consecutive samples are decoded from it
+	int m_lastDecodedSample = -1;
+	vector<double> m_decodedValues;
+	vector<double> m_previousValues;
 public:
 	Function(string name, size_t numSamplesX, size_t numSamplesY, size_t numSamplesZ);
 	~Function();
@@ -164,12 +156,17 @@ public:
 	size_t numSamplesX() const { return m_numSamplesX; }
 	size_t numSamplesY() const { return m_numSamplesY; }
 	size_t numSamplesZ() const { return m_numSamplesZ; }
+	size_t numSavedSamples() const { return m_samples.size(); }
+	const FunctionSample& getSavedSample(size_t i) const { return m_samples[i]; }
+	//Reconstructs the values of the i-th saved sample. The reference is valid until the next call
+	const vector<double>& getSavedSampleValues(size_t i);
 	const vector<double>& getInterpolatedData(size_t episode, size_t step, bool &dataChanged);
-	void addSample(FunctionSample* functionSample) { m_samples.push_back(functionSample); }
+	void addSample(const FunctionSample& functionSample) { m_samples.push_back(functionSample); }
 };
 
 class FunctionLog
 {
+	MemoryMappedFile m_file;
 	vector<Function*> m_functions;
 public:
 	FunctionLog() {}
@@ -179,10 +176,13 @@ public:
 };
 
 
+//Experiment log loaded from a memory-mapped file: loading only indexes the episodes and no step data is copied, so
+//logs bigger than the available memory can be opened. The OS reads the pages of the file as they are accessed
 class ExperimentLog
 {
-	ExperimentHeader m_header;
-	Episode *m_pEpisodes = 0;
+	MemoryMappedFile m_logFile;
+	const ExperimentHeader* m_pHeader = nullptr;
+	vector<Episode> m_episodes;
 
 	Descriptor m_descriptor;
 
@@ -196,8 +196,10 @@ public:
 	ExperimentLog() { }
 	~ExperimentLog();
 
-	int getNumEpisodes() const { return (int) m_header.numEpisodes; }
-	Episode* getEpisode(int i) { return &m_pEpisodes[i]; }
+	//Number of complete episodes in the log file. It may be lower than the number of episodes in the experiment header
+	//if the experiment didn't finish
+	int getNumEpisodes() const { return (int) m_episodes.size(); }
+	Episode* getEpisode(int i) { if (i < 0 || i >= (int) m_episodes.size()) return nullptr; return &m_episodes[i]; }
 
 	int getVariableIndex(string variableName) const;
 
@@ -204,11 +204,11 @@ bool SimionLogViewer::loadLogFile(string filename)
 		m_pRenderer->setDataFolder("../config/scenes/");
 		m_pRenderer->loadScene(sceneFile.c_str());
 
-		//allocate a step object to store the interpolated data
+		//allocate a buffer to store the interpolated data
 		Episode* pFirstEpisode = m_pExperimentLog->getEpisode(0);
 		if (pFirstEpisode)
 		{
-			m_pInterpolatedStep = new Step(pFirstEpisode->getNumValuesPerStep());
+			m_interpolatedValues = vector<double>(pFirstEpisode->getNumValuesPerStep());
 			m_numEpisodes = m_pExperimentLog->getNumEpisodes();
 		}
 		else return false;
@@ -276,16 +276,18 @@ bool SimionLogViewer::loadLogFile(string filename)
 }
 
 
-void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, Step* pOutInterpolatedData) const
+void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, vector<double>& outInterpolatedData) const
 {
 	int step = 0;
 
-	while (step<pInEpisode->getNumSteps() - 1 && t>pInEpisode->getStep(step + 1)->getEpisodeSimTime())
+	while (step<pInEpisode->getNumSteps() - 1 && t>pInEpisode->getStep(step + 1).getEpisodeSimTime())
 		++step;
 
+	Step step0 = pInEpisode->getStep(step);
+	Step step1 = pInEpisode->getStep(step + 1);
 	double t1, t0;
-	t0 = pInEpisode->getStep(step)->getEpisodeSimTime();
-	t1 = pInEpisode->getStep(step + 1)->getEpisodeSimTime();
+	t0 = step0.getEpisodeSimTime();
+	t1 = step1.getEpisodeSimTime();
 
 	double u = (std::max(0.0, t - t0) / (t1 - t0));
 	double v0, v1, interpolatedValue;
@@ -294,10 +296,10 @@ void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, Step* p
 
 	Descriptor& descriptor = m_pExperimentLog->getDescriptor();
 
-	for (int i = 0; i < pInEpisode->getStep(0)->getNumValues(); ++i)
+	for (int i = 0; i < pInEpisode->getNumValuesPerStep(); ++i)
 	{
-		v0 = pInEpisode->getStep(step)->getValue(i);
-		v1 = pInEpisode->getStep(step + 1)->getValue(i);
+		v0 = step0.getValue(i);
+		v1 = step1.getValue(i);
 		//if the variable is circular and the two values lay on opposite sides of the range, make them closer
 		if (descriptor[i].isCircular() && abs(v0 - v1) > descriptor[i].getRangeWidth()*0.8)
 		{
@@ -310,7 +312,7 @@ void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, Step* p
 				printf("jump");
 		}
 		interpolatedValue = (1 - u)*v0 + (u)*v1;
-		pOutInterpolatedData->setValue(i, interpolatedValue);
+		outInterpolatedData[i] = interpolatedValue;
 	}
 }
 
@@ -339,19 +341,19 @@ void SimionLogViewer::draw()
 	m_pPlaybackRateText->set(string("Rate: ") + to_string_with_precision(playbackRate, 2));
 
 	//interpolate logged data between saved points
-	interpolateStepData(m_episodeSimTime, m_pCurrentEpisode, m_pInterpolatedStep);
+	interpolateStepData(m_episodeSimTime, m_pCurrentEpisode, m_interpolatedValues);
 
 	//update variable meters
 	Descriptor& logDescriptor = m_pExperimentLog->getDescriptor();
 	for (int i = 0; i < logDescriptor.size(); i++)
-		m_variableMeters[i]->setValue(m_pInterpolatedStep->getValue(i));
+		m_variableMeters[i]->setValue(m_interpolatedValues[i]);
 
 	//update bindings
 	for (int b = 0; b < m_pRenderer->getNumBindings(); ++b)
 	{
 		string varName = m_pRenderer->getBindingExternalName(b);
 		int variableIndex = m_pExperimentLog->getVariableIndex(varName);
-		value = m_pInterpolatedStep->getValue(variableIndex);
+		value = (variableIndex >= 0) ? m_interpolatedValues[variableIndex] : 0.0;
 
 		m_pRenderer->updateBinding(varName, value);
 	}
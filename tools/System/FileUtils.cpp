@@ -86,10 +86,21 @@ bool bFileExists(const string& filename)
 	return (stat(filename.c_str(), &buffer) == 0);
 }
 
+bool bIsDirectory(const string& path)
+{
+	struct stat buffer;
+	return stat(path.c_str(), &buffer) == 0 && (buffer.st_mode & S_IFDIR) != 0;
+}
+
 #if defined(_WIN32) || defined(_WIN64)
 #include <direct.h>
+#define WINDOWS_MEAN_AND_LEAN
+#include <windows.h>
+#undef min
+#undef max
 #else
 #include <unistd.h>
+#include <dirent.h>
 #endif
 
 bool changeWorkingDirectory(const string& directory)
@@ -99,4 +110,62 @@ bool changeWorkingDirectory(const string& directory)
 #else
 	return chdir(directory.c_str()) == 0;
 #endif
-}
\ No newline at end of file
+}
+
+static bool endsWith(const string& s, const string& suffix)
+{
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void findFiles(const string& directory, const string& suffix, vector<string>& outFiles, bool bRecursive)
+{
+	size_t numPreviousFiles = outFiles.size();
+	string path = directory;
+	if (!path.empty() && path.back() != '/' && path.back() != '\\')
+		path += "/";
+
+#if defined(_WIN32) || defined(_WIN64)
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA((path + "*").c_str(), &findData);
+	if (findHandle == INVALID_HANDLE_VALUE)
+		return;
+	do
+	{
+		string name = findData.cFileName;
+		if (name == "." || name == "..")
+			continue;
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			if (bRecursive)
+				findFiles(path + name, suffix, outFiles, bRecursive);
+		}
+		else if (endsWith(name, suffix))
+			outFiles.push_back(path + name);
+	} while (FindNextFileA(findHandle, &findData));
+	FindClose(findHandle);
+#else
+	DIR* pDir = opendir(path.c_str());
+	if (!pDir)
+		return;
+	struct dirent* pEntry;
+	while ((pEntry = readdir(pDir)) != nullptr)
+	{
+		string name = pEntry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		struct stat fileInfo;
+		if (stat((path + name).c_str(), &fileInfo) != 0)
+			continue;
+		if (S_ISDIR(fileInfo.st_mode))
+		{
+			if (bRecursive)
+				findFiles(path + name, suffix, outFiles, bRecursive);
+		}
+		else if (endsWith(name, suffix))
+			outFiles.push_back(path + name);
+	}
+	closedir(pDir);
+#endif
+	//directory listings are not sorted on every platform
+	std::sort(outFiles.begin() + numPreviousFiles, outFiles.end());
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 using namespace std;
 
 size_t getLastBarPos(const string& s);
@@ -8,5 +9,9 @@ string getDirectory(const string& filename);
 string removeExtension(const string& filename, unsigned int numExtensions = 1);
 string getFilename(const string& filepath);
 bool bFileExists(const string& filename);
+bool bIsDirectory(const string& path);
+
+//Appends to outFiles the path of every file in directory (and its subdirectories if bRecursive) whose name ends with suffix
+void findFiles(const string& directory, const string& suffix, vector<string>& outFiles, bool bRecursive = true);
 
 bool changeWorkingDirectory(const string& directory);
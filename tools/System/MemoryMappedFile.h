@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+
+//Read-only view of a whole file mapped in memory. The OS pages the contents in on demand, so opening big files is
+//cheap and only the parts actually accessed are read from disk
+class MemoryMappedFile
+{
+	const char* m_pData = nullptr;
+	size_t m_size = 0;
+
+	//platform-dependent handles
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+	int m_fileDescriptor = -1;
+public:
+	MemoryMappedFile();
+	virtual ~MemoryMappedFile();
+	//copies would unmap the same view twice
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	//Maps the whole file. Returns false if the file couldn't be opened or mapped. Empty files can't be mapped
+	bool open(const char* filename);
+	void close();
+
+	bool isOpen() const { return m_pData != nullptr; }
+	const char* data() const { return m_pData; }
+	size_t size() const { return m_size; }
+
+	//Hints the OS that the file is going to be read sequentially so that it reads ahead more aggressively
+	void adviseSequentialAccess();
+};
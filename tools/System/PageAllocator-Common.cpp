@@ -0,0 +1,71 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "PageAllocator.h"
+
+PageAllocator::PageAllocator(bool bHugePages, NumaPolicy numaPolicy, int numaNode)
+	: m_bHugePages(bHugePages), m_numaPolicy(numaPolicy), m_numaNode(numaNode)
+{
+}
+
+size_t PageAllocator::getAllocationSize(size_t size) const
+{
+	//huge pages can only be used if the size is a multiple of their size
+	if (m_bHugePages && size >= HUGE_PAGE_SIZE)
+		return ((size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+	return size;
+}
+
+void* PageAllocator::allocate(size_t size)
+{
+	if (size == 0)
+		return nullptr;
+
+	size_t allocationSize = getAllocationSize(size);
+	bool bHugePages = m_bHugePages && size >= HUGE_PAGE_SIZE;
+	void* pAddress = allocatePages(allocationSize, bHugePages);
+	if (!pAddress)
+		return nullptr;
+
+	m_allocatedBytes += allocationSize;
+	if (bHugePages)
+		m_hugePageBytes += allocationSize;
+	m_allocations[pAddress] = { allocationSize, bHugePages };
+	return pAddress;
+}
+
+void PageAllocator::free(void* pAddress)
+{
+	auto it = m_allocations.find(pAddress);
+	if (it == m_allocations.end())
+		return;
+
+	freePages(pAddress, it->second.size);
+
+	m_allocatedBytes -= it->second.size;
+	if (it->second.bHugePages)
+		m_hugePageBytes -= it->second.size;
+	m_allocations.erase(it);
+}
@@ -0,0 +1,144 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "PageAllocator.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+
+//mbind() is called through syscall() so that libnuma isn't required
+#define MPOL_BIND_MODE 2
+#define MPOL_INTERLEAVE_MODE 3
+#define MAX_NUMA_NODES 1024
+#define BITS_PER_MASK_WORD (8 * sizeof(unsigned long))
+
+int PageAllocator::getNumNumaNodes()
+{
+	static int numNodes = 0;
+	if (numNodes == 0)
+	{
+		//the online nodes are listed as ranges: "0", "0-3", "0-1,4"...
+		int maxNode = 0;
+		FILE* pFile = fopen("/sys/devices/system/node/online", "r");
+		if (pFile)
+		{
+			int first, last;
+			char separator;
+			while (fscanf(pFile, "%d", &first) == 1)
+			{
+				last = first;
+				separator = (char)fgetc(pFile);
+				if (separator == '-' && fscanf(pFile, "%d", &last) == 1)
+					separator = (char)fgetc(pFile);
+				if (last > maxNode)
+					maxNode = last;
+				if (separator != ',')
+					break;
+			}
+			fclose(pFile);
+		}
+		numNodes = maxNode + 1 < MAX_NUMA_NODES ? maxNode + 1 : MAX_NUMA_NODES;
+	}
+	return numNodes;
+}
+
+static bool bTransparentHugePagesEnabled()
+{
+	static int enabled = -1;
+	if (enabled < 0)
+	{
+		//the selected mode is enclosed in brackets: "always [madvise] never"
+		char mode[128] = {};
+		FILE* pFile = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+		if (pFile)
+		{
+			if (!fgets(mode, sizeof(mode), pFile))
+				mode[0] = 0;
+			fclose(pFile);
+		}
+		enabled = (mode[0] != 0 && !strstr(mode, "[never]")) ? 1 : 0;
+	}
+	return enabled == 1;
+}
+
+void* PageAllocator::allocatePages(size_t size, bool& bHugePages)
+{
+	void* pAddress = MAP_FAILED;
+	if (bHugePages)
+	{
+		//explicit huge pages are only available if they have been reserved (vm.nr_hugepages)
+		pAddress = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (pAddress == MAP_FAILED)
+		{
+			//transparent huge pages: map a region aligned to the size of huge pages and advise the kernel to use them
+			char* pRegion = (char*)mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS
+				, -1, 0);
+			if (pRegion != (char*)MAP_FAILED)
+			{
+				size_t misalignment = (size_t)pRegion % HUGE_PAGE_SIZE;
+				size_t head = misalignment == 0 ? 0 : HUGE_PAGE_SIZE - misalignment;
+				if (head > 0)
+					munmap(pRegion, head);
+				munmap(pRegion + head + size, HUGE_PAGE_SIZE - head);
+				pAddress = pRegion + head;
+				bHugePages = madvise(pAddress, size, MADV_HUGEPAGE) == 0 && bTransparentHugePagesEnabled();
+			}
+		}
+	}
+	else
+		pAddress = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (pAddress == MAP_FAILED)
+		return nullptr;
+
+	//the policy must be set before the pages are touched for the first time
+	if (m_numaPolicy != NumaPolicy::Local)
+	{
+		unsigned long nodeMask[MAX_NUMA_NODES / BITS_PER_MASK_WORD] = {};
+		int mode;
+		if (m_numaPolicy == NumaPolicy::Bind)
+		{
+			mode = MPOL_BIND_MODE;
+			int node = m_numaNode >= 0 && m_numaNode < getNumNumaNodes() ? m_numaNode : 0;
+			nodeMask[node / BITS_PER_MASK_WORD] |= 1ul << (node % BITS_PER_MASK_WORD);
+		}
+		else
+		{
+			mode = MPOL_INTERLEAVE_MODE;
+			for (int node = 0; node < getNumNumaNodes(); ++node)
+				nodeMask[node / BITS_PER_MASK_WORD] |= 1ul << (node % BITS_PER_MASK_WORD);
+		}
+		//if the policy can't be set, the memory is still valid and pages are placed with the default policy
+		syscall(SYS_mbind, pAddress, size, mode, nodeMask, (unsigned long)MAX_NUMA_NODES, 0);
+	}
+	return pAddress;
+}
+
+void PageAllocator::freePages(void* pAddress, size_t size)
+{
+	munmap(pAddress, size);
+}
@@ -0,0 +1,98 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "PageAllocator.h"
+
+#define WINDOWS_MEAN_AND_LEAN
+#include <windows.h>
+#undef min
+#undef max
+
+int PageAllocator::getNumNumaNodes()
+{
+	static int numNodes = 0;
+	if (numNodes == 0)
+	{
+		ULONG highestNode = 0;
+		if (!GetNumaHighestNodeNumber(&highestNode))
+			highestNode = 0;
+		numNodes = (int)highestNode + 1;
+	}
+	return numNodes;
+}
+
+//Large pages require the "Lock pages in memory" privilege (SeLockMemoryPrivilege) to be granted to the user. It
+//needs to be enabled in the process token before large pages can be allocated
+static bool bLargePagesAvailable()
+{
+	static int available = -1;
+	if (available < 0)
+	{
+		available = 0;
+		HANDLE token;
+		if (GetLargePageMinimum() > 0
+			&& OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		{
+			TOKEN_PRIVILEGES privileges;
+			privileges.PrivilegeCount = 1;
+			privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+			if (LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid)
+				&& AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL)
+				&& GetLastError() == ERROR_SUCCESS)
+				available = 1;
+			CloseHandle(token);
+		}
+	}
+	return available == 1;
+}
+
+void* PageAllocator::allocatePages(size_t size, bool& bHugePages)
+{
+	//Windows has no interleaved policy: with Interleave, each allocation is placed on the next node
+	DWORD node = NUMA_NO_PREFERRED_NODE;
+	if (m_numaPolicy == NumaPolicy::Bind)
+		node = (DWORD)(m_numaNode >= 0 && m_numaNode < getNumNumaNodes() ? m_numaNode : 0);
+	else if (m_numaPolicy == NumaPolicy::Interleave)
+	{
+		node = (DWORD)m_nextNumaNode;
+		m_nextNumaNode = (m_nextNumaNode + 1) % getNumNumaNodes();
+	}
+
+	void* pAddress = nullptr;
+	if (bHugePages && bLargePagesAvailable() && size % GetLargePageMinimum() == 0)
+	{
+		pAddress = VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES
+			, PAGE_READWRITE, node);
+	}
+	bHugePages = pAddress != nullptr;
+	if (!pAddress)
+		pAddress = VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+	return pAddress;
+}
+
+void PageAllocator::freePages(void* pAddress, size_t size)
+{
+	VirtualFree(pAddress, 0, MEM_RELEASE);
+}
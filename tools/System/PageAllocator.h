@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <unordered_map>
+
+//Placement of the pages on the NUMA nodes of the system:
+// - Local: the OS default. Each page lands on the node of the first thread that writes it (first-touch)
+// - Bind: all the pages are placed on a given node
+// - Interleave: pages are distributed round-robin across all the nodes
+enum class NumaPolicy { Local, Bind, Interleave };
+
+//Allocates memory directly from the OS in whole pages instead of using the heap. Optionally, the memory is backed by
+//2MB huge pages, which reduces TLB misses when big buffers are accessed at random positions, and placed on the NUMA
+//nodes with a given policy. If huge pages can't be used, it falls back to regular pages. Allocations smaller than a huge
+//page always use regular pages, and bigger ones are rounded up to a whole number of huge pages.
+//The memory is not touched when allocated, so the threads that initialize it decide where pages land with the Local
+//policy
+class PageAllocator
+{
+	bool m_bHugePages = false;
+	NumaPolicy m_numaPolicy = NumaPolicy::Local;
+	int m_numaNode = 0;
+
+	size_t m_allocatedBytes = 0;
+	size_t m_hugePageBytes = 0;
+	//the size actually mapped for each allocation and whether huge pages were used, so that they are freed the same way
+	//even if the options change in between
+	struct Allocation
+	{
+		size_t size;
+		bool bHugePages;
+	};
+	std::unordered_map<void*, Allocation> m_allocations;
+	int m_nextNumaNode = 0;
+
+	size_t getAllocationSize(size_t size) const;
+	//platform-dependent. On input, bHugePages tells whether huge pages should be tried. On output, whether they were used
+	void* allocatePages(size_t size, bool& bHugePages);
+	void freePages(void* pAddress, size_t size);
+public:
+	static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+	PageAllocator() = default;
+	PageAllocator(bool bHugePages, NumaPolicy numaPolicy = NumaPolicy::Local, int numaNode = 0);
+
+	static int getNumNumaNodes();
+
+	void setHugePages(bool bHugePages) { m_bHugePages = bHugePages; }
+	bool bHugePages() const { return m_bHugePages; }
+	//node is only used by the Bind policy
+	void setNumaPolicy(NumaPolicy policy, int node = 0) { m_numaPolicy = policy; m_numaNode = node; }
+	NumaPolicy getNumaPolicy() const { return m_numaPolicy; }
+	int getNumaNode() const { return m_numaNode; }
+
+	//Returns nullptr if the memory couldn't be allocated
+	void* allocate(size_t size);
+	void free(void* pAddress);
+
+	//Bytes currently allocated, and how many of them were allocated with huge pages. Under Linux, transparent huge
+	//pages are counted if the kernel was advised to use them: it may still use regular pages if it can't find free
+	//huge pages
+	size_t getAllocatedBytes() const { return m_allocatedBytes; }
+	size_t getHugePageBytes() const { return m_hugePageBytes; }
+};
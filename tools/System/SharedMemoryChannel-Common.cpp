@@ -0,0 +1,303 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "SharedMemoryChannel.h"
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <thread>
+#include <chrono>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define CPU_PAUSE() _mm_pause()
+#else
+#define CPU_PAUSE()
+#endif
+
+#define NUM_SPIN_ITERATIONS 4000	//iterations a reader/writer spins before blocking
+#define BLOCK_TIMEOUT_MS 100		//blocked readers/writers check whether the other process is still alive this often
+
+//the layout of the shared memory must be the same in 32 and 64 bit processes (FAST is a 32 bit process)
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "Shared memory channels require lock-free atomics");
+
+#define DATA_SIGNAL 0
+#define SPACE_SIGNAL 1
+
+SharedMemoryChannel::SharedMemoryChannel()
+{
+	m_fullName[0] = 0;
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+}
+
+void SharedMemoryChannel::logMessage(const char* message)
+{
+	if (m_bVerbose)
+	{
+		std::cout << message << "\n";
+	}
+}
+
+bool SharedMemoryChannel::isConnected()
+{
+	if (!m_pHeader)
+		return false;
+	if (m_bServer)
+		return m_pHeader->clientProcessId.load() != 0;
+	return true;
+}
+
+bool SharedMemoryChannel::isPeerConnected()
+{
+	if (!m_pHeader)
+		return false;
+	if (m_bServer)
+	{
+		if (m_pHeader->clientProcessId.load() == 0 || m_pHeader->bClientClosed.load())
+			return false;
+	}
+	else if (m_pHeader->bServerClosed.load())
+		return false;
+	return isPeerAlive();
+}
+
+std::atomic<unsigned int>* SharedMemoryChannel::getSignal(int signal)
+{
+	return &m_pHeader->rings[signal / 2].signals[signal % 2];
+}
+
+void SharedMemoryChannel::notify(int ringIndex, int signalType)
+{
+	//the position has already been updated (seq_cst), so either we see the other side waiting or it sees the update
+	SharedMemoryRing& ring = m_pHeader->rings[ringIndex];
+	if (ring.numWaiting[signalType].load())
+	{
+		ring.signals[signalType].fetch_add(1);
+		wakeUpSignal(ringIndex * 2 + signalType);
+	}
+}
+
+template <typename Condition>
+bool SharedMemoryChannel::waitUntil(int ringIndex, int signalType, Condition condition)
+{
+	//spin first: the other side usually answers in a few microseconds and blocking costs two context switches.
+	//With a single CPU, spinning only delays the other side, so we block right away
+	static const int numSpinIterations = std::thread::hardware_concurrency() > 1 ? NUM_SPIN_ITERATIONS : 0;
+	for (int i = 0; i < numSpinIterations; ++i)
+	{
+		if (condition())
+			return true;
+		CPU_PAUSE();
+	}
+
+	SharedMemoryRing& ring = m_pHeader->rings[ringIndex];
+	while (true)
+	{
+		ring.numWaiting[signalType].store(1);
+		unsigned int signalValue = ring.signals[signalType].load();
+		if (condition() || !isPeerConnected())
+			break;
+		waitForSignal(ringIndex * 2 + signalType, signalValue, BLOCK_TIMEOUT_MS);
+	}
+	ring.numWaiting[signalType].store(0);
+	return condition();
+}
+
+int SharedMemoryChannel::writeBuffer(const void* pBuffer, int numBytes)
+{
+	if (!m_pHeader)
+	{
+		logMessage("Error: couldn't write on shared memory channel");
+		return 0;
+	}
+	SharedMemoryRing& ring = m_pHeader->rings[outgoingRingIndex()];
+	const char* pData = (const char*)pBuffer;
+	int numBytesWritten = 0;
+	while (numBytesWritten < numBytes)
+	{
+		unsigned long long writePos = ring.writePos.load(std::memory_order_relaxed);
+		auto freeSpace = [&]() { return SHARED_MEMORY_RING_SIZE - (size_t)(writePos - ring.readPos.load()); };
+		if (!waitUntil(outgoingRingIndex(), SPACE_SIGNAL, [&]() { return freeSpace() > 0; }))
+			break;
+
+		size_t numBytesToCopy = std::min(freeSpace(), (size_t)(numBytes - numBytesWritten));
+		size_t offset = (size_t)(writePos % SHARED_MEMORY_RING_SIZE);
+		size_t firstPieceSize = std::min(numBytesToCopy, SHARED_MEMORY_RING_SIZE - offset);
+		memcpy(ring.buffer + offset, pData + numBytesWritten, firstPieceSize);
+		if (firstPieceSize < numBytesToCopy)
+			memcpy(ring.buffer, pData + numBytesWritten + firstPieceSize, numBytesToCopy - firstPieceSize);
+
+		ring.writePos.store(writePos + numBytesToCopy);
+		notify(outgoingRingIndex(), DATA_SIGNAL);
+		numBytesWritten += (int)numBytesToCopy;
+	}
+	return numBytesWritten;
+}
+
+int SharedMemoryChannel::readToBuffer(void *pBuffer, int numBytes)
+{
+	if (!m_pHeader)
+	{
+		logMessage("Error: couldn't read from shared memory channel because it's closed");
+		return 0;
+	}
+	SharedMemoryRing& ring = m_pHeader->rings[incomingRingIndex()];
+	char* pData = (char*)pBuffer;
+	int numBytesRead = 0;
+	while (numBytesRead < numBytes)
+	{
+		unsigned long long readPos = ring.readPos.load(std::memory_order_relaxed);
+		auto availableData = [&]() { return (size_t)(ring.writePos.load() - readPos); };
+		if (!waitUntil(incomingRingIndex(), DATA_SIGNAL, [&]() { return availableData() > 0; }))
+			break;
+
+		size_t numBytesToCopy = std::min(availableData(), (size_t)(numBytes - numBytesRead));
+		size_t offset = (size_t)(readPos % SHARED_MEMORY_RING_SIZE);
+		size_t firstPieceSize = std::min(numBytesToCopy, SHARED_MEMORY_RING_SIZE - offset);
+		memcpy(pData + numBytesRead, ring.buffer + offset, firstPieceSize);
+		if (firstPieceSize < numBytesToCopy)
+			memcpy(pData + numBytesRead + firstPieceSize, ring.buffer, numBytesToCopy - firstPieceSize);
+
+		ring.readPos.store(readPos + numBytesToCopy);
+		notify(incomingRingIndex(), SPACE_SIGNAL);
+		numBytesRead += (int)numBytesToCopy;
+	}
+	return numBytesRead;
+}
+
+
+//SharedMemoryChannelServer
+#define NUM_MAX_CHANNEL_SERVERS_PER_MACHINE 100
+#define SHARED_MEMORY_MAGIC_NUMBER 0x53484d43
+
+SharedMemoryChannelServer::SharedMemoryChannelServer()
+{
+	m_bServer = true;
+}
+
+SharedMemoryChannelServer::~SharedMemoryChannelServer()
+{
+	closeServer();
+}
+
+bool SharedMemoryChannelServer::openUniqueChannelServer(const char* name)
+{
+	closeServer();
+
+	bool bCreated = false;
+	for (int id = 0; id < NUM_MAX_CHANNEL_SERVERS_PER_MACHINE && !bCreated; ++id)
+	{
+		setName(name, true, id);
+		bCreated = createSharedMemory();
+	}
+	if (!bCreated)
+	{
+		logMessage("Error: couldn't create shared memory channel server");
+		return false;
+	}
+
+	//the memory is zero-initialized by the OS
+	m_pHeader->magicNumber = SHARED_MEMORY_MAGIC_NUMBER;
+	m_pHeader->serverProcessId.store(getCurrentProcessId());
+	logMessage("Shared memory channel server created");
+	return true;
+}
+
+bool SharedMemoryChannelServer::waitForClientConnection(int timeoutMs)
+{
+	for (int elapsedMs = 0; m_pHeader && elapsedMs < timeoutMs; ++elapsedMs)
+	{
+		if (m_pHeader->clientProcessId.load() != 0)
+			return openPeerProcess();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+void SharedMemoryChannelServer::closeServer()
+{
+	if (!m_pHeader)
+		return;
+
+	logMessage("Destroying shared memory channel server");
+	m_pHeader->bServerClosed.store(1);
+	//wake up the client if it is blocked
+	for (int signal = 0; signal < 4; ++signal)
+	{
+		getSignal(signal)->fetch_add(1);
+		wakeUpSignal(signal);
+	}
+	closeSharedMemory();
+}
+
+
+//SharedMemoryChannelClient
+SharedMemoryChannelClient::SharedMemoryChannelClient()
+{
+	m_bServer = false;
+}
+
+SharedMemoryChannelClient::~SharedMemoryChannelClient()
+{
+	closeConnection();
+}
+
+bool SharedMemoryChannelClient::connectToServer(const char* name, bool bAddPrefix)
+{
+	closeConnection();
+
+	setName(name, bAddPrefix);
+	if (!openSharedMemory())
+	{
+		logMessage("Error: Client couldn't open the shared memory channel");
+		return false;
+	}
+	if (m_pHeader->magicNumber != SHARED_MEMORY_MAGIC_NUMBER || !openPeerProcess())
+	{
+		logMessage("Error: Client couldn't connect to shared memory channel server");
+		closeSharedMemory();
+		return false;
+	}
+	m_pHeader->clientProcessId.store(getCurrentProcessId());
+	logMessage("Client connected to shared memory channel server");
+	return true;
+}
+
+void SharedMemoryChannelClient::closeConnection()
+{
+	if (!m_pHeader)
+		return;
+
+	m_pHeader->bClientClosed.store(1);
+	//wake up the server if it is blocked
+	for (int signal = 0; signal < 4; ++signal)
+	{
+		getSignal(signal)->fetch_add(1);
+		wakeUpSignal(signal);
+	}
+	closeSharedMemory();
+}
@@ -0,0 +1,137 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "SharedMemoryChannel.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+void SharedMemoryChannel::setName(const char* name, bool bAddPrefix, int id)
+{
+	//POSIX shared memory objects are named "/name"
+	const char* prefix = bAddPrefix ? "/" : "";
+	if (id < 0)
+		snprintf(m_fullName, MAX_SHARED_MEMORY_NAME_SIZE, "%s%s", prefix, name);
+	else
+		snprintf(m_fullName, MAX_SHARED_MEMORY_NAME_SIZE, "%s%s-%d", prefix, name, id);
+}
+
+bool SharedMemoryChannel::createSharedMemory()
+{
+	int fileDescriptor = shm_open(m_fullName, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if (fileDescriptor < 0)
+		return false;
+
+	if (ftruncate(fileDescriptor, sizeof(SharedMemoryChannelHeader)) != 0)
+	{
+		close(fileDescriptor);
+		shm_unlink(m_fullName);
+		return false;
+	}
+	void* pMemory = mmap(nullptr, sizeof(SharedMemoryChannelHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+	//the mapping is kept after closing the descriptor
+	close(fileDescriptor);
+	if (pMemory == MAP_FAILED)
+	{
+		shm_unlink(m_fullName);
+		return false;
+	}
+	m_pHeader = (SharedMemoryChannelHeader*)pMemory;
+	return true;
+}
+
+bool SharedMemoryChannel::openSharedMemory()
+{
+	int fileDescriptor = shm_open(m_fullName, O_RDWR, 0);
+	if (fileDescriptor < 0)
+		return false;
+
+	struct stat fileInfo;
+	if (fstat(fileDescriptor, &fileInfo) != 0 || (size_t)fileInfo.st_size < sizeof(SharedMemoryChannelHeader))
+	{
+		close(fileDescriptor);
+		return false;
+	}
+	void* pMemory = mmap(nullptr, sizeof(SharedMemoryChannelHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+	close(fileDescriptor);
+	if (pMemory == MAP_FAILED)
+		return false;
+	m_pHeader = (SharedMemoryChannelHeader*)pMemory;
+	return true;
+}
+
+void SharedMemoryChannel::closeSharedMemory()
+{
+	if (m_pHeader)
+	{
+		munmap(m_pHeader, sizeof(SharedMemoryChannelHeader));
+		m_pHeader = nullptr;
+	}
+	//the name is removed by the server. The memory is freed once the client unmaps it too
+	if (m_bServer)
+		shm_unlink(m_fullName);
+}
+
+bool SharedMemoryChannel::openPeerProcess()
+{
+	//there is no handle to open: processes are checked using their id
+	return isPeerAlive();
+}
+
+bool SharedMemoryChannel::isPeerAlive()
+{
+	unsigned int processId = m_bServer ? m_pHeader->clientProcessId.load() : m_pHeader->serverProcessId.load();
+	if (processId == 0)
+		return false;
+	return kill((pid_t)processId, 0) == 0 || errno == EPERM;
+}
+
+unsigned int SharedMemoryChannel::getCurrentProcessId()
+{
+	return (unsigned int)getpid();
+}
+
+void SharedMemoryChannel::waitForSignal(int signal, unsigned int expectedValue, int timeoutMs)
+{
+	//shared futex (not FUTEX_PRIVATE_FLAG) because the word is shared with another process
+	struct timespec timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+	syscall(SYS_futex, (unsigned int*)getSignal(signal), FUTEX_WAIT, expectedValue, &timeout, nullptr, 0);
+}
+
+void SharedMemoryChannel::wakeUpSignal(int signal)
+{
+	syscall(SYS_futex, (unsigned int*)getSignal(signal), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
@@ -0,0 +1,171 @@
+/*
+	SimionZoo: A framework for online model-free Reinforcement Learning on continuous
+	control problems
+
+	Copyright (c) 2016 SimionSoft. https://github.com/simionsoft
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "SharedMemoryChannel.h"
+#include <Windows.h>
+#include <stdio.h>
+
+#define INVALID_HANDLE (long long int)-1
+
+void SharedMemoryChannel::setName(const char* name, bool bAddPrefix, int id)
+{
+	//named objects in the session namespace: no special privileges are needed to create them
+	const char* prefix = bAddPrefix ? "Local\\" : "";
+	if (id < 0)
+		sprintf_s(m_fullName, "%s%s", prefix, name);
+	else
+		sprintf_s(m_fullName, "%s%s-%d", prefix, name, id);
+}
+
+//Windows has no inter-process futex, so each signal has an auto-reset named event
+static HANDLE openSignalEvent(const char* channelName, int signal)
+{
+	char eventName[MAX_SHARED_MEMORY_NAME_SIZE + 16];
+	sprintf_s(eventName, "%s-signal-%d", channelName, signal);
+	return CreateEventA(NULL, FALSE, FALSE, eventName);
+}
+
+static bool openSignalEvents(const char* channelName, long long int* pEventHandles)
+{
+	for (int signal = 0; signal < 4; ++signal)
+	{
+		HANDLE eventHandle = openSignalEvent(channelName, signal);
+		if (eventHandle == NULL)
+			return false;
+		pEventHandles[signal] = (long long int)eventHandle;
+	}
+	return true;
+}
+
+bool SharedMemoryChannel::createSharedMemory()
+{
+	HANDLE mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0
+		, (DWORD)sizeof(SharedMemoryChannelHeader), m_fullName);
+	if (mappingHandle == NULL)
+		return false;
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		//used by another server
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	void* pMemory = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedMemoryChannelHeader));
+	if (pMemory == NULL)
+	{
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	m_mappingHandle = (long long int)mappingHandle;
+	m_pHeader = (SharedMemoryChannelHeader*)pMemory;
+
+	if (!openSignalEvents(m_fullName, m_eventHandles))
+	{
+		closeSharedMemory();
+		return false;
+	}
+	return true;
+}
+
+bool SharedMemoryChannel::openSharedMemory()
+{
+	HANDLE mappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, m_fullName);
+	if (mappingHandle == NULL)
+		return false;
+	void* pMemory = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedMemoryChannelHeader));
+	if (pMemory == NULL)
+	{
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	m_mappingHandle = (long long int)mappingHandle;
+	m_pHeader = (SharedMemoryChannelHeader*)pMemory;
+
+	if (!openSignalEvents(m_fullName, m_eventHandles))
+	{
+		closeSharedMemory();
+		return false;
+	}
+	return true;
+}
+
+void SharedMemoryChannel::closeSharedMemory()
+{
+	if (m_pHeader)
+	{
+		UnmapViewOfFile(m_pHeader);
+		m_pHeader = nullptr;
+	}
+	if (m_mappingHandle != INVALID_HANDLE)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+		m_mappingHandle = INVALID_HANDLE;
+	}
+	for (int signal = 0; signal < 4; ++signal)
+	{
+		if (m_eventHandles[signal] != INVALID_HANDLE)
+		{
+			CloseHandle((HANDLE)m_eventHandles[signal]);
+			m_eventHandles[signal] = INVALID_HANDLE;
+		}
+	}
+	if (m_peerProcessHandle != INVALID_HANDLE)
+	{
+		CloseHandle((HANDLE)m_peerProcessHandle);
+		m_peerProcessHandle = INVALID_HANDLE;
+	}
+}
+
+bool SharedMemoryChannel::openPeerProcess()
+{
+	unsigned int processId = m_bServer ? m_pHeader->clientProcessId.load() : m_pHeader->serverProcessId.load();
+	HANDLE processHandle = OpenProcess(SYNCHRONIZE, FALSE, processId);
+	if (processHandle == NULL)
+		return false;
+	m_peerProcessHandle = (long long int)processHandle;
+	return true;
+}
+
+bool SharedMemoryChannel::isPeerAlive()
+{
+	if (m_peerProcessHandle == INVALID_HANDLE)
+		return false;
+	return WaitForSingleObject((HANDLE)m_peerProcessHandle, 0) == WAIT_TIMEOUT;
+}
+
+unsigned int SharedMemoryChannel::getCurrentProcessId()
+{
+	return (unsigned int)GetCurrentProcessId();
+}
+
+void SharedMemoryChannel::waitForSignal(int signal, unsigned int expectedValue, int timeoutMs)
+{
+	//the event stays signaled if it was set after expectedValue was read, so no wake-up can be lost
+	WaitForSingleObject((HANDLE)m_eventHandles[signal], (DWORD)timeoutMs);
+}
+
+void SharedMemoryChannel::wakeUpSignal(int signal)
+{
+	SetEvent((HANDLE)m_eventHandles[signal]);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+
+#define MAX_SHARED_MEMORY_NAME_SIZE 1024
+#define SHARED_MEMORY_RING_SIZE (64 * 1024) //must be a power of 2
+
+//Layout of the shared memory segment. The atomics must be lock-free so that they can be shared between processes
+struct SharedMemoryRing
+{
+	//positions increase monotonically: the position in the buffer is pos % SHARED_MEMORY_RING_SIZE
+	alignas(64) std::atomic<unsigned long long> writePos;
+	alignas(64) std::atomic<unsigned long long> readPos;
+	//signals are incremented to wake up the other side: [0] data available, [1] free space available
+	alignas(64) std::atomic<unsigned int> signals[2];
+	std::atomic<unsigned int> numWaiting[2];
+	alignas(64) char buffer[SHARED_MEMORY_RING_SIZE];
+};
+
+struct SharedMemoryChannelHeader
+{
+	unsigned int magicNumber;
+	std::atomic<unsigned int> serverProcessId;
+	std::atomic<unsigned int> clientProcessId;
+	std::atomic<unsigned int> bServerClosed;
+	std::atomic<unsigned int> bClientClosed;
+	//[0]: server to client, [1]: client to server
+	SharedMemoryRing rings[2];
+};
+
+//Bidirectional channel between two processes with the same interface as NamedPipe. Data is exchanged through two
+//single-producer/single-consumer rings in a shared memory segment (one per direction), so no system call is needed
+//to send or receive data as long as the other side is active. A reader with no data first spins for a while and then
+//blocks (on a futex in Linux and on a named event in Windows) until the writer wakes it up
+class SharedMemoryChannel
+{
+protected:
+	bool m_bVerbose = false;
+	bool m_bServer = false;
+
+	char m_fullName[MAX_SHARED_MEMORY_NAME_SIZE];
+
+	SharedMemoryChannelHeader* m_pHeader = nullptr;
+
+	//platform-dependent handles
+	long long int m_mappingHandle = -1;
+	long long int m_peerProcessHandle = -1;
+	long long int m_eventHandles[4] = { -1, -1, -1, -1 };
+
+	//if bAddPrefix, the platform's prefix for shared objects is prepended to the name
+	//if id>=0, the id is appended to the name
+	void setName(const char* name, bool bAddPrefix = true, int id = -1);
+
+	void logMessage(const char* message);
+
+	//platform-dependent functions
+	bool createSharedMemory();
+	bool openSharedMemory();
+	void closeSharedMemory();
+	bool openPeerProcess();
+	bool isPeerAlive();
+	unsigned int getCurrentProcessId();
+	//signals are identified by ringIndex * 2 + signal type
+	std::atomic<unsigned int>* getSignal(int signal);
+	//blocks until the signal changes its value from expectedValue or timeoutMs milliseconds pass
+	void waitForSignal(int signal, unsigned int expectedValue, int timeoutMs);
+	void wakeUpSignal(int signal);
+
+	int outgoingRingIndex() const { return m_bServer ? 0 : 1; }
+	int incomingRingIndex() const { return m_bServer ? 1 : 0; }
+	bool isPeerConnected();
+	void notify(int ringIndex, int signalType);
+	//Spins and then blocks until the condition is true or the other process disconnects. Returns the condition
+	template <typename Condition>
+	bool waitUntil(int ringIndex, int signalType, Condition condition);
+public:
+	SharedMemoryChannel();
+	virtual ~SharedMemoryChannel();
+
+	//Both calls block until all the bytes are transferred or the other side disconnects, and return the number of
+	//bytes actually transferred
+	int writeBuffer(const void* pBuffer, int numBytes);
+	int readToBuffer(void *pBuffer, int numBytes);
+
+	const char* getFullName() { return m_fullName; }
+	bool isConnected();
+
+	void setVerbose(bool set) { m_bVerbose = set; }
+};
+
+class SharedMemoryChannelServer : public SharedMemoryChannel
+{
+public:
+	SharedMemoryChannelServer();
+	virtual ~SharedMemoryChannelServer();
+
+	//Creates the shared memory segment using the first unused name formed by appending an id to the given name.
+	//getFullName() should be used after to retrieve the actual name so that the client can open it
+	bool openUniqueChannelServer(const char* name);
+
+	//Returns true once the client has connected. Returns false if it didn't in timeoutMs milliseconds
+	bool waitForClientConnection(int timeoutMs);
+	void closeServer();
+};
+
+class SharedMemoryChannelClient : public SharedMemoryChannel
+{
+public:
+	SharedMemoryChannelClient();
+	virtual ~SharedMemoryChannelClient();
+
+	bool connectToServer(const char* name, bool bAddPrefix = true);
+	void closeConnection();
+};